@@ -13,10 +13,28 @@
 
 #include <immintrin.h>
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
 #if defined(_WIN64) || defined(_WIN32)
 #define __lzcnt32(a) __lzcnt(a)
 #endif
 
+/* Functions using instructions the compiler wasn't told it could use need a target attribute. MSVC doesn't need it. A
+ * function with a target attribute can inline a function without one, but not the other way around. So when a generic body
+ * calls a target specific helper, flatten the target function to get the helper inlined into the copy of the body in it.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define ELK_TARGET(features) __attribute__((target(features)))
+#define ELK_FLATTEN __attribute__((flatten))
+#else
+#define ELK_TARGET(features)
+#define ELK_FLATTEN
+#endif
+
 /*---------------------------------------------------------------------------------------------------------------------------
  * TODO: Things I'd like to add.
  *-------------------------------------------------------------------------------------------------------------------------*/
@@ -103,6 +121,8 @@ static f64 const ELK_SQRT2PI  = 2.50662827463100024161;
 
 void *memcpy(void *dst, void const *src, size_t num_bytes);
 void *memset(void *buffer, int val, size_t num_bytes);
+void *memmove(void *dst, void const *src, size_t num_bytes);
+void *memchr(void const *buffer, int val, size_t num_bytes);
 int memcmp(const void *s1, const void *s2, size_t num_bytes);
 
 /*---------------------------------------------------------------------------------------------------------------------------
@@ -181,6 +201,13 @@ typedef enum
     ElkWeek = 60 * 60 * 24 * 7,
 } ElkTimeUnit;
 
+typedef enum
+{
+    ElkCalendarDay,
+    ElkCalendarMonth,
+    ElkCalendarYear,
+} ElkCalendarUnit;
+
 static ElkTime const elk_unix_epoch_timestamp = INT64_C(62135596800);
 
 static inline i64 elk_time_to_unix_epoch(ElkTime time);
@@ -189,12 +216,70 @@ static inline b32 elk_is_leap_year(int year);
 static inline ElkTime elk_make_time(ElkStructTime tm); /* Ignores the day_of_year member. */
 static inline ElkTime elk_time_truncate_to_hour(ElkTime time);
 static inline ElkTime elk_time_truncate_to_specific_hour(ElkTime time, int hour);
+static inline ElkTime elk_time_truncate(ElkTime time, ElkTimeDiff interval, ElkTimeDiff offset);
+static inline ElkTime elk_time_truncate_to_calendar(ElkTime time, ElkCalendarUnit unit);
 static inline ElkTime elk_time_add(ElkTime time, ElkTimeDiff change_in_time);
 static inline ElkTimeDiff elk_time_difference(ElkTime a, ElkTime b); /* a - b */
 
 static inline ElkTime elk_time_from_ymd_and_hms(int year, int month, int day, int hour, int minutes, int seconds);
 static inline ElkTime elk_time_from_yd_and_hms(int year, int day_of_year, int hour, int minutes, int seconds);
 static inline ElkStructTime elk_make_struct_time(ElkTime time);
+
+/* Converting many times at once.
+ *
+ * The broken down times are stored as a structure of arrays, one column for each member of ElkStructTime, and each column
+ * must have room for n values. elk_time_to_columns() skips any column that is NULL, so if you only need the day of the
+ * year and the hour don't pass the others. elk_time_from_columns() ignores the day_of_year column, but all the others are
+ * required, and like elk_time_from_ymd_and_hms() the values must be valid. With AVX2 these convert 8 values at a time,
+ * and all of the divisions are done as multiplies and shifts.
+ */
+typedef struct
+{
+    i16 *year;
+    i8 *month;
+    i8 *day;
+    i8 *hour;
+    i8 *minute;
+    i8 *second;
+    i16 *day_of_year;
+} ElkTimeColumns;
+
+static inline void elk_time_to_columns(ElkTime const *times, size n, ElkTimeColumns columns);
+static inline void elk_time_from_columns(ElkTimeColumns columns, size n, ElkTime *out);
+
+/* Truncating many times at once, out may be the same array as times.
+ *
+ * elk_time_truncate() finds the start of the interval containing a time, where the intervals are interval seconds long
+ * and start offset seconds after the epoch (or any multiple of interval from there). So 3 hourly synoptic times are
+ * (3 * ElkHour, 0), and days starting at 12Z are (ElkDay, 12 * ElkHour). The epoch was a Monday, so (ElkWeek, 0) gives
+ * weeks starting on Monday. Times less than offset seconds after the epoch truncate to before it. With AVX2 the batch
+ * versions do the division as a multiply by the reciprocal in f64, which is exact over the whole ElkTime range.
+ */
+static inline void elk_time_truncate_batch(ElkTime const *times, size n, ElkTimeDiff interval, ElkTimeDiff offset,
+        ElkTime *out);
+static inline void elk_time_truncate_to_calendar_batch(ElkTime const *times, size n, ElkCalendarUnit unit, ElkTime *out);
+
+/* Resampling a sorted, irregular time series onto the regular grid start, start + step, ... with num_out points. The grid
+ * and the observations are walked together in one pass, so there's no searching.
+ *
+ *  - ELK_RESAMPLE_STEP uses the last observation at or before each grid time, like a step function.
+ *  - ELK_RESAMPLE_NEAREST uses the closest observation before or after, the earlier one on a tie.
+ *  - ELK_RESAMPLE_LINEAR interpolates between the observations on either side.
+ *
+ * max_gap limits how far apart the data can be, use INT64_MAX for no limit. For step and nearest it's the longest time
+ * between the grid time and the observation used, and for linear it's the longest time between the two observations. A
+ * grid time that matches an observation always gets its value (the last one if there are duplicate times). Grid points
+ * without a value are set to NaN, and the return value is the number of grid points that got one.
+ */
+typedef enum
+{
+    ELK_RESAMPLE_STEP,
+    ELK_RESAMPLE_NEAREST,
+    ELK_RESAMPLE_LINEAR,
+} ElkResampleMethod;
+
+static inline size elk_time_series_resample(ElkTime const *times, f64 const *values, size n, ElkTime start,
+        ElkTimeDiff step, size num_out, ElkResampleMethod method, ElkTimeDiff max_gap, f64 *out);
 /*---------------------------------------------------------------------------------------------------------------------------
  *                                                      String Slice
  *---------------------------------------------------------------------------------------------------------------------------
@@ -237,11 +322,19 @@ static inline ElkStrSplitPair elk_str_split_on_char(ElkStr str, char const split
  * numeric will cause a parse error for the number parsing cases. Robust parsers check for more error cases, and fast 
  * parsers make more assumptions. 
  *
+ * For i64, values that overflow are an error. Strings up to 16 characters long are parsed with SSSE3 if it's available.
+ *
  * For f64, the fast parser assumes no NaN or Infinity values or any errors of any kind. The robust parser checks for NaN,
- * +/- Infinity, and overflow.
+ * +/- Infinity, and overflow. Both are correctly rounded, they use the Eisel-Lemire algorithm with a table of 128 bit
+ * powers of 5. Values with more than 19 significant digits are accepted by both, they fall back to a much slower big
+ * integer comparison in the rare cases where the extra digits decide which way to round.
  *
- * Parsing datetimes assumes a format YYYY-MM-DD HH:MM:SS, YYYY-MM-DDTHH:MM:SS, YYYYDDDHHMMSS. The latter format is the 
- * year, day of the year, hours, minutes, and seconds.
+ * Parsing datetimes assumes a format YYYY-MM-DD HH:MM:SS, YYYY-MM-DDTHH:MM:SS, YYYYDDDHHMMSS, YYYYMMDDHHMM, or YYYYMMDDHH,
+ * picked by the length of the string. The YYYYDDDHHMMSS format is the year, day of the year, hours, minutes, and seconds.
+ * Every field is checked, including the day against the length of the month, all at once with AVX2 if it's available.
+ * The long format can also be ISO 8601 with fractional seconds (up to 9 digits) and a time zone, either Z or an offset
+ * like +HH:MM, +HHMM, or +HH, e.g. 2024-05-01T12:00:00.250-06:00. Times with an offset are converted to UTC. The fraction
+ * is dropped by elk_str_parse_datetime(), elk_str_parse_datetime_ns() also returns it in nanoseconds.
  *
  * In general, these functions return true on success and false on failure. On falure the out argument is left untouched.
  */
@@ -249,6 +342,68 @@ static inline b32 elk_str_parse_i64(ElkStr str, i64 *result);
 static inline b32 elk_str_robust_parse_f64(ElkStr str, f64 *out);
 static inline b32 elk_str_fast_parse_f64(ElkStr str, f64 *out);
 static inline b32 elk_str_parse_datetime(ElkStr str, ElkTime *out);
+static inline b32 elk_str_parse_datetime_ns(ElkStr str, ElkTime *out, i32 *nanoseconds);
+
+/* Parse a whole column of f64 values, the results are exactly the same as elk_str_robust_parse_f64(), including correct
+ * rounding of values with more than 19 significant digits. Short decimals (up to 16 characters) like -12.3 or 1013.25 are
+ * checked and converted two at a time with AVX2, anything else goes through the robust parser. Values that fail to parse are set to NaN, and if ok is not NULL it gets true or false for each value. The
+ * return value is the number of values parsed successfully.
+ */
+static inline size elk_str_parse_f64_batch(ElkStr const *tokens, size n, f64 *out, b32 *ok);
+
+/* Parse a whole column of datetimes, the results are exactly the same as elk_str_parse_datetime(). With AVX2, groups of 8
+ * values that are all the same length are decoded two per register, and the conversion to ElkTime is done in vector lanes
+ * too. Groups with mixed lengths or ISO 8601 suffixes are parsed one at a time. Values that fail to parse are set to
+ * INT64_MIN, and like elk_str_parse_f64_batch(), ok can be NULL and the return value is the number parsed successfully.
+ */
+static inline size elk_str_parse_datetime_batch(ElkStr const *tokens, size n, ElkTime *out, b32 *ok);
+
+/* Parse decimals into integers scaled by 10^decimals with no floating point step, e.g. -12.34 with 1 decimal is -123.
+ * Extra digits after the decimal point are rounded half away from zero, and missing ones are taken as zeros. There is no
+ * exponent part, and overflow is an error. The batch version stores the values as i32 for compact columns, values that fail
+ * to parse or don't fit are set to INT32_MIN. Like elk_str_parse_f64_batch(), short values are parsed two at a time with
+ * AVX2, ok can be NULL, and the return value is the number parsed successfully. decimals must be in the range 0 to 18.
+ */
+static inline b32 elk_str_parse_fixed(ElkStr str, i32 decimals, i64 *out);
+static inline size elk_str_parse_fixed_batch(ElkStr const *tokens, size n, i32 decimals, i32 *out, b32 *ok);
+
+/* Formatting values as strings.
+ *
+ * The value is written to dest and the returned string points into it, if it doesn't fit in dst_len bytes nothing is
+ * written and the returned string is empty with a NULL start. No terminating zero is added. The buffer sizes below are
+ * always big enough. The versions ending in _alloc (see the Static Arena section) copy the result into an arena instead.
+ *
+ * Integers are formatted two digits at a time from a table. elk_str_format_f64() writes the shortest string that parses
+ * back to exactly the same value, using the Schubfach algorithm. It's plain decimal notation unless that would need more
+ * than 3 zeros after the decimal point before the first digit, or more than 17 digits before the decimal point. Then it's
+ * like 1.25e-7 or 6.02e23. elk_str_format_f64_fixed() writes exactly num_decimals digits (0 to 17) after the decimal
+ * point, correctly rounded half to even from the exact binary value like printf("%.*f"), except values that round to zero
+ * never get a minus sign. Both write NaN, Infinity, and -Infinity so they round trip through elk_str_robust_parse_f64().
+ */
+#define ELK_I64_FORMAT_MAX_LEN 20
+#define ELK_F64_FORMAT_MAX_LEN 24
+#define ELK_F64_FIXED_FORMAT_MAX_LEN 328
+
+static inline ElkStr elk_str_format_i64(i64 value, size dst_len, char *dest);
+static inline ElkStr elk_str_format_f64(f64 value, size dst_len, char *dest);
+static inline ElkStr elk_str_format_f64_fixed(f64 value, i32 num_decimals, size dst_len, char *dest);
+
+/* Formatting times in the same formats elk_str_parse_datetime() accepts, all in UTC. The compact formats leave off the
+ * smaller fields instead of rounding. Years after 9999 get 5 digits, so they won't parse back.
+ */
+typedef enum
+{
+    ELK_DATETIME_LONG,              // YYYY-MM-DD HH:MM:SS
+    ELK_DATETIME_ISO_8601,          // YYYY-MM-DDTHH:MM:SS
+    ELK_DATETIME_ISO_8601_Z,        // YYYY-MM-DDTHH:MM:SSZ
+    ELK_DATETIME_DAY_OF_YEAR,       // YYYYDDDHHMMSS
+    ELK_DATETIME_COMPACT_MINUTES,   // YYYYMMDDHHMM
+    ELK_DATETIME_COMPACT_HOURS,     // YYYYMMDDHH
+} ElkDatetimeFormat;
+
+#define ELK_DATETIME_FORMAT_MAX_LEN 21
+
+static inline ElkStr elk_time_format(ElkTime time, ElkDatetimeFormat format, size dst_len, char *dest);
 
 #define elk_str_parse_elk_time(str, result) elk_str_parse_i64((str), (result))
 
@@ -308,6 +463,20 @@ static inline void elk_static_arena_free(ElkStaticArena *arena, void *ptr); // U
 #define elk_static_arena_nmalloc(arena, count, type) (type *)elk_static_arena_alloc((arena), (count) * sizeof(type), _Alignof(type))
 #define elk_static_arena_nrealloc(arena, ptr, count, type) (type *) elk_static_arena_realloc((arena), (ptr), sizeof(type) * (count))
 
+/* String formatting that allocates the result in an arena, see elk_str_format_i64() and friends. */
+static inline ElkStr elk_str_format_i64_alloc(i64 value, ElkStaticArena *arena);
+static inline ElkStr elk_str_format_f64_alloc(f64 value, ElkStaticArena *arena);
+static inline ElkStr elk_str_format_f64_fixed_alloc(f64 value, i32 num_decimals, ElkStaticArena *arena);
+static inline ElkStr elk_time_format_alloc(ElkTime time, ElkDatetimeFormat format, ElkStaticArena *arena);
+
+/* Format a whole column of times into one block allocated from the arena, out[i] points at the text for times[i] and
+ * they're back to back with no separators. With AVX2 the digits for 8 times are computed together in vector lanes, and
+ * each time is shuffled into place and written with a single store. Returns false, with nothing allocated, if the arena
+ * doesn't have room.
+ */
+static inline b32 elk_time_format_batch(ElkTime const *times, size n, ElkDatetimeFormat format, ElkStaticArena *arena,
+        ElkStr *out);
+
 #ifdef _ELK_TRACK_MEM_USAGE
 static ElkStaticArenaAllocationMetrics elk_static_arena_metrics[128] = {0};
 static size elk_static_arena_metrics_next = 0;
@@ -315,6 +484,69 @@ static inline f64 elk_static_arena_max_ratio(ElkStaticArena *arena);
 static inline b32 elk_static_arena_over_allocated(ElkStaticArena *arena);
 #endif
 
+/*---------------------------------------------------------------------------------------------------------------------------
+ *                                                  CPU Features & Dispatch
+ *---------------------------------------------------------------------------------------------------------------------------
+ *
+ * The SIMD code paths are normally picked at compile time. If this file is compiled with AVX2 enabled (e.g. -march=native)
+ * then the AVX2 versions are always used, they get inlined, and none of this is needed. But a binary built that way won't
+ * run on older hardware, and a binary built without it leaves a lot of performance on the table.
+ *
+ * So for portable builds, the caller can check what the CPU supports at startup with elk_cpu_features_detect() and use it
+ * to create a dispatch table of the best functions for that CPU. There is no global state, the dispatch table is just a
+ * value the caller keeps around and passes to functions that take one (e.g. elk_csv_create_parser_dispatch()), or calls
+ * through directly. The variants are compiled with target attributes, so it doesn't matter what flags the file using this
+ * library was compiled with.
+ */
+typedef struct
+{
+    b32 sse2;
+    b32 sse42;
+    b32 popcnt;
+    b32 pclmul;
+    b32 avx2;       // Only set if the OS also saves the AVX registers.
+    b32 bmi2;
+} ElkCpuFeatures;
+
+/* Scan a 32 byte block for 4 different characters, bits[i] has a bit set for every byte equal to chars[i]. If the block is
+ * aligned on a 32 byte boundary it never crosses a page boundary, so it's safe to read past the end of a string.
+ */
+typedef void (*ElkScanCharsFunction)(char const *block, char const chars[4], u32 bits[4]);
+typedef b32 (*ElkParseDatetimeFunction)(ElkStr str, ElkTime *out);
+typedef size (*ElkParseF64BatchFunction)(ElkStr const *tokens, size n, f64 *out, b32 *ok);
+typedef size (*ElkParseDatetimeBatchFunction)(ElkStr const *tokens, size n, ElkTime *out, b32 *ok);
+typedef void (*ElkTimeToColumnsFunction)(ElkTime const *times, size n, ElkTimeColumns columns);
+typedef void (*ElkTimeFromColumnsFunction)(ElkTimeColumns columns, size n, ElkTime *out);
+typedef void (*ElkTimeTruncateBatchFunction)(ElkTime const *times, size n, ElkTimeDiff interval, ElkTimeDiff offset,
+        ElkTime *out);
+typedef void (*ElkTimeTruncateToCalendarBatchFunction)(ElkTime const *times, size n, ElkCalendarUnit unit, ElkTime *out);
+typedef b32 (*ElkTimeFormatBatchFunction)(ElkTime const *times, size n, ElkDatetimeFormat format, ElkStaticArena *arena,
+        ElkStr *out);
+
+/* Stage 1 of the CSV structural index, chars are the quote, delimiter, '\n', and comment characters. Fills in the bitmaps
+ * for the blocks from base to end and returns the number of comment lines. The prefix XOR that finds the quoted strings is
+ * one carry-less multiply with PCLMUL.
+ */
+typedef size (*ElkCsvIndexBlocksFunction)(char const *base, size start, size end, char const chars[4], u64 *delimiter_bits,
+        u64 *newline_bits, b32 *ends_in_comment);
+
+typedef struct
+{
+    ElkScanCharsFunction scan_chars;                    // Used by the CSV parser.
+    ElkParseDatetimeFunction parse_datetime;            // Same as elk_str_parse_datetime().
+    ElkParseF64BatchFunction parse_f64_batch;           // Same as elk_str_parse_f64_batch().
+    ElkParseDatetimeBatchFunction parse_datetime_batch; // Same as elk_str_parse_datetime_batch().
+    ElkTimeToColumnsFunction time_to_columns;           // Same as elk_time_to_columns().
+    ElkTimeFromColumnsFunction time_from_columns;       // Same as elk_time_from_columns().
+    ElkTimeTruncateBatchFunction time_truncate_batch;   // Same as elk_time_truncate_batch().
+    ElkTimeTruncateToCalendarBatchFunction time_truncate_to_calendar_batch; // elk_time_truncate_to_calendar_batch()
+    ElkTimeFormatBatchFunction time_format_batch;       // Same as elk_time_format_batch().
+    ElkCsvIndexBlocksFunction csv_index_blocks;         // Used by elk_csv_index_create_dispatch().
+} ElkDispatch;
+
+static inline ElkCpuFeatures elk_cpu_features_detect(void);
+static inline ElkDispatch elk_dispatch_create(ElkCpuFeatures features);
+
 /*---------------------------------------------------------------------------------------------------------------------------
  *                                                  Static Pool Allocator
  *---------------------------------------------------------------------------------------------------------------------------
@@ -686,6 +918,42 @@ static inline void elk_radix_sort(
         ElkRadixSortByType sort_type, 
         ElkSortOrder order);
 
+/*---------------------------------------------------------------------------------------------------------------------------
+ *                                                 Sorted Time Series Search
+ *---------------------------------------------------------------------------------------------------------------------------
+ * Binary search on a big sorted array misses the cache on almost every step. The time index is a static B+ tree (an
+ * S+ tree) over a sorted ElkTime column. The leaves are the column itself, in blocks of 8, so the index only stores about 1
+ * key for every 7 values. Every node is 8 keys in one cache line, compared all at once with AVX2, so a search touches one
+ * cache line per level and a 10 million value index only has 8 levels. The column must stay alive and unchanged while the
+ * index is in use.
+ *
+ * The searches work like the C++ standard library. elk_time_index_lower_bound() is the position of the first time that is
+ * not before t, and elk_time_index_upper_bound() is the position of the first time after t, so the times in [start, end)
+ * are at positions lower_bound(start) up to lower_bound(end). elk_time_index_as_of() is the position of the last time at or
+ * before t, the "value as of t" query, or -1 if there isn't one. Positions of n mean past the end.
+ *
+ * elk_time_as_of_join() matches every time in the sorted left column to the as-of position in the sorted right column, or
+ * -1 if there isn't one or it's more than tolerance seconds before, like matching observations to the latest forecast. It
+ * is a single merge pass that gallops through long runs in the right column, and returns the number of matches.
+ */
+#define ELK_TIME_INDEX_MAX_LEVELS 20
+
+typedef struct
+{
+    ElkTime const *times;                           // The sorted column, these are the leaves.
+    size n;
+    i32 num_levels;                                 // Levels of internal nodes, 0 for 8 or fewer times.
+    ElkTime *levels[ELK_TIME_INDEX_MAX_LEVELS];     // levels[0] is the root, each is padded to whole nodes.
+    ElkTime last_leaf[8];                           // A padded copy of the last block of times.
+} ElkTimeIndex;
+
+static inline b32 elk_time_index_create(ElkTime const *sorted_times, size n, ElkStaticArena *arena, ElkTimeIndex *index);
+static inline size elk_time_index_lower_bound(ElkTimeIndex const *index, ElkTime t);
+static inline size elk_time_index_upper_bound(ElkTimeIndex const *index, ElkTime t);
+static inline size elk_time_index_as_of(ElkTimeIndex const *index, ElkTime t);
+static inline size elk_time_as_of_join(ElkTime const *left, size n_left, ElkTime const *right, size n_right,
+        ElkTimeDiff tolerance, size *matches);
+
 /*---------------------------------------------------------------------------------------------------------------------------
  *
  *                                         
@@ -699,7 +967,8 @@ static inline void elk_radix_sort(
  *---------------------------------------------------------------------------------------------------------------------------
  * Parsing a string may modify it, especially if it uses quotes a lot. The only function in this API that modifies the 
  * the string in place is the elk_csv_unquote_str() function. So, this function cannot be used if you're parsing a string 
- * stored in read only memory, which is probably the case if parsing a memory mapped file. None of the other functions in 
+ * stored in read only memory, which is probably the case if parsing a memory mapped file, use elk_csv_lazy_unquote_str()
+ * instead. None of the other functions in 
  * this API modify the string they are parsing. However, you (the user) may modify strings (memory) returned by the 
  * elk_csv_*_next_token() functions. So be very careful using this API if you're parsing read only memory.
  *
@@ -720,30 +989,271 @@ typedef struct
     ElkStr value; // The value not including the comma or any new line character
 } ElkCsvToken;
 
+/* The characters used to separate values, quote strings, and start comment lines can be changed with a dialect, e.g. for
+ * tab or pipe separated values. All of them are found with the same SIMD compares as the default dialect, so it's just as
+ * fast. Rows are always separated by '\n', but if crlf is set the '\r' before it is removed from the last value in the row.
+ *
+ * Everything that reads CSV has a *_dialect() version: the parsers, the stream parser, the structural index, the column
+ * loader, and the chunk splitter. The versions without a dialect use ELK_CSV_DIALECT_DEFAULT. The writer takes one too.
+ * The elk_csv_unquote_str() and elk_csv_simple_unquote_str() helpers always use '"', elk_csv_lazy_unquote_str() takes
+ * the quote character.
+ */
+typedef struct
+{
+    char delimiter;
+    char quote;
+    char comment;
+    b32 crlf;
+} ElkCsvDialect;
+
+#define ELK_CSV_DIALECT_DEFAULT ((ElkCsvDialect){ .delimiter = ',', .quote = '"', .comment = '#', .crlf = false })
+
 typedef struct
 {
     ElkStr remaining;       // The portion of the string remaining to be parsed. Useful for diagnosing parse errors.
     size row;               // Only counts parseable rows, comment lines don't count.
     size col;               // CSV column, that is, how many commas have we passed on this line.
     b32 error;              // Have we encountered an error while parsing?
-#ifdef __AVX2__
     i32 byte_pos;
 
-    __m256i buf;
     u32 buf_comma_bits;
     u32 buf_newline_bits;
     u32 buf_any_delimiter_bits;
     u32 carry;
-#endif
+
+    ElkScanCharsFunction scan_chars; // Ignored if compiled with AVX2 enabled, AVX2 is always used then.
+    ElkCsvDialect dialect;
 } ElkCsvParser;
 
 static inline ElkCsvParser elk_csv_create_parser(ElkStr input);
+static inline ElkCsvParser elk_csv_create_parser_dispatch(ElkStr input, ElkDispatch const *dispatch); // NULL for defaults
+static inline ElkCsvParser elk_csv_create_parser_dialect(ElkStr input, ElkCsvDialect dialect, ElkDispatch const *dispatch);
 static inline ElkCsvToken elk_csv_full_next_token(ElkCsvParser *parser);
 static inline ElkCsvToken elk_csv_fast_next_token(ElkCsvParser *parser);
 static inline b32 elk_csv_finished(ElkCsvParser *parser);
+
+/* Parse the rest of the current row in one call using the same assumptions as the fast parser. Up to max_fields values are
+ * stored in fields, and the return value is the number of fields actually in the row, so ragged rows are easy to detect.
+ * If the return value is larger than max_fields, the extra fields were skipped.
+ */
+static inline size elk_csv_next_row(ElkCsvParser *parser, size max_fields, ElkStr *fields);
+
+/* Like elk_csv_next_row(), but only the columns with their bit set in column_mask are returned, so only the first 64
+ * columns can be selected. The values are packed into fields in column order, so it needs room for as many values as there
+ * are bits set in column_mask. Wanted columns missing from a short row are returned as empty strings. The return value is
+ * the number of fields actually in the row. The fast version finds the wanted columns by counting the commas in between with
+ * a popcount, the unwanted fields are never visited.
+ */
+static inline size elk_csv_next_projected_row(ElkCsvParser *parser, u64 column_mask, ElkStr *fields);
 static inline ElkStr elk_csv_unquote_str(ElkStr str, ElkStr const buffer);
 static inline ElkStr elk_csv_simple_unquote_str(ElkStr str);
 
+/* Remove the quotes without modifying the input, so it's safe for read only (e.g. memory mapped) input. If there are no
+ * escaped quotes inside the value, the result is a slice of the input and nothing is copied. Only values with escaped quotes
+ * are copied into the arena with the escapes removed. Values that aren't quoted are returned as is. If the arena is out of
+ * memory, the returned string has a NULL start. The quote character is usually '"', but it can come from a dialect.
+ */
+static inline ElkStr elk_csv_lazy_unquote_str(ElkStr str, char quote, ElkStaticArena *arena);
+
+/* Parallel parsing of large CSV inputs.
+ *
+ * This library doesn't create threads, that's system specific. Instead these functions split the input up so the user can
+ * hand the pieces out to their own worker threads. It takes three steps.
+ *
+ *   1. elk_csv_chunks_create() splits the input into roughly equal sized chunks. It's cheap, call it on one thread.
+ *   2. elk_csv_chunk_scan() must be called once for every chunk, and these calls can run in parallel. It counts the quotes
+ *      in the chunk and finds where the first row ends for both the case where the chunk starts inside a quoted string and
+ *      the case where it doesn't.
+ *   3. elk_csv_chunks_finalize() walks the scan results on one thread, works out which chunks really start inside a quoted
+ *      string, and moves each chunk boundary up to the start of the next row. Chunks without a row boundary in them get
+ *      merged into the previous chunk, and the number of chunks left is returned.
+ *
+ * After that, each chunk's text can be parsed by its own ElkCsvParser on its own thread. The first chunk starts at the
+ * beginning of the input, so it has the header row. Each worker should write to its own output, and then concatenating the
+ * outputs in chunk order keeps the rows in the same order they were in the input. The row numbers in the tokens are relative
+ * to the start of the chunk, the number of rows in earlier chunks must be added to get the row number in the whole input.
+ *
+ * Like the fast parser, this assumes there are no comment lines after the start of the file. A comment line with an odd
+ * number of quotes in it would throw off the quote counting.
+ */
+typedef struct
+{
+    ElkStr text;           // The rows in this chunk. After finalizing, this always starts at the beginning of a row.
+    size quote_count;      // Internal only, number of quote characters in the chunk.
+    size first_row_end[2]; // Internal only, offset just past the first row ending if starting outside [0] or inside [1] quotes.
+    ElkCsvDialect dialect; // Internal only, set by elk_csv_chunks_create_dialect().
+} ElkCsvChunk;
+
+static inline size elk_csv_chunks_create(ElkStr input, size max_chunks, ElkCsvChunk *chunks); // returns number of chunks
+static inline size elk_csv_chunks_create_dialect(ElkStr input, ElkCsvDialect dialect, size max_chunks, ElkCsvChunk *chunks);
+static inline void elk_csv_chunk_scan(ElkCsvChunk *chunk);
+static inline size elk_csv_chunks_finalize(size num_chunks, ElkCsvChunk *chunks); // returns number of chunks left
+
+/* Streaming CSV parser for input that's too big to fit in memory, or when you want to start parsing before it's all read.
+ *
+ * The user supplies a fixed size buffer and a function to read more data into it. The read function should copy at most
+ * max_bytes into dest and return the number of bytes copied, 0 at the end of the input, or a negative number on error. For
+ * a file descriptor, that's just a thin wrapper around read(). Memory use is bounded by the size of the buffer.
+ *
+ * The buffer is handed out one window of complete rows at a time to a regular ElkCsvParser, so the fast (SIMD) parser is
+ * used under the hood. A row that starts in one read and ends in another is moved to the front of the buffer before reading
+ * more, so tokens never get split. That means every row must fit in the buffer, if one doesn't the parser stops with an
+ * error. Tokens returned by elk_csv_stream_next_token() point into the buffer, and are only valid until the next call.
+ *
+ * Like the fast parser, comment lines are only skipped at the start of the input, and the tokens are the same no matter
+ * what size the buffer is or how the reads are split up.
+ */
+typedef size (*ElkCsvReadFunction)(void *read_ctx, size max_bytes, byte *dest);
+
+typedef struct
+{
+    ElkCsvParser parser;        // Parser for the current window of complete rows.
+    ElkCsvReadFunction read;
+    void *read_ctx;
+    ElkStr buffer;              // User supplied, fixed size buffer.
+    size filled;                // Number of bytes of data in the buffer.
+    size window_len;            // Number of bytes at the front of the buffer that make up the current window.
+    size row;                   // Number of rows in previous windows.
+    b32 started;                // Past the comment lines at the start of the input?
+    b32 eof;                    // Has the read function signaled the end of the input?
+    b32 error;                  // Have we encountered an error while reading or parsing?
+    ElkCsvDialect dialect;
+    ElkScanCharsFunction scan_chars;
+} ElkCsvStreamParser;
+
+static inline ElkCsvStreamParser elk_csv_create_stream_parser(ElkCsvReadFunction read, void *read_ctx, size buf_size, byte buffer[]);
+static inline ElkCsvStreamParser elk_csv_create_stream_parser_dialect(ElkCsvReadFunction read, void *read_ctx, size buf_size,
+                                                                      byte buffer[], ElkCsvDialect dialect,
+                                                                      ElkDispatch const *dispatch); // NULL for defaults
+static inline ElkCsvToken elk_csv_stream_next_token(ElkCsvStreamParser *parser);
+static inline b32 elk_csv_stream_finished(ElkCsvStreamParser *parser);
+
+/* Two stage CSV parsing with a structural index.
+ *
+ * Stage 1, elk_csv_index_create(), makes one pass over the whole input 64 bytes at a time and builds bitmaps of where every
+ * comma and newline that isn't in a quoted string or a comment line is. It takes 2 bits of index per byte of input, and the
+ * memory comes from the arena. Stage 2 iterates over the index to return tokens without looking at the input again, except
+ * to check the first character of each row for a comment. So unlike the fast parser, comment lines can be anywhere.
+ *
+ * The index can be reused, for instance to count rows or to skip columns without making tokens for them. The input must not
+ * be modified while the index is in use. Finding the quoted strings uses a carry-less multiply if the CPU has PCLMUL, that's
+ * checked at compile time by elk_csv_index_create() and at runtime with a dispatch table.
+ */
+typedef struct
+{
+    char *base;               // Start of the first block, input aligned down to 64 bytes.
+    size start;               // Offset from base to the start of the input.
+    size end;                 // Offset from base to the end of the input.
+    size num_blocks;
+    u64 *delimiter_bits;      // One bit for every comma or newline that separates tokens, one u64 per 64 byte block.
+    u64 *newline_bits;        // Just the newlines.
+    size num_comment_newlines; // Number of newlines that end a comment line.
+    b32 last_row_unterminated; // Does the last row end without a newline?
+    ElkCsvDialect dialect;
+} ElkCsvIndex;
+
+typedef struct
+{
+    ElkCsvIndex const *index;
+    size block;               // Current block.
+    u64 bits;                 // Delimiters not yet processed in the current block.
+    size next_start;          // Offset from base to the start of the next token.
+    size row;                 // Only counts parseable rows, comment lines don't count.
+    size col;
+} ElkCsvIndexIter;
+
+static inline ElkCsvIndex elk_csv_index_create(ElkStr input, ElkStaticArena *arena); // num_blocks == 0 if empty or out of
+                                                                                     // memory
+static inline ElkCsvIndex elk_csv_index_create_dispatch(ElkStr input, ElkStaticArena *arena,
+                                                        ElkDispatch const *dispatch); // NULL for defaults
+static inline ElkCsvIndex elk_csv_index_create_dialect(ElkStr input, ElkCsvDialect dialect, ElkStaticArena *arena,
+                                                       ElkDispatch const *dispatch);
+static inline size elk_csv_index_count_rows(ElkCsvIndex const *index);
+static inline ElkCsvIndexIter elk_csv_index_iter(ElkCsvIndex const *index);
+static inline b32 elk_csv_index_iter_finished(ElkCsvIndexIter *iter);
+static inline ElkCsvToken elk_csv_index_next_token(ElkCsvIndexIter *iter);
+static inline size elk_csv_index_skip_columns(ElkCsvIndexIter *iter, size num_cols); // Won't go past the end of a row,
+                                                                                     // returns number actually skipped.
+
+/* Load a CSV file into typed columns.
+ *
+ * Instead of calling elk_csv_*_next_token() and then parsing each token as it comes, this loader takes a schema with the
+ * type of every column and fills in one array per column (structure of arrays) in a single pass. Tokens are gathered up in
+ * batches of rows and each column of the batch is parsed in a tight loop, so there is no per token dispatch on the type and
+ * the columns come out ready for vectorized math.
+ *
+ * It's built on the structural index above, so comment lines can be anywhere, columns marked ELK_CSV_COL_SKIP cost almost
+ * nothing, and the number of rows is known before any parsing is done. The index and the columns are allocated from the
+ * arena. Blank lines are skipped, and so are any columns past the end of the schema. Quoted values are unquoted
+ * with elk_csv_lazy_unquote_str(), so escaped quotes are unescaped and only those values are copied into the arena.
+ * elk_csv_load_columns_dialect() takes a dialect, and a dispatch table for building the index.
+ *
+ * String columns are interned if an interner is supplied. If interner is NULL, the strings point into the input instead.
+ *
+ * Values that fail to parse, including empty values and columns missing from short rows, are set to INT64_MIN for i64 and
+ * ElkTime columns, NaN for f64 columns, and an empty string for string columns. They are counted in num_parse_errors. The
+ * f64 columns use the robust parser.
+ */
+typedef enum { ELK_CSV_COL_SKIP, ELK_CSV_COL_I64, ELK_CSV_COL_F64, ELK_CSV_COL_TIME, ELK_CSV_COL_STR } ElkCsvColumnType;
+
+typedef struct
+{
+    ElkCsvColumnType type;
+    void *data;             // Array of i64, f64, ElkTime, or ElkStr depending on type, one per row. NULL if skipped or no rows.
+} ElkCsvColumn;
+
+typedef struct
+{
+    size num_rows;          // Number of data rows loaded, doesn't include the header.
+    size num_cols;
+    ElkCsvColumn *cols;
+    size num_parse_errors;
+    b32 error;              // Ran out of memory in the arena.
+} ElkCsvTable;
+
+static inline ElkCsvTable elk_csv_load_columns(ElkStr input, b32 has_header, size num_cols, ElkCsvColumnType const *types,
+                                               ElkStringInterner *interner, ElkStaticArena *arena);
+static inline ElkCsvTable elk_csv_load_columns_dialect(ElkStr input, ElkCsvDialect dialect, b32 has_header, size num_cols,
+                                                       ElkCsvColumnType const *types, ElkStringInterner *interner,
+                                                       ElkStaticArena *arena, ElkDispatch const *dispatch);
+
+/* Writing CSV.
+ *
+ * The writer formats values into a user supplied buffer, and when the buffer fills up it hands the data to a write
+ * function, e.g. a thin wrapper around write() or fwrite(). The write function must take all num_bytes, and it should return
+ * the number of bytes written or a negative number on error. If the write function is NULL, everything has to fit in the
+ * buffer (e.g. a big one from an arena) and it's an error if it doesn't. Either way, the unflushed output is the first len
+ * bytes of the buffer.
+ *
+ * Strings are checked for characters that need quoting 32 bytes at a time with the same SIMD compares the parser uses, and
+ * quotes are escaped only if needed. Numbers and times are formatted without calling into the C library. Floating point
+ * values are formatted with elk_str_format_f64_fixed() if num_decimals is 0 to 17, or with the shortest string that round
+ * trips (elk_str_format_f64()) if it's negative. Times are written in the YYYY-MM-DD HH:MM:SS format.
+ *
+ * The dialect can be changed after creating the writer, but before writing anything. Once an error occurs, nothing else is
+ * written.
+ */
+typedef size (*ElkCsvWriteFunction)(void *write_ctx, size num_bytes, byte const *src);
+
+typedef struct
+{
+    ElkCsvWriteFunction write;
+    void *write_ctx;
+    ElkStr buffer;              // User supplied, fixed size buffer.
+    size len;                   // Number of bytes in the buffer not written out yet.
+    size col;                   // Column of the next value in the current row.
+    ElkCsvDialect dialect;
+    b32 error;
+} ElkCsvWriter;
+
+static inline ElkCsvWriter elk_csv_create_writer(ElkCsvWriteFunction write, void *write_ctx, size buf_size, byte buffer[]);
+static inline void elk_csv_write_str(ElkCsvWriter *writer, ElkStr value);
+static inline void elk_csv_write_i64(ElkCsvWriter *writer, i64 value);
+static inline void elk_csv_write_f64(ElkCsvWriter *writer, f64 value, i32 num_decimals);
+static inline void elk_csv_write_time(ElkCsvWriter *writer, ElkTime value);
+static inline void elk_csv_write_end_row(ElkCsvWriter *writer);
+static inline b32 elk_csv_writer_flush(ElkCsvWriter *writer); // Returns false if there was an error at any point.
+
 /*---------------------------------------------------------------------------------------------------------------------------
  *
  *                                         
@@ -841,6 +1351,44 @@ elk_days_since_epoch(int year)
     return ts;
 }
 
+/* Constant time, branch free conversions between dates and days since the epoch, from H. Hinnant's days_from_civil()
+ * and civil_from_days() at https://howardhinnant.github.io/date_algorithms.html. The years start in March so the leap day
+ * is at the end, and a 400 year era always has 146,097 days. Years are never negative here, so the eras are too.
+ */
+static inline i64
+elk_days_from_civil(int year, int month, int day)
+{
+    i64 const jan_feb = month <= 2;
+    i64 const march_year = year - jan_feb;
+    i64 const march_month = month - 3 + 12 * jan_feb;                       // [0, 11]
+
+    i64 const era = march_year / 400;
+    i64 const year_of_era = march_year - era * 400;                         // [0, 399]
+    i64 const day_of_year = (153 * march_month + 2) / 5 + day - 1;          // [0, 365]
+    i64 const day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+    return era * 146097 + day_of_era - 306; // 0001-01-01 is 306 days after 0000-03-01
+}
+
+static inline void
+elk_civil_from_days(i64 days, int *year, int *month, int *day)
+{
+    /* Everything fits in 32 bits over the supported range, and unsigned division by a constant is the cheapest. */
+    Assert(days >= 0 && days < INT32_MAX - 306);
+
+    u32 const z = (u32)days + 306;
+    u32 const era = z / 146097;
+    u32 const day_of_era = z - era * 146097;                                // [0, 146096]
+    u32 const year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    u32 const day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100); // [0, 365]
+    u32 const march_month = (5 * day_of_year + 2) / 153;                    // [0, 11]
+
+    u32 const jan_feb = march_month >= 10;
+    *day = (int)(day_of_year - (153 * march_month + 2) / 5 + 1);
+    *month = (int)(march_month + 3 - 12 * jan_feb);
+    *year = (int)(year_of_era + era * 400 + jan_feb);
+}
+
 static inline i64
 elk_time_to_unix_epoch(ElkTime time)
 {
@@ -868,41 +1416,57 @@ elk_make_time(ElkStructTime tm)
 }
 
 static inline ElkTime
-elk_time_truncate_to_hour(ElkTime time)
+elk_time_truncate(ElkTime time, ElkTimeDiff interval, ElkTimeDiff offset)
 {
-    ElkTime adjusted = time;
-
-    i64 const seconds = adjusted % SECONDS_PER_MINUTE;
-    adjusted -= seconds;
+    Assert(interval > 0);
 
-    i64 const minutes = (adjusted / SECONDS_PER_MINUTE) % MINUTES_PER_HOUR;
-    adjusted -= minutes * SECONDS_PER_MINUTE;
+    offset %= interval;
+    if(offset < 0) { offset += interval; }
 
-    Assert(adjusted >= 0);
+    i64 into_interval = (time - offset) % interval;
+    if(into_interval < 0) { into_interval += interval; }
 
-    return adjusted;
+    return time - into_interval;
 }
 
 static inline ElkTime
-elk_time_truncate_to_specific_hour(ElkTime time, int hour)
+elk_time_truncate_to_calendar(ElkTime time, ElkCalendarUnit unit)
 {
-    Assert(hour >= 0 && hour <= 23 && time >= 0);
+    Assert(time >= 0);
 
-    ElkTime adjusted = time;
+    switch(unit)
+    {
+        case ElkCalendarDay: return time - time % SECONDS_PER_DAY;
+        case ElkCalendarMonth:
+        {
+            ElkStructTime const tm = elk_make_struct_time(time);
+            return elk_time_from_ymd_and_hms(tm.year, tm.month, 1, 0, 0, 0);
+        }
+        case ElkCalendarYear:
+        {
+            ElkStructTime const tm = elk_make_struct_time(time);
+            return elk_time_from_ymd_and_hms(tm.year, 1, 1, 0, 0, 0);
+        }
+        default: Panic();
+    }
 
-    i64 const seconds = adjusted % SECONDS_PER_MINUTE;
-    adjusted -= seconds;
+    return time;
+}
 
-    i64 const minutes = (adjusted / SECONDS_PER_MINUTE) % MINUTES_PER_HOUR;
-    adjusted -= minutes * SECONDS_PER_MINUTE;
+static inline ElkTime
+elk_time_truncate_to_hour(ElkTime time)
+{
+    Assert(time >= 0);
 
-    i64 actual_hour = (adjusted / SECONDS_PER_HOUR) % HOURS_PER_DAY;
-    if (actual_hour < hour) { actual_hour += 24; }
+    return time - time % SECONDS_PER_HOUR;
+}
 
-    i64 change_hours = actual_hour - hour;
-    Assert(change_hours >= 0);
-    adjusted -= change_hours * SECONDS_PER_HOUR;
+static inline ElkTime
+elk_time_truncate_to_specific_hour(ElkTime time, int hour)
+{
+    Assert(hour >= 0 && hour <= 23 && time >= 0);
 
+    ElkTime const adjusted = elk_time_truncate(time, SECONDS_PER_DAY, hour * SECONDS_PER_HOUR);
     Assert(adjusted >= 0);
 
     return adjusted;
@@ -922,13 +1486,6 @@ elk_time_difference(ElkTime a, ElkTime b)
     return a - b;
 }
 
-// Days in a year up to beginning of month
-static i64 const sum_days_to_month[2][13] = {
-    {0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334},
-    {0, 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335},
-};
-
-
 static inline ElkTime
 elk_time_from_ymd_and_hms(int year, int month, int day, int hour, int minutes, int seconds)
 {
@@ -939,17 +1496,8 @@ elk_time_from_ymd_and_hms(int year, int month, int day, int hour, int minutes, i
     Assert(minutes >= 0 && minutes <= 59);
     Assert(seconds >= 0 && seconds <= 59);
 
-    // Seconds in the years up to now.
-    i64 const num_leap_years_since_epoch = elk_num_leap_years_since_epoch(year);
-    ElkTime ts = (year - 1) * SECONDS_PER_YEAR + num_leap_years_since_epoch * SECONDS_PER_DAY;
-
-    // Seconds in the months up to the start of this month
-    i64 const days_until_start_of_month =
-        elk_is_leap_year(year) ? sum_days_to_month[1][month] : sum_days_to_month[0][month];
-    ts += days_until_start_of_month * SECONDS_PER_DAY;
-
-    // Seconds in the days of the month up to this one.
-    ts += (day - 1) * SECONDS_PER_DAY;
+    // Seconds in the days up to this one.
+    ElkTime ts = elk_days_from_civil(year, month, day) * SECONDS_PER_DAY;
 
     // Seconds in the hours, minutes, & seconds so far this day.
     ts += hour * SECONDS_PER_HOUR;
@@ -992,52 +1540,23 @@ elk_make_struct_time(ElkTime time)
 {
     Assert(time >= 0);
 
-    // Get the seconds part and then trim it off and convert to minutes
-    int const second = (int const)(time % SECONDS_PER_MINUTE);
-    time = (time - second) / SECONDS_PER_MINUTE;
-    Assert(time >= 0 && second >= 0 && second <= 59);
+    // Split into days and seconds into the day, then the hours, minutes, and seconds don't depend on each other.
+    i64 const days_since_epoch = time / SECONDS_PER_DAY;
+    u32 const second_of_day = (u32)(time - days_since_epoch * SECONDS_PER_DAY);
 
-    // Get the minutes part, trim it off and convert to hours.
-    int const minute = (int const)(time % MINUTES_PER_HOUR);
-    time = (time - minute) / MINUTES_PER_HOUR;
-    Assert(time >= 0 && minute >= 0 && minute <= 59);
-
-    // Get the hours part, trim it off and convert to days.
-    int const hour = (int const)(time % HOURS_PER_DAY);
-    time = (time - hour) / HOURS_PER_DAY;
-    Assert(time >= 0 && hour >= 0 && hour <= 23);
-
-    // Rename variable for clarity
-    i64 const days_since_epoch = time;
-
-    // Calculate the year
-    int year = (int)(days_since_epoch / (DAYS_PER_YEAR) + 1); // High estimate, but good starting point.
-    i64 test_time = elk_days_since_epoch(year);
-    while (test_time > days_since_epoch) 
-    {
-        int step = (int)((test_time - days_since_epoch) / (DAYS_PER_YEAR + 1));
-        step = step == 0 ? 1 : step;
-        year -= step;
-        test_time = elk_days_since_epoch(year);
-    }
-    Assert(test_time <= elk_days_since_epoch(year));
-    time -= elk_days_since_epoch(year); // Now it's days since start of the year.
-    Assert(time >= 0);
-    i16 day_of_year = (i16)(time + 1);
+    int const hour = (int)(second_of_day / 3600);
+    int const minute = (int)(second_of_day / 60 % 60);
+    int const second = (int)(second_of_day % 60);
+    Assert(hour <= 23 && minute <= 59 && second <= 59);
 
-    // Calculate the month
+    // Calculate the date without any loops or searching.
+    int year = 0;
     int month = 0;
-    int leap_year_idx = elk_is_leap_year(year) ? 1 : 0;
-    for (month = 1; month <= 11; month++)
-    {
-        if (sum_days_to_month[leap_year_idx][month + 1] > time) { break; }
-    }
-    Assert(time >= 0 && month > 0 && month <= 12);
-    time -= sum_days_to_month[leap_year_idx][month]; // Now in days since start of month
+    int day = 0;
+    elk_civil_from_days(days_since_epoch, &year, &month, &day);
+    Assert(year >= 1 && month >= 1 && month <= 12 && day >= 1 && day <= 31);
 
-    // Calculate the day
-    int const day = (int const)(time + 1);
-    Assert(day > 0 && day <= 31);
+    i16 const day_of_year = (i16)(days_since_epoch - elk_days_since_epoch(year) + 1);
 
     return (ElkStructTime)
     {
@@ -1051,2631 +1570,7022 @@ elk_make_struct_time(ElkTime time)
     };
 }
 
-static inline ElkStr
-elk_str_from_cstring(char *src)
-{
-    size len;
-    for (len = 0; *(src + len) != '\0'; ++len) ; // intentionally left blank.
-    return (ElkStr){.start = src, .len = len};
+static inline void
+elk_time_helper_columns_store(ElkTimeColumns columns, size i, ElkStructTime tm)
+{
+    if(columns.year) { columns.year[i] = tm.year; }
+    if(columns.month) { columns.month[i] = tm.month; }
+    if(columns.day) { columns.day[i] = tm.day; }
+    if(columns.hour) { columns.hour[i] = tm.hour; }
+    if(columns.minute) { columns.minute[i] = tm.minute; }
+    if(columns.second) { columns.second[i] = tm.second; }
+    if(columns.day_of_year) { columns.day_of_year[i] = tm.day_of_year; }
 }
 
-static inline ElkStr
-elk_str_copy(size dst_len, char *restrict dest, ElkStr src)
+static inline void
+elk_time_helper_to_columns_scalar(ElkTime const *times, size n, ElkTimeColumns columns)
 {
-    size const copy_len = src.len < dst_len ? src.len : dst_len;
-    memcpy(dest, src.start, copy_len);
+    for(size i = 0; i < n; ++i)
+    {
+        elk_time_helper_columns_store(columns, i, elk_make_struct_time(times[i]));
+    }
+}
 
-    // Add a terminating zero IFF we can.
-    if(copy_len < dst_len) { dest[copy_len] = '\0'; }
+static inline void
+elk_time_helper_from_columns_scalar(ElkTimeColumns columns, size n, ElkTime *out)
+{
+    Assert(columns.year && columns.month && columns.day && columns.hour && columns.minute && columns.second);
 
-    return (ElkStr){.start = dest, .len = copy_len};
+    for(size i = 0; i < n; ++i)
+    {
+        out[i] = elk_time_from_ymd_and_hms(columns.year[i], columns.month[i], columns.day[i], columns.hour[i],
+                columns.minute[i], columns.second[i]);
+    }
 }
 
-static inline ElkStr
-elk_str_strip(ElkStr input)
+ELK_TARGET("avx2")
+static inline __m256i
+elk_time_helper_mulhi_epu32_avx2(__m256i values, u32 multiplier)
 {
-    char *const start = input.start;
-    size start_offset = 0;
-    for (start_offset = 0; start_offset < input.len && start[start_offset] <= 0x20; ++start_offset);
-
-    size end_offset = 0;
-    for (end_offset = input.len - 1; end_offset > start_offset && start[end_offset] <= 0x20; --end_offset);
+    /* The high 32 bits of the 64 bit product in each lane. */
+    __m256i const m = _mm256_set1_epi32((i32)multiplier);
+    __m256i const even = _mm256_srli_epi64(_mm256_mul_epu32(values, m), 32);
+    __m256i const odd = _mm256_mul_epu32(_mm256_srli_epi64(values, 32), m);
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
 
-    return (ElkStr) { .start = &start[start_offset], .len = end_offset - start_offset + 1 };
+ELK_TARGET("avx2")
+static inline __m256d
+elk_time_helper_to_f64_avx2(__m256i times)
+{
+    /* Exact for values with a magnitude less than 2^51, adding 1.5 * 2^52 puts the integer in the low mantissa bits. */
+    __m256d const magic = _mm256_set1_pd(6755399441055744.0);
+    __m256i const bits = _mm256_add_epi64(times, _mm256_castpd_si256(magic));
+    return _mm256_sub_pd(_mm256_castsi256_pd(bits), magic);
 }
 
-static inline 
-ElkStr elk_str_substr(ElkStr str, size start, size len)
+ELK_TARGET("avx2")
+static inline __m256i
+elk_time_helper_from_f64_avx2(__m256d values)
 {
-    Assert(start >= 0 && len > 0 && start + len <= str.len);
-    char *ptr_start = (char *)((size)str.start + start);
-    return (ElkStr) {.start = ptr_start, .len = len};
+    /* The inverse of elk_time_helper_to_f64_avx2(), the values must already be integers. */
+    __m256d const magic = _mm256_set1_pd(6755399441055744.0);
+    __m256i const bits = _mm256_castpd_si256(_mm256_add_pd(values, magic));
+    return _mm256_sub_epi64(bits, _mm256_castpd_si256(magic));
 }
 
-static inline i32
-elk_str_cmp(ElkStr left, ElkStr right)
+ELK_TARGET("avx2")
+static inline __m256i
+elk_time_helper_split_days_avx2(ElkTime const *times, __m256i *seconds_of_day)
 {
-    if(left.start == right.start && left.len == right.len) { return 0; }
+    /* Days since the epoch and the seconds into the day for 8 times, in 32 bit lanes. The times are converted to f64
+     * exactly, and adding half a second puts them far enough from a day boundary that multiplying by the rounded
+     * 1 / 86,400 and truncating is never off by one.
+     */
+    __m256i const times_lo = _mm256_loadu_si256((__m256i const *)times);
+    __m256i const times_hi = _mm256_loadu_si256((__m256i const *)(times + 4));
+
+    __m256d const half = _mm256_set1_pd(0.5);
+    __m256d const per_day = _mm256_set1_pd(1.0 / 86400.0);
+    __m256d const seconds_lo = _mm256_add_pd(elk_time_helper_to_f64_avx2(times_lo), half);
+    __m256d const seconds_hi = _mm256_add_pd(elk_time_helper_to_f64_avx2(times_hi), half);
+    __m256i const days = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm256_cvttpd_epi32(_mm256_mul_pd(seconds_lo, per_day))),
+            _mm256_cvttpd_epi32(_mm256_mul_pd(seconds_hi, per_day)), 1);
+
+    /* The seconds of the day fit in 32 bits, so only the low halves of the times are needed. */
+    __m256i const low_halves = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    __m256i const times_32 = _mm256_permute2x128_si256(_mm256_permutevar8x32_epi32(times_lo, low_halves),
+            _mm256_permutevar8x32_epi32(times_hi, low_halves), 0x20);
+    *seconds_of_day = _mm256_sub_epi32(times_32, _mm256_mullo_epi32(days, _mm256_set1_epi32(86400)));
+
+    return days;
+}
 
-    size len = left.len > right.len ? right.len : left.len;
+ELK_TARGET("avx2")
+static inline void
+elk_time_helper_store_times_avx2(ElkTime *out, __m256i days, __m256i seconds_of_day)
+{
+    /* Convert days since the epoch and seconds into the day, in 32 bit lanes, to 8 ElkTimes. */
+    __m256i const seconds_per_day = _mm256_set1_epi64x(SECONDS_PER_DAY);
+    __m256i const days_lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(days));
+    __m256i const days_hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(days, 1));
+    __m256i const sod_lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(seconds_of_day));
+    __m256i const sod_hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(seconds_of_day, 1));
+    _mm256_storeu_si256((__m256i *)out, _mm256_add_epi64(_mm256_mul_epu32(days_lo, seconds_per_day), sod_lo));
+    _mm256_storeu_si256((__m256i *)(out + 4), _mm256_add_epi64(_mm256_mul_epu32(days_hi, seconds_per_day), sod_hi));
+}
 
-    for (size i = 0; i < len; ++i) 
+ELK_TARGET("avx2")
+static inline void
+elk_time_helper_civil_from_days_avx2(__m256i days, __m256i *year, __m256i *month, __m256i *day, __m256i *day_of_year)
+{
+    /* The same steps as elk_civil_from_days(), the multipliers were checked for every possible value. */
+    __m256i const z = _mm256_add_epi32(days, _mm256_set1_epi32(306));
+    __m256i const era = _mm256_srli_epi32(elk_time_helper_mulhi_epu32_avx2(z, 3762951), 7);                // / 146097
+    __m256i const day_of_era = _mm256_sub_epi32(z, _mm256_mullo_epi32(era, _mm256_set1_epi32(146097)));
+
+    __m256i year_of_era = _mm256_sub_epi32(day_of_era, elk_time_helper_mulhi_epu32_avx2(day_of_era, 2941759)); // / 1460
+    year_of_era = _mm256_add_epi32(year_of_era,
+            _mm256_srli_epi32(elk_time_helper_mulhi_epu32_avx2(day_of_era, 235187), 1));                     // / 36524
+    year_of_era = _mm256_add_epi32(year_of_era, _mm256_cmpeq_epi32(day_of_era, _mm256_set1_epi32(146096)));
+    year_of_era = elk_time_helper_mulhi_epu32_avx2(year_of_era, 11767034);                                    // / 365
+
+    __m256i const centuries = _mm256_srli_epi32(_mm256_mullo_epi32(year_of_era, _mm256_set1_epi32(41)), 12);     // / 100
+    __m256i march_day = _mm256_mullo_epi32(year_of_era, _mm256_set1_epi32(365));
+    march_day = _mm256_sub_epi32(_mm256_add_epi32(march_day, _mm256_srli_epi32(year_of_era, 2)), centuries);
+    march_day = _mm256_sub_epi32(day_of_era, march_day);
+
+    __m256i march_month = _mm256_add_epi32(_mm256_mullo_epi32(march_day, _mm256_set1_epi32(5)), _mm256_set1_epi32(2));
+    march_month = _mm256_srli_epi32(_mm256_mullo_epi32(march_month, _mm256_set1_epi32(857)), 17);             // / 153
+
+    __m256i days_before_month = _mm256_mullo_epi32(march_month, _mm256_set1_epi32(153));
+    days_before_month = _mm256_add_epi32(days_before_month, _mm256_set1_epi32(2));
+    days_before_month = _mm256_srli_epi32(_mm256_mullo_epi32(days_before_month, _mm256_set1_epi32(1639)), 13); // / 5
+    *day = _mm256_add_epi32(_mm256_sub_epi32(march_day, days_before_month), _mm256_set1_epi32(1));
+
+    __m256i const jan_feb = _mm256_cmpgt_epi32(march_month, _mm256_set1_epi32(9));
+    *month = _mm256_sub_epi32(_mm256_add_epi32(march_month, _mm256_set1_epi32(3)),
+            _mm256_and_si256(jan_feb, _mm256_set1_epi32(12)));
+    *year = _mm256_add_epi32(year_of_era, _mm256_mullo_epi32(era, _mm256_set1_epi32(400)));
+    *year = _mm256_sub_epi32(*year, jan_feb);
+
+    /* The day of the year counts from January. From March on it depends on whether the year of the era is a leap year,
+     * January and February are at the end of the March based year.
+     */
+    __m256i const zero = _mm256_setzero_si256();
+    __m256i const div_by_4 = _mm256_cmpeq_epi32(_mm256_and_si256(year_of_era, _mm256_set1_epi32(3)), zero);
+    __m256i const div_by_100 = _mm256_cmpeq_epi32(_mm256_mullo_epi32(centuries, _mm256_set1_epi32(100)), year_of_era);
+    __m256i const not_leap = _mm256_or_si256(_mm256_andnot_si256(div_by_4, _mm256_set1_epi32(-1)),
+            _mm256_andnot_si256(_mm256_cmpeq_epi32(centuries, zero), div_by_100));
+    __m256i const from_march = _mm256_add_epi32(march_day, _mm256_set1_epi32(61));
+    *day_of_year = _mm256_blendv_epi8(_mm256_add_epi32(from_march, not_leap),
+            _mm256_sub_epi32(march_day, _mm256_set1_epi32(305)), jan_feb);
+}
+
+ELK_TARGET("avx2")
+static inline void
+elk_time_helper_columns_store_avx2(ElkTimeColumns columns, size i, __m256i const fields[7])
+{
+    /* Pack the 32 bit lanes down to the column widths, fields are in the same order as the columns. */
+    i16 *wide_columns[2] = { columns.year, columns.day_of_year };
+    __m256i const wide_fields[2] = { fields[0], fields[6] };
+    for(i32 f = 0; f < 2; ++f)
     {
-        if (left.start[i] < right.start[i]) { return -1; }
-        else if (left.start[i] > right.start[i]) { return 1; }
+        if(!wide_columns[f]) { continue; }
+        __m128i const packed =
+            _mm_packs_epi32(_mm256_castsi256_si128(wide_fields[f]), _mm256_extracti128_si256(wide_fields[f], 1));
+        _mm_storeu_si128((__m128i *)(wide_columns[f] + i), packed);
     }
 
-    if (left.len == right.len) { return 0; }
-    if (left.len > right.len) { return 1; }
-    return -1;
+    i8 *narrow_columns[5] = { columns.month, columns.day, columns.hour, columns.minute, columns.second };
+    for(i32 f = 0; f < 5; ++f)
+    {
+        if(!narrow_columns[f]) { continue; }
+        __m128i const packed =
+            _mm_packs_epi32(_mm256_castsi256_si128(fields[f + 1]), _mm256_extracti128_si256(fields[f + 1], 1));
+        _mm_storel_epi64((__m128i *)(narrow_columns[f] + i), _mm_packs_epi16(packed, packed));
+    }
 }
 
-static inline b32
-elk_str_eq(ElkStr const left, ElkStr const right)
+ELK_TARGET("avx2")
+static inline void
+elk_time_helper_to_columns_avx2(ElkTime const *times, size n, ElkTimeColumns columns)
 {
-    if (left.len != right.len) { return false; }
+    size i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        __m256i seconds_of_day;
+        __m256i const days = elk_time_helper_split_days_avx2(times + i, &seconds_of_day);
 
-    size len = left.len > right.len ? right.len : left.len;
+        __m256i fields[7];
+        fields[3] = _mm256_srli_epi32(_mm256_mullo_epi32(seconds_of_day, _mm256_set1_epi32(37283)), 27);  // / 3600
+        __m256i const seconds_of_hour =
+            _mm256_sub_epi32(seconds_of_day, _mm256_mullo_epi32(fields[3], _mm256_set1_epi32(3600)));
+        fields[4] = _mm256_srli_epi32(_mm256_mullo_epi32(seconds_of_hour, _mm256_set1_epi32(2185)), 17);  // / 60
+        fields[5] = _mm256_sub_epi32(seconds_of_hour, _mm256_mullo_epi32(fields[4], _mm256_set1_epi32(60)));
 
-    for (size i = 0; i < len; ++i)
-    {
-        if (left.start[i] != right.start[i]) { return false; }
+        elk_time_helper_civil_from_days_avx2(days, &fields[0], &fields[1], &fields[2], &fields[6]);
+
+        elk_time_helper_columns_store_avx2(columns, i, fields);
     }
 
-    return true;
+    for(; i < n; ++i)
+    {
+        elk_time_helper_columns_store(columns, i, elk_make_struct_time(times[i]));
+    }
 }
 
-static inline ElkStrSplitPair
-elk_str_split_on_char(ElkStr str, char const split_char)
+ELK_TARGET("avx2")
+static inline void
+elk_time_helper_from_columns_avx2(ElkTimeColumns columns, size n, ElkTime *out)
 {
-    ElkStr left = { .start = str.start, .len = 0 };
-    ElkStr right = { .start = NULL, .len = 0 };
+    Assert(columns.year && columns.month && columns.day && columns.hour && columns.minute && columns.second);
 
-    for(char const *c = str.start; *c != split_char && left.len < str.len; ++c, ++left.len);
+    size i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        __m256i const years = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const *)(columns.year + i)));
+        __m256i const months = _mm256_cvtepi8_epi32(_mm_loadl_epi64((__m128i const *)(columns.month + i)));
+        __m256i const days_of_month = _mm256_cvtepi8_epi32(_mm_loadl_epi64((__m128i const *)(columns.day + i)));
+        __m256i const hours = _mm256_cvtepi8_epi32(_mm_loadl_epi64((__m128i const *)(columns.hour + i)));
+        __m256i const minutes = _mm256_cvtepi8_epi32(_mm_loadl_epi64((__m128i const *)(columns.minute + i)));
+        __m256i const seconds = _mm256_cvtepi8_epi32(_mm_loadl_epi64((__m128i const *)(columns.second + i)));
+
+        /* The same steps as elk_days_from_civil(). */
+        __m256i const jan_feb = _mm256_cmpgt_epi32(_mm256_set1_epi32(3), months);
+        __m256i const march_years = _mm256_add_epi32(years, jan_feb);
+        __m256i const march_months = _mm256_add_epi32(_mm256_sub_epi32(months, _mm256_set1_epi32(3)),
+                _mm256_and_si256(jan_feb, _mm256_set1_epi32(12)));
+
+        __m256i const era = _mm256_srli_epi32(_mm256_mullo_epi32(march_years, _mm256_set1_epi32(5243)), 21);   // / 400
+        __m256i const year_of_era = _mm256_sub_epi32(march_years, _mm256_mullo_epi32(era, _mm256_set1_epi32(400)));
+        __m256i const centuries = _mm256_srli_epi32(_mm256_mullo_epi32(year_of_era, _mm256_set1_epi32(41)), 12); // / 100
+
+        __m256i day_of_year = _mm256_mullo_epi32(march_months, _mm256_set1_epi32(153));
+        day_of_year = _mm256_add_epi32(day_of_year, _mm256_set1_epi32(2));
+        day_of_year = _mm256_srli_epi32(_mm256_mullo_epi32(day_of_year, _mm256_set1_epi32(1639)), 13);        // / 5
+        day_of_year = _mm256_add_epi32(day_of_year, days_of_month);
+
+        __m256i days = _mm256_mullo_epi32(year_of_era, _mm256_set1_epi32(365));
+        days = _mm256_sub_epi32(_mm256_add_epi32(days, _mm256_srli_epi32(year_of_era, 2)), centuries);
+        days = _mm256_add_epi32(days, _mm256_mullo_epi32(era, _mm256_set1_epi32(146097)));
+        days = _mm256_add_epi32(days, _mm256_sub_epi32(day_of_year, _mm256_set1_epi32(307)));
+
+        __m256i seconds_of_day = _mm256_mullo_epi32(hours, _mm256_set1_epi32(3600));
+        seconds_of_day = _mm256_add_epi32(seconds_of_day, _mm256_mullo_epi32(minutes, _mm256_set1_epi32(60)));
+        seconds_of_day = _mm256_add_epi32(seconds_of_day, seconds);
+
+        elk_time_helper_store_times_avx2(out + i, days, seconds_of_day);
+    }
 
-    if(left.len + 1 < str.len)
+    for(; i < n; ++i)
     {
-        right.start = &str.start[left.len + 1];
-        right.len = str.len - left.len - 1;
+        out[i] = elk_time_from_ymd_and_hms(columns.year[i], columns.month[i], columns.day[i], columns.hour[i],
+                columns.minute[i], columns.second[i]);
     }
+}
 
-    return (ElkStrSplitPair) { .left = left, .right = right};
+static inline void
+elk_time_helper_truncate_batch_scalar(ElkTime const *times, size n, ElkTimeDiff interval, ElkTimeDiff offset, ElkTime *out)
+{
+    for(size i = 0; i < n; ++i) { out[i] = elk_time_truncate(times[i], interval, offset); }
 }
 
-_Static_assert(sizeof(size) == sizeof(uptr), "intptr_t and uintptr_t aren't the same size?!");
+static inline void
+elk_time_helper_truncate_to_calendar_batch_scalar(ElkTime const *times, size n, ElkCalendarUnit unit, ElkTime *out)
+{
+    for(size i = 0; i < n; ++i) { out[i] = elk_time_truncate_to_calendar(times[i], unit); }
+}
 
-static inline b32 
-elk_str_helper_parse_i64(ElkStr str, i64 *result)
+ELK_TARGET("avx2")
+static inline void
+elk_time_helper_truncate_batch_avx2(ElkTime const *times, size n, ElkTimeDiff interval, ElkTimeDiff offset, ElkTime *out)
 {
-    u64 parsed = 0;
-    b32 neg_flag = false;
-    b32 in_digits = false;
-    char const *c = str.start;
-    while (true)
-    {
-        // We've reached the end of the string.
-        if (!*c || c >= (str.start + (uptr)str.len)) { break; }
+    Assert(interval > 0);
 
-        // Is a digit?
-        if (*c + 0U - '0' <= 9U) 
-        {
-            in_digits = true;                    // Signal we've passed +/- signs
-            parsed = parsed * 10 + (*c - '0');   // Accumulate digits
+    offset %= interval;
+    if(offset < 0) { offset += interval; }
 
-        }
-        else if (*c == '-' && !in_digits) { neg_flag = true; }
-        else if (*c == '+' && !in_digits) { neg_flag = false; }
-        else { return false; }
+    /* Everything is an integer less than 2^51 in f64, so the subtraction and the products are exact. Adding half a second
+     * keeps the quotient at least 0.5 / interval away from an integer, much more than the rounding error of multiplying
+     * by the rounded reciprocal, so the floor is exact too.
+     */
+    __m256d const start = _mm256_set1_pd((f64)offset - 0.5);
+    __m256d const end = _mm256_set1_pd((f64)offset);
+    __m256d const length = _mm256_set1_pd((f64)interval);
+    __m256d const per_interval = _mm256_set1_pd(1.0 / (f64)interval);
 
-        // Move to the next character
-        ++c;
+    size i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        __m256d const seconds = elk_time_helper_to_f64_avx2(_mm256_loadu_si256((__m256i const *)(times + i)));
+        __m256d const intervals = _mm256_floor_pd(_mm256_mul_pd(_mm256_sub_pd(seconds, start), per_interval));
+        __m256d const truncated = _mm256_add_pd(_mm256_mul_pd(intervals, length), end);
+        _mm256_storeu_si256((__m256i *)(out + i), elk_time_helper_from_f64_avx2(truncated));
     }
 
-    *result = neg_flag ? -parsed : parsed;
-    return true;
+    elk_time_helper_truncate_batch_scalar(times + i, n - i, interval, offset, out + i);
 }
 
-static inline b32
-elk_str_parse_i64(ElkStr str, i64 *result)
+ELK_TARGET("avx2")
+static inline void
+elk_time_helper_truncate_to_calendar_batch_avx2(ElkTime const *times, size n, ElkCalendarUnit unit, ElkTime *out)
 {
-    // Empty string is an error
-    StopIf(str.len == 0, return false);
-
-#if 0
-    /* Check that first the string is short enough, 16 bytes, and second that it does not cross a 4 KiB memory boundary.
-     * The boundary check is needed because we can't be sure that we have access to the other page. If we don't, seg-fault!
-     */
-    if(str.len <= 16 && ((((uptr)str.start + str.len) % ELK_KiB(4)) >= 16))
-    {
-        // _0_ Load, but ensure the last digit is in the last position
-        u8 len = (u8)str.len;
-        uptr start = (uptr)str.start + str.len - 16;
-        __m128i value = _mm_loadu_si128((__m128i const *)start);
-        __m128i const positions = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
-        __m128i const positions_mask = _mm_cmpgt_epi8(positions, _mm_set1_epi8(len));
-        value = _mm_andnot_si128(positions_mask, value);                                 /* Mask out data we didn't want.*/
- 
-        // _1_ detect negative sign
-        __m128i const neg_sign = _mm_set1_epi8('-');
-        __m128i const pos_sign = _mm_set1_epi8('+');
-        __m128i const neg_mask = _mm_cmpeq_epi8(value, neg_sign);
-        __m128i const pos_mask = _mm_cmpeq_epi8(value, pos_sign);
-        i32 neg_flag = _mm_movemask_epi8(neg_mask);
-        i32 pos_flag = _mm_movemask_epi8(pos_mask);
-        neg_flag = (neg_flag >> (16 - str.len)) & 0x01; /* 0-false or 1-true, remember movemask reverses bits. */
-        pos_flag = (pos_flag >> (16 - str.len)) & 0x01; /* 0-false or 1-true, remember movemask reverses bits. */
-
-        // _2_ mask out negative sign and non-digit characters
-        __m128i const not_digits = _mm_or_si128(
-                _mm_cmpgt_epi8(value, _mm_set1_epi8('9')),
-                _mm_cmplt_epi8(value, _mm_set1_epi8('0')));
-        value = _mm_andnot_si128(not_digits, value);
-
-        // _3_ movemask to get bits representing data
-        u32 const digit_bits = (~_mm_movemask_epi8(not_digits)) & 0xFFFF;
-
-        // _4_ _mm_popcnt_u32 to get the number of digits, depending on - sign, if less than string length, ERROR!
-        i32 const num_digits = _mm_popcnt_u32(digit_bits);
-        if(num_digits < ((neg_flag || pos_flag) ? len - 1 : len)) { return false; }
-
-        // _5_ subtract '0' from fields with digits.
-        __m128i const zero_char = _mm_set1_epi8('0');
-        value = _mm_sub_epi8(value, zero_char);
-        value = _mm_andnot_si128(not_digits, value);     /* Re-zero the bytes that had zeros before this operation */
-        
-        // _6_ _mm_maddubs_epi16(_2_, first constant)
-        __m128i const m1 = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
-        value = _mm_maddubs_epi16(value, m1);
-        
-        // _7_ _mm_madd_epi16(_6_, second constant)
-        __m128i const m2 = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
-        value = _mm_madd_epi16(value, m2);
+    if(unit == ElkCalendarDay)
+    {
+        elk_time_helper_truncate_batch_avx2(times, n, ElkDay, 0, out);
+        return;
+    }
 
-        // _8_ _mm_packs_epi32(_7_, _7_)
-        value = _mm_packs_epi32(_mm_setzero_si128(), value);
+    Assert(unit == ElkCalendarMonth || unit == ElkCalendarYear);
 
-        // _9_ _mm_madd_epi16(_8_, third constant)
-        __m128i const m3 = _mm_setr_epi16(0, 0, 0, 0, 10000, 1, 10000, 1);
-        value = _mm_madd_epi16(value, m3);
+    size i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        __m256i seconds_of_day;
+        __m256i days = elk_time_helper_split_days_avx2(times + i, &seconds_of_day);
 
-        // _10_ _mm_mul_epu32(_10_, fourth constant multiplier)
-        __m128i const m4 = _mm_set1_epi32(100000000);
-        __m128i value_top = _mm_mul_epu32(value, m4);
+        __m256i year;
+        __m256i month;
+        __m256i day;
+        __m256i day_of_year;
+        elk_time_helper_civil_from_days_avx2(days, &year, &month, &day, &day_of_year);
 
-        // _11_ shuffle value into little endian for the 64 bit add coming up. _mm_shuffle_epi32(_9_, 0xB4) 0b 00 11 00 00
-        value = _mm_shuffle_epi32(value, 0x30); 
+        __m256i const days_in = unit == ElkCalendarMonth ? day : day_of_year;
+        days = _mm256_add_epi32(_mm256_sub_epi32(days, days_in), _mm256_set1_epi32(1));
 
-        // _12_ _mm_add_epi64(_9_, _11_)
-        value = _mm_add_epi64(value, value_top);
+        elk_time_helper_store_times_avx2(out + i, days, _mm256_setzero_si256());
+    }
 
-        // _13_ __int64 val = _mm_extract_epi64(_12_, 0)
-        *result = (neg_flag ? -1 : 1) * _mm_extract_epi64(value, 1);
-        return true;
+    elk_time_helper_truncate_to_calendar_batch_scalar(times + i, n - i, unit, out + i);
+}
 
-    }
-    else
-    {
-        return elk_str_helper_parse_i64(str, result);
-    }
+static inline void
+elk_time_to_columns(ElkTime const *times, size n, ElkTimeColumns columns)
+{
+#if __AVX2__
+    elk_time_helper_to_columns_avx2(times, n, columns);
 #else
-    return elk_str_helper_parse_i64(str, result);
+    elk_time_helper_to_columns_scalar(times, n, columns);
 #endif
 }
 
-#pragma warning(disable : 4723)
-static inline b32
-elk_str_robust_parse_f64(ElkStr str, f64 *out)
+static inline void
+elk_time_from_columns(ElkTimeColumns columns, size n, ElkTime *out)
 {
-    // The following block is required to create NAN/INF witnout using math.h on MSVC Using
-    // #define NAN (0.0/0.0) doesn't work either on MSVC, which gives C2124 divide by zero error.
-    static f64 const ELK_ZERO = 0.0;
-    f64 const ELK_INF = 1.0 / ELK_ZERO;
-    f64 const ELK_NEG_INF = -1.0 / ELK_ZERO;
-    f64 const ELK_NAN = 0.0 / ELK_ZERO;
-
-    StopIf(str.len == 0, goto ERR_RETURN);
+#if __AVX2__
+    elk_time_helper_from_columns_avx2(columns, n, out);
+#else
+    elk_time_helper_from_columns_scalar(columns, n, out);
+#endif
+}
 
-    char const *c = str.start;
-    char const *end = str.start + str.len;
-    size len_remaining = str.len;
+static inline void
+elk_time_truncate_batch(ElkTime const *times, size n, ElkTimeDiff interval, ElkTimeDiff offset, ElkTime *out)
+{
+#if __AVX2__
+    elk_time_helper_truncate_batch_avx2(times, n, interval, offset, out);
+#else
+    elk_time_helper_truncate_batch_scalar(times, n, interval, offset, out);
+#endif
+}
 
-    i8 sign = 0;        // 0 is positive, 1 is negative
-    i8 exp_sign = 0;    // 0 is positive, 1 is negative
-    i16 exponent = 0;
-    i64 mantissa = 0;
-    i16 extra_exp = 0;  // decimal places after the point
+static inline void
+elk_time_truncate_to_calendar_batch(ElkTime const *times, size n, ElkCalendarUnit unit, ElkTime *out)
+{
+#if __AVX2__
+    elk_time_helper_truncate_to_calendar_batch_avx2(times, n, unit, out);
+#else
+    elk_time_helper_truncate_to_calendar_batch_scalar(times, n, unit, out);
+#endif
+}
 
-    // Check & parse a sign
-    if (*c == '-')      { sign =  1; --len_remaining; ++c; }
-    else if (*c == '+') { sign =  0; --len_remaining; ++c; }
+static inline ElkStr
+elk_str_from_cstring(char *src)
+{
+    size len;
+    for (len = 0; *(src + len) != '\0'; ++len) ; // intentionally left blank.
+    return (ElkStr){.start = src, .len = len};
+}
 
-    // check for nan/NAN/NaN/Nan inf/INF/Inf
-    if (len_remaining == 3) 
-    {
-        if(memcmp(c, "nan", 3) == 0 || memcmp(c, "NAN", 3) == 0 || memcmp(c, "NaN", 3) == 0 || memcmp(c, "Nan", 3) == 0) 
-        { 
-            *out = ELK_NAN; return true;
-        }
+static inline ElkStr
+elk_str_copy(size dst_len, char *restrict dest, ElkStr src)
+{
+    size const copy_len = src.len < dst_len ? src.len : dst_len;
+    memcpy(dest, src.start, copy_len);
 
-        if(memcmp(c, "inf", 3) == 0 || memcmp(c, "Inf", 3) == 0 || memcmp(c, "INF", 3) == 0)
-        {
-            if(sign == 0) *out = ELK_INF;
-            else if(sign == 1) *out = ELK_NEG_INF;
-            return true; 
-        }
-    }
+    // Add a terminating zero IFF we can.
+    if(copy_len < dst_len) { dest[copy_len] = '\0'; }
 
-    // check for infinity/INFINITY/Infinity
-    if (len_remaining == 8) 
-    {
-        if(memcmp(c, "infinity", 8) == 0 || memcmp(c, "Infinity", 8) == 0 || memcmp(c, "INFINITY", 8) == 0)
-        {
-            if(sign == 0) *out = ELK_INF;
-            else if(sign == 1) *out = ELK_NEG_INF;
-            return true; 
-        }
-    }
+    return (ElkStr){.start = dest, .len = copy_len};
+}
 
-    // Parse the mantissa up to the decimal point or exponent part
-    char digit = *c - '0';
-    while (c < end && digit  < 10 && digit  >= 0)
-    {
-        mantissa = mantissa * 10 + digit;
-        ++c;
-        digit = *c - '0';
-    }
+static inline ElkStr
+elk_str_strip(ElkStr input)
+{
+    char *const start = input.start;
+    size start_offset = 0;
+    for (start_offset = 0; start_offset < input.len && start[start_offset] <= 0x20; ++start_offset);
 
-    // Check for the decimal point
-    if (c < end && *c == '.')
-    {
-        ++c;
+    size end_offset = 0;
+    for (end_offset = input.len - 1; end_offset > start_offset && start[end_offset] <= 0x20; --end_offset);
 
-        // Parse the mantissa up to the decimal point or exponent part
-        digit = *c - '0';
-        while (c < end && digit < 10 && digit >= 0)
-        {
-            // overflow check
-            StopIf((INT64_MAX - digit) / 10 < mantissa, goto ERR_RETURN); 
+    return (ElkStr) { .start = &start[start_offset], .len = end_offset - start_offset + 1 };
+}
 
-            mantissa = mantissa * 10 + digit;
-            extra_exp += 1;
+static inline 
+ElkStr elk_str_substr(ElkStr str, size start, size len)
+{
+    Assert(start >= 0 && len > 0 && start + len <= str.len);
+    char *ptr_start = (char *)((size)str.start + start);
+    return (ElkStr) {.start = ptr_start, .len = len};
+}
 
-            ++c;
-            digit = *c - '0';
-        }
-    }
+/* Bit twiddling helpers, mostly for working with the masks created by SIMD compares. */
+static inline i32
+elk_bit_count_trailing_zeros32(u32 bits)
+{
+    Assert(bits);
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx = 0;
+    _BitScanForward(&idx, bits);
+    return (i32)idx;
+#else
+    return __builtin_ctz(bits);
+#endif
+}
 
-    // Account for negative signs
-    mantissa = sign == 1 ? -mantissa : mantissa;
+static inline i32
+elk_bit_count_leading_zeros32(u32 bits)
+{
+    Assert(bits);
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx = 0;
+    _BitScanReverse(&idx, bits);
+    return 31 - (i32)idx;
+#else
+    return __builtin_clz(bits);
+#endif
+}
 
-    // Start the exponent
-    if (c < end && (*c == 'e' || *c == 'E')) 
-    {
-        ++c;
+static inline i32
+elk_bit_popcount32(u32 bits)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    bits = bits - ((bits >> 1) & 0x55555555);
+    bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+    return (i32)((((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+#else
+    return __builtin_popcount(bits);
+#endif
+}
 
-        if (*c == '-') { exp_sign = 1; ++c; }
-        else if (*c == '+') { exp_sign = 0; ++c; }
+static inline i32
+elk_bit_count_trailing_zeros64(u64 bits)
+{
+    Assert(bits);
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx = 0;
+    _BitScanForward64(&idx, bits);
+    return (i32)idx;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
 
-        // Parse the mantissa up to the decimal point or exponent part
-        digit = *c - '0';
-        while (c < end && digit < 10 && digit >= 0)
-        {
-            // Overflow check
-            StopIf((INT16_MAX - digit) / 10 < exponent, goto ERR_RETURN); 
+static inline i32
+elk_bit_count_leading_zeros64(u64 bits)
+{
+    Assert(bits);
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx = 0;
+    _BitScanReverse64(&idx, bits);
+    return 63 - (i32)idx;
+#else
+    return __builtin_clzll(bits);
+#endif
+}
 
-            exponent = exponent * 10 + digit;
+static inline i32
+elk_bit_popcount64(u64 bits)
+{
+    return elk_bit_popcount32((u32)bits) + elk_bit_popcount32((u32)(bits >> 32));
+}
 
-            ++c;
-            digit = *c - '0';
-        }
+static inline i32
+elk_str_helper_cmp_scalar(ElkStr left, ElkStr right)
+{
+    size len = left.len > right.len ? right.len : left.len;
 
-        // Account for negative signs
-        exponent = exp_sign == 1 ? -exponent : exponent;
+    for (size i = 0; i < len; ++i) 
+    {
+        if (left.start[i] < right.start[i]) { return -1; }
+        else if (left.start[i] > right.start[i]) { return 1; }
     }
 
-    // Once we get here we're done. Should be end of string.
-    StopIf( c!= end, goto ERR_RETURN);
-
-    // Account for decimal point location.
-    exponent -= extra_exp;
-
-    // Check for overflow
-    StopIf(exponent < -307 || exponent > 308, goto ERR_RETURN);
-
-    f64 exp_part = 1.0;
-    for (int i = 0; i < exponent; ++i) { exp_part *= 10.0; }
-    for (int i = 0; i > exponent; --i) { exp_part /= 10.0; }
+    if (left.len == right.len) { return 0; }
+    if (left.len > right.len) { return 1; }
+    return -1;
+}
 
-    f64 value = (f64)mantissa * exp_part;
-    StopIf(value == ELK_INF || value == ELK_NEG_INF, goto ERR_RETURN);
+static inline b32
+elk_str_helper_eq_scalar(ElkStr const left, ElkStr const right)
+{
+    for (size i = 0; i < left.len; ++i)
+    {
+        if (left.start[i] != right.start[i]) { return false; }
+    }
 
-    *out = value;
     return true;
-
-ERR_RETURN:
-    *out = ELK_NAN;
-    return false;
 }
-#pragma warning(default : 4723)
 
-#pragma warning(disable : 4723)
-static inline b32 
-elk_str_fast_parse_f64(ElkStr str, f64 *out)
+ELK_TARGET("avx2")
+static inline u32
+elk_str_helper_diff_bits_avx2(char const *left, char const *right)
 {
-    // The following block is required to create NAN/INF witnout using math.h on MSVC Using
-    // #define NAN (0.0/0.0) doesn't work either on MSVC, which gives C2124 divide by zero error.
-    static f64 const ELK_ZERO = 0.0;
-    f64 const ELK_INF = 1.0 / ELK_ZERO;
-    f64 const ELK_NEG_INF = -1.0 / ELK_ZERO;
-    f64 const ELK_NAN = 0.0 / ELK_ZERO;
-
-    StopIf(str.len == 0, goto ERR_RETURN);
-
-    char const *c = str.start;
-    char const *end = str.start + str.len;
-
-    i8 sign = 0;        // 0 is positive, 1 is negative
-    i8 exp_sign = 0;    // 0 is positive, 1 is negative
-    i16 exponent = 0;
-    i64 mantissa = 0;
-    i16 extra_exp = 0;  // decimal places after the point
+    __m256i const equal = _mm256_cmpeq_epi8(_mm256_loadu_si256((__m256i const *)left),
+            _mm256_loadu_si256((__m256i const *)right));
+    return ~(u32)_mm256_movemask_epi8(equal);
+}
 
-    // Check & parse a sign
-    if (*c == '-')      { sign =  1; ++c; }
-    else if (*c == '+') { sign =  0; ++c; }
+ELK_TARGET("avx2")
+static inline b32
+elk_str_helper_short_diff_bits_avx2(char const *left, char const *right, size len, u32 *diff)
+{
+    /* Compare 0 < len < 32 bytes, diff gets a bit set for each byte that's different. A 32 byte load from the start of a
+     * string is safe if it doesn't cross into the next page, and one ending at the end of it is safe if it doesn't cross
+     * into the previous page. Both strings have to be loaded the same way so the bytes line up, returns false if neither
+     * way works for both of them.
+     */
+    Assert(len > 0 && len < 32);
 
-    // Parse the mantissa up to the decimal point or exponent part
-    char digit = *c - '0';
-    while (c < end && digit  < 10 && digit  >= 0)
+    u32 const page_left = (uptr)left & 0xFFF;
+    u32 const page_right = (uptr)right & 0xFFF;
+    if(page_left <= ELK_KiB(4) - 32 && page_right <= ELK_KiB(4) - 32)
     {
-        mantissa = mantissa * 10 + digit;
-        ++c;
-        digit = *c - '0';
+        *diff = elk_str_helper_diff_bits_avx2(left, right) & ((1u << len) - 1);
+        return true;
     }
 
-    // Check for the decimal point
-    if (c < end && *c == '.')
+    u32 const end_page_left = (uptr)(left + len - 1) & 0xFFF;
+    u32 const end_page_right = (uptr)(right + len - 1) & 0xFFF;
+    if(end_page_left >= 31 && end_page_right >= 31)
     {
-        ++c;
-
-        // Parse the mantissa up to the decimal point or exponent part
-        digit = *c - '0';
-        while (c < end && digit < 10 && digit >= 0)
-        {
-            mantissa = mantissa * 10 + digit;
-            extra_exp += 1;
-
-            ++c;
-            digit = *c - '0';
-        }
+        *diff = elk_str_helper_diff_bits_avx2(left + len - 32, right + len - 32) >> (32 - len);
+        return true;
     }
 
-    // Account for negative signs
-    mantissa = sign == 1 ? -mantissa : mantissa;
-
-    // Start the exponent
-    if (c < end && (*c == 'e' || *c == 'E')) 
-    {
-        ++c;
+    return false;
+}
 
-        if (*c == '-') { exp_sign = 1; ++c; }
-        else if (*c == '+') { exp_sign = 0; ++c; }
+ELK_TARGET("avx2")
+static inline i32
+elk_str_helper_cmp_avx2(ElkStr left, ElkStr right)
+{
+    size const len = left.len > right.len ? right.len : left.len;
 
-        // Parse the mantissa up to the decimal point or exponent part
-        digit = *c - '0';
-        while (c < end && digit < 10 && digit >= 0)
+    /* Find the first byte that's different, the last block overlaps the one before it if len isn't a multiple of 32. */
+    size at = -1;
+    if(len >= 32)
+    {
+        for(size i = 0; i < len; i += 32)
         {
-            exponent = exponent * 10 + digit;
-
-            ++c;
-            digit = *c - '0';
+            size const start = i + 32 <= len ? i : len - 32;
+            u32 const diff = elk_str_helper_diff_bits_avx2(left.start + start, right.start + start);
+            if(diff) { at = start + elk_bit_count_trailing_zeros32(diff); break; }
         }
-
-        // Account for negative signs
-        exponent = exp_sign == 1 ? -exponent : exponent;
+    }
+    else if(len > 0)
+    {
+        u32 diff = 0;
+        StopIf(!elk_str_helper_short_diff_bits_avx2(left.start, right.start, len, &diff),
+                return elk_str_helper_cmp_scalar(left, right));
+        if(diff) { at = elk_bit_count_trailing_zeros32(diff); }
     }
 
-    // Account for decimal point location.
-    exponent -= extra_exp;
+    if(at >= 0) { return left.start[at] < right.start[at] ? -1 : 1; }
 
-    f64 exp_part = 1.0;
-    for (int i = 0; i < exponent; ++i) { exp_part *= 10.0; }
-    for (int i = 0; i > exponent; --i) { exp_part /= 10.0; }
-
-    f64 value = (f64)mantissa * exp_part;
-    StopIf(value == ELK_INF || value == ELK_NEG_INF, goto ERR_RETURN);
-
-    *out = value;
-    return true;
-
-ERR_RETURN:
-    *out = ELK_NAN;
-    return false;
+    if (left.len == right.len) { return 0; }
+    if (left.len > right.len) { return 1; }
+    return -1;
 }
-#pragma warning(default : 4723)
 
+ELK_TARGET("avx2")
 static inline b32
-elk_str_parse_datetime_long_format(ElkStr str, ElkTime *out)
-{
-    /* Calculate the start address to load it into the buffer with just the right positions for the characters. */
-    uptr start = (uptr)str.start + str.len + 7 - 32;
-
-    /* YYYY-MM-DD HH:MM:SS and YYYY-MM-DDTHH:MM:SS formats */
-    /* Check to make sure we have AVX and that the string buffer won't cross a 4 KiB boundary. */
-    if(__AVX2__ && ((((uptr)str.start + str.len + 7) % ELK_KiB(4)) >= 32))
-    {
-        __m256i dt_string = _mm256_loadu_si256((__m256i *)start);
-
-        /* Shuffle around the numbers to get them in position for doing math. */
-        __m256i shuffle = _mm256_setr_epi8(
-                0xFF, 0xFF, 0xFF, 0xFF,    6,    7,    8,    9, 0xFF, 0xFF,   11,   12, 0xFF, 0xFF,   14,   15,
-                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,    1,    2, 0xFF, 0xFF,    4,    5, 0xFF, 0xFF,    7,    8);
-        dt_string = _mm256_shuffle_epi8(dt_string, shuffle);
-
-        /* Subtract out the zero char value and mask out lanes that hold no data we need */
-        dt_string = _mm256_sub_epi8(dt_string, _mm256_set1_epi8('0'));
-        __m256i data_mask = _mm256_setr_epi8(
-                0xFF, 0xFF, 0xFF, 0xFF,    0,    0,    0,    0, 0xFF, 0xFF,    0,    0, 0xFF, 0xFF,    0,    0,
-                0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,    0,    0, 0xFF, 0xFF,    0,    0, 0xFF, 0xFF,    0,    0);
-        dt_string = _mm256_andnot_si256(data_mask, dt_string);
-
-        /* Multiply and add adjacent lanes */
-        __m256i madd_const1 = _mm256_setr_epi8(
-                0,  0,  0,  0, 10,  1, 10,  1,  0,  0, 10,  1,  0,  0, 10,  1,
-                0,  0,  0,  0,  0,  0, 10,  1,  0,  0, 10,  1,  0,  0, 10,  1);
-        __m256i vals16 = _mm256_maddubs_epi16(dt_string, madd_const1);
-
-        /* Month, day, hour, minute, second are already done! Now need to calculate year. */
-        __m256i madd_const2 = _mm256_setr_epi16(0, 0, 100, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-        __m256i vals32 = _mm256_madd_epi16(vals16, madd_const2);
-
-        i16 year = _mm256_extract_epi32(vals32, 1);
-        i8 month = _mm256_extract_epi16(vals16, 5);
-        i8 day = _mm256_extract_epi16(vals16, 7);
-        i8 hour = _mm256_extract_epi16(vals16, 11);
-        i8 minutes = _mm256_extract_epi16(vals16, 13);
-        i8 seconds = _mm256_extract_epi16(vals16, 15);
-
-            *out = elk_time_from_ymd_and_hms(year, month, day, hour, minutes, seconds);
-            return true;
-    }
-    else
+elk_str_helper_eq_avx2(ElkStr const left, ElkStr const right)
+{
+    size const len = left.len;
+    if(len >= 32)
     {
-        i64 year = INT64_MIN;
-        i64 month = INT64_MIN;
-        i64 day = INT64_MIN;
-        i64 hour = INT64_MIN;
-        i64 minutes = INT64_MIN;
-        i64 seconds = INT64_MIN;
-
-        if(
-            elk_str_parse_i64(elk_str_substr(str,  0, 4), &year    ) && 
-            elk_str_parse_i64(elk_str_substr(str,  5, 2), &month   ) &&
-            elk_str_parse_i64(elk_str_substr(str,  8, 2), &day     ) &&
-            elk_str_parse_i64(elk_str_substr(str, 11, 2), &hour    ) &&
-            elk_str_parse_i64(elk_str_substr(str, 14, 2), &minutes ) &&
-            elk_str_parse_i64(elk_str_substr(str, 17, 2), &seconds ))
+        for(size i = 0; i + 32 <= len; i += 32)
         {
-            *out = elk_time_from_ymd_and_hms((i16)year, (i8)month, (i8)day, (i8)hour, (i8)minutes, (i8)seconds);
-            return true;
+            StopIf(elk_str_helper_diff_bits_avx2(left.start + i, right.start + i), return false);
         }
+        return elk_str_helper_diff_bits_avx2(left.start + len - 32, right.start + len - 32) == 0;
     }
 
-    return false;
+    StopIf(len == 0, return true);
+
+    u32 diff = 0;
+    StopIf(!elk_str_helper_short_diff_bits_avx2(left.start, right.start, len, &diff),
+            return elk_str_helper_eq_scalar(left, right));
+    return diff == 0;
 }
 
-static inline b32
-elk_str_parse_datetime_compact_doy(ElkStr str, ElkTime *out)
-{
-    // YYYYDDDHHMMSS format
-    i64 year = INT64_MIN;
-    i64 day_of_year = INT64_MIN;
-    i64 hour = INT64_MIN;
-    i64 minutes = INT64_MIN;
-    i64 seconds = INT64_MIN;
-
-    if(
-        elk_str_parse_i64(elk_str_substr(str,  0, 4), &year        ) && 
-        elk_str_parse_i64(elk_str_substr(str,  4, 3), &day_of_year ) &&
-        elk_str_parse_i64(elk_str_substr(str,  7, 2), &hour        ) &&
-        elk_str_parse_i64(elk_str_substr(str,  9, 2), &minutes     ) &&
-        elk_str_parse_i64(elk_str_substr(str, 11, 2), &seconds     ))
-    {
-        *out = elk_time_from_yd_and_hms((i16)year, (i8)day_of_year, (i8)hour, (i8)minutes, (i8)seconds);
-        return true;
-    }
+static inline i32
+elk_str_cmp(ElkStr left, ElkStr right)
+{
+    if(left.start == right.start && left.len == right.len) { return 0; }
 
-    return false;
+#if __AVX2__
+    return elk_str_helper_cmp_avx2(left, right);
+#else
+    return elk_str_helper_cmp_scalar(left, right);
+#endif
 }
 
 static inline b32
-elk_str_parse_datetime(ElkStr str, ElkTime *out)
+elk_str_eq(ElkStr const left, ElkStr const right)
 {
-    // Check the length to find out what type of string we are parsing.
-    switch(str.len)
-    {
-        // YYYY-MM-DD HH:MM:SS and YYYY-MM-DDTHH:MM:SS formats
-        case 19: return elk_str_parse_datetime_long_format(str, out);
+    if (left.len != right.len) { return false; }
 
-        // YYYYDDDHHMMSS format
-        case 13: return elk_str_parse_datetime_compact_doy(str, out);
+#if __AVX2__
+    return elk_str_helper_eq_avx2(left, right);
+#else
+    return elk_str_helper_eq_scalar(left, right);
+#endif
+}
 
-        default: return false;
+static inline ElkStrSplitPair
+elk_str_split_on_char(ElkStr str, char const split_char)
+{
+    ElkStr left = { .start = str.start, .len = 0 };
+    ElkStr right = { .start = NULL, .len = 0 };
+
+    for(char const *c = str.start; *c != split_char && left.len < str.len; ++c, ++left.len);
+
+    if(left.len + 1 < str.len)
+    {
+        right.start = &str.start[left.len + 1];
+        right.len = str.len - left.len - 1;
     }
 
-    return false;
+    return (ElkStrSplitPair) { .left = left, .right = right};
 }
 
-static u64 const fnv_offset_bias = 0xcbf29ce484222325;
-static u64 const fnv_prime = 0x00000100000001b3;
+_Static_assert(sizeof(size) == sizeof(uptr), "intptr_t and uintptr_t aren't the same size?!");
 
-static inline u64
-elk_fnv1a_hash_accumulate(size const size_bytes, void const *value, u64 const hash_so_far)
+static inline b32 
+elk_str_helper_parse_i64_scalar(ElkStr str, i64 *result)
 {
-    u8 const *data = value;
+    char const *c = str.start;
+    char const *end = str.start + str.len;
 
-    u64 hash = hash_so_far;
-    for (size i = 0; i < size_bytes; ++i)
+    b32 neg_flag = false;
+    if(c < end && (*c == '-' || *c == '+')) { neg_flag = *c == '-'; ++c; }
+    StopIf(c == end, return false);
+
+    /* Accumulate as unsigned so the most negative value fits, and check every step for overflow. */
+    u64 parsed = 0;
+    for(; c < end; ++c)
     {
-        hash ^= data[i];
-        hash *= fnv_prime;
+        u32 const digit = (u32)(*c - '0');
+        StopIf(digit > 9, return false);
+        StopIf(parsed > (UINT64_MAX - digit) / 10, return false);
+        parsed = parsed * 10 + digit;
     }
 
-    return hash;
-}
+    u64 const max_magnitude = neg_flag ? (u64)INT64_MAX + 1 : (u64)INT64_MAX;
+    StopIf(parsed > max_magnitude, return false);
 
-static inline u64
-elk_fnv1a_hash(size const n, void const *value)
-{
-    return elk_fnv1a_hash_accumulate(n, value, fnv_offset_bias);
+    *result = neg_flag ? (i64)(0 - parsed) : (i64)parsed;
+    return true;
 }
 
-static inline u64
-elk_fnv1a_hash_str(ElkStr str)
+ELK_TARGET("ssse3")
+static inline b32
+elk_str_helper_parse_i64_ssse3(ElkStr str, i64 *result)
 {
-    return elk_fnv1a_hash(str.len, str.start);
-}
+    /* Up to 16 characters can't overflow, even if they're all digits. Load it so the last digit is in the last byte, but
+     * only if the load doesn't cross into the previous page. Anything else goes through the scalar version.
+     */
+    if(str.len == 0 || str.len > 16 || (((uptr)str.start + str.len - 1) & 0xFFF) < 15)
+    {
+        return elk_str_helper_parse_i64_scalar(str, result);
+    }
 
-static inline ElkStringInterner 
-elk_string_interner_create(i8 size_exp, ElkStaticArena *storage)
-{
-    Assert(size_exp > 0 && size_exp <= 31); // Come on, 31 is HUGE
+    __m128i const text = _mm_loadu_si128((__m128i const *)(str.start + str.len - 16));
 
-    usize const handles_len = (usize)(1 << size_exp);
-    ElkStringInternerHandle *handles = elk_static_arena_nmalloc(storage, handles_len, ElkStringInternerHandle);
-    PanicIf(!handles);
+    /* Mask of the bytes in the string, and which of those should be digits. */
+    __m128i const positions = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i const in_str = _mm_cmpgt_epi8(positions, _mm_set1_epi8((char)(15 - str.len)));
+    u32 const in_bits = (u32)_mm_movemask_epi8(in_str);
 
-    return (ElkStringInterner)
-    {
-        .storage = storage,
-        .handles = handles,
-        .num_handles = 0, 
-        .size_exp = size_exp
-    };
-}
+    b32 const has_sign = str.start[0] == '-' || str.start[0] == '+';
+    u32 const want_digit_bits = has_sign ? in_bits & (in_bits - 1) : in_bits;
 
-static inline void
-elk_string_interner_destroy(ElkStringInterner *interner)
-{
-    return;
+    __m128i const digits = _mm_sub_epi8(text, _mm_set1_epi8('0'));
+    __m128i const is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+    u32 const digit_bits = (u32)_mm_movemask_epi8(is_digit) & in_bits;
+    StopIf(want_digit_bits == 0 || digit_bits != want_digit_bits, return false);
+
+    /* Combine the digits in pairs, then groups of 4, then 8. */
+    __m128i values = _mm_and_si128(digits, _mm_and_si128(is_digit, in_str));
+    values = _mm_maddubs_epi16(values, _mm_set1_epi16(0x010A));
+    values = _mm_madd_epi16(values, _mm_set1_epi32(0x00010064));
+    values = _mm_packs_epi32(values, values);
+    values = _mm_madd_epi16(values, _mm_set1_epi32(0x00012710));
+
+    u64 const high = (u32)_mm_cvtsi128_si32(values);
+    u64 const low = (u32)_mm_cvtsi128_si32(_mm_srli_si128(values, 4));
+    i64 const parsed = (i64)(high * 100000000 + low);
+
+    *result = str.start[0] == '-' ? -parsed : parsed;
+    return true;
 }
 
 static inline b32
-elk_hash_table_large_enough(usize num_handles, i8 size_exp)
+elk_str_parse_i64(ElkStr str, i64 *result)
 {
-    // Shoot for no more than 75% of slots filled.
-    return num_handles < 3 * (1 << size_exp) / 4;
+#if __SSSE3__
+    return elk_str_helper_parse_i64_ssse3(str, result);
+#else
+    return elk_str_helper_parse_i64_scalar(str, result);
+#endif
 }
 
-static inline u32
-elk_hash_lookup(u64 hash, i8 exp, u32 idx)
-{
-    // Copied from https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
-    u32 mask = (UINT32_C(1) << exp) - 1;
-    u32 step = (u32)((hash >> (64 - exp)) | 1);    // the | 1 forces an odd number
-    return (idx + step) & mask;
+/* Powers of five from 5^-342 to 5^324 as 128 bit values, high bits first, normalized so the most significant bit is set.
+ * They're truncated, except 5^-27 to 5^-1 are rounded up. This is the table from the Eisel-Lemire algorithm, which is
+ * described in D. Lemire, "Number Parsing at a Gigabyte per Second", Software: Practice and Experience 51 (8), 2021.
+ * Parsing only needs up to 5^308, the rest are for formatting subnormals.
+ */
+#define ELK_F64_SMALLEST_POWER_OF_10 -342
+#define ELK_F64_LARGEST_POWER_OF_10 308
+#define ELK_F64_TABLE_LARGEST_POWER_OF_10 324
+
+static u64 const elk_power_of_five_128[] = {
+    0xEEF453D6923BD65AULL, 0x113FAA2906A13B3FULL,
+    0x9558B4661B6565F8ULL, 0x4AC7CA59A424C507ULL,
+    0xBAAEE17FA23EBF76ULL, 0x5D79BCF00D2DF649ULL,
+    0xE95A99DF8ACE6F53ULL, 0xF4D82C2C107973DCULL,
+    0x91D8A02BB6C10594ULL, 0x79071B9B8A4BE869ULL,
+    0xB64EC836A47146F9ULL, 0x9748E2826CDEE284ULL,
+    0xE3E27A444D8D98B7ULL, 0xFD1B1B2308169B25ULL,
+    0x8E6D8C6AB0787F72ULL, 0xFE30F0F5E50E20F7ULL,
+    0xB208EF855C969F4FULL, 0xBDBD2D335E51A935ULL,
+    0xDE8B2B66B3BC4723ULL, 0xAD2C788035E61382ULL,
+    0x8B16FB203055AC76ULL, 0x4C3BCB5021AFCC31ULL,
+    0xADDCB9E83C6B1793ULL, 0xDF4ABE242A1BBF3DULL,
+    0xD953E8624B85DD78ULL, 0xD71D6DAD34A2AF0DULL,
+    0x87D4713D6F33AA6BULL, 0x8672648C40E5AD68ULL,
+    0xA9C98D8CCB009506ULL, 0x680EFDAF511F18C2ULL,
+    0xD43BF0EFFDC0BA48ULL, 0x0212BD1B2566DEF2ULL,
+    0x84A57695FE98746DULL, 0x014BB630F7604B57ULL,
+    0xA5CED43B7E3E9188ULL, 0x419EA3BD35385E2DULL,
+    0xCF42894A5DCE35EAULL, 0x52064CAC828675B9ULL,
+    0x818995CE7AA0E1B2ULL, 0x7343EFEBD1940993ULL,
+    0xA1EBFB4219491A1FULL, 0x1014EBE6C5F90BF8ULL,
+    0xCA66FA129F9B60A6ULL, 0xD41A26E077774EF6ULL,
+    0xFD00B897478238D0ULL, 0x8920B098955522B4ULL,
+    0x9E20735E8CB16382ULL, 0x55B46E5F5D5535B0ULL,
+    0xC5A890362FDDBC62ULL, 0xEB2189F734AA831DULL,
+    0xF712B443BBD52B7BULL, 0xA5E9EC7501D523E4ULL,
+    0x9A6BB0AA55653B2DULL, 0x47B233C92125366EULL,
+    0xC1069CD4EABE89F8ULL, 0x999EC0BB696E840AULL,
+    0xF148440A256E2C76ULL, 0xC00670EA43CA250DULL,
+    0x96CD2A865764DBCAULL, 0x380406926A5E5728ULL,
+    0xBC807527ED3E12BCULL, 0xC605083704F5ECF2ULL,
+    0xEBA09271E88D976BULL, 0xF7864A44C633682EULL,
+    0x93445B8731587EA3ULL, 0x7AB3EE6AFBE0211DULL,
+    0xB8157268FDAE9E4CULL, 0x5960EA05BAD82964ULL,
+    0xE61ACF033D1A45DFULL, 0x6FB92487298E33BDULL,
+    0x8FD0C16206306BABULL, 0xA5D3B6D479F8E056ULL,
+    0xB3C4F1BA87BC8696ULL, 0x8F48A4899877186CULL,
+    0xE0B62E2929ABA83CULL, 0x331ACDABFE94DE87ULL,
+    0x8C71DCD9BA0B4925ULL, 0x9FF0C08B7F1D0B14ULL,
+    0xAF8E5410288E1B6FULL, 0x07ECF0AE5EE44DD9ULL,
+    0xDB71E91432B1A24AULL, 0xC9E82CD9F69D6150ULL,
+    0x892731AC9FAF056EULL, 0xBE311C083A225CD2ULL,
+    0xAB70FE17C79AC6CAULL, 0x6DBD630A48AAF406ULL,
+    0xD64D3D9DB981787DULL, 0x092CBBCCDAD5B108ULL,
+    0x85F0468293F0EB4EULL, 0x25BBF56008C58EA5ULL,
+    0xA76C582338ED2621ULL, 0xAF2AF2B80AF6F24EULL,
+    0xD1476E2C07286FAAULL, 0x1AF5AF660DB4AEE1ULL,
+    0x82CCA4DB847945CAULL, 0x50D98D9FC890ED4DULL,
+    0xA37FCE126597973CULL, 0xE50FF107BAB528A0ULL,
+    0xCC5FC196FEFD7D0CULL, 0x1E53ED49A96272C8ULL,
+    0xFF77B1FCBEBCDC4FULL, 0x25E8E89C13BB0F7AULL,
+    0x9FAACF3DF73609B1ULL, 0x77B191618C54E9ACULL,
+    0xC795830D75038C1DULL, 0xD59DF5B9EF6A2417ULL,
+    0xF97AE3D0D2446F25ULL, 0x4B0573286B44AD1DULL,
+    0x9BECCE62836AC577ULL, 0x4EE367F9430AEC32ULL,
+    0xC2E801FB244576D5ULL, 0x229C41F793CDA73FULL,
+    0xF3A20279ED56D48AULL, 0x6B43527578C1110FULL,
+    0x9845418C345644D6ULL, 0x830A13896B78AAA9ULL,
+    0xBE5691EF416BD60CULL, 0x23CC986BC656D553ULL,
+    0xEDEC366B11C6CB8FULL, 0x2CBFBE86B7EC8AA8ULL,
+    0x94B3A202EB1C3F39ULL, 0x7BF7D71432F3D6A9ULL,
+    0xB9E08A83A5E34F07ULL, 0xDAF5CCD93FB0CC53ULL,
+    0xE858AD248F5C22C9ULL, 0xD1B3400F8F9CFF68ULL,
+    0x91376C36D99995BEULL, 0x23100809B9C21FA1ULL,
+    0xB58547448FFFFB2DULL, 0xABD40A0C2832A78AULL,
+    0xE2E69915B3FFF9F9ULL, 0x16C90C8F323F516CULL,
+    0x8DD01FAD907FFC3BULL, 0xAE3DA7D97F6792E3ULL,
+    0xB1442798F49FFB4AULL, 0x99CD11CFDF41779CULL,
+    0xDD95317F31C7FA1DULL, 0x40405643D711D583ULL,
+    0x8A7D3EEF7F1CFC52ULL, 0x482835EA666B2572ULL,
+    0xAD1C8EAB5EE43B66ULL, 0xDA3243650005EECFULL,
+    0xD863B256369D4A40ULL, 0x90BED43E40076A82ULL,
+    0x873E4F75E2224E68ULL, 0x5A7744A6E804A291ULL,
+    0xA90DE3535AAAE202ULL, 0x711515D0A205CB36ULL,
+    0xD3515C2831559A83ULL, 0x0D5A5B44CA873E03ULL,
+    0x8412D9991ED58091ULL, 0xE858790AFE9486C2ULL,
+    0xA5178FFF668AE0B6ULL, 0x626E974DBE39A872ULL,
+    0xCE5D73FF402D98E3ULL, 0xFB0A3D212DC8128FULL,
+    0x80FA687F881C7F8EULL, 0x7CE66634BC9D0B99ULL,
+    0xA139029F6A239F72ULL, 0x1C1FFFC1EBC44E80ULL,
+    0xC987434744AC874EULL, 0xA327FFB266B56220ULL,
+    0xFBE9141915D7A922ULL, 0x4BF1FF9F0062BAA8ULL,
+    0x9D71AC8FADA6C9B5ULL, 0x6F773FC3603DB4A9ULL,
+    0xC4CE17B399107C22ULL, 0xCB550FB4384D21D3ULL,
+    0xF6019DA07F549B2BULL, 0x7E2A53A146606A48ULL,
+    0x99C102844F94E0FBULL, 0x2EDA7444CBFC426DULL,
+    0xC0314325637A1939ULL, 0xFA911155FEFB5308ULL,
+    0xF03D93EEBC589F88ULL, 0x793555AB7EBA27CAULL,
+    0x96267C7535B763B5ULL, 0x4BC1558B2F3458DEULL,
+    0xBBB01B9283253CA2ULL, 0x9EB1AAEDFB016F16ULL,
+    0xEA9C227723EE8BCBULL, 0x465E15A979C1CADCULL,
+    0x92A1958A7675175FULL, 0x0BFACD89EC191EC9ULL,
+    0xB749FAED14125D36ULL, 0xCEF980EC671F667BULL,
+    0xE51C79A85916F484ULL, 0x82B7E12780E7401AULL,
+    0x8F31CC0937AE58D2ULL, 0xD1B2ECB8B0908810ULL,
+    0xB2FE3F0B8599EF07ULL, 0x861FA7E6DCB4AA15ULL,
+    0xDFBDCECE67006AC9ULL, 0x67A791E093E1D49AULL,
+    0x8BD6A141006042BDULL, 0xE0C8BB2C5C6D24E0ULL,
+    0xAECC49914078536DULL, 0x58FAE9F773886E18ULL,
+    0xDA7F5BF590966848ULL, 0xAF39A475506A899EULL,
+    0x888F99797A5E012DULL, 0x6D8406C952429603ULL,
+    0xAAB37FD7D8F58178ULL, 0xC8E5087BA6D33B83ULL,
+    0xD5605FCDCF32E1D6ULL, 0xFB1E4A9A90880A64ULL,
+    0x855C3BE0A17FCD26ULL, 0x5CF2EEA09A55067FULL,
+    0xA6B34AD8C9DFC06FULL, 0xF42FAA48C0EA481EULL,
+    0xD0601D8EFC57B08BULL, 0xF13B94DAF124DA26ULL,
+    0x823C12795DB6CE57ULL, 0x76C53D08D6B70858ULL,
+    0xA2CB1717B52481EDULL, 0x54768C4B0C64CA6EULL,
+    0xCB7DDCDDA26DA268ULL, 0xA9942F5DCF7DFD09ULL,
+    0xFE5D54150B090B02ULL, 0xD3F93B35435D7C4CULL,
+    0x9EFA548D26E5A6E1ULL, 0xC47BC5014A1A6DAFULL,
+    0xC6B8E9B0709F109AULL, 0x359AB6419CA1091BULL,
+    0xF867241C8CC6D4C0ULL, 0xC30163D203C94B62ULL,
+    0x9B407691D7FC44F8ULL, 0x79E0DE63425DCF1DULL,
+    0xC21094364DFB5636ULL, 0x985915FC12F542E4ULL,
+    0xF294B943E17A2BC4ULL, 0x3E6F5B7B17B2939DULL,
+    0x979CF3CA6CEC5B5AULL, 0xA705992CEECF9C42ULL,
+    0xBD8430BD08277231ULL, 0x50C6FF782A838353ULL,
+    0xECE53CEC4A314EBDULL, 0xA4F8BF5635246428ULL,
+    0x940F4613AE5ED136ULL, 0x871B7795E136BE99ULL,
+    0xB913179899F68584ULL, 0x28E2557B59846E3FULL,
+    0xE757DD7EC07426E5ULL, 0x331AEADA2FE589CFULL,
+    0x9096EA6F3848984FULL, 0x3FF0D2C85DEF7621ULL,
+    0xB4BCA50B065ABE63ULL, 0x0FED077A756B53A9ULL,
+    0xE1EBCE4DC7F16DFBULL, 0xD3E8495912C62894ULL,
+    0x8D3360F09CF6E4BDULL, 0x64712DD7ABBBD95CULL,
+    0xB080392CC4349DECULL, 0xBD8D794D96AACFB3ULL,
+    0xDCA04777F541C567ULL, 0xECF0D7A0FC5583A0ULL,
+    0x89E42CAAF9491B60ULL, 0xF41686C49DB57244ULL,
+    0xAC5D37D5B79B6239ULL, 0x311C2875C522CED5ULL,
+    0xD77485CB25823AC7ULL, 0x7D633293366B828BULL,
+    0x86A8D39EF77164BCULL, 0xAE5DFF9C02033197ULL,
+    0xA8530886B54DBDEBULL, 0xD9F57F830283FDFCULL,
+    0xD267CAA862A12D66ULL, 0xD072DF63C324FD7BULL,
+    0x8380DEA93DA4BC60ULL, 0x4247CB9E59F71E6DULL,
+    0xA46116538D0DEB78ULL, 0x52D9BE85F074E608ULL,
+    0xCD795BE870516656ULL, 0x67902E276C921F8BULL,
+    0x806BD9714632DFF6ULL, 0x00BA1CD8A3DB53B6ULL,
+    0xA086CFCD97BF97F3ULL, 0x80E8A40ECCD228A4ULL,
+    0xC8A883C0FDAF7DF0ULL, 0x6122CD128006B2CDULL,
+    0xFAD2A4B13D1B5D6CULL, 0x796B805720085F81ULL,
+    0x9CC3A6EEC6311A63ULL, 0xCBE3303674053BB0ULL,
+    0xC3F490AA77BD60FCULL, 0xBEDBFC4411068A9CULL,
+    0xF4F1B4D515ACB93BULL, 0xEE92FB5515482D44ULL,
+    0x991711052D8BF3C5ULL, 0x751BDD152D4D1C4AULL,
+    0xBF5CD54678EEF0B6ULL, 0xD262D45A78A0635DULL,
+    0xEF340A98172AACE4ULL, 0x86FB897116C87C34ULL,
+    0x9580869F0E7AAC0EULL, 0xD45D35E6AE3D4DA0ULL,
+    0xBAE0A846D2195712ULL, 0x8974836059CCA109ULL,
+    0xE998D258869FACD7ULL, 0x2BD1A438703FC94BULL,
+    0x91FF83775423CC06ULL, 0x7B6306A34627DDCFULL,
+    0xB67F6455292CBF08ULL, 0x1A3BC84C17B1D542ULL,
+    0xE41F3D6A7377EECAULL, 0x20CABA5F1D9E4A93ULL,
+    0x8E938662882AF53EULL, 0x547EB47B7282EE9CULL,
+    0xB23867FB2A35B28DULL, 0xE99E619A4F23AA43ULL,
+    0xDEC681F9F4C31F31ULL, 0x6405FA00E2EC94D4ULL,
+    0x8B3C113C38F9F37EULL, 0xDE83BC408DD3DD04ULL,
+    0xAE0B158B4738705EULL, 0x9624AB50B148D445ULL,
+    0xD98DDAEE19068C76ULL, 0x3BADD624DD9B0957ULL,
+    0x87F8A8D4CFA417C9ULL, 0xE54CA5D70A80E5D6ULL,
+    0xA9F6D30A038D1DBCULL, 0x5E9FCF4CCD211F4CULL,
+    0xD47487CC8470652BULL, 0x7647C3200069671FULL,
+    0x84C8D4DFD2C63F3BULL, 0x29ECD9F40041E073ULL,
+    0xA5FB0A17C777CF09ULL, 0xF468107100525890ULL,
+    0xCF79CC9DB955C2CCULL, 0x7182148D4066EEB4ULL,
+    0x81AC1FE293D599BFULL, 0xC6F14CD848405530ULL,
+    0xA21727DB38CB002FULL, 0xB8ADA00E5A506A7CULL,
+    0xCA9CF1D206FDC03BULL, 0xA6D90811F0E4851CULL,
+    0xFD442E4688BD304AULL, 0x908F4A166D1DA663ULL,
+    0x9E4A9CEC15763E2EULL, 0x9A598E4E043287FEULL,
+    0xC5DD44271AD3CDBAULL, 0x40EFF1E1853F29FDULL,
+    0xF7549530E188C128ULL, 0xD12BEE59E68EF47CULL,
+    0x9A94DD3E8CF578B9ULL, 0x82BB74F8301958CEULL,
+    0xC13A148E3032D6E7ULL, 0xE36A52363C1FAF01ULL,
+    0xF18899B1BC3F8CA1ULL, 0xDC44E6C3CB279AC1ULL,
+    0x96F5600F15A7B7E5ULL, 0x29AB103A5EF8C0B9ULL,
+    0xBCB2B812DB11A5DEULL, 0x7415D448F6B6F0E7ULL,
+    0xEBDF661791D60F56ULL, 0x111B495B3464AD21ULL,
+    0x936B9FCEBB25C995ULL, 0xCAB10DD900BEEC34ULL,
+    0xB84687C269EF3BFBULL, 0x3D5D514F40EEA742ULL,
+    0xE65829B3046B0AFAULL, 0x0CB4A5A3112A5112ULL,
+    0x8FF71A0FE2C2E6DCULL, 0x47F0E785EABA72ABULL,
+    0xB3F4E093DB73A093ULL, 0x59ED216765690F56ULL,
+    0xE0F218B8D25088B8ULL, 0x306869C13EC3532CULL,
+    0x8C974F7383725573ULL, 0x1E414218C73A13FBULL,
+    0xAFBD2350644EEACFULL, 0xE5D1929EF90898FAULL,
+    0xDBAC6C247D62A583ULL, 0xDF45F746B74ABF39ULL,
+    0x894BC396CE5DA772ULL, 0x6B8BBA8C328EB783ULL,
+    0xAB9EB47C81F5114FULL, 0x066EA92F3F326564ULL,
+    0xD686619BA27255A2ULL, 0xC80A537B0EFEFEBDULL,
+    0x8613FD0145877585ULL, 0xBD06742CE95F5F36ULL,
+    0xA798FC4196E952E7ULL, 0x2C48113823B73704ULL,
+    0xD17F3B51FCA3A7A0ULL, 0xF75A15862CA504C5ULL,
+    0x82EF85133DE648C4ULL, 0x9A984D73DBE722FBULL,
+    0xA3AB66580D5FDAF5ULL, 0xC13E60D0D2E0EBBAULL,
+    0xCC963FEE10B7D1B3ULL, 0x318DF905079926A8ULL,
+    0xFFBBCFE994E5C61FULL, 0xFDF17746497F7052ULL,
+    0x9FD561F1FD0F9BD3ULL, 0xFEB6EA8BEDEFA633ULL,
+    0xC7CABA6E7C5382C8ULL, 0xFE64A52EE96B8FC0ULL,
+    0xF9BD690A1B68637BULL, 0x3DFDCE7AA3C673B0ULL,
+    0x9C1661A651213E2DULL, 0x06BEA10CA65C084EULL,
+    0xC31BFA0FE5698DB8ULL, 0x486E494FCFF30A62ULL,
+    0xF3E2F893DEC3F126ULL, 0x5A89DBA3C3EFCCFAULL,
+    0x986DDB5C6B3A76B7ULL, 0xF89629465A75E01CULL,
+    0xBE89523386091465ULL, 0xF6BBB397F1135823ULL,
+    0xEE2BA6C0678B597FULL, 0x746AA07DED582E2CULL,
+    0x94DB483840B717EFULL, 0xA8C2A44EB4571CDCULL,
+    0xBA121A4650E4DDEBULL, 0x92F34D62616CE413ULL,
+    0xE896A0D7E51E1566ULL, 0x77B020BAF9C81D17ULL,
+    0x915E2486EF32CD60ULL, 0x0ACE1474DC1D122EULL,
+    0xB5B5ADA8AAFF80B8ULL, 0x0D819992132456BAULL,
+    0xE3231912D5BF60E6ULL, 0x10E1FFF697ED6C69ULL,
+    0x8DF5EFABC5979C8FULL, 0xCA8D3FFA1EF463C1ULL,
+    0xB1736B96B6FD83B3ULL, 0xBD308FF8A6B17CB2ULL,
+    0xDDD0467C64BCE4A0ULL, 0xAC7CB3F6D05DDBDEULL,
+    0x8AA22C0DBEF60EE4ULL, 0x6BCDF07A423AA96BULL,
+    0xAD4AB7112EB3929DULL, 0x86C16C98D2C953C6ULL,
+    0xD89D64D57A607744ULL, 0xE871C7BF077BA8B7ULL,
+    0x87625F056C7C4A8BULL, 0x11471CD764AD4972ULL,
+    0xA93AF6C6C79B5D2DULL, 0xD598E40D3DD89BCFULL,
+    0xD389B47879823479ULL, 0x4AFF1D108D4EC2C3ULL,
+    0x843610CB4BF160CBULL, 0xCEDF722A585139BAULL,
+    0xA54394FE1EEDB8FEULL, 0xC2974EB4EE658828ULL,
+    0xCE947A3DA6A9273EULL, 0x733D226229FEEA32ULL,
+    0x811CCC668829B887ULL, 0x0806357D5A3F525FULL,
+    0xA163FF802A3426A8ULL, 0xCA07C2DCB0CF26F7ULL,
+    0xC9BCFF6034C13052ULL, 0xFC89B393DD02F0B5ULL,
+    0xFC2C3F3841F17C67ULL, 0xBBAC2078D443ACE2ULL,
+    0x9D9BA7832936EDC0ULL, 0xD54B944B84AA4C0DULL,
+    0xC5029163F384A931ULL, 0x0A9E795E65D4DF11ULL,
+    0xF64335BCF065D37DULL, 0x4D4617B5FF4A16D5ULL,
+    0x99EA0196163FA42EULL, 0x504BCED1BF8E4E45ULL,
+    0xC06481FB9BCF8D39ULL, 0xE45EC2862F71E1D6ULL,
+    0xF07DA27A82C37088ULL, 0x5D767327BB4E5A4CULL,
+    0x964E858C91BA2655ULL, 0x3A6A07F8D510F86FULL,
+    0xBBE226EFB628AFEAULL, 0x890489F70A55368BULL,
+    0xEADAB0ABA3B2DBE5ULL, 0x2B45AC74CCEA842EULL,
+    0x92C8AE6B464FC96FULL, 0x3B0B8BC90012929DULL,
+    0xB77ADA0617E3BBCBULL, 0x09CE6EBB40173744ULL,
+    0xE55990879DDCAABDULL, 0xCC420A6A101D0515ULL,
+    0x8F57FA54C2A9EAB6ULL, 0x9FA946824A12232DULL,
+    0xB32DF8E9F3546564ULL, 0x47939822DC96ABF9ULL,
+    0xDFF9772470297EBDULL, 0x59787E2B93BC56F7ULL,
+    0x8BFBEA76C619EF36ULL, 0x57EB4EDB3C55B65AULL,
+    0xAEFAE51477A06B03ULL, 0xEDE622920B6B23F1ULL,
+    0xDAB99E59958885C4ULL, 0xE95FAB368E45ECEDULL,
+    0x88B402F7FD75539BULL, 0x11DBCB0218EBB414ULL,
+    0xAAE103B5FCD2A881ULL, 0xD652BDC29F26A119ULL,
+    0xD59944A37C0752A2ULL, 0x4BE76D3346F0495FULL,
+    0x857FCAE62D8493A5ULL, 0x6F70A4400C562DDBULL,
+    0xA6DFBD9FB8E5B88EULL, 0xCB4CCD500F6BB952ULL,
+    0xD097AD07A71F26B2ULL, 0x7E2000A41346A7A7ULL,
+    0x825ECC24C873782FULL, 0x8ED400668C0C28C8ULL,
+    0xA2F67F2DFA90563BULL, 0x728900802F0F32FAULL,
+    0xCBB41EF979346BCAULL, 0x4F2B40A03AD2FFB9ULL,
+    0xFEA126B7D78186BCULL, 0xE2F610C84987BFA8ULL,
+    0x9F24B832E6B0F436ULL, 0x0DD9CA7D2DF4D7C9ULL,
+    0xC6EDE63FA05D3143ULL, 0x91503D1C79720DBBULL,
+    0xF8A95FCF88747D94ULL, 0x75A44C6397CE912AULL,
+    0x9B69DBE1B548CE7CULL, 0xC986AFBE3EE11ABAULL,
+    0xC24452DA229B021BULL, 0xFBE85BADCE996168ULL,
+    0xF2D56790AB41C2A2ULL, 0xFAE27299423FB9C3ULL,
+    0x97C560BA6B0919A5ULL, 0xDCCD879FC967D41AULL,
+    0xBDB6B8E905CB600FULL, 0x5400E987BBC1C920ULL,
+    0xED246723473E3813ULL, 0x290123E9AAB23B68ULL,
+    0x9436C0760C86E30BULL, 0xF9A0B6720AAF6521ULL,
+    0xB94470938FA89BCEULL, 0xF808E40E8D5B3E69ULL,
+    0xE7958CB87392C2C2ULL, 0xB60B1D1230B20E04ULL,
+    0x90BD77F3483BB9B9ULL, 0xB1C6F22B5E6F48C2ULL,
+    0xB4ECD5F01A4AA828ULL, 0x1E38AEB6360B1AF3ULL,
+    0xE2280B6C20DD5232ULL, 0x25C6DA63C38DE1B0ULL,
+    0x8D590723948A535FULL, 0x579C487E5A38AD0EULL,
+    0xB0AF48EC79ACE837ULL, 0x2D835A9DF0C6D851ULL,
+    0xDCDB1B2798182244ULL, 0xF8E431456CF88E65ULL,
+    0x8A08F0F8BF0F156BULL, 0x1B8E9ECB641B58FFULL,
+    0xAC8B2D36EED2DAC5ULL, 0xE272467E3D222F3FULL,
+    0xD7ADF884AA879177ULL, 0x5B0ED81DCC6ABB0FULL,
+    0x86CCBB52EA94BAEAULL, 0x98E947129FC2B4E9ULL,
+    0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL,
+    0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL,
+    0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL,
+    0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL,
+    0xCDB02555653131B6ULL, 0x3792F412CB06794DULL,
+    0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL,
+    0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL,
+    0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL,
+    0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL,
+    0x9CED737BB6C4183DULL, 0x55464DD69685606BULL,
+    0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL,
+    0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL,
+    0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL,
+    0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL,
+    0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL,
+    0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL,
+    0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL,
+    0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL,
+    0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL,
+    0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL,
+    0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL,
+    0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL,
+    0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL,
+    0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL,
+    0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL,
+    0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL,
+    0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL,
+    0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL,
+    0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL,
+    0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL,
+    0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL,
+    0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL,
+    0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL,
+    0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL,
+    0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL,
+    0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL,
+    0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL,
+    0x9E74D1B791E07E48ULL, 0x775EA264CF55347EULL,
+    0xC612062576589DDAULL, 0x95364AFE032A819EULL,
+    0xF79687AED3EEC551ULL, 0x3A83DDBD83F52205ULL,
+    0x9ABE14CD44753B52ULL, 0xC4926A9672793543ULL,
+    0xC16D9A0095928A27ULL, 0x75B7053C0F178294ULL,
+    0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6339ULL,
+    0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E04ULL,
+    0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF585ULL,
+    0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E6ULL,
+    0x9392EE8E921D5D07ULL, 0x3AFF322E62439FD0ULL,
+    0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C3ULL,
+    0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B4ULL,
+    0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A11ULL,
+    0xB424DC35095CD80FULL, 0x538484C19EF38C95ULL,
+    0xE12E13424BB40E13ULL, 0x2865A5F206B06FBAULL,
+    0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D4ULL,
+    0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D749ULL,
+    0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1CULL,
+    0x89705F4136B4A597ULL, 0x31680A88F8953031ULL,
+    0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3EULL,
+    0xD6BF94D5E57A42BCULL, 0x3D32907604691B4DULL,
+    0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B110ULL,
+    0xA7C5AC471B478423ULL, 0x0FCF80DC33721D54ULL,
+    0xD1B71758E219652BULL, 0xD3C36113404EA4A9ULL,
+    0x83126E978D4FDF3BULL, 0x645A1CAC083126EAULL,
+    0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A4ULL,
+    0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCDULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL,
+    0xA000000000000000ULL, 0x0000000000000000ULL,
+    0xC800000000000000ULL, 0x0000000000000000ULL,
+    0xFA00000000000000ULL, 0x0000000000000000ULL,
+    0x9C40000000000000ULL, 0x0000000000000000ULL,
+    0xC350000000000000ULL, 0x0000000000000000ULL,
+    0xF424000000000000ULL, 0x0000000000000000ULL,
+    0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xBEBC200000000000ULL, 0x0000000000000000ULL,
+    0xEE6B280000000000ULL, 0x0000000000000000ULL,
+    0x9502F90000000000ULL, 0x0000000000000000ULL,
+    0xBA43B74000000000ULL, 0x0000000000000000ULL,
+    0xE8D4A51000000000ULL, 0x0000000000000000ULL,
+    0x9184E72A00000000ULL, 0x0000000000000000ULL,
+    0xB5E620F480000000ULL, 0x0000000000000000ULL,
+    0xE35FA931A0000000ULL, 0x0000000000000000ULL,
+    0x8E1BC9BF04000000ULL, 0x0000000000000000ULL,
+    0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL,
+    0xDE0B6B3A76400000ULL, 0x0000000000000000ULL,
+    0x8AC7230489E80000ULL, 0x0000000000000000ULL,
+    0xAD78EBC5AC620000ULL, 0x0000000000000000ULL,
+    0xD8D726B7177A8000ULL, 0x0000000000000000ULL,
+    0x878678326EAC9000ULL, 0x0000000000000000ULL,
+    0xA968163F0A57B400ULL, 0x0000000000000000ULL,
+    0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL,
+    0x84595161401484A0ULL, 0x0000000000000000ULL,
+    0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL,
+    0xCECB8F27F4200F3AULL, 0x0000000000000000ULL,
+    0x813F3978F8940984ULL, 0x4000000000000000ULL,
+    0xA18F07D736B90BE5ULL, 0x5000000000000000ULL,
+    0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL,
+    0xFC6F7C4045812296ULL, 0x4D00000000000000ULL,
+    0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL,
+    0xC5371912364CE305ULL, 0x6C28000000000000ULL,
+    0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL,
+    0x9A130B963A6C115CULL, 0x3C7F400000000000ULL,
+    0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL,
+    0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL,
+    0x96769950B50D88F4ULL, 0x1314448000000000ULL,
+    0xBC143FA4E250EB31ULL, 0x17D955A000000000ULL,
+    0xEB194F8E1AE525FDULL, 0x5DCFAB0800000000ULL,
+    0x92EFD1B8D0CF37BEULL, 0x5AA1CAE500000000ULL,
+    0xB7ABC627050305ADULL, 0xF14A3D9E40000000ULL,
+    0xE596B7B0C643C719ULL, 0x6D9CCD05D0000000ULL,
+    0x8F7E32CE7BEA5C6FULL, 0xE4820023A2000000ULL,
+    0xB35DBF821AE4F38BULL, 0xDDA2802C8A800000ULL,
+    0xE0352F62A19E306EULL, 0xD50B2037AD200000ULL,
+    0x8C213D9DA502DE45ULL, 0x4526F422CC340000ULL,
+    0xAF298D050E4395D6ULL, 0x9670B12B7F410000ULL,
+    0xDAF3F04651D47B4CULL, 0x3C0CDD765F114000ULL,
+    0x88D8762BF324CD0FULL, 0xA5880A69FB6AC800ULL,
+    0xAB0E93B6EFEE0053ULL, 0x8EEA0D047A457A00ULL,
+    0xD5D238A4ABE98068ULL, 0x72A4904598D6D880ULL,
+    0x85A36366EB71F041ULL, 0x47A6DA2B7F864750ULL,
+    0xA70C3C40A64E6C51ULL, 0x999090B65F67D924ULL,
+    0xD0CF4B50CFE20765ULL, 0xFFF4B4E3F741CF6DULL,
+    0x82818F1281ED449FULL, 0xBFF8F10E7A8921A4ULL,
+    0xA321F2D7226895C7ULL, 0xAFF72D52192B6A0DULL,
+    0xCBEA6F8CEB02BB39ULL, 0x9BF4F8A69F764490ULL,
+    0xFEE50B7025C36A08ULL, 0x02F236D04753D5B4ULL,
+    0x9F4F2726179A2245ULL, 0x01D762422C946590ULL,
+    0xC722F0EF9D80AAD6ULL, 0x424D3AD2B7B97EF5ULL,
+    0xF8EBAD2B84E0D58BULL, 0xD2E0898765A7DEB2ULL,
+    0x9B934C3B330C8577ULL, 0x63CC55F49F88EB2FULL,
+    0xC2781F49FFCFA6D5ULL, 0x3CBF6B71C76B25FBULL,
+    0xF316271C7FC3908AULL, 0x8BEF464E3945EF7AULL,
+    0x97EDD871CFDA3A56ULL, 0x97758BF0E3CBB5ACULL,
+    0xBDE94E8E43D0C8ECULL, 0x3D52EEED1CBEA317ULL,
+    0xED63A231D4C4FB27ULL, 0x4CA7AAA863EE4BDDULL,
+    0x945E455F24FB1CF8ULL, 0x8FE8CAA93E74EF6AULL,
+    0xB975D6B6EE39E436ULL, 0xB3E2FD538E122B44ULL,
+    0xE7D34C64A9C85D44ULL, 0x60DBBCA87196B616ULL,
+    0x90E40FBEEA1D3A4AULL, 0xBC8955E946FE31CDULL,
+    0xB51D13AEA4A488DDULL, 0x6BABAB6398BDBE41ULL,
+    0xE264589A4DCDAB14ULL, 0xC696963C7EED2DD1ULL,
+    0x8D7EB76070A08AECULL, 0xFC1E1DE5CF543CA2ULL,
+    0xB0DE65388CC8ADA8ULL, 0x3B25A55F43294BCBULL,
+    0xDD15FE86AFFAD912ULL, 0x49EF0EB713F39EBEULL,
+    0x8A2DBF142DFCC7ABULL, 0x6E3569326C784337ULL,
+    0xACB92ED9397BF996ULL, 0x49C2C37F07965404ULL,
+    0xD7E77A8F87DAF7FBULL, 0xDC33745EC97BE906ULL,
+    0x86F0AC99B4E8DAFDULL, 0x69A028BB3DED71A3ULL,
+    0xA8ACD7C0222311BCULL, 0xC40832EA0D68CE0CULL,
+    0xD2D80DB02AABD62BULL, 0xF50A3FA490C30190ULL,
+    0x83C7088E1AAB65DBULL, 0x792667C6DA79E0FAULL,
+    0xA4B8CAB1A1563F52ULL, 0x577001B891185938ULL,
+    0xCDE6FD5E09ABCF26ULL, 0xED4C0226B55E6F86ULL,
+    0x80B05E5AC60B6178ULL, 0x544F8158315B05B4ULL,
+    0xA0DC75F1778E39D6ULL, 0x696361AE3DB1C721ULL,
+    0xC913936DD571C84CULL, 0x03BC3A19CD1E38E9ULL,
+    0xFB5878494ACE3A5FULL, 0x04AB48A04065C723ULL,
+    0x9D174B2DCEC0E47BULL, 0x62EB0D64283F9C76ULL,
+    0xC45D1DF942711D9AULL, 0x3BA5D0BD324F8394ULL,
+    0xF5746577930D6500ULL, 0xCA8F44EC7EE36479ULL,
+    0x9968BF6ABBE85F20ULL, 0x7E998B13CF4E1ECBULL,
+    0xBFC2EF456AE276E8ULL, 0x9E3FEDD8C321A67EULL,
+    0xEFB3AB16C59B14A2ULL, 0xC5CFE94EF3EA101EULL,
+    0x95D04AEE3B80ECE5ULL, 0xBBA1F1D158724A12ULL,
+    0xBB445DA9CA61281FULL, 0x2A8A6E45AE8EDC97ULL,
+    0xEA1575143CF97226ULL, 0xF52D09D71A3293BDULL,
+    0x924D692CA61BE758ULL, 0x593C2626705F9C56ULL,
+    0xB6E0C377CFA2E12EULL, 0x6F8B2FB00C77836CULL,
+    0xE498F455C38B997AULL, 0x0B6DFB9C0F956447ULL,
+    0x8EDF98B59A373FECULL, 0x4724BD4189BD5EACULL,
+    0xB2977EE300C50FE7ULL, 0x58EDEC91EC2CB657ULL,
+    0xDF3D5E9BC0F653E1ULL, 0x2F2967B66737E3EDULL,
+    0x8B865B215899F46CULL, 0xBD79E0D20082EE74ULL,
+    0xAE67F1E9AEC07187ULL, 0xECD8590680A3AA11ULL,
+    0xDA01EE641A708DE9ULL, 0xE80E6F4820CC9495ULL,
+    0x884134FE908658B2ULL, 0x3109058D147FDCDDULL,
+    0xAA51823E34A7EEDEULL, 0xBD4B46F0599FD415ULL,
+    0xD4E5E2CDC1D1EA96ULL, 0x6C9E18AC7007C91AULL,
+    0x850FADC09923329EULL, 0x03E2CF6BC604DDB0ULL,
+    0xA6539930BF6BFF45ULL, 0x84DB8346B786151CULL,
+    0xCFE87F7CEF46FF16ULL, 0xE612641865679A63ULL,
+    0x81F14FAE158C5F6EULL, 0x4FCB7E8F3F60C07EULL,
+    0xA26DA3999AEF7749ULL, 0xE3BE5E330F38F09DULL,
+    0xCB090C8001AB551CULL, 0x5CADF5BFD3072CC5ULL,
+    0xFDCB4FA002162A63ULL, 0x73D9732FC7C8F7F6ULL,
+    0x9E9F11C4014DDA7EULL, 0x2867E7FDDCDD9AFAULL,
+    0xC646D63501A1511DULL, 0xB281E1FD541501B8ULL,
+    0xF7D88BC24209A565ULL, 0x1F225A7CA91A4226ULL,
+    0x9AE757596946075FULL, 0x3375788DE9B06958ULL,
+    0xC1A12D2FC3978937ULL, 0x0052D6B1641C83AEULL,
+    0xF209787BB47D6B84ULL, 0xC0678C5DBD23A49AULL,
+    0x9745EB4D50CE6332ULL, 0xF840B7BA963646E0ULL,
+    0xBD176620A501FBFFULL, 0xB650E5A93BC3D898ULL,
+    0xEC5D3FA8CE427AFFULL, 0xA3E51F138AB4CEBEULL,
+    0x93BA47C980E98CDFULL, 0xC66F336C36B10137ULL,
+    0xB8A8D9BBE123F017ULL, 0xB80B0047445D4184ULL,
+    0xE6D3102AD96CEC1DULL, 0xA60DC059157491E5ULL,
+    0x9043EA1AC7E41392ULL, 0x87C89837AD68DB2FULL,
+    0xB454E4A179DD1877ULL, 0x29BABE4598C311FBULL,
+    0xE16A1DC9D8545E94ULL, 0xF4296DD6FEF3D67AULL,
+    0x8CE2529E2734BB1DULL, 0x1899E4A65F58660CULL,
+    0xB01AE745B101E9E4ULL, 0x5EC05DCFF72E7F8FULL,
+    0xDC21A1171D42645DULL, 0x76707543F4FA1F73ULL,
+    0x899504AE72497EBAULL, 0x6A06494A791C53A8ULL,
+    0xABFA45DA0EDBDE69ULL, 0x0487DB9D17636892ULL,
+    0xD6F8D7509292D603ULL, 0x45A9D2845D3C42B6ULL,
+    0x865B86925B9BC5C2ULL, 0x0B8A2392BA45A9B2ULL,
+    0xA7F26836F282B732ULL, 0x8E6CAC7768D7141EULL,
+    0xD1EF0244AF2364FFULL, 0x3207D795430CD926ULL,
+    0x8335616AED761F1FULL, 0x7F44E6BD49E807B8ULL,
+    0xA402B9C5A8D3A6E7ULL, 0x5F16206C9C6209A6ULL,
+    0xCD036837130890A1ULL, 0x36DBA887C37A8C0FULL,
+    0x802221226BE55A64ULL, 0xC2494954DA2C9789ULL,
+    0xA02AA96B06DEB0FDULL, 0xF2DB9BAA10B7BD6CULL,
+    0xC83553C5C8965D3DULL, 0x6F92829494E5ACC7ULL,
+    0xFA42A8B73ABBF48CULL, 0xCB772339BA1F17F9ULL,
+    0x9C69A97284B578D7ULL, 0xFF2A760414536EFBULL,
+    0xC38413CF25E2D70DULL, 0xFEF5138519684ABAULL,
+    0xF46518C2EF5B8CD1ULL, 0x7EB258665FC25D69ULL,
+    0x98BF2F79D5993802ULL, 0xEF2F773FFBD97A61ULL,
+    0xBEEEFB584AFF8603ULL, 0xAAFB550FFACFD8FAULL,
+    0xEEAABA2E5DBF6784ULL, 0x95BA2A53F983CF38ULL,
+    0x952AB45CFA97A0B2ULL, 0xDD945A747BF26183ULL,
+    0xBA756174393D88DFULL, 0x94F971119AEEF9E4ULL,
+    0xE912B9D1478CEB17ULL, 0x7A37CD5601AAB85DULL,
+    0x91ABB422CCB812EEULL, 0xAC62E055C10AB33AULL,
+    0xB616A12B7FE617AAULL, 0x577B986B314D6009ULL,
+    0xE39C49765FDF9D94ULL, 0xED5A7E85FDA0B80BULL,
+    0x8E41ADE9FBEBC27DULL, 0x14588F13BE847307ULL,
+    0xB1D219647AE6B31CULL, 0x596EB2D8AE258FC8ULL,
+    0xDE469FBD99A05FE3ULL, 0x6FCA5F8ED9AEF3BBULL,
+    0x8AEC23D680043BEEULL, 0x25DE7BB9480D5854ULL,
+    0xADA72CCC20054AE9ULL, 0xAF561AA79A10AE6AULL,
+    0xD910F7FF28069DA4ULL, 0x1B2BA1518094DA04ULL,
+    0x87AA9AFF79042286ULL, 0x90FB44D2F05D0842ULL,
+    0xA99541BF57452B28ULL, 0x353A1607AC744A53ULL,
+    0xD3FA922F2D1675F2ULL, 0x42889B8997915CE8ULL,
+    0x847C9B5D7C2E09B7ULL, 0x69956135FEBADA11ULL,
+    0xA59BC234DB398C25ULL, 0x43FAB9837E699095ULL,
+    0xCF02B2C21207EF2EULL, 0x94F967E45E03F4BBULL,
+    0x8161AFB94B44F57DULL, 0x1D1BE0EEBAC278F5ULL,
+    0xA1BA1BA79E1632DCULL, 0x6462D92A69731732ULL,
+    0xCA28A291859BBF93ULL, 0x7D7B8F7503CFDCFEULL,
+    0xFCB2CB35E702AF78ULL, 0x5CDA735244C3D43EULL,
+    0x9DEFBF01B061ADABULL, 0x3A0888136AFA64A7ULL,
+    0xC56BAEC21C7A1916ULL, 0x088AAA1845B8FDD0ULL,
+    0xF6C69A72A3989F5BULL, 0x8AAD549E57273D45ULL,
+    0x9A3C2087A63F6399ULL, 0x36AC54E2F678864BULL,
+    0xC0CB28A98FCF3C7FULL, 0x84576A1BB416A7DDULL,
+    0xF0FDF2D3F3C30B9FULL, 0x656D44A2A11C51D5ULL,
+    0x969EB7C47859E743ULL, 0x9F644AE5A4B1B325ULL,
+    0xBC4665B596706114ULL, 0x873D5D9F0DDE1FEEULL,
+    0xEB57FF22FC0C7959ULL, 0xA90CB506D155A7EAULL,
+    0x9316FF75DD87CBD8ULL, 0x09A7F12442D588F2ULL,
+    0xB7DCBF5354E9BECEULL, 0x0C11ED6D538AEB2FULL,
+    0xE5D3EF282A242E81ULL, 0x8F1668C8A86DA5FAULL,
+    0x8FA475791A569D10ULL, 0xF96E017D694487BCULL,
+    0xB38D92D760EC4455ULL, 0x37C981DCC395A9ACULL,
+    0xE070F78D3927556AULL, 0x85BBE253F47B1417ULL,
+    0x8C469AB843B89562ULL, 0x93956D7478CCEC8EULL,
+    0xAF58416654A6BABBULL, 0x387AC8D1970027B2ULL,
+    0xDB2E51BFE9D0696AULL, 0x06997B05FCC0319EULL,
+    0x88FCF317F22241E2ULL, 0x441FECE3BDF81F03ULL,
+    0xAB3C2FDDEEAAD25AULL, 0xD527E81CAD7626C3ULL,
+    0xD60B3BD56A5586F1ULL, 0x8A71E223D8D3B074ULL,
+    0x85C7056562757456ULL, 0xF6872D5667844E49ULL,
+    0xA738C6BEBB12D16CULL, 0xB428F8AC016561DBULL,
+    0xD106F86E69D785C7ULL, 0xE13336D701BEBA52ULL,
+    0x82A45B450226B39CULL, 0xECC0024661173473ULL,
+    0xA34D721642B06084ULL, 0x27F002D7F95D0190ULL,
+    0xCC20CE9BD35C78A5ULL, 0x31EC038DF7B441F4ULL,
+    0xFF290242C83396CEULL, 0x7E67047175A15271ULL,
+    0x9F79A169BD203E41ULL, 0x0F0062C6E984D386ULL,
+    0xC75809C42C684DD1ULL, 0x52C07B78A3E60868ULL,
+    0xF92E0C3537826145ULL, 0xA7709A56CCDF8A82ULL,
+    0x9BBCC7A142B17CCBULL, 0x88A66076400BB691ULL,
+    0xC2ABF989935DDBFEULL, 0x6ACFF893D00EA435ULL,
+    0xF356F7EBF83552FEULL, 0x0583F6B8C4124D43ULL,
+    0x98165AF37B2153DEULL, 0xC3727A337A8B704AULL,
+    0xBE1BF1B059E9A8D6ULL, 0x744F18C0592E4C5CULL,
+    0xEDA2EE1C7064130CULL, 0x1162DEF06F79DF73ULL,
+    0x9485D4D1C63E8BE7ULL, 0x8ADDCB5645AC2BA8ULL,
+    0xB9A74A0637CE2EE1ULL, 0x6D953E2BD7173692ULL,
+    0xE8111C87C5C1BA99ULL, 0xC8FA8DB6CCDD0437ULL,
+    0x910AB1D4DB9914A0ULL, 0x1D9C9892400A22A2ULL,
+    0xB54D5E4A127F59C8ULL, 0x2503BEB6D00CAB4BULL,
+    0xE2A0B5DC971F303AULL, 0x2E44AE64840FD61DULL,
+    0x8DA471A9DE737E24ULL, 0x5CEAECFED289E5D2ULL,
+    0xB10D8E1456105DADULL, 0x7425A83E872C5F47ULL,
+    0xDD50F1996B947518ULL, 0xD12F124E28F77719ULL,
+    0x8A5296FFE33CC92FULL, 0x82BD6B70D99AAA6FULL,
+    0xACE73CBFDC0BFB7BULL, 0x636CC64D1001550BULL,
+    0xD8210BEFD30EFA5AULL, 0x3C47F7E05401AA4EULL,
+    0x8714A775E3E95C78ULL, 0x65ACFAEC34810A71ULL,
+    0xA8D9D1535CE3B396ULL, 0x7F1839A741A14D0DULL,
+    0xD31045A8341CA07CULL, 0x1EDE48111209A050ULL,
+    0x83EA2B892091E44DULL, 0x934AED0AAB460432ULL,
+    0xA4E4B66B68B65D60ULL, 0xF81DA84D5617853FULL,
+    0xCE1DE40642E3F4B9ULL, 0x36251260AB9D668EULL,
+    0x80D2AE83E9CE78F3ULL, 0xC1D72B7C6B426019ULL,
+    0xA1075A24E4421730ULL, 0xB24CF65B8612F81FULL,
+    0xC94930AE1D529CFCULL, 0xDEE033F26797B627ULL,
+    0xFB9B7CD9A4A7443CULL, 0x169840EF017DA3B1ULL,
+    0x9D412E0806E88AA5ULL, 0x8E1F289560EE864EULL,
+    0xC491798A08A2AD4EULL, 0xF1A6F2BAB92A27E2ULL,
+    0xF5B5D7EC8ACB58A2ULL, 0xAE10AF696774B1DBULL,
+    0x9991A6F3D6BF1765ULL, 0xACCA6DA1E0A8EF29ULL,
+    0xBFF610B0CC6EDD3FULL, 0x17FD090A58D32AF3ULL,
+    0xEFF394DCFF8A948EULL, 0xDDFC4B4CEF07F5B0ULL,
+    0x95F83D0A1FB69CD9ULL, 0x4ABDAF101564F98EULL,
+    0xBB764C4CA7A4440FULL, 0x9D6D1AD41ABE37F1ULL,
+    0xEA53DF5FD18D5513ULL, 0x84C86189216DC5EDULL,
+    0x92746B9BE2F8552CULL, 0x32FD3CF5B4E49BB4ULL,
+    0xB7118682DBB66A77ULL, 0x3FBC8C33221DC2A1ULL,
+    0xE4D5E82392A40515ULL, 0x0FABAF3FEAA5334AULL,
+    0x8F05B1163BA6832DULL, 0x29CB4D87F2A7400EULL,
+    0xB2C71D5BCA9023F8ULL, 0x743E20E9EF511012ULL,
+    0xDF78E4B2BD342CF6ULL, 0x914DA9246B255416ULL,
+    0x8BAB8EEFB6409C1AULL, 0x1AD089B6C2F7548EULL,
+    0xAE9672ABA3D0C320ULL, 0xA184AC2473B529B1ULL,
+    0xDA3C0F568CC4F3E8ULL, 0xC9E5D72D90A2741EULL,
+    0x8865899617FB1871ULL, 0x7E2FA67C7A658892ULL,
+    0xAA7EEBFB9DF9DE8DULL, 0xDDBB901B98FEEAB7ULL,
+    0xD51EA6FA85785631ULL, 0x552A74227F3EA565ULL,
+    0x8533285C936B35DEULL, 0xD53A88958F87275FULL,
+    0xA67FF273B8460356ULL, 0x8A892ABAF368F137ULL,
+    0xD01FEF10A657842CULL, 0x2D2B7569B0432D85ULL,
+    0x8213F56A67F6B29BULL, 0x9C3B29620E29FC73ULL,
+    0xA298F2C501F45F42ULL, 0x8349F3BA91B47B8FULL,
+    0xCB3F2F7642717713ULL, 0x241C70A936219A73ULL,
+    0xFE0EFB53D30DD4D7ULL, 0xED238CD383AA0110ULL,
+    0x9EC95D1463E8A506ULL, 0xF4363804324A40AAULL,
+    0xC67BB4597CE2CE48ULL, 0xB143C6053EDCD0D5ULL,
+    0xF81AA16FDC1B81DAULL, 0xDD94B7868E94050AULL,
+    0x9B10A4E5E9913128ULL, 0xCA7CF2B4191C8326ULL,
+    0xC1D4CE1F63F57D72ULL, 0xFD1C2F611F63A3F0ULL,
+    0xF24A01A73CF2DCCFULL, 0xBC633B39673C8CECULL,
+    0x976E41088617CA01ULL, 0xD5BE0503E085D813ULL,
+    0xBD49D14AA79DBC82ULL, 0x4B2D8644D8A74E18ULL,
+    0xEC9C459D51852BA2ULL, 0xDDF8E7D60ED1219EULL,
+    0x93E1AB8252F33B45ULL, 0xCABB90E5C942B503ULL,
+    0xB8DA1662E7B00A17ULL, 0x3D6A751F3B936243ULL,
+    0xE7109BFBA19C0C9DULL, 0x0CC512670A783AD4ULL,
+    0x906A617D450187E2ULL, 0x27FB2B80668B24C5ULL,
+    0xB484F9DC9641E9DAULL, 0xB1F9F660802DEDF6ULL,
+    0xE1A63853BBD26451ULL, 0x5E7873F8A0396973ULL,
+    0x8D07E33455637EB2ULL, 0xDB0B487B6423E1E8ULL,
+    0xB049DC016ABC5E5FULL, 0x91CE1A9A3D2CDA62ULL,
+    0xDC5C5301C56B75F7ULL, 0x7641A140CC7810FBULL,
+    0x89B9B3E11B6329BAULL, 0xA9E904C87FCB0A9DULL,
+    0xAC2820D9623BF429ULL, 0x546345FA9FBDCD44ULL,
+    0xD732290FBACAF133ULL, 0xA97C177947AD4095ULL,
+    0x867F59A9D4BED6C0ULL, 0x49ED8EABCCCC485DULL,
+    0xA81F301449EE8C70ULL, 0x5C68F256BFFF5A74ULL,
+    0xD226FC195C6A2F8CULL, 0x73832EEC6FFF3111ULL,
+    0x83585D8FD9C25DB7ULL, 0xC831FD53C5FF7EABULL,
+    0xA42E74F3D032F525ULL, 0xBA3E7CA8B77F5E55ULL,
+    0xCD3A1230C43FB26FULL, 0x28CE1BD2E55F35EBULL,
+    0x80444B5E7AA7CF85ULL, 0x7980D163CF5B81B3ULL,
+    0xA0555E361951C366ULL, 0xD7E105BCC332621FULL,
+    0xC86AB5C39FA63440ULL, 0x8DD9472BF3FEFAA7ULL,
+    0xFA856334878FC150ULL, 0xB14F98F6F0FEB951ULL,
+    0x9C935E00D4B9D8D2ULL, 0x6ED1BF9A569F33D3ULL,
+    0xC3B8358109E84F07ULL, 0x0A862F80EC4700C8ULL,
+    0xF4A642E14C6262C8ULL, 0xCD27BB612758C0FAULL,
+    0x98E7E9CCCFBD7DBDULL, 0x8038D51CB897789CULL,
+    0xBF21E44003ACDD2CULL, 0xE0470A63E6BD56C3ULL,
+    0xEEEA5D5004981478ULL, 0x1858CCFCE06CAC74ULL,
+    0x95527A5202DF0CCBULL, 0x0F37801E0C43EBC8ULL,
+    0xBAA718E68396CFFDULL, 0xD30560258F54E6BAULL,
+    0xE950DF20247C83FDULL, 0x47C6B82EF32A2069ULL,
+    0x91D28B7416CDD27EULL, 0x4CDC331D57FA5441ULL,
+    0xB6472E511C81471DULL, 0xE0133FE4ADF8E952ULL,
+    0xE3D8F9E563A198E5ULL, 0x58180FDDD97723A6ULL,
+    0x8E679C2F5E44FF8FULL, 0x570F09EAA7EA7648ULL,
+    0xB201833B35D63F73ULL, 0x2CD2CC6551E513DAULL,
+    0xDE81E40A034BCF4FULL, 0xF8077F7EA65E58D1ULL,
+    0x8B112E86420F6191ULL, 0xFB04AFAF27FAF782ULL,
+    0xADD57A27D29339F6ULL, 0x79C5DB9AF1F9B563ULL,
+    0xD94AD8B1C7380874ULL, 0x18375281AE7822BCULL,
+    0x87CEC76F1C830548ULL, 0x8F2293910D0B15B5ULL,
+    0xA9C2794AE3A3C69AULL, 0xB2EB3875504DDB22ULL,
+    0xD433179D9C8CB841ULL, 0x5FA60692A46151EBULL,
+    0x849FEEC281D7F328ULL, 0xDBC7C41BA6BCD333ULL,
+    0xA5C7EA73224DEFF3ULL, 0x12B9B522906C0800ULL,
+    0xCF39E50FEAE16BEFULL, 0xD768226B34870A00ULL,
+    0x81842F29F2CCE375ULL, 0xE6A1158300D46640ULL,
+    0xA1E53AF46F801C53ULL, 0x60495AE3C1097FD0ULL,
+    0xCA5E89B18B602368ULL, 0x385BB19CB14BDFC4ULL,
+    0xFCF62C1DEE382C42ULL, 0x46729E03DD9ED7B5ULL,
+    0x9E19DB92B4E31BA9ULL, 0x6C07A2C26A8346D1ULL,
+};
+
+_Static_assert(
+    sizeof(elk_power_of_five_128) == 2 * sizeof(u64) * (ELK_F64_TABLE_LARGEST_POWER_OF_10 - ELK_F64_SMALLEST_POWER_OF_10 + 1),
+    "Missing powers of five?!");
+
+static inline u64
+elk_mul_u64_full(u64 a, u64 b, u64 *high)
+{
+    /* 64 x 64 -> 128 bit multiply, returns the low bits. */
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 const product = (unsigned __int128)a * b;
+    *high = (u64)(product >> 64);
+    return (u64)product;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, high);
+#else
+    u64 const a_lo = (u32)a, a_hi = a >> 32;
+    u64 const b_lo = (u32)b, b_hi = b >> 32;
+    u64 const lo_lo = a_lo * b_lo;
+    u64 const hi_lo = a_hi * b_lo;
+    u64 const lo_hi = a_lo * b_hi;
+    u64 const hi_hi = a_hi * b_hi;
+    u64 const cross = (lo_lo >> 32) + (u32)hi_lo + lo_hi;
+    *high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    return (cross << 32) | (u32)lo_lo;
+#endif
 }
 
-static inline void
-elk_string_interner_expand_table(ElkStringInterner *interner)
+static inline f64
+elk_str_helper_f64_from_decimal(u64 w, i32 q)
 {
-    i8 const size_exp = interner->size_exp;
-    i8 const new_size_exp = size_exp + 1;
+    /* Correctly rounded w * 10^q. Overflow gives infinity, and underflow gives zero. */
+    static f64 const exact_powers_of_10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
 
-    usize const handles_len = (usize)(1 << size_exp);
-    usize const new_handles_len = (usize)(1 << new_size_exp);
+    u64 bits = 0;
 
-    ElkStringInternerHandle *new_handles = elk_static_arena_nmalloc(interner->storage, new_handles_len, ElkStringInternerHandle);
-    PanicIf(!new_handles);
+    /* Clinger's fast path, w and 10^q are both exact doubles, so one rounding gives the right answer. */
+    if(q >= -22 && q <= 22 && w <= (UINT64_C(1) << 53))
+    {
+        f64 value = (f64)w;
+        return q < 0 ? value / exact_powers_of_10[-q] : value * exact_powers_of_10[q];
+    }
 
-    for (u32 i = 0; i < handles_len; i++) 
+    if(w == 0 || q < ELK_F64_SMALLEST_POWER_OF_10) { goto BUILD_DOUBLE; }
+    if(q > ELK_F64_LARGEST_POWER_OF_10) { bits = UINT64_C(0x7FF) << 52; goto BUILD_DOUBLE; }
+
+    /* Multiply the normalized mantissa by the truncated power of 5. The power of 2 goes straight into the exponent. Only
+     * if the bits below the 55 we need are all ones could the truncated part of the table entry matter, then we use the
+     * low half of the entry too. With both halves the product is always precise enough to round correctly.
+     */
+    i32 const lz = elk_bit_count_leading_zeros64(w);
+    w <<= lz;
+
+    size const index = 2 * (size)(q - ELK_F64_SMALLEST_POWER_OF_10);
+    u64 high = 0;
+    u64 low = elk_mul_u64_full(w, elk_power_of_five_128[index], &high);
+    if((high & 0x1FF) == 0x1FF)
     {
-        ElkStringInternerHandle *handle = &interner->handles[i];
+        u64 second_high = 0;
+        elk_mul_u64_full(w, elk_power_of_five_128[index + 1], &second_high);
+        low += second_high;
+        if(second_high > low) { high += 1; }
+    }
 
-        if (handle->str.start == NULL) { continue; } // Skip if it's empty
+    i32 const upper_bit = (i32)(high >> 63);
+    i32 const shift = upper_bit + 64 - 52 - 3;
+    u64 mantissa = high >> shift;
+    i32 power2 = (((152170 + 65536) * q) >> 16) + 63 + upper_bit - lz + 1023;
 
-        // Find the position in the new table and update it.
-        u64 const hash = handle->hash;
-        u32 j = hash & 0xffffffff; // truncate
-        while (true) 
-        {
-            j = elk_hash_lookup(hash, new_size_exp, j);
-            ElkStringInternerHandle *new_handle = &new_handles[j];
+    if(power2 <= 0)
+    {
+        /* Subnormal, or it rounds to zero. */
+        StopIf(-power2 + 1 >= 64, goto BUILD_DOUBLE);
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        power2 = mantissa < (UINT64_C(1) << 52) ? 0 : 1;
+        bits = (mantissa & ~(UINT64_C(1) << 52)) | ((u64)power2 << 52);
+        goto BUILD_DOUBLE;
+    }
 
-            if (!new_handle->str.start)
-            {
-                // empty - put it here. Don't need to check for room because we just expanded
-                // the hash table of handles, and we're not copying anything new into storage,
-                // it's already there!
-                *new_handle = *handle;
-                break;
-            }
-        }
+    /* Exactly halfway between two doubles, round to even. This can only happen for small powers of 10. */
+    if(low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high) { mantissa &= ~UINT64_C(1); }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if(mantissa >= (UINT64_C(2) << 52))
+    {
+        mantissa = UINT64_C(1) << 52;
+        power2 += 1;
     }
+    mantissa &= ~(UINT64_C(1) << 52);
 
-    interner->handles = new_handles;
-    interner->size_exp = new_size_exp;
+    if(power2 >= 0x7FF) { bits = UINT64_C(0x7FF) << 52; }
+    else { bits = mantissa | ((u64)power2 << 52); }
 
-    return;
+BUILD_DOUBLE:;
+    f64 value = 0.0;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
 }
 
-static inline ElkStr
-elk_string_interner_intern_cstring(ElkStringInterner *interner, char *string)
-{
-    ElkStr str = elk_str_from_cstring(string);
-    return elk_string_interner_intern(interner, str);
-}
+/* Arbitrary precision unsigned integers, just big enough for rounding decimal strings to doubles exactly. */
+#define ELK_BIG_UINT_LIMBS 128
 
-static inline ElkStr
-elk_string_interner_intern(ElkStringInterner *interner, ElkStr str)
+typedef struct
 {
-    // Inspired by https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
+    u32 limbs[ELK_BIG_UINT_LIMBS]; // Least significant first
+    i32 len;                       // Never has leading zero limbs, so zero has len 0
+} ElkBigUInt;
 
-    u64 const hash = elk_fnv1a_hash_str(str);
-    u32 i = hash & 0xffffffff; // truncate
-    while (true)
+static inline void
+elk_big_uint_mul_small(ElkBigUInt *big, u32 factor)
+{
+    u64 carry = 0;
+    for(i32 i = 0; i < big->len; ++i)
     {
-        i = elk_hash_lookup(hash, interner->size_exp, i);
-        ElkStringInternerHandle *handle = &interner->handles[i];
-
-        if (!handle->str.start)
-        {
-            // empty, insert here if room in the table of handles. Check for room first!
-            if (elk_hash_table_large_enough(interner->num_handles, interner->size_exp))
-            {
-                char *dest = elk_static_arena_nmalloc(interner->storage, str.len + 1, char);
-                PanicIf(!dest);
-                ElkStr interned_str = elk_str_copy(str.len + 1, dest, str);
+        u64 const product = (u64)big->limbs[i] * factor + carry;
+        big->limbs[i] = (u32)product;
+        carry = product >> 32;
+    }
 
-                *handle = (ElkStringInternerHandle){.hash = hash, .str = interned_str};
-                interner->num_handles += 1;
+    if(carry)
+    {
+        PanicIf(big->len >= ELK_BIG_UINT_LIMBS);
+        big->limbs[big->len++] = (u32)carry;
+    }
+}
 
-                return handle->str;
-            }
-            else 
-            {
-                // Grow the table so we have room
-                elk_string_interner_expand_table(interner);
+static inline void
+elk_big_uint_add_small(ElkBigUInt *big, u32 value)
+{
+    u64 carry = value;
+    for(i32 i = 0; i < big->len && carry; ++i)
+    {
+        u64 const sum = (u64)big->limbs[i] + carry;
+        big->limbs[i] = (u32)sum;
+        carry = sum >> 32;
+    }
 
-                // Recurse because all the state needed by the *_lookup function was just crushed
-                // by the expansion of the table.
-                return elk_string_interner_intern(interner, str);
-            }
-        }
-        else if (handle->hash == hash && !elk_str_cmp(str, handle->str)) 
-        {
-            // found it!
-            return handle->str;
-        }
+    if(carry)
+    {
+        PanicIf(big->len >= ELK_BIG_UINT_LIMBS);
+        big->limbs[big->len++] = (u32)carry;
     }
 }
 
-static inline b32
-elk_is_power_of_2(uptr p)
+static inline void
+elk_big_uint_mul_pow5(ElkBigUInt *big, i32 power)
 {
-    return (p & (p - 1)) == 0;
+    static u32 const powers_of_5[] =
+    {
+        1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625, 48828125, 244140625, 1220703125
+    };
+
+    for(; power >= 13; power -= 13) { elk_big_uint_mul_small(big, powers_of_5[13]); }
+    elk_big_uint_mul_small(big, powers_of_5[power]);
 }
 
-static inline uptr
-elk_align_pointer(uptr ptr, usize align)
+static inline void
+elk_big_uint_shift_left(ElkBigUInt *big, i32 shift)
 {
+    if(big->len == 0) { return; }
 
-    Assert(elk_is_power_of_2(align));
+    i32 const limb_shift = shift / 32;
+    i32 const bit_shift = shift % 32;
 
-    uptr a = (uptr)align;
-    uptr mod = ptr & (a - 1); // Same as (ptr % a) but faster as 'a' is a power of 2
+    /* Make room for the top bits that spill over into a new limb. */
+    i32 new_len = big->len + limb_shift + (bit_shift > 0);
+    PanicIf(new_len > ELK_BIG_UINT_LIMBS);
 
-    if (mod != 0)
+    for(i32 i = new_len - 1; i >= limb_shift; --i)
     {
-        // push the address forward to the next value which is aligned
-        ptr += a - mod;
+        i32 const src = i - limb_shift;
+        u32 const hi = src < big->len ? big->limbs[src] : 0;
+        u32 const lo = src > 0 ? big->limbs[src - 1] : 0;
+        big->limbs[i] = bit_shift ? (hi << bit_shift) | (lo >> (32 - bit_shift)) : hi;
     }
+    for(i32 i = 0; i < limb_shift; ++i) { big->limbs[i] = 0; }
 
-    return ptr;
+    while(new_len > 0 && big->limbs[new_len - 1] == 0) { --new_len; }
+    big->len = new_len;
 }
 
-static inline void
-elk_static_arena_create(ElkStaticArena *arena, size buf_size, byte buffer[])
+static inline i32
+elk_big_uint_cmp(ElkBigUInt const *left, ElkBigUInt const *right)
 {
-    Assert(arena && buffer && buf_size > 0);
+    if(left->len != right->len) { return left->len < right->len ? -1 : 1; }
 
-    *arena = (ElkStaticArena)
+    for(i32 i = left->len - 1; i >= 0; --i)
     {
-        .buf_size = buf_size,
-        .buf_offset = 0,
-        .buffer = buffer,
-        .prev_ptr = NULL,
-        .prev_offset = 0,
-    };
+        if(left->limbs[i] != right->limbs[i]) { return left->limbs[i] < right->limbs[i] ? -1 : 1; }
+    }
 
-#ifdef _ELK_TRACK_MEM_USAGE
-    size idx = elk_static_arena_metrics_next++;
-    Assert(idx < (sizeof(elk_static_arena_metrics) / sizeof(elk_static_arena_metrics[0])));
-    arena->metrics_ptr = &elk_static_arena_metrics[idx];
-    *arena->metrics_ptr = (ElkStaticArenaAllocationMetrics){0};
-#endif
-    return;
+    return 0;
 }
 
-static inline void
-elk_static_arena_destroy(ElkStaticArena *arena)
-{
-    // no-op
-    return;
-}
+static inline f64
+elk_str_helper_f64_round_digits(char const *c, char const *end, i32 exponent, f64 lower, f64 upper)
+{
+    /* The slow path, only used when the truncated digits make the fast path ambiguous. The decimal value is between lower
+     * and upper, which are adjacent doubles, so compare all of the digits to the point halfway between them. The halfway
+     * point never has more than 769 significant digits, so any beyond that only matter if it's a tie.
+     *
+     * c to end is the digits with an optional decimal point, and exponent is the one that goes with the first 19
+     * significant digits.
+     */
+    i32 const max_digits = 769;
 
-static inline void
-elk_static_arena_reset(ElkStaticArena *arena)
-{
-    Assert(arena->buffer);
-    arena->buf_offset = 0;
-    arena->prev_ptr = NULL;
-    arena->prev_offset = 0;
-    return;
-}
+    ElkBigUInt digits = {0};
+    i32 num_digits = 0;
+    b32 sticky = false;
 
-static inline void *
-elk_static_arena_alloc(ElkStaticArena *arena, size num_bytes, size alignment)
-{
-    Assert(num_bytes > 0 && alignment > 0);
+    u32 chunk = 0;
+    u32 chunk_scale = 1;
+    for(; c < end; ++c)
+    {
+        if(*c == '.') { continue; }
+        if(num_digits == 0 && *c == '0') { continue; }
+        if(num_digits == max_digits) { sticky |= *c != '0'; continue; }
 
-    // Align 'curr_offset' forward to the specified alignment
-    uptr curr_ptr = (uptr)arena->buffer + (uptr)arena->buf_offset;
-    uptr offset = elk_align_pointer(curr_ptr, alignment);
-    offset -= (uptr)arena->buffer; // change to relative offset
+        chunk = chunk * 10 + (*c - '0');
+        chunk_scale *= 10;
+        num_digits += 1;
 
-    // Check to see if there is enough space left
-    if ((size)(offset + num_bytes) <= arena->buf_size)
+        if(chunk_scale == 1000000000)
+        {
+            elk_big_uint_mul_small(&digits, chunk_scale);
+            elk_big_uint_add_small(&digits, chunk);
+            chunk = 0;
+            chunk_scale = 1;
+        }
+    }
+    elk_big_uint_mul_small(&digits, chunk_scale);
+    elk_big_uint_add_small(&digits, chunk);
+
+    i32 const digits_exponent = exponent - (num_digits - 19);
+
+    /* lower = m * 2^e2, so halfway = (2m + 1) * 2^(e2 - 1). */
+    u64 bits = 0;
+    memcpy(&bits, &lower, sizeof(bits));
+    i32 const biased_exponent = (i32)(bits >> 52);
+    u64 m = bits & ((UINT64_C(1) << 52) - 1);
+    i32 e2 = -1074;
+    if(biased_exponent > 0) { m |= UINT64_C(1) << 52; e2 = biased_exponent - 1075; }
+
+    ElkBigUInt halfway = {0};
+    elk_big_uint_add_small(&halfway, (u32)(2 * m + 1));
+    u64 const halfway_hi = (2 * m + 1) >> 32;
+    if(halfway_hi)
     {
-        void *ptr = &arena->buffer[offset];
-        memset(ptr, 0, num_bytes);
-        arena->prev_offset = arena->buf_offset;
-        arena->buf_offset = offset + num_bytes;
-        arena->prev_ptr = ptr;
+        halfway.limbs[1] = (u32)halfway_hi;
+        halfway.len = 2;
+    }
 
-#ifdef _ELK_TRACK_MEM_USAGE
-        arena->metrics_ptr->max_offset = arena->buf_offset > (arena->metrics_ptr->max_offset) ?
-            arena->buf_offset : (arena->metrics_ptr->max_offset);
-#endif
+    /* Compare digits * 5^d * 2^d with halfway * 2^(e2 - 1), with everything as integers. */
+    if(digits_exponent >= 0) { elk_big_uint_mul_pow5(&digits, digits_exponent); }
+    else { elk_big_uint_mul_pow5(&halfway, -digits_exponent); }
 
-        return ptr;
+    i32 const shift = digits_exponent - (e2 - 1);
+    if(shift > 0) { elk_big_uint_shift_left(&digits, shift); }
+    else { elk_big_uint_shift_left(&halfway, -shift); }
+
+    i32 const cmp = elk_big_uint_cmp(&digits, &halfway);
+    if(cmp > 0 || (cmp == 0 && sticky)) { return upper; }
+    if(cmp < 0) { return lower; }
+
+    /* Exactly halfway, round to even. */
+    return (m & 1) ? upper : lower;
+}
+
+static inline char const *
+elk_str_helper_parse_decimal_digits(char const *c, char const *end, u64 *mantissa, i32 *exponent, b32 *truncated)
+{
+    /* Parse digits with an optional decimal point. At most 19 significant digits are kept, which always fit in a u64, the
+     * rest only move the exponent. Returns a pointer to the first character that wasn't part of the number.
+     */
+    u64 w = 0;
+    i32 num_digits = 0;
+    i32 exp = 0;
+    b32 trunc = false;
+
+    while(c < end && (u8)(*c - '0') <= 9)
+    {
+        if(num_digits < 19) { w = w * 10 + (*c - '0'); num_digits += w > 0; }
+        else { exp += 1; trunc |= *c != '0'; }
+        ++c;
     }
-    else
+
+    if(c < end && *c == '.')
     {
-#ifdef _ELK_TRACK_MEM_USAGE
-        arena->metrics_ptr->over_allocation_attempted = true;
-#endif
-        return NULL;
+        ++c;
+        while(c < end && (u8)(*c - '0') <= 9)
+        {
+            if(num_digits < 19) { w = w * 10 + (*c - '0'); num_digits += w > 0; exp -= 1; }
+            else { trunc |= *c != '0'; }
+            ++c;
+        }
     }
+
+    *mantissa = w;
+    *exponent = exp;
+    *truncated = trunc;
+    return c;
 }
 
-static inline void * 
-elk_static_arena_realloc(ElkStaticArena *arena, void *ptr, size asize)
+static inline char const *
+elk_str_helper_parse_exponent(char const *c, char const *end, i32 *exponent)
 {
-    Assert(asize > 0);
+    /* Parse an optional exponent part, e.g. e-5. Huge exponents are clamped, they're out of range for a double anyway. */
+    if(c >= end || (*c != 'e' && *c != 'E')) { return c; }
+    ++c;
 
-    if(ptr == arena->prev_ptr)
+    b32 neg = false;
+    if(c < end && *c == '-') { neg = true; ++c; }
+    else if(c < end && *c == '+') { ++c; }
+
+    i32 exp = 0;
+    while(c < end && (u8)(*c - '0') <= 9)
     {
-        // Get previous extra offset due to alignment
-        uptr offset = (uptr)ptr - (uptr)arena->buffer; // relative offset accounting for alignment
+        if(exp < 100000) { exp = exp * 10 + (*c - '0'); }
+        ++c;
+    }
 
-        // Check to see if there is enough space left
-        if ((size)(offset + asize) <= arena->buf_size)
-        {
-            arena->buf_offset = offset + asize;
+    *exponent += neg ? -exp : exp;
+    return c;
+}
 
-#ifdef _ELK_TRACK_MEM_USAGE
-            arena->metrics_ptr->max_offset = arena->buf_offset > (arena->metrics_ptr->max_offset) ?
-                arena->buf_offset : (arena->metrics_ptr->max_offset);
-#endif
+#pragma warning(disable : 4723)
+static inline b32
+elk_str_robust_parse_f64(ElkStr str, f64 *out)
+{
+    // The following block is required to create NAN/INF witnout using math.h on MSVC Using
+    // #define NAN (0.0/0.0) doesn't work either on MSVC, which gives C2124 divide by zero error.
+    static f64 const ELK_ZERO = 0.0;
+    f64 const ELK_INF = 1.0 / ELK_ZERO;
+    f64 const ELK_NEG_INF = -1.0 / ELK_ZERO;
+    f64 const ELK_NAN = 0.0 / ELK_ZERO;
 
-            return ptr;
+    StopIf(str.len == 0, goto ERR_RETURN);
+
+    char const *c = str.start;
+    char const *end = str.start + str.len;
+    size len_remaining = str.len;
+
+    i8 sign = 0;        // 0 is positive, 1 is negative
+
+    // Check & parse a sign
+    if (*c == '-')      { sign =  1; --len_remaining; ++c; }
+    else if (*c == '+') { sign =  0; --len_remaining; ++c; }
+
+    // check for nan/NAN/NaN/Nan inf/INF/Inf
+    if (len_remaining == 3) 
+    {
+        if(memcmp(c, "nan", 3) == 0 || memcmp(c, "NAN", 3) == 0 || memcmp(c, "NaN", 3) == 0 || memcmp(c, "Nan", 3) == 0) 
+        { 
+            *out = ELK_NAN; return true;
         }
-        else
+
+        if(memcmp(c, "inf", 3) == 0 || memcmp(c, "Inf", 3) == 0 || memcmp(c, "INF", 3) == 0)
         {
-#ifdef _ELK_TRACK_MEM_USAGE
-            arena->metrics_ptr->over_allocation_attempted = true;
-#endif
+            if(sign == 0) *out = ELK_INF;
+            else if(sign == 1) *out = ELK_NEG_INF;
+            return true; 
         }
     }
 
-    return NULL;
-}
+    // check for infinity/INFINITY/Infinity
+    if (len_remaining == 8) 
+    {
+        if(memcmp(c, "infinity", 8) == 0 || memcmp(c, "Infinity", 8) == 0 || memcmp(c, "INFINITY", 8) == 0)
+        {
+            if(sign == 0) *out = ELK_INF;
+            else if(sign == 1) *out = ELK_NEG_INF;
+            return true; 
+        }
+    }
 
-static inline void
-elk_static_arena_free(ElkStaticArena *arena, void *ptr)
-{
-    if(ptr == arena->prev_ptr)
+    // Parse the mantissa and exponent
+    u64 mantissa = 0;
+    i32 exponent = 0;
+    b32 truncated = false;
+    char const *digits = c;
+    c = elk_str_helper_parse_decimal_digits(c, end, &mantissa, &exponent, &truncated);
+    char const *digits_end = c;
+    c = elk_str_helper_parse_exponent(c, end, &exponent);
+
+    // Once we get here we're done. Should be end of string.
+    StopIf( c!= end, goto ERR_RETURN);
+
+    f64 value = elk_str_helper_f64_from_decimal(mantissa, exponent);
+
+    // Too many digits to keep, round with all of them the same way the fast parser does.
+    if(truncated)
     {
-        arena->buf_offset = arena->prev_offset;
+        f64 const upper = elk_str_helper_f64_from_decimal(mantissa + 1, exponent);
+        if(upper != value) { value = elk_str_helper_f64_round_digits(digits, digits_end, exponent, value, upper); }
     }
 
-    return;
-}
+    value = sign == 1 ? -value : value;
 
-#ifdef _ELK_TRACK_MEM_USAGE
+    // Check for overflow and underflow
+    StopIf(value == ELK_INF || value == ELK_NEG_INF, goto ERR_RETURN);
+    StopIf(value == 0.0 && mantissa != 0, goto ERR_RETURN);
 
-static inline f64 
-elk_static_arena_max_ratio(ElkStaticArena *arena)
-{
-    return (f64)arena->metrics_ptr->max_offset / (f64)arena->buf_size;
+    *out = value;
+    return true;
+
+ERR_RETURN:
+    *out = ELK_NAN;
+    return false;
 }
+#pragma warning(default : 4723)
 
+#pragma warning(disable : 4723)
 static inline b32 
-elk_static_arena_over_allocated(ElkStaticArena *arena)
+elk_str_fast_parse_f64(ElkStr str, f64 *out)
 {
-    return arena->metrics_ptr->over_allocation_attempted;
-}
+    // The following block is required to create NAN/INF witnout using math.h on MSVC Using
+    // #define NAN (0.0/0.0) doesn't work either on MSVC, which gives C2124 divide by zero error.
+    static f64 const ELK_ZERO = 0.0;
+    f64 const ELK_INF = 1.0 / ELK_ZERO;
+    f64 const ELK_NEG_INF = -1.0 / ELK_ZERO;
+    f64 const ELK_NAN = 0.0 / ELK_ZERO;
 
-#endif
+    StopIf(str.len == 0, goto ERR_RETURN);
 
-static inline void
-elk_static_pool_initialize_linked_list(byte *buffer, size object_size, size num_objects)
-{
+    char const *c = str.start;
+    char const *end = str.start + str.len;
 
-    // Initialize the free list to a linked list.
+    i8 sign = 0;        // 0 is positive, 1 is negative
 
-    // start by pointing to last element and assigning it NULL
-    size offset = object_size * (num_objects - 1);
-    uptr *ptr = (uptr *)&buffer[offset];
-    *ptr = (uptr)NULL;
+    // Check & parse a sign
+    if (*c == '-')      { sign =  1; ++c; }
+    else if (*c == '+') { sign =  0; ++c; }
 
-    // Then work backwards to the front of the list.
-    while (offset) 
+    // Parse the mantissa and exponent
+    u64 mantissa = 0;
+    i32 exponent = 0;
+    b32 truncated = false;
+    char const *digits = c;
+    c = elk_str_helper_parse_decimal_digits(c, end, &mantissa, &exponent, &truncated);
+    char const *digits_end = c;
+    c = elk_str_helper_parse_exponent(c, end, &exponent);
+
+    f64 value = elk_str_helper_f64_from_decimal(mantissa, exponent);
+
+    /* With more than 19 significant digits the value is somewhere between mantissa and mantissa + 1 (scaled). If both
+     * round to the same double, that's the answer. Otherwise it's really close to halfway between two doubles, and we need
+     * all the digits to decide.
+     */
+    if(truncated)
     {
-        size next_offset = offset;
-        offset -= object_size;
-        ptr = (uptr *)&buffer[offset];
-        uptr next = (uptr)&buffer[next_offset];
-        *ptr = next;
+        f64 const upper = elk_str_helper_f64_from_decimal(mantissa + 1, exponent);
+        if(upper != value) { value = elk_str_helper_f64_round_digits(digits, digits_end, exponent, value, upper); }
     }
 
-    return;
-}
+    value = sign == 1 ? -value : value;
 
-static inline void
-elk_static_pool_reset(ElkStaticPool *pool)
-{
-    Assert(pool && pool->buffer && pool->num_objects && pool->object_size);
+    StopIf(value == ELK_INF || value == ELK_NEG_INF, goto ERR_RETURN);
 
-    // Initialize the free list to a linked list.
-    elk_static_pool_initialize_linked_list(pool->buffer, pool->object_size, pool->num_objects);
-    pool->free = &pool->buffer[0];
+    *out = value;
+    return true;
+
+ERR_RETURN:
+    *out = ELK_NAN;
+    return false;
 }
+#pragma warning(default : 4723)
 
-static inline void
-elk_static_pool_create(ElkStaticPool *pool, size object_size, size num_objects, byte buffer[])
+/* The datetime parsers decode every format into the same fields, with the day of the year in place of the day and a month
+ * of 0 for the YYYYDDDHHMMSS format. Missing minutes and seconds are 0.
+ */
+typedef enum
 {
-    Assert(object_size >= sizeof(void *));       // Need to be able to fit at least a pointer!
-    Assert(object_size % _Alignof(void *) == 0); // Need for alignment of pointers.
-    Assert(num_objects > 0);
+    ELK_DT_YEAR, ELK_DT_MONTH, ELK_DT_DAY, ELK_DT_HOUR, ELK_DT_MINUTE, ELK_DT_SECOND, ELK_DT_NUM_FIELDS
+} ElkDatetimeField;
 
-    pool->buffer = buffer;
-    pool->object_size = object_size;
-    pool->num_objects = num_objects;
+static inline b32
+elk_str_helper_datetime_from_fields(i32 const fields[ELK_DT_NUM_FIELDS], ElkTime *out)
+{
+    /* The fields are already in range, but the day might be past the end of a short month or a non-leap year. */
+    static i8 const days_in_month[2][13] =
+    {
+        { 0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 },
+        { 0, 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 },
+    };
 
-    elk_static_pool_reset(pool);
-}
+    i32 const leap = elk_is_leap_year(fields[ELK_DT_YEAR]);
+    if(fields[ELK_DT_MONTH] == 0)
+    {
+        StopIf(fields[ELK_DT_DAY] > 365 + leap, return false);
+        *out = elk_time_from_yd_and_hms(fields[ELK_DT_YEAR], fields[ELK_DT_DAY], fields[ELK_DT_HOUR],
+                fields[ELK_DT_MINUTE], fields[ELK_DT_SECOND]);
+        return true;
+    }
 
-static inline void
-elk_static_pool_destroy(ElkStaticPool *pool)
-{
-    memset(pool, 0, sizeof(*pool));
+    StopIf(fields[ELK_DT_DAY] > days_in_month[leap][fields[ELK_DT_MONTH]], return false);
+    *out = elk_time_from_ymd_and_hms(fields[ELK_DT_YEAR], fields[ELK_DT_MONTH], fields[ELK_DT_DAY], fields[ELK_DT_HOUR],
+            fields[ELK_DT_MINUTE], fields[ELK_DT_SECOND]);
+    return true;
 }
 
-static inline void
-elk_static_pool_free(ElkStaticPool *pool, void *ptr)
+static inline b32
+elk_str_helper_datetime_separators_ok(char const *c)
 {
-    uptr *next = ptr;
-    *next = (uptr)pool->free;
-    pool->free = ptr;
+    /* YYYY-MM-DD HH:MM:SS or YYYY-MM-DDTHH:MM:SS */
+    return c[4] == '-' && c[7] == '-' && (c[10] == ' ' || c[10] == 'T') && c[13] == ':' && c[16] == ':';
 }
 
-static inline void *
-elk_static_pool_alloc(ElkStaticPool *pool)
+static inline char const *
+elk_str_helper_datetime_src(ElkStr str, char copy[16])
 {
-    void *ptr = pool->free;
-    uptr *next = pool->free;
-
-    if (ptr) 
+    /* The short formats are read 16 bytes at a time, so copy them if that would cross into the next page. */
+    if(str.len < 16 && (((uptr)str.start & 0xFFF) > ELK_KiB(4) - 16))
     {
-        pool->free = (void *)*next;
-        memset(ptr, 0, pool->object_size);
+        memset(copy, 0, 16);
+        memcpy(copy, str.start, str.len);
+        return copy;
     }
 
-    return ptr;
+    return str.start;
 }
 
-static inline ElkQueueLedger
-elk_queue_ledger_create(size capacity)
+static inline b32
+elk_str_helper_parse_datetime_digits(char const *c, i32 num_digits, i32 *out)
 {
-    return (ElkQueueLedger)
+    i32 value = 0;
+    for(i32 i = 0; i < num_digits; ++i)
     {
-        .capacity = capacity, 
-        .length = 0,
-        .front = 0, 
-        .back = 0
-    };
+        u32 const digit = (u32)(c[i] - '0');
+        StopIf(digit > 9, return false);
+        value = value * 10 + digit;
+    }
+
+    *out = value;
+    return true;
 }
 
-static inline b32 
-elk_queue_ledger_full(ElkQueueLedger *queue)
-{ 
-    return queue->length == queue->capacity;
+static inline b32
+elk_str_helper_datetime_finish(ElkTime local, i32 nanos, ElkStr zone, ElkTime *out, i32 *nanoseconds)
+{
+    /* After any fractional seconds there's no time zone, Z for UTC, or an offset from UTC like +HH:MM, +HHMM, or +HH. */
+    i64 offset = 0;
+    if(zone.len == 1) { StopIf(zone.start[0] != 'Z', return false); }
+    else if(zone.len > 0)
+    {
+        char const *c = zone.start;
+        StopIf(c[0] != '+' && c[0] != '-', return false);
+
+        i32 hours = 0;
+        i32 minutes = 0;
+        switch(zone.len)
+        {
+            case 6: StopIf(c[3] != ':' || !elk_str_helper_parse_datetime_digits(c + 4, 2, &minutes), return false); break;
+            case 5: StopIf(!elk_str_helper_parse_datetime_digits(c + 3, 2, &minutes), return false); break;
+            case 3: break;
+            default: return false;
+        }
+        StopIf(!elk_str_helper_parse_datetime_digits(c + 1, 2, &hours) || hours > 23 || minutes > 59, return false);
+
+        offset = (hours * MINUTES_PER_HOUR + minutes) * SECONDS_PER_MINUTE;
+        if(c[0] == '-') { offset = -offset; }
+    }
+
+    ElkTime const utc = local - offset;
+    StopIf(utc < 0, return false);
+
+    *out = utc;
+    if(nanoseconds) { *nanoseconds = nanos; }
+    return true;
 }
 
 static inline b32
-elk_queue_ledger_empty(ElkQueueLedger *queue)
-{ 
-    return queue->length == 0;
+elk_str_helper_parse_datetime_ns_scalar(ElkStr str, ElkTime *out, i32 *nanoseconds)
+{
+    /* Where each field starts and how many digits it has, for each format. A width of 0 means the field is 0. */
+    static i8 const long_format[ELK_DT_NUM_FIELDS][2] =   { {0, 4}, {5, 2}, {8, 2}, {11, 2}, {14, 2}, {17, 2} };
+    static i8 const doy_format[ELK_DT_NUM_FIELDS][2] =    { {0, 4}, {0, 0}, {4, 3}, { 7, 2}, { 9, 2}, {11, 2} };
+    static i8 const ymdhm_format[ELK_DT_NUM_FIELDS][2] =  { {0, 4}, {4, 2}, {6, 2}, { 8, 2}, {10, 2}, { 0, 0} };
+    static i8 const ymdh_format[ELK_DT_NUM_FIELDS][2] =   { {0, 4}, {4, 2}, {6, 2}, { 8, 2}, { 0, 0}, { 0, 0} };
+    static i32 const min_values[ELK_DT_NUM_FIELDS] = { 1, 1, 1, 0, 0, 0 };
+    static i32 const max_values[ELK_DT_NUM_FIELDS] = { 9999, 12, 31, 23, 59, 59 };
+
+    /* Only the long format can have fractional seconds and a time zone after it, at most .123456789+HH:MM. */
+    StopIf(str.len > 35, return false);
+    size const base_len = str.len > 19 ? 19 : str.len;
+
+    i8 const (*format)[2] = NULL;
+    switch(base_len)
+    {
+        case 19:
+        {
+            StopIf(!elk_str_helper_datetime_separators_ok(str.start), return false);
+            format = long_format;
+        } break;
+
+        case 13: format = doy_format; break;
+        case 12: format = ymdhm_format; break;
+        case 10: format = ymdh_format; break;
+        default: return false;
+    }
+
+    i32 fields[ELK_DT_NUM_FIELDS] = {0};
+    for(i32 f = 0; f < ELK_DT_NUM_FIELDS; ++f)
+    {
+        StopIf(!elk_str_helper_parse_datetime_digits(str.start + format[f][0], format[f][1], &fields[f]), return false);
+        if(format[f][1] == 0) { continue; }
+
+        i32 const min_value = f == ELK_DT_DAY && format == doy_format ? 1 : min_values[f];
+        i32 const max_value = f == ELK_DT_DAY && format == doy_format ? 366 : max_values[f];
+        StopIf(fields[f] < min_value || fields[f] > max_value, return false);
+    }
+
+    ElkTime local = 0;
+    StopIf(!elk_str_helper_datetime_from_fields(fields, &local), return false);
+
+    ElkStr suffix = { .start = str.start + base_len, .len = str.len - base_len };
+    i32 nanos = 0;
+    if(suffix.len > 0 && suffix.start[0] == '.')
+    {
+        i32 num_digits = 0;
+        while(num_digits + 1 < suffix.len && (u32)(suffix.start[num_digits + 1] - '0') <= 9) { ++num_digits; }
+        StopIf(num_digits < 1 || num_digits > 9, return false);
+
+        elk_str_helper_parse_datetime_digits(suffix.start + 1, num_digits, &nanos);
+        for(i32 d = num_digits; d < 9; ++d) { nanos *= 10; }
+
+        suffix.start += num_digits + 1;
+        suffix.len -= num_digits + 1;
+    }
+
+    return elk_str_helper_datetime_finish(local, nanos, suffix, out, nanoseconds);
 }
 
-static inline size
-elk_queue_ledger_push_back_index(ElkQueueLedger *queue)
+static inline b32
+elk_str_helper_parse_datetime_scalar(ElkStr str, ElkTime *out)
 {
-    if(elk_queue_ledger_full(queue)) { return ELK_COLLECTION_FULL; }
+    return elk_str_helper_parse_datetime_ns_scalar(str, out, NULL);
+}
 
-    size idx = queue->back % queue->capacity;
-    queue->back += 1;
-    queue->length += 1;
-    return idx;
+ELK_TARGET("avx2")
+static inline b32
+elk_str_helper_datetime_format_avx2(size len, __m256i *shuffle, __m256i *min_values, __m256i *max_values, i32 *time_offset)
+{
+    /* Each field gets its own 32 bit lane, 4 digits wide with leading zeros shuffled in. The year, month, day, and hour
+     * come from the 128 bit lane with the start of the string, and the minutes and seconds from the other. For the long
+     * format that one starts 3 bytes later so everything fits in 16 bytes, otherwise it's the same bytes.
+     */
+    char const Z = (char)0x80; /* Shuffles in a zero. */
+    *time_offset = 0;
+    switch(len)
+    {
+        case 19:
+        {
+            /* YYYY-MM-DD HH:MM:SS */
+            *shuffle = _mm256_setr_epi8(
+                    0,  1,  2,  3,  Z,  Z,  5,  6,  Z,  Z,  8,  9,  Z,  Z, 11, 12,
+                    Z,  Z, 11, 12,  Z,  Z, 14, 15,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z);
+            *min_values = _mm256_setr_epi32(1, 1, 1, 0, 0, 0, 0, 0);
+            *max_values = _mm256_setr_epi32(9999, 12, 31, 23, 59, 59, 0, 0);
+            *time_offset = 3;
+        } return true;
+
+        case 13:
+        {
+            /* YYYYDDDHHMMSS */
+            *shuffle = _mm256_setr_epi8(
+                    0,  1,  2,  3,  Z,  Z,  Z,  Z,  Z,  4,  5,  6,  Z,  Z,  7,  8,
+                    Z,  Z,  9, 10,  Z,  Z, 11, 12,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z);
+            *min_values = _mm256_setr_epi32(1, 0, 1, 0, 0, 0, 0, 0);
+            *max_values = _mm256_setr_epi32(9999, 0, 366, 23, 59, 59, 0, 0);
+        } return true;
+
+        case 12:
+        {
+            /* YYYYMMDDHHMM */
+            *shuffle = _mm256_setr_epi8(
+                    0,  1,  2,  3,  Z,  Z,  4,  5,  Z,  Z,  6,  7,  Z,  Z,  8,  9,
+                    Z,  Z, 10, 11,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z);
+            *min_values = _mm256_setr_epi32(1, 1, 1, 0, 0, 0, 0, 0);
+            *max_values = _mm256_setr_epi32(9999, 12, 31, 23, 59, 0, 0, 0);
+        } return true;
+
+        case 10:
+        {
+            /* YYYYMMDDHH */
+            *shuffle = _mm256_setr_epi8(
+                    0,  1,  2,  3,  Z,  Z,  4,  5,  Z,  Z,  6,  7,  Z,  Z,  8,  9,
+                    Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z,  Z);
+            *min_values = _mm256_setr_epi32(1, 1, 1, 0, 0, 0, 0, 0);
+            *max_values = _mm256_setr_epi32(9999, 12, 31, 23, 0, 0, 0, 0);
+        } return true;
+
+        default: return false;
+    }
 }
 
-static inline size
-elk_queue_ledger_pop_front_index(ElkQueueLedger *queue)
+ELK_TARGET("avx2")
+static inline __m256i
+elk_str_helper_datetime_decode_avx2(__m256i chars, __m256i shuffle, __m256i min_values, __m256i max_values, __m256i *bad)
 {
-    if(elk_queue_ledger_empty(queue)) { return ELK_COLLECTION_EMPTY; }
+    /* Convert the shuffled fields all at once, any byte of bad is set if a lane had a non-digit or was out of range.
+     * Unused lanes shuffle in zeros, and any character that isn't a digit ends up bigger than 9.
+     */
+    __m256i const digits = _mm256_shuffle_epi8(_mm256_sub_epi8(chars, _mm256_set1_epi8('0')), shuffle);
+    __m256i const nines = _mm256_set1_epi8(9);
+    __m256i const bad_digits = _mm256_xor_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(digits, nines), nines),
+            _mm256_set1_epi8(-1));
 
-    size idx = queue->front % queue->capacity;
-    queue->front += 1;
-    queue->length -= 1;
-    return idx;
+    __m256i values = _mm256_maddubs_epi16(digits, _mm256_set1_epi16(0x010A));
+    values = _mm256_madd_epi16(values, _mm256_set1_epi32(0x00010064));
+
+    __m256i const out_of_range = _mm256_or_si256(
+            _mm256_cmpgt_epi32(min_values, values), _mm256_cmpgt_epi32(values, max_values));
+    *bad = _mm256_or_si256(*bad, _mm256_or_si256(bad_digits, out_of_range));
+
+    return values;
 }
 
-static inline size
-elk_queue_ledger_peek_front_index(ElkQueueLedger *queue)
+ELK_TARGET("avx2")
+static inline b32
+elk_str_helper_datetime_suffix_avx2(ElkStr suffix, i32 *nanos, i64 *offset)
 {
-    if(queue->length == 0) { return ELK_COLLECTION_EMPTY; }
-    return queue->front % queue->capacity;
+    /* Fractional seconds and a time zone after the long format, see elk_str_helper_datetime_finish(). It's at most 16
+     * characters, so one load finds all the digits. The fraction is converted all at once, padded with zeros so it's in
+     * nanoseconds, and the time zone digits just have to be where they belong.
+     */
+    char copy[16];
+    __m128i const digits = _mm_sub_epi8(
+            _mm_loadu_si128((__m128i const *)elk_str_helper_datetime_src(suffix, copy)), _mm_set1_epi8('0'));
+    __m128i const nines = _mm_set1_epi8(9);
+    u32 const digit_bits = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nines), nines))
+        & ((UINT32_C(1) << suffix.len) - 1);
+
+    i32 zone_start = 0;
+    if(suffix.start[0] == '.')
+    {
+        i32 const num_digits = elk_bit_count_trailing_zeros32(~(digit_bits >> 1));
+        StopIf(num_digits < 1 || num_digits > 9, return false);
+
+        __m128i const lanes = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        __m128i const keep = _mm_cmpgt_epi8(_mm_set1_epi8((char)num_digits), lanes);
+        __m128i values = _mm_and_si128(_mm_srli_si128(digits, 1), keep);
+        values = _mm_maddubs_epi16(values, _mm_set1_epi16(0x010A));
+        values = _mm_madd_epi16(values, _mm_set1_epi32(0x00010064));
+        *nanos = _mm_extract_epi32(values, 0) * 100000 + _mm_extract_epi32(values, 1) * 10;
+        *nanos += _mm_extract_epi32(values, 2) / 1000;
+
+        zone_start = num_digits + 1;
+    }
+
+    char const *c = suffix.start + zone_start;
+    u32 const zone_digits = digit_bits >> zone_start;
+    switch(suffix.len - zone_start)
+    {
+        case 0: return true;
+        case 1: return c[0] == 'Z';
+        case 3: StopIf((zone_digits & 0x06) != 0x06, return false); break;
+        case 5: StopIf((zone_digits & 0x1E) != 0x1E, return false); break;
+        case 6: StopIf((zone_digits & 0x36) != 0x36 || c[3] != ':', return false); break;
+        default: return false;
+    }
+    StopIf(c[0] != '+' && c[0] != '-', return false);
+
+    i32 const hours = (c[1] - '0') * 10 + (c[2] - '0');
+    char const *m = suffix.len - zone_start == 6 ? c + 4 : c + 3;
+    i32 const minutes = suffix.len - zone_start == 3 ? 0 : (m[0] - '0') * 10 + (m[1] - '0');
+    StopIf(hours > 23 || minutes > 59, return false);
+
+    *offset = (hours * MINUTES_PER_HOUR + minutes) * SECONDS_PER_MINUTE;
+    if(c[0] == '-') { *offset = -*offset; }
+    return true;
 }
 
-static inline size
-elk_queue_ledger_len(ElkQueueLedger const *queue)
+ELK_TARGET("avx2")
+static inline b32
+elk_str_helper_parse_datetime_ns_avx2(ElkStr str, ElkTime *out, i32 *nanoseconds)
 {
-    return queue->length;
+    /* Only the long format can have fractional seconds and a time zone after it, at most .123456789+HH:MM. */
+    StopIf(str.len > 35, return false);
+    ElkStr const base = { .start = str.start, .len = str.len > 19 ? 19 : str.len };
+
+    __m256i shuffle;
+    __m256i min_values;
+    __m256i max_values;
+    i32 time_offset = 0;
+    StopIf(!elk_str_helper_datetime_format_avx2(base.len, &shuffle, &min_values, &max_values, &time_offset), return false);
+    StopIf(base.len == 19 && !elk_str_helper_datetime_separators_ok(str.start), return false);
+
+    char copy[16];
+    char const *src = elk_str_helper_datetime_src(base, copy);
+    __m128i const date_chars = _mm_loadu_si128((__m128i const *)src);
+    __m128i const time_chars = _mm_loadu_si128((__m128i const *)(src + time_offset));
+    __m256i const chars = _mm256_inserti128_si256(_mm256_castsi128_si256(date_chars), time_chars, 1);
+
+    __m256i bad = _mm256_setzero_si256();
+    __m256i const values = elk_str_helper_datetime_decode_avx2(chars, shuffle, min_values, max_values, &bad);
+    StopIf(!_mm256_testz_si256(bad, bad), return false);
+
+    _Alignas(32) i32 fields[8];
+    _mm256_store_si256((__m256i *)fields, values);
+
+    ElkTime local = 0;
+    StopIf(!elk_str_helper_datetime_from_fields(fields, &local), return false);
+
+    i32 nanos = 0;
+    i64 offset = 0;
+    ElkStr const suffix = { .start = str.start + base.len, .len = str.len - base.len };
+    if(suffix.len > 0) { StopIf(!elk_str_helper_datetime_suffix_avx2(suffix, &nanos, &offset), return false); }
+
+    ElkTime const utc = local - offset;
+    StopIf(utc < 0, return false);
+
+    *out = utc;
+    if(nanoseconds) { *nanoseconds = nanos; }
+    return true;
 }
 
-static inline ElkArrayLedger
-elk_array_ledger_create(size capacity)
+ELK_TARGET("avx2")
+static inline b32
+elk_str_helper_parse_datetime_avx2(ElkStr str, ElkTime *out)
 {
-    Assert(capacity > 0);
-    return (ElkArrayLedger)
-    {
-        .capacity = capacity,
-        .length = 0
-    };
+    return elk_str_helper_parse_datetime_ns_avx2(str, out, NULL);
 }
 
-static inline b32 
-elk_array_ledger_full(ElkArrayLedger *array)
-{ 
-    return array->length == array->capacity;
+static inline b32
+elk_str_parse_datetime(ElkStr str, ElkTime *out)
+{
+#if __AVX2__
+    return elk_str_helper_parse_datetime_avx2(str, out);
+#else
+    return elk_str_helper_parse_datetime_scalar(str, out);
+#endif
 }
 
 static inline b32
-elk_array_ledger_empty(ElkArrayLedger *array)
-{ 
-    return array->length == 0;
+elk_str_parse_datetime_ns(ElkStr str, ElkTime *out, i32 *nanoseconds)
+{
+#if __AVX2__
+    return elk_str_helper_parse_datetime_ns_avx2(str, out, nanoseconds);
+#else
+    return elk_str_helper_parse_datetime_ns_scalar(str, out, nanoseconds);
+#endif
 }
 
 static inline size
-elk_array_ledger_push_back_index(ElkArrayLedger *array)
+elk_str_helper_parse_datetime_batch_scalar(ElkStr const *tokens, size n, ElkTime *out, b32 *ok)
 {
-    if(elk_array_ledger_full(array)) { return ELK_COLLECTION_FULL; }
+    size num_ok = 0;
+    for(size i = 0; i < n; ++i)
+    {
+        b32 const success = elk_str_helper_parse_datetime_scalar(tokens[i], out + i);
+        if(!success) { out[i] = INT64_MIN; }
+        if(ok) { ok[i] = success; }
+        num_ok += success;
+    }
 
-    size idx = array->length;
-    array->length += 1;
-    return idx;
+    return num_ok;
 }
 
-static inline size
-elk_array_ledger_pop_back_index(ElkArrayLedger *array)
+ELK_TARGET("avx2")
+static inline __m256i
+elk_str_helper_days_before_year_avx2(__m256i years, __m256i *leap)
 {
-    if(elk_array_ledger_empty(array)) { return ELK_COLLECTION_EMPTY; }
-
-    return --array->length;
+    /* Days from 0001-01-01 to the start of the year after each of these, and whether that year is a leap year. Division
+     * by 100 is a multiply and shift, which is exact for years up to 9999.
+     */
+    __m256i const zero = _mm256_setzero_si256();
+    __m256i const centuries = _mm256_srli_epi32(_mm256_mullo_epi32(years, _mm256_set1_epi32(5243)), 19);
+    __m256i const quads = _mm256_srli_epi32(years, 2);
+    __m256i const quad_centuries = _mm256_srli_epi32(centuries, 2);
+
+    __m256i const div_by_4 = _mm256_cmpeq_epi32(_mm256_and_si256(years, _mm256_set1_epi32(3)), zero);
+    __m256i const div_by_100 = _mm256_cmpeq_epi32(_mm256_mullo_epi32(centuries, _mm256_set1_epi32(100)), years);
+    __m256i const div_by_400 = _mm256_and_si256(div_by_100, _mm256_cmpeq_epi32(_mm256_slli_epi32(quad_centuries, 2), centuries));
+    *leap = _mm256_or_si256(_mm256_andnot_si256(div_by_100, div_by_4), div_by_400);
+
+    __m256i days = _mm256_mullo_epi32(years, _mm256_set1_epi32(365));
+    days = _mm256_add_epi32(days, _mm256_sub_epi32(quads, centuries));
+    return _mm256_add_epi32(days, quad_centuries);
 }
 
+ELK_TARGET("avx2")
 static inline size
-elk_array_ledger_len(ElkArrayLedger const *array)
+elk_str_helper_parse_datetime_each_avx2(ElkStr const *tokens, size n, ElkTime *out, b32 *ok)
 {
-    return array->length;
+    /* Like elk_str_helper_parse_datetime_batch_scalar(), but one at a time with the AVX2 parser. */
+    size num_ok = 0;
+    for(size i = 0; i < n; ++i)
+    {
+        b32 const success = elk_str_helper_parse_datetime_avx2(tokens[i], out + i);
+        if(!success) { out[i] = INT64_MIN; }
+        if(ok) { ok[i] = success; }
+        num_ok += success;
+    }
+
+    return num_ok;
 }
 
-static inline void
-elk_array_ledger_reset(ElkArrayLedger *array)
+ELK_TARGET("avx2")
+static inline size
+elk_str_helper_parse_datetime_batch_avx2(ElkStr const *tokens, size n, ElkTime *out, b32 *ok)
 {
-    array->length = 0;
+    size num_ok = 0;
+    size i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        ElkStr const *group = tokens + i;
+        size const len = group[0].len;
+        b32 same_len = true;
+        for(i32 t = 1; t < 8; ++t) { same_len &= group[t].len == len; }
+
+        __m256i shuffle;
+        __m256i min_values;
+        __m256i max_values;
+        i32 time_offset = 0;
+        if(!same_len || !elk_str_helper_datetime_format_avx2(len, &shuffle, &min_values, &max_values, &time_offset))
+        {
+            num_ok += elk_str_helper_parse_datetime_each_avx2(group, 8, out + i, ok ? ok + i : NULL);
+            continue;
+        }
+
+        /* Two timestamps per register, token t in the low 128 bit lane and t + 4 in the high one, so each half of the
+         * format has to be in both lanes.
+         */
+        __m256i const date_shuffle = _mm256_permute2x128_si256(shuffle, shuffle, 0x00);
+        __m256i const time_shuffle = _mm256_permute2x128_si256(shuffle, shuffle, 0x11);
+        __m256i const date_min = _mm256_permute2x128_si256(min_values, min_values, 0x00);
+        __m256i const time_min = _mm256_permute2x128_si256(min_values, min_values, 0x11);
+        __m256i const date_max = _mm256_permute2x128_si256(max_values, max_values, 0x00);
+        __m256i const time_max = _mm256_permute2x128_si256(max_values, max_values, 0x11);
+
+        u32 bad_tokens = 0;
+        __m256i dates[4];
+        __m256i times[4];
+        char copies[8][16];
+        for(i32 t = 0; t < 4; ++t)
+        {
+            char const *lo = elk_str_helper_datetime_src(group[t], copies[t]);
+            char const *hi = elk_str_helper_datetime_src(group[t + 4], copies[t + 4]);
+
+            __m256i const date_chars = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128((__m128i const *)lo)), _mm_loadu_si128((__m128i const *)hi), 1);
+            __m256i const time_chars = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128((__m128i const *)(lo + time_offset))),
+                    _mm_loadu_si128((__m128i const *)(hi + time_offset)), 1);
+
+            __m256i bad = _mm256_setzero_si256();
+            dates[t] = elk_str_helper_datetime_decode_avx2(date_chars, date_shuffle, date_min, date_max, &bad);
+            times[t] = elk_str_helper_datetime_decode_avx2(time_chars, time_shuffle, time_min, time_max, &bad);
+
+            u32 const bad_bytes = (u32)_mm256_movemask_epi8(bad);
+            bad_tokens |= ((bad_bytes & 0xFFFF) != 0) << t;
+            bad_tokens |= ((bad_bytes >> 16) != 0) << (t + 4);
+
+            if(len == 19)
+            {
+                bad_tokens |= !elk_str_helper_datetime_separators_ok(group[t].start) << t;
+                bad_tokens |= !elk_str_helper_datetime_separators_ok(group[t + 4].start) << (t + 4);
+            }
+        }
+
+        /* Transpose so each register has one field for all 8 timestamps, in order. */
+        __m256i const year_month_01 = _mm256_unpacklo_epi32(dates[0], dates[1]);
+        __m256i const year_month_23 = _mm256_unpacklo_epi32(dates[2], dates[3]);
+        __m256i const day_hour_01 = _mm256_unpackhi_epi32(dates[0], dates[1]);
+        __m256i const day_hour_23 = _mm256_unpackhi_epi32(dates[2], dates[3]);
+        __m256i const minute_second_01 = _mm256_unpacklo_epi32(times[0], times[1]);
+        __m256i const minute_second_23 = _mm256_unpacklo_epi32(times[2], times[3]);
+
+        __m256i const years = _mm256_unpacklo_epi64(year_month_01, year_month_23);
+        __m256i const months = _mm256_unpackhi_epi64(year_month_01, year_month_23);
+        __m256i const days_of_month = _mm256_unpacklo_epi64(day_hour_01, day_hour_23);
+        __m256i const hours = _mm256_unpackhi_epi64(day_hour_01, day_hour_23);
+        __m256i const minutes = _mm256_unpacklo_epi64(minute_second_01, minute_second_23);
+        __m256i const seconds = _mm256_unpackhi_epi64(minute_second_01, minute_second_23);
+
+        /* Days since 0001-01-01, and check the day against the length of the month or year. */
+        __m256i const one = _mm256_set1_epi32(1);
+        __m256i leap;
+        __m256i days;
+        __m256i max_day;
+        if(len == 13)
+        {
+            /* The day of the year is in the day lane. */
+            days = elk_str_helper_days_before_year_avx2(_mm256_sub_epi32(years, one), &leap);
+            days = _mm256_add_epi32(days, _mm256_sub_epi32(days_of_month, one));
+
+            elk_str_helper_days_before_year_avx2(years, &leap);
+            max_day = _mm256_sub_epi32(_mm256_set1_epi32(365), leap);
+        }
+        else
+        {
+            /* Count years from March so the leap day is at the end, like H. Hinnant's days_from_civil(). The days before
+             * the month are then (153 * m + 2) / 5, and the division is a multiply and shift.
+             */
+            __m256i const jan_feb = _mm256_cmpgt_epi32(_mm256_set1_epi32(3), months);
+            __m256i const march_years = _mm256_add_epi32(years, jan_feb);
+            __m256i const march_months = _mm256_add_epi32(_mm256_sub_epi32(months, _mm256_set1_epi32(3)),
+                    _mm256_and_si256(jan_feb, _mm256_set1_epi32(12)));
+
+            __m256i days_before_month = _mm256_mullo_epi32(march_months, _mm256_set1_epi32(153));
+            days_before_month = _mm256_add_epi32(days_before_month, _mm256_set1_epi32(2));
+            days_before_month = _mm256_srli_epi32(_mm256_mullo_epi32(days_before_month, _mm256_set1_epi32(13108)), 16);
+
+            days = elk_str_helper_days_before_year_avx2(march_years, &leap);
+            days = _mm256_add_epi32(days, days_before_month);
+            days = _mm256_add_epi32(days, _mm256_sub_epi32(days_of_month, _mm256_set1_epi32(307)));
+
+            /* 31 days for odd months before August and even months after, February is 28 or 29. */
+            elk_str_helper_days_before_year_avx2(years, &leap);
+            __m256i const long_month = _mm256_and_si256(_mm256_xor_si256(months, _mm256_srli_epi32(months, 3)), one);
+            __m256i const february = _mm256_cmpeq_epi32(months, _mm256_set1_epi32(2));
+            max_day = _mm256_add_epi32(_mm256_set1_epi32(30), long_month);
+            max_day = _mm256_blendv_epi8(max_day, _mm256_sub_epi32(_mm256_set1_epi32(28), leap), february);
+        }
+        bad_tokens |= (u32)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(days_of_month, max_day)));
+
+        /* Convert to seconds in 64 bit lanes. */
+        __m256i seconds_of_day = _mm256_mullo_epi32(hours, _mm256_set1_epi32(3600));
+        seconds_of_day = _mm256_add_epi32(seconds_of_day, _mm256_mullo_epi32(minutes, _mm256_set1_epi32(60)));
+        seconds_of_day = _mm256_add_epi32(seconds_of_day, seconds);
+        elk_time_helper_store_times_avx2(out + i, days, seconds_of_day);
+
+        for(i32 t = 0; t < 8; ++t)
+        {
+            b32 const success = !(bad_tokens & (1u << t));
+            if(!success) { out[i + t] = INT64_MIN; }
+            if(ok) { ok[i + t] = success; }
+        }
+        num_ok += 8 - elk_bit_popcount32(bad_tokens);
+    }
+
+    num_ok += elk_str_helper_parse_datetime_each_avx2(tokens + i, n - i, out + i, ok ? ok + i : NULL);
+
+    return num_ok;
 }
 
-static inline void
-elk_array_ledger_set_capacity(ElkArrayLedger *array, size capacity)
+static inline size
+elk_str_parse_datetime_batch(ElkStr const *tokens, size n, ElkTime *out, b32 *ok)
 {
-    Assert(capacity > 0);
-    array->capacity = capacity;
+#if __AVX2__
+    return elk_str_helper_parse_datetime_batch_avx2(tokens, n, out, ok);
+#else
+    return elk_str_helper_parse_datetime_batch_scalar(tokens, n, out, ok);
+#endif
 }
 
-static ElkHashMap 
-elk_hash_map_create(i8 size_exp, ElkSimpleHash key_hash, ElkEqFunction key_eq, ElkStaticArena *arena)
+static inline size
+elk_str_helper_parse_f64_batch_scalar(ElkStr const *tokens, size n, f64 *out, b32 *ok)
 {
-    Assert(size_exp > 0 && size_exp <= 31); // Come on, 31 is HUGE
-
-    size const handles_len = (size)(1 << size_exp);
-    ElkHashMapHandle *handles = elk_static_arena_nmalloc(arena, handles_len, ElkHashMapHandle);
-    PanicIf(!handles);
-
-    return (ElkHashMap)
+    size num_ok = 0;
+    for(size i = 0; i < n; ++i)
     {
-        .arena = arena,
-        .handles = handles,
-        .num_handles = 0, 
-        .hasher = key_hash,
-        .eq = key_eq,
-        .size_exp = size_exp
-    };
+        b32 const success = elk_str_robust_parse_f64(tokens[i], out + i);
+        if(ok) { ok[i] = success; }
+        num_ok += success;
+    }
+
+    return num_ok;
 }
 
-static inline void 
-elk_hash_map_destroy(ElkHashMap *map)
+static inline b32
+elk_str_helper_decimal_fits(ElkStr str)
 {
-    return;
+    /* The string is loaded as the last bytes of a 16 byte load, so it has to be short and the load can't cross into the
+     * previous page.
+     */
+    return str.len > 0 && str.len <= 16 && (((uptr)str.start + str.len - 1) & 0xFFF) >= 15;
 }
 
-static inline void
-elk_hash_table_expand(ElkHashMap *map)
+ELK_TARGET("avx2")
+static inline u32
+elk_str_helper_parse_decimal_pair_avx2(ElkStr const pair[2], u64 mantissas[2], i32 frac_digits[2], b32 negative[2])
 {
-    i8 const size_exp = map->size_exp;
-    i8 const new_size_exp = size_exp + 1;
+    /* Parse two short decimals like -12.3 at once, both must pass elk_str_helper_decimal_fits(). Each one gets its digits
+     * as an integer, the number of digits after the decimal point, and its sign. Returns a mask with bit 0 set if the first
+     * one is valid and bit 1 set if the second one is.
+     */
 
-    size const handles_len = (size)(1 << size_exp);
-    size const new_handles_len = (size)(1 << new_size_exp);
+    /* Load each string into its own 128 bit lane so it ends on the last byte. */
+    __m128i const text0 = _mm_loadu_si128((__m128i const *)(pair[0].start + pair[0].len - 16));
+    __m128i const text1 = _mm_loadu_si128((__m128i const *)(pair[1].start + pair[1].len - 16));
+    __m256i const text = _mm256_inserti128_si256(_mm256_castsi128_si256(text0), text1, 1);
+
+    __m256i const positions = _mm256_setr_epi8(
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m256i const first_pos = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_set1_epi8((char)(16 - pair[0].len))), _mm_set1_epi8((char)(16 - pair[1].len)), 1);
+    __m256i const in_str = _mm256_cmpgt_epi8(positions, _mm256_sub_epi8(first_pos, _mm256_set1_epi8(1)));
+
+    /* Classify the characters. */
+    __m256i const digits = _mm256_sub_epi8(text, _mm256_set1_epi8('0'));
+    __m256i const is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+    __m256i const is_dot = _mm256_cmpeq_epi8(text, _mm256_set1_epi8('.'));
+    __m256i const is_minus = _mm256_cmpeq_epi8(text, _mm256_set1_epi8('-'));
+    __m256i const is_sign = _mm256_or_si256(is_minus, _mm256_cmpeq_epi8(text, _mm256_set1_epi8('+')));
+
+    u32 const in_bits = (u32)_mm256_movemask_epi8(in_str);
+    u32 const digit_bits = (u32)_mm256_movemask_epi8(is_digit) & in_bits;
+    u32 const dot_bits = (u32)_mm256_movemask_epi8(is_dot) & in_bits;
+    u32 const sign_bits = (u32)_mm256_movemask_epi8(is_sign) & in_bits;
+    u32 const minus_bits = (u32)_mm256_movemask_epi8(is_minus) & in_bits;
+
+    /* Valid strings have at least one digit, at most one decimal point, and only a sign at the start. */
+    u32 valid = 0;
+    i32 dot_pos[2] = {0};
+    for(i32 lane = 0; lane < 2; ++lane)
+    {
+        u32 const in = (in_bits >> (16 * lane)) & 0xFFFF;
+        u32 const dig = (digit_bits >> (16 * lane)) & 0xFFFF;
+        u32 const dot = (dot_bits >> (16 * lane)) & 0xFFFF;
+        u32 const sign = (sign_bits >> (16 * lane)) & 0xFFFF;
+        u32 const first = UINT32_C(1) << (16 - pair[lane].len);
+
+        b32 const lane_valid = dig && (dig | dot | sign) == in && (dot & (dot - 1)) == 0 && (sign & ~first) == 0;
+        valid |= (u32)lane_valid << lane;
+        dot_pos[lane] = dot ? elk_bit_count_trailing_zeros32(dot) : -1;
+        frac_digits[lane] = dot ? 15 - dot_pos[lane] : 0;
+        negative[lane] = ((minus_bits >> (16 * lane)) & 0xFFFF) != 0;
+    }
 
-    ElkHashMapHandle *new_handles = elk_static_arena_nmalloc(map->arena, new_handles_len, ElkHashMapHandle);
-    PanicIf(!new_handles);
+    /* Zero everything that isn't a digit, then shift the digits before the decimal point over to fill its spot. */
+    __m256i values = _mm256_and_si256(digits, _mm256_and_si256(is_digit, in_str));
+    __m256i const dot_end = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_set1_epi8((char)(dot_pos[0] + 1))), _mm_set1_epi8((char)(dot_pos[1] + 1)), 1);
+    __m256i const shuffle = _mm256_add_epi8(positions, _mm256_cmpgt_epi8(dot_end, positions));
+    values = _mm256_shuffle_epi8(values, shuffle);
 
-    for (u32 i = 0; i < handles_len; i++) 
+    /* Combine the digits in pairs, then groups of 4, then 8. */
+    values = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x010A));
+    values = _mm256_madd_epi16(values, _mm256_set1_epi32(0x00010064));
+    values = _mm256_packus_epi32(values, values);
+    values = _mm256_madd_epi16(values, _mm256_set1_epi32(0x00012710));
+
+    mantissas[0] = (u64)(u32)_mm256_extract_epi32(values, 0) * 100000000 + (u32)_mm256_extract_epi32(values, 1);
+    mantissas[1] = (u64)(u32)_mm256_extract_epi32(values, 4) * 100000000 + (u32)_mm256_extract_epi32(values, 5);
+
+    return valid;
+}
+
+ELK_TARGET("avx2")
+static inline size
+elk_str_helper_parse_f64_batch_avx2(ElkStr const *tokens, size n, f64 *out, b32 *ok)
+{
+    static f64 const exact_powers_of_10[] =
     {
-        ElkHashMapHandle *handle = &map->handles[i];
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
 
-        if (handle->key == NULL) { continue; } // Skip if it's empty
+    size num_ok = 0;
+    size i = 0;
+    for(; i + 2 <= n; i += 2)
+    {
+        ElkStr const *pair = tokens + i;
+        if(!elk_str_helper_decimal_fits(pair[0]) || !elk_str_helper_decimal_fits(pair[1]))
+        {
+            num_ok += elk_str_helper_parse_f64_batch_scalar(pair, 2, out + i, ok ? ok + i : NULL);
+            continue;
+        }
 
-        // Find the position in the new table and update it.
-        u64 const hash = handle->hash;
-        u32 j = hash & 0xffffffff; // truncate
-        while (true) 
+        u64 mantissas[2] = {0};
+        i32 frac_digits[2] = {0};
+        b32 negative[2] = {0};
+        u32 const valid = elk_str_helper_parse_decimal_pair_avx2(pair, mantissas, frac_digits, negative);
+
+        /* Both are exact doubles, so it's Clinger's fast path on both of them at once. */
+        u64 const two_52 = UINT64_C(1) << 52;
+        if(valid == 3 && mantissas[0] < two_52 && mantissas[1] < two_52)
         {
-            j = elk_hash_lookup(hash, new_size_exp, j);
-            ElkHashMapHandle *new_handle = &new_handles[j];
+            __m128d const magic = _mm_set1_pd(4503599627370496.0); /* 2^52, convert by putting w in the mantissa. */
+            __m128i const w = _mm_set_epi64x((i64)mantissas[1], (i64)mantissas[0]);
+            __m128d result = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(w, _mm_castpd_si128(magic))), magic);
+            result = _mm_div_pd(result, _mm_setr_pd(exact_powers_of_10[frac_digits[0]], exact_powers_of_10[frac_digits[1]]));
+
+            __m128i const signs = _mm_set_epi64x((i64)((u64)negative[1] << 63), (i64)((u64)negative[0] << 63));
+            result = _mm_or_pd(result, _mm_castsi128_pd(signs));
+            _mm_storeu_pd(out + i, result);
+
+            if(ok) { ok[i] = ok[i + 1] = true; }
+            num_ok += 2;
+            continue;
+        }
 
-            if (!new_handle->key)
+        for(i32 lane = 0; lane < 2; ++lane)
+        {
+            if(!(valid & (1u << lane)))
             {
-                // empty - put it here. Don't need to check for room because we just expanded
-                // the hash table of handles, and we're not copying anything new into storage,
-                // it's already there!
-                *new_handle = *handle;
-                break;
+                num_ok += elk_str_helper_parse_f64_batch_scalar(pair + lane, 1, out + i + lane, ok ? ok + i + lane : NULL);
+                continue;
             }
+
+            f64 const value = elk_str_helper_f64_from_decimal(mantissas[lane], -frac_digits[lane]);
+            out[i + lane] = negative[lane] ? -value : value;
+            if(ok) { ok[i + lane] = true; }
+            num_ok += 1;
         }
     }
 
-    map->handles = new_handles;
-    map->size_exp = new_size_exp;
+    num_ok += elk_str_helper_parse_f64_batch_scalar(tokens + i, n - i, out + i, ok ? ok + i : NULL);
 
-    return;
+    return num_ok;
 }
 
-static inline void *
-elk_hash_map_insert(ElkHashMap *map, void *key, void *value)
+static inline size
+elk_str_parse_f64_batch(ElkStr const *tokens, size n, f64 *out, b32 *ok)
 {
-    // Inspired by https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
+#if __AVX2__
+    return elk_str_helper_parse_f64_batch_avx2(tokens, n, out, ok);
+#else
+    return elk_str_helper_parse_f64_batch_scalar(tokens, n, out, ok);
+#endif
+}
 
-    u64 const hash = map->hasher(key);
-    u32 i = hash & 0xffffffff; // truncate
-    while (true)
+static inline b32
+elk_str_parse_fixed(ElkStr str, i32 decimals, i64 *out)
+{
+    Assert(decimals >= 0 && decimals <= 18);
+
+    char const *c = str.start;
+    char const *end = str.start + str.len;
+
+    b32 neg_flag = false;
+    if(c < end && (*c == '-' || *c == '+')) { neg_flag = *c == '-'; ++c; }
+
+    /* Keep the whole part and the first decimals digits after the point, overflow is checked as we go. */
+    u64 parsed = 0;
+    i32 num_digits = 0;
+    for(; c < end && (u32)(*c - '0') <= 9; ++c, ++num_digits)
     {
-        i = elk_hash_lookup(hash, map->size_exp, i);
-        ElkHashMapHandle *handle = &map->handles[i];
+        u32 const digit = (u32)(*c - '0');
+        StopIf(parsed > (UINT64_MAX - digit) / 10, return false);
+        parsed = parsed * 10 + digit;
+    }
 
-        if (!handle->key)
+    i32 kept_decimals = 0;
+    b32 round_up = false;
+    if(c < end && *c == '.')
+    {
+        for(++c; c < end && (u32)(*c - '0') <= 9; ++c, ++num_digits)
         {
-            // empty, insert here if room in the table of handles. Check for room first!
-            if (elk_hash_table_large_enough(map->num_handles, map->size_exp))
+            u32 const digit = (u32)(*c - '0');
+            if(kept_decimals < decimals)
             {
-
-                *handle = (ElkHashMapHandle){.hash = hash, .key=key, .value=value};
-                map->num_handles += 1;
-
-                return handle->value;
+                StopIf(parsed > (UINT64_MAX - digit) / 10, return false);
+                parsed = parsed * 10 + digit;
+                kept_decimals += 1;
             }
-            else 
+            else if(kept_decimals == decimals)
             {
-                // Grow the table so we have room
-                elk_hash_table_expand(map);
-
-                // Recurse because all the state needed by the *_lookup function was just crushed
-                // by the expansion of the table.
-                return elk_hash_map_insert(map, key, value);
+                /* The first digit that doesn't fit decides the rounding, the rest don't matter. */
+                round_up = digit >= 5;
+                kept_decimals += 1;
             }
         }
-        else if (handle->hash == hash && map->eq(handle->key, key)) 
-        {
-            // found it!
-            return handle->value;
-        }
     }
+    StopIf(c != end || num_digits == 0, return false);
 
-    return NULL;
+    for(; kept_decimals < decimals; ++kept_decimals)
+    {
+        StopIf(parsed > UINT64_MAX / 10, return false);
+        parsed *= 10;
+    }
+
+    StopIf(round_up && parsed == UINT64_MAX, return false);
+    parsed += round_up;
+
+    u64 const max_magnitude = neg_flag ? (u64)INT64_MAX + 1 : (u64)INT64_MAX;
+    StopIf(parsed > max_magnitude, return false);
+
+    *out = neg_flag ? (i64)(0 - parsed) : (i64)parsed;
+    return true;
 }
 
-static inline void *
-elk_hash_map_lookup(ElkHashMap *map, void *key)
+static inline size
+elk_str_helper_parse_fixed_batch_scalar(ElkStr const *tokens, size n, i32 decimals, i32 *out, b32 *ok)
 {
-    // Inspired by https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
+    size num_ok = 0;
+    for(size i = 0; i < n; ++i)
+    {
+        i64 value = 0;
+        b32 const success = elk_str_parse_fixed(tokens[i], decimals, &value) && value >= INT32_MIN && value <= INT32_MAX;
+        out[i] = success ? (i32)value : INT32_MIN;
+        if(ok) { ok[i] = success; }
+        num_ok += success;
+    }
 
-    u64 const hash = map->hasher(key);
-    u32 i = hash & 0xffffffff; // truncate
-    while (true)
+    return num_ok;
+}
+
+ELK_TARGET("avx2")
+static inline size
+elk_str_helper_parse_fixed_batch_avx2(ElkStr const *tokens, size n, i32 decimals, i32 *out, b32 *ok)
+{
+    static u64 const powers_of_10[] =
     {
-        i = elk_hash_lookup(hash, map->size_exp, i);
-        ElkHashMapHandle *handle = &map->handles[i];
+        UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000), UINT64_C(100000),
+        UINT64_C(1000000), UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000), UINT64_C(10000000000),
+        UINT64_C(100000000000), UINT64_C(1000000000000), UINT64_C(10000000000000), UINT64_C(100000000000000),
+        UINT64_C(1000000000000000), UINT64_C(10000000000000000), UINT64_C(100000000000000000),
+        UINT64_C(1000000000000000000)
+    };
 
-        if (!handle->key)
+    size num_ok = 0;
+    size i = 0;
+    for(; i + 2 <= n; i += 2)
+    {
+        ElkStr const *pair = tokens + i;
+        if(!elk_str_helper_decimal_fits(pair[0]) || !elk_str_helper_decimal_fits(pair[1]))
         {
-            return NULL;
-            
+            num_ok += elk_str_helper_parse_fixed_batch_scalar(pair, 2, decimals, out + i, ok ? ok + i : NULL);
+            continue;
         }
-        else if (handle->hash == hash && map->eq(handle->key, key)) 
+
+        u64 mantissas[2] = {0};
+        i32 frac_digits[2] = {0};
+        b32 negative[2] = {0};
+        u32 const valid = elk_str_helper_parse_decimal_pair_avx2(pair, mantissas, frac_digits, negative);
+
+        for(i32 lane = 0; lane < 2; ++lane)
         {
-            // found it!
-            return handle->value;
+            /* Scale to the right number of decimals, rounding half away from zero if there are too many. */
+            u64 magnitude = mantissas[lane];
+            i32 const extra = frac_digits[lane] - decimals;
+            if(extra > 0) { magnitude = (magnitude + powers_of_10[extra] / 2) / powers_of_10[extra]; }
+            else if(magnitude > UINT64_MAX / powers_of_10[-extra]) { magnitude = UINT64_MAX; }
+            else { magnitude *= powers_of_10[-extra]; }
+
+            u64 const max_magnitude = negative[lane] ? (u64)INT32_MAX + 1 : (u64)INT32_MAX;
+            b32 const success = (valid & (1u << lane)) && magnitude <= max_magnitude;
+
+            out[i + lane] = success ? (i32)(negative[lane] ? 0 - magnitude : magnitude) : INT32_MIN;
+            if(ok) { ok[i + lane] = success; }
+            num_ok += success;
         }
     }
 
-    return NULL;
-}
+    num_ok += elk_str_helper_parse_fixed_batch_scalar(tokens + i, n - i, decimals, out + i, ok ? ok + i : NULL);
 
-static inline size 
-elk_hash_map_len(ElkHashMap *map)
-{
-    return map->num_handles;
+    return num_ok;
 }
 
-static inline ElkHashMapKeyIter 
-elk_hash_map_key_iter(ElkHashMap *map)
+static inline size
+elk_str_parse_fixed_batch(ElkStr const *tokens, size n, i32 decimals, i32 *out, b32 *ok)
 {
-    return 0;
+    Assert(decimals >= 0 && decimals <= 18);
+#if __AVX2__
+    return elk_str_helper_parse_fixed_batch_avx2(tokens, n, decimals, out, ok);
+#else
+    return elk_str_helper_parse_fixed_batch_scalar(tokens, n, decimals, out, ok);
+#endif
 }
 
-static inline void *
-elk_hash_map_key_iter_next(ElkHashMap *map, ElkHashMapKeyIter *iter)
-{
-    size const max_iter = (size)(1 << map->size_exp);
-    void *next_key = NULL;
-    if(*iter >= max_iter) { return next_key; }
+static char const elk_digit_pairs[] =
+    "0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+    "5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
 
-    do
+static inline size
+elk_str_helper_format_u64(u64 value, char *dest)
+{
+    /* Write the digits two at a time from the back of a temporary, then copy them out. Returns the number of digits. */
+    char digits[20];
+    i32 pos = 20;
+    while(value >= 100)
     {
-        next_key = map->handles[*iter].key;
-        *iter += 1;
+        u64 const quotient = value / 100;
+        u32 const pair = (u32)(value - quotient * 100);
+        pos -= 2;
+        memcpy(digits + pos, elk_digit_pairs + 2 * pair, 2);
+        value = quotient;
+    }
 
-    } while(next_key == NULL && *iter < max_iter);
+    if(value >= 10) { pos -= 2; memcpy(digits + pos, elk_digit_pairs + 2 * value, 2); }
+    else { digits[--pos] = (char)('0' + value); }
 
-    return next_key;
+    memcpy(dest, digits + pos, 20 - pos);
+    return 20 - pos;
 }
 
+static inline size
+elk_str_helper_format_u64_padded(u64 value, i32 min_digits, char *dest)
+{
+    /* Like elk_str_helper_format_u64(), but pad with leading zeros. */
+    char digits[20];
+    size len = elk_str_helper_format_u64(value, digits);
+    size const pad = len < min_digits ? min_digits - len : 0;
+    memset(dest, '0', pad);
+    memcpy(dest + pad, digits, len);
+    return pad + len;
+}
 
-static inline ElkStrMap 
-elk_str_map_create(i8 size_exp, ElkStaticArena *arena)
+static inline u32
+elk_big_uint_div_small(ElkBigUInt *big, u32 divisor)
 {
-    Assert(size_exp > 0 && size_exp <= 31); // Come on, 31 is HUGE
-
-    size const handles_len = (size)(1 << size_exp);
-    ElkStrMapHandle *handles = elk_static_arena_nmalloc(arena, handles_len, ElkStrMapHandle);
-    PanicIf(!handles);
-
-    return (ElkStrMap)
+    /* Divide in place, returns the remainder. */
+    u64 remainder = 0;
+    for(i32 i = big->len - 1; i >= 0; --i)
     {
-        .arena = arena,
-        .handles = handles,
-        .num_handles = 0, 
-        .size_exp = size_exp,
-    };
+        u64 const current = (remainder << 32) | big->limbs[i];
+        big->limbs[i] = (u32)(current / divisor);
+        remainder = current % divisor;
+    }
+
+    while(big->len > 0 && big->limbs[big->len - 1] == 0) { --big->len; }
+    return (u32)remainder;
 }
 
-static inline void
-elk_str_map_destroy(ElkStrMap *map)
+static inline u64
+elk_f64_helper_round_to_odd(u64 g_hi, u64 g_lo, u64 cp)
 {
-    return;
+    /* The top 64 bits of g * cp, with the lowest bit set if any of the rest are (accounting for g being rounded up). */
+    u64 x_hi = 0;
+    elk_mul_u64_full(g_lo, cp, &x_hi);
+
+    u64 y_hi = 0;
+    u64 y_lo = elk_mul_u64_full(g_hi, cp, &y_hi);
+    y_lo += x_hi;
+    y_hi += y_lo < x_hi;
+
+    return y_hi | (y_lo > 1);
 }
 
-static inline void
-elk_str_table_expand(ElkStrMap *map)
+static inline u64
+elk_f64_helper_shortest_decimal(u64 bits, i32 *exponent)
 {
-    i8 const size_exp = map->size_exp;
-    i8 const new_size_exp = size_exp + 1;
+    /* The shortest decimal digits that round trip, using the Schubfach algorithm from R. Giulietti, "The Schubfach way to
+     * render doubles", 2020. The value must be finite and positive. Returns the digits, and the value is digits * 10^exponent.
+     *
+     * It needs 10^k rounded up to 128 bits for k from -292 to 324. The power of 5 table for parsing has the same
+     * normalized values, but it's rounded down outside of 10^-27 to 10^-1, so add one there.
+     */
+    u64 const ieee_mantissa = bits & ((UINT64_C(1) << 52) - 1);
+    i32 const ieee_exponent = (i32)(bits >> 52);
 
-    size const handles_len = (size)(1 << size_exp);
-    size const new_handles_len = (size)(1 << new_size_exp);
+    u64 c = ieee_mantissa;
+    i32 q = -1074;
+    if(ieee_exponent > 0)
+    {
+        c |= UINT64_C(1) << 52;
+        q = ieee_exponent - 1075;
+    }
 
-    ElkStrMapHandle *new_handles = elk_static_arena_nmalloc(map->arena, new_handles_len, ElkStrMapHandle);
-    PanicIf(!new_handles);
+    /* Small integers are exact. */
+    if(q <= 0 && q > -53 && (c & ((UINT64_C(1) << -q) - 1)) == 0)
+    {
+        *exponent = 0;
+        return c >> -q;
+    }
 
-    for (u32 i = 0; i < handles_len; i++) 
+    b32 const is_even = (c & 1) == 0;
+    b32 const lower_closer = ieee_mantissa == 0 && ieee_exponent > 1;
+
+    u64 const cbl = 4 * c - 2 + lower_closer;
+    u64 const cb = 4 * c;
+    u64 const cbr = 4 * c + 2;
+
+    /* k = floor(log10(2^q)), or floor(log10(3/4 2^q)) if the lower boundary is closer. */
+    i32 const k = (q * 1262611 - (lower_closer ? 524031 : 0)) >> 22;
+    i32 const h = q + ((-k * 1741647) >> 19) + 1;
+
+    size const index = 2 * (size)(-k - ELK_F64_SMALLEST_POWER_OF_10);
+    u64 g_hi = elk_power_of_five_128[index];
+    u64 g_lo = elk_power_of_five_128[index + 1];
+    if(-k < -27 || -k >= 0)
     {
-        ElkStrMapHandle *handle = &map->handles[i];
+        g_lo += 1;
+        g_hi += g_lo == 0;
+    }
 
-        if (handle->key.start == NULL) { continue; } // Skip if it's empty
+    u64 const vbl = elk_f64_helper_round_to_odd(g_hi, g_lo, cbl << h);
+    u64 const vb = elk_f64_helper_round_to_odd(g_hi, g_lo, cb << h);
+    u64 const vbr = elk_f64_helper_round_to_odd(g_hi, g_lo, cbr << h);
 
-        // Find the position in the new table and update it.
-        u64 const hash = handle->hash;
-        u32 j = hash & 0xffffffff; // truncate
-        while (true) 
-        {
-            j = elk_hash_lookup(hash, new_size_exp, j);
-            ElkStrMapHandle *new_handle = &new_handles[j];
+    u64 const lower = vbl + !is_even;
+    u64 const upper = vbr - !is_even;
 
-            if (!new_handle->key.start)
-            {
-                // empty - put it here. Don't need to check for room because we just expanded
-                // the hash table of handles, and we're not copying anything new into storage,
-                // it's already there!
-                *new_handle = *handle;
-                break;
-            }
+    /* Try one less digit first, then the two closest candidates with this many digits. */
+    u64 const s = vb / 4;
+    if(s >= 10)
+    {
+        u64 const sp = s / 10;
+        b32 const up_inside = lower <= 40 * sp;
+        b32 const wp_inside = 40 * sp + 40 <= upper;
+        if(up_inside != wp_inside)
+        {
+            *exponent = k + 1;
+            return sp + wp_inside;
         }
     }
 
-    map->handles = new_handles;
-    map->size_exp = new_size_exp;
+    b32 const u_inside = lower <= 4 * s;
+    b32 const w_inside = 4 * s + 4 <= upper;
+    *exponent = k;
+    if(u_inside != w_inside) { return s + w_inside; }
 
-    return;
+    /* Both are inside, pick the closest, ties go to even. */
+    u64 const mid = 4 * s + 2;
+    b32 const round_up = vb > mid || (vb == mid && (s & 1) != 0);
+    return s + round_up;
 }
 
-
-static inline void *
-elk_str_map_insert(ElkStrMap *map, ElkStr key, void *value)
+static inline size
+elk_str_helper_format_special_f64(f64 value, char *dest)
 {
-    // Inspired by https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
-
-    u64 const hash = elk_fnv1a_hash_str(key);
-    u32 i = hash & 0xffffffff; // truncate
-    while (true)
-    {
-        i = elk_hash_lookup(hash, map->size_exp, i);
-        ElkStrMapHandle *handle = &map->handles[i];
+    /* Write NaN or +/-Infinity and return the length, or return 0 if it's a regular number. */
+    if(value != value) { memcpy(dest, "NaN", 3); return 3; }
+    if(value > 1.7976931348623157e308) { memcpy(dest, "Infinity", 8); return 8; }
+    if(value < -1.7976931348623157e308) { memcpy(dest, "-Infinity", 9); return 9; }
+    return 0;
+}
 
-        if (!handle->key.start)
-        {
-            // empty, insert here if room in the table of handles. Check for room first!
-            if (elk_hash_table_large_enough(map->num_handles, map->size_exp))
-            {
+static inline ElkStr
+elk_str_format_i64(i64 value, size dst_len, char *dest)
+{
+    char buf[ELK_I64_FORMAT_MAX_LEN];
+    size len = 0;
+    if(value < 0) { buf[len++] = '-'; }
+    len += elk_str_helper_format_u64(value < 0 ? 0 - (u64)value : (u64)value, buf + len);
 
-                *handle = (ElkStrMapHandle){.hash = hash, .key=key, .value=value};
-                map->num_handles += 1;
+    StopIf(len > dst_len, return (ElkStr){0});
+    memcpy(dest, buf, len);
+    return (ElkStr){ .start = dest, .len = len };
+}
 
-                return handle->value;
-            }
-            else 
-            {
-                // Grow the table so we have room
-                elk_str_table_expand(map);
+static inline ElkStr
+elk_str_format_f64(f64 value, size dst_len, char *dest)
+{
+    char buf[ELK_F64_FORMAT_MAX_LEN];
+    size len = elk_str_helper_format_special_f64(value, buf);
+    if(len > 0) { goto COPY_OUT; }
 
-                // Recurse because all the state needed by the *_lookup function was just crushed
-                // by the expansion of the table.
-                return elk_str_map_insert(map, key, value);
-            }
-        }
-        else if (handle->hash == hash && !elk_str_cmp(key, handle->key)) 
-        {
-            // found it! Replace value
-            void *tmp = handle->value;
-            handle->value = value;
+    u64 bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    if(bits >> 63) { buf[len++] = '-'; }
+    bits &= ~(UINT64_C(1) << 63);
 
-            return tmp;
-        }
+    if(bits == 0)
+    {
+        buf[len++] = '0';
+        goto COPY_OUT;
     }
-}
 
-static inline void *
-elk_str_map_lookup(ElkStrMap *map, ElkStr key)
-{
-    // Inspired by https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
+    i32 exponent = 0;
+    u64 digits = elk_f64_helper_shortest_decimal(bits, &exponent);
+    while(digits % 10 == 0) { digits /= 10; exponent += 1; }
 
-    u64 const hash = elk_fnv1a_hash_str(key);
-    u32 i = hash & 0xffffffff; // truncate
-    while (true)
-    {
-        i = elk_hash_lookup(hash, map->size_exp, i);
-        ElkStrMapHandle *handle = &map->handles[i];
+    char digit_chars[20];
+    i32 const num_digits = (i32)elk_str_helper_format_u64(digits, digit_chars);
 
-        if (!handle->key.start) { return NULL; }
-        else if (handle->hash == hash && !elk_str_cmp(key, handle->key)) 
+    /* The value is 0.ddd * 10^point. Use scientific notation if there would be a lot of leading or trailing zeros. */
+    i32 const point = num_digits + exponent;
+    if(point > 17 || point < -3)
+    {
+        buf[len++] = digit_chars[0];
+        if(num_digits > 1)
         {
-            // found it!
-            return handle->value;
+            buf[len++] = '.';
+            memcpy(buf + len, digit_chars + 1, num_digits - 1);
+            len += num_digits - 1;
         }
+
+        buf[len++] = 'e';
+        i32 const sci_exponent = point - 1;
+        if(sci_exponent < 0) { buf[len++] = '-'; }
+        len += elk_str_helper_format_u64(sci_exponent < 0 ? -sci_exponent : sci_exponent, buf + len);
+    }
+    else if(point <= 0)
+    {
+        buf[len++] = '0';
+        buf[len++] = '.';
+        memset(buf + len, '0', -point);
+        len += -point;
+        memcpy(buf + len, digit_chars, num_digits);
+        len += num_digits;
+    }
+    else if(point >= num_digits)
+    {
+        memcpy(buf + len, digit_chars, num_digits);
+        len += num_digits;
+        memset(buf + len, '0', point - num_digits);
+        len += point - num_digits;
+    }
+    else
+    {
+        memcpy(buf + len, digit_chars, point);
+        len += point;
+        buf[len++] = '.';
+        memcpy(buf + len, digit_chars + point, num_digits - point);
+        len += num_digits - point;
     }
 
-    return NULL;
+COPY_OUT:
+    StopIf(len > dst_len, return (ElkStr){0});
+    memcpy(dest, buf, len);
+    return (ElkStr){ .start = dest, .len = len };
 }
 
-static inline ElkStrMapHandle const *
-elk_str_map_lookup_handle(ElkStrMap *map, ElkStr key)
+static inline ElkStr
+elk_str_format_f64_fixed(f64 value, i32 num_decimals, size dst_len, char *dest)
 {
-    // Inspired by https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
-
-    u64 const hash = elk_fnv1a_hash_str(key);
-    u32 i = hash & 0xffffffff; // truncate
-    while (true)
+    Assert(num_decimals >= 0 && num_decimals <= 17);
+    static u64 const powers_of_10[] =
     {
-        i = elk_hash_lookup(hash, map->size_exp, i);
-        ElkStrMapHandle *handle = &map->handles[i];
+        UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000), UINT64_C(100000),
+        UINT64_C(1000000), UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000), UINT64_C(10000000000),
+        UINT64_C(100000000000), UINT64_C(1000000000000), UINT64_C(10000000000000), UINT64_C(100000000000000),
+        UINT64_C(1000000000000000), UINT64_C(10000000000000000), UINT64_C(100000000000000000)
+    };
 
-        if (!handle->key.start) { return NULL; }
-        else if (handle->hash == hash && !elk_str_cmp(key, handle->key)) 
+    char buf[ELK_F64_FIXED_FORMAT_MAX_LEN];
+    size len = elk_str_helper_format_special_f64(value, buf);
+    if(len > 0) { goto COPY_OUT; }
+
+    u64 bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    b32 const neg = bits >> 63;
+    bits &= ~(UINT64_C(1) << 63);
+
+    u64 m = bits & ((UINT64_C(1) << 52) - 1);
+    i32 const ieee_exponent = (i32)(bits >> 52);
+    i32 e = -1074;
+    if(ieee_exponent > 0) { m |= UINT64_C(1) << 52; e = ieee_exponent - 1075; }
+
+    /* The value is exactly m * 2^e, split it into the whole part and the fraction digits rounded half to even. */
+    u64 whole = 0;
+    u64 fraction = 0;
+    char whole_chars[320];
+    size whole_len = 0;
+    if(e >= 0 && e <= 11)
+    {
+        whole = m << e;
+    }
+    else if(e > 11)
+    {
+        /* Too big for a u64, but it's an integer so there is no fraction. Get the digits 9 at a time. */
+        ElkBigUInt big = {0};
+        elk_big_uint_add_small(&big, (u32)(m >> 32));
+        elk_big_uint_shift_left(&big, 32);
+        elk_big_uint_add_small(&big, (u32)m);
+        elk_big_uint_shift_left(&big, e);
+
+        char reversed[320];
+        size num_reversed = 0;
+        while(big.len > 0)
         {
-            // found it!
-            return handle;
+            u32 chunk = elk_big_uint_div_small(&big, 1000000000);
+            for(i32 d = 0; d < 9; ++d) { reversed[num_reversed++] = (char)('0' + chunk % 10); chunk /= 10; }
         }
+        while(num_reversed > 1 && reversed[num_reversed - 1] == '0') { --num_reversed; }
+        for(size d = 0; d < num_reversed; ++d) { whole_chars[d] = reversed[num_reversed - 1 - d]; }
+        whole_len = num_reversed;
     }
+    else
+    {
+        i32 const shift = -e;
+        u64 frac_bits = m;
+        if(shift < 64)
+        {
+            whole = m >> shift;
+            frac_bits = m & ((UINT64_C(1) << shift) - 1);
+        }
 
-    return NULL;
+        /* frac_bits * 10^decimals / 2^shift, it's at most 110 bits before the shift so it fits in 128. */
+        u64 hi = 0;
+        u64 lo = elk_mul_u64_full(frac_bits, powers_of_10[num_decimals], &hi);
+        if(shift < 128)
+        {
+            u64 q = 0;
+            b32 above_half = false;
+            b32 exactly_half = false;
+            if(shift >= 64)
+            {
+                i32 const s = shift - 64;
+                q = s == 0 ? hi : hi >> s;
+                u64 const rem_hi = s == 0 ? 0 : hi & ((UINT64_C(1) << s) - 1);
+                u64 const half_hi = s == 0 ? 0 : UINT64_C(1) << (s - 1);
+                if(s == 0)
+                {
+                    above_half = lo > (UINT64_C(1) << 63);
+                    exactly_half = lo == (UINT64_C(1) << 63);
+                }
+                else
+                {
+                    above_half = rem_hi > half_hi || (rem_hi == half_hi && lo > 0);
+                    exactly_half = rem_hi == half_hi && lo == 0;
+                }
+            }
+            else
+            {
+                q = (lo >> shift) | (hi << (64 - shift));
+                u64 const rem = lo & ((UINT64_C(1) << shift) - 1);
+                u64 const half = UINT64_C(1) << (shift - 1);
+                above_half = rem > half;
+                exactly_half = rem == half;
+            }
+
+            /* Ties go to an even last digit, which is in the whole part if there are no decimals. */
+            u64 const last_digit = num_decimals > 0 ? q : whole;
+            fraction = q + (above_half || (exactly_half && (last_digit & 1)));
+            if(fraction == powers_of_10[num_decimals])
+            {
+                fraction = 0;
+                whole += 1;
+            }
+        }
+    }
+
+    if(whole_len == 0) { whole_len = elk_str_helper_format_u64(whole, whole_chars); }
+
+    /* No minus sign if it rounded to zero. */
+    b32 const is_zero = whole_len == 1 && whole_chars[0] == '0' && fraction == 0;
+    if(neg && !is_zero) { buf[len++] = '-'; }
+
+    memcpy(buf + len, whole_chars, whole_len);
+    len += whole_len;
+    if(num_decimals > 0)
+    {
+        buf[len++] = '.';
+        len += elk_str_helper_format_u64_padded(fraction, num_decimals, buf + len);
+    }
+
+COPY_OUT:
+    StopIf(len > dst_len, return (ElkStr){0});
+    memcpy(dest, buf, len);
+    return (ElkStr){ .start = dest, .len = len };
 }
 
-static inline size
-elk_str_map_len(ElkStrMap *map)
+static inline ElkStr
+elk_str_format_i64_alloc(i64 value, ElkStaticArena *arena)
 {
-    return map->num_handles;
+    char buf[ELK_I64_FORMAT_MAX_LEN];
+    ElkStr const text = elk_str_format_i64(value, sizeof(buf), buf);
+    char *dest = elk_static_arena_nmalloc(arena, text.len, char);
+    StopIf(!dest, return (ElkStr){0});
+    return elk_str_copy(text.len, dest, text);
 }
 
-static inline ElkHashMapKeyIter 
-elk_str_map_key_iter(ElkStrMap *map)
+static inline ElkStr
+elk_str_format_f64_alloc(f64 value, ElkStaticArena *arena)
 {
-    return 0;
+    char buf[ELK_F64_FORMAT_MAX_LEN];
+    ElkStr const text = elk_str_format_f64(value, sizeof(buf), buf);
+    char *dest = elk_static_arena_nmalloc(arena, text.len, char);
+    StopIf(!dest, return (ElkStr){0});
+    return elk_str_copy(text.len, dest, text);
 }
 
-static inline ElkStrMapHandleIter 
-elk_str_map_handle_iter(ElkStrMap *map)
+static inline ElkStr
+elk_str_format_f64_fixed_alloc(f64 value, i32 num_decimals, ElkStaticArena *arena)
 {
-    return 0;
+    char buf[ELK_F64_FIXED_FORMAT_MAX_LEN];
+    ElkStr const text = elk_str_format_f64_fixed(value, num_decimals, sizeof(buf), buf);
+    char *dest = elk_static_arena_nmalloc(arena, text.len, char);
+    StopIf(!dest, return (ElkStr){0});
+    return elk_str_copy(text.len, dest, text);
 }
 
-static inline ElkStr 
-elk_str_map_key_iter_next(ElkStrMap *map, ElkStrMapKeyIter *iter)
-{
-    size const max_iter = (size)(1 << map->size_exp);
-    if(*iter < max_iter) 
-    {
-        ElkStr next_key = map->handles[*iter].key;
-        *iter += 1;
-        while(next_key.start == NULL && *iter < max_iter)
-        {
-            next_key = map->handles[*iter].key;
-            *iter += 1;
-        }
+static ElkTime const elk_time_year_10000 = INT64_C(315537897600); // 10000-01-01 00:00:00, the first 5 digit year.
 
-        return next_key;
-    }
-    else
+static inline size
+elk_time_helper_format_len(ElkTime time, ElkDatetimeFormat format)
+{
+    static u8 const lens[] =
     {
-        return (ElkStr){.start=NULL, .len=0};
-    }
+        [ELK_DATETIME_LONG] = 19, [ELK_DATETIME_ISO_8601] = 19, [ELK_DATETIME_ISO_8601_Z] = 20,
+        [ELK_DATETIME_DAY_OF_YEAR] = 13, [ELK_DATETIME_COMPACT_MINUTES] = 12, [ELK_DATETIME_COMPACT_HOURS] = 10,
+    };
 
+    return lens[format] + (time >= elk_time_year_10000);
 }
 
-static inline ElkStrMapHandle 
-elk_str_map_handle_iter_next(ElkStrMap *map, ElkStrMapHandleIter *iter)
+static inline ElkStr
+elk_time_format(ElkTime time, ElkDatetimeFormat format, size dst_len, char *dest)
 {
-    size const max_iter = (size)(1 << map->size_exp);
-    if(*iter < max_iter) 
-    {
-        ElkStrMapHandle next = map->handles[*iter];
-        *iter += 1;
-        while(next.key.start == NULL && *iter < max_iter)
-        {
-            next = map->handles[*iter];
-            *iter += 1;
-        }
+    Assert(time >= 0 && format >= ELK_DATETIME_LONG && format <= ELK_DATETIME_COMPACT_HOURS);
 
-        return next;
+    size const len = elk_time_helper_format_len(time, format);
+    StopIf(len > dst_len, return (ElkStr){0});
+
+    ElkStructTime const tm = elk_make_struct_time(time);
+    char *next = dest;
+    if(tm.year >= 10000) { *next++ = (char)('0' + tm.year / 10000); }
+    memcpy(next, elk_digit_pairs + 2 * (tm.year % 10000 / 100), 2); next += 2;
+    memcpy(next, elk_digit_pairs + 2 * (tm.year % 100), 2); next += 2;
+
+    if(format == ELK_DATETIME_DAY_OF_YEAR)
+    {
+        *next++ = (char)('0' + tm.day_of_year / 100);
+        memcpy(next, elk_digit_pairs + 2 * (tm.day_of_year % 100), 2); next += 2;
     }
     else
     {
-        return (ElkStrMapHandle){ .key = (ElkStr){.start=NULL, .len=0}, .hash = 0, .value = NULL };
+        b32 const separators = format <= ELK_DATETIME_ISO_8601_Z;
+        if(separators) { *next++ = '-'; }
+        memcpy(next, elk_digit_pairs + 2 * tm.month, 2); next += 2;
+        if(separators) { *next++ = '-'; }
+        memcpy(next, elk_digit_pairs + 2 * tm.day, 2); next += 2;
+        if(separators) { *next++ = format == ELK_DATETIME_LONG ? ' ' : 'T'; }
     }
+
+    memcpy(next, elk_digit_pairs + 2 * tm.hour, 2); next += 2;
+    if(format == ELK_DATETIME_COMPACT_HOURS) { return (ElkStr){ .start = dest, .len = len }; }
+
+    if(format <= ELK_DATETIME_ISO_8601_Z) { *next++ = ':'; }
+    memcpy(next, elk_digit_pairs + 2 * tm.minute, 2); next += 2;
+    if(format == ELK_DATETIME_COMPACT_MINUTES) { return (ElkStr){ .start = dest, .len = len }; }
+
+    if(format <= ELK_DATETIME_ISO_8601_Z) { *next++ = ':'; }
+    memcpy(next, elk_digit_pairs + 2 * tm.second, 2); next += 2;
+    if(format == ELK_DATETIME_ISO_8601_Z) { *next++ = 'Z'; }
+
+    Assert(next - dest == len);
+    return (ElkStr){ .start = dest, .len = len };
 }
 
-static inline ElkHashSet 
-elk_hash_set_create(i8 size_exp, ElkSimpleHash val_hash, ElkEqFunction val_eq, ElkStaticArena *arena)
+static inline ElkStr
+elk_time_format_alloc(ElkTime time, ElkDatetimeFormat format, ElkStaticArena *arena)
 {
-    Assert(size_exp > 0 && size_exp <= 31); // Come on, 31 is HUGE
+    char buf[ELK_DATETIME_FORMAT_MAX_LEN];
+    ElkStr const text = elk_time_format(time, format, sizeof(buf), buf);
+    char *dest = elk_static_arena_nmalloc(arena, text.len, char);
+    StopIf(!dest, return (ElkStr){0});
+    return elk_str_copy(text.len, dest, text);
+}
 
-    size const handles_len = (size)(1 << size_exp);
-    ElkHashSetHandle *handles = elk_static_arena_nmalloc(arena, handles_len, ElkHashSetHandle);
-    PanicIf(!handles);
+static inline char *
+elk_time_helper_format_batch_alloc(ElkTime const *times, size n, ElkDatetimeFormat format, ElkStaticArena *arena,
+        size *total)
+{
+    /* One block for all the strings, 5 digit years are rare so count them instead of assuming the worst. */
+    size num_long_years = 0;
+    for(size i = 0; i < n; ++i) { num_long_years += times[i] >= elk_time_year_10000; }
 
-    return (ElkHashSet)
+    *total = n * elk_time_helper_format_len(0, format) + num_long_years;
+    return elk_static_arena_nmalloc(arena, *total > 0 ? *total : 1, char);
+}
+
+static inline b32
+elk_time_helper_format_batch_scalar(ElkTime const *times, size n, ElkDatetimeFormat format, ElkStaticArena *arena,
+        ElkStr *out)
+{
+    size total = 0;
+    char *dest = elk_time_helper_format_batch_alloc(times, n, format, arena, &total);
+    StopIf(!dest, return false);
+
+    for(size i = 0; i < n; ++i)
     {
-        .arena = arena,
-        .handles = handles,
-        .num_handles = 0, 
-        .hasher = val_hash,
-        .eq = val_eq,
-        .size_exp = size_exp
-    };
+        out[i] = elk_time_format(times[i], format, ELK_DATETIME_FORMAT_MAX_LEN, dest);
+        dest += out[i].len;
+    }
+
+    return true;
 }
 
-static inline void 
-elk_hash_set_destroy(ElkHashSet *set)
+ELK_TARGET("avx2")
+static inline __m256i
+elk_time_helper_digit_pairs_avx2(__m256i values)
 {
-    return;
+    /* Two ASCII digits in the low 16 bits of each lane for values 0 to 99, 103 / 1024 is exactly / 10 up to 178. */
+    __m256i const tens = _mm256_srli_epi32(_mm256_mullo_epi32(values, _mm256_set1_epi32(103)), 10);
+    __m256i const ones = _mm256_sub_epi32(values, _mm256_mullo_epi32(tens, _mm256_set1_epi32(10)));
+    return _mm256_add_epi32(_mm256_or_si256(tens, _mm256_slli_epi32(ones, 8)), _mm256_set1_epi32(0x3030));
 }
 
-static void
-elk_hash_set_expand(ElkHashSet *set)
+ELK_TARGET("avx2")
+static inline b32
+elk_time_helper_format_batch_avx2(ElkTime const *times, size n, ElkDatetimeFormat format, ElkStaticArena *arena,
+        ElkStr *out)
 {
-    i8 const size_exp = set->size_exp;
-    i8 const new_size_exp = size_exp + 1;
+    Assert(format >= ELK_DATETIME_LONG && format <= ELK_DATETIME_COMPACT_HOURS);
 
-    size const handles_len = (size)(1 << size_exp);
-    size const new_handles_len = (size)(1 << new_size_exp);
+    size total = 0;
+    char *dest = elk_time_helper_format_batch_alloc(times, n, format, arena, &total);
+    StopIf(!dest, return false);
+    char *const end = dest + total;
 
-    ElkHashSetHandle *new_handles = elk_static_arena_nmalloc(set->arena, new_handles_len, ElkHashSetHandle);
-    PanicIf(!new_handles);
+    /* The digits for each time are packed into 16 bytes as YYYYMMDDhhmmss, or YYYYDDD.hhmmss for the day of the year
+     * format, then shuffled into place with the separators added. The low lane makes the first 16 bytes of the output and
+     * the high lane the rest. A zero in the separators is a digit, and 0x80 in the shuffle zeros the byte.
+     */
+    static i8 const shuffles[][32] =
+    {
+        [ELK_DATETIME_LONG] =
+        {
+            0, 1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10, 11,
+            -1, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+        },
+        [ELK_DATETIME_ISO_8601] =
+        {
+            0, 1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10, 11,
+            -1, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+        },
+        [ELK_DATETIME_ISO_8601_Z] =
+        {
+            0, 1, 2, 3, -1, 4, 5, -1, 6, 7, -1, 8, 9, -1, 10, 11,
+            -1, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+        },
+        [ELK_DATETIME_DAY_OF_YEAR] =
+        {
+            0, 1, 2, 3, 4, 5, 6, 8, 9, 10, 11, 12, 13, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+        },
+        [ELK_DATETIME_COMPACT_MINUTES] =
+        {
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+        },
+        [ELK_DATETIME_COMPACT_HOURS] =
+        {
+            0, 1, 2, 3, 4, 5, 6, 7, 8, 9, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+        },
+    };
 
-    for (u32 i = 0; i < handles_len; i++) 
+    char const date_time_separator = format == ELK_DATETIME_LONG ? ' ' : 'T';
+    char const zone = format == ELK_DATETIME_ISO_8601_Z ? 'Z' : 0;
+    char separators[32] = {0};
+    if(format <= ELK_DATETIME_ISO_8601_Z)
     {
-        ElkHashSetHandle *handle = &set->handles[i];
+        separators[4] = '-';
+        separators[7] = '-';
+        separators[10] = date_time_separator;
+        separators[13] = ':';
+        separators[16] = ':';
+        separators[19] = zone;
+    }
 
-        if (handle->value == NULL) { continue; } // Skip if it's empty
+    __m256i const shuffle = _mm256_loadu_si256((__m256i const *)shuffles[format]);
+    __m256i const separator_chars = _mm256_loadu_si256((__m256i const *)separators);
+    size const len = elk_time_helper_format_len(0, format);
 
-        // Find the position in the new table and update it.
-        u64 const hash = handle->hash;
-        u32 j = hash & 0xffffffff; // truncate
-        while (true) 
+    size i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        /* 5 digit years are done one at a time. */
+        __m256i const limit = _mm256_set1_epi64x(elk_time_year_10000 - 1);
+        __m256i const big = _mm256_or_si256(
+                _mm256_cmpgt_epi64(_mm256_loadu_si256((__m256i const *)(times + i)), limit),
+                _mm256_cmpgt_epi64(_mm256_loadu_si256((__m256i const *)(times + i + 4)), limit));
+        if(!_mm256_testz_si256(big, big))
         {
-            j = elk_hash_lookup(hash, new_size_exp, j);
-            ElkHashSetHandle *new_handle = &new_handles[j];
-
-            if (!new_handle->value)
+            for(i32 t = 0; t < 8; ++t)
             {
-                // empty - put it here. Don't need to check for room because we just expanded
-                // the hash table of handles, and we're not copying anything new into storage,
-                // it's already there!
-                *new_handle = *handle;
-                break;
+                out[i + t] = elk_time_format(times[i + t], format, ELK_DATETIME_FORMAT_MAX_LEN, dest);
+                dest += out[i + t].len;
             }
+            continue;
         }
-    }
 
-    set->handles = new_handles;
-    set->size_exp = new_size_exp;
+        __m256i seconds_of_day;
+        __m256i const days = elk_time_helper_split_days_avx2(times + i, &seconds_of_day);
+
+        __m256i const hours = _mm256_srli_epi32(_mm256_mullo_epi32(seconds_of_day, _mm256_set1_epi32(37283)), 27);
+        __m256i const seconds_of_hour =
+            _mm256_sub_epi32(seconds_of_day, _mm256_mullo_epi32(hours, _mm256_set1_epi32(3600)));
+        __m256i const minutes = _mm256_srli_epi32(_mm256_mullo_epi32(seconds_of_hour, _mm256_set1_epi32(2185)), 17);
+        __m256i const seconds = _mm256_sub_epi32(seconds_of_hour, _mm256_mullo_epi32(minutes, _mm256_set1_epi32(60)));
+
+        __m256i year;
+        __m256i month;
+        __m256i day;
+        __m256i day_of_year;
+        elk_time_helper_civil_from_days_avx2(days, &year, &month, &day, &day_of_year);
+
+        /* 4 bytes of digits in each lane, then transpose so each time's 16 bytes are together. */
+        __m256i const centuries = _mm256_srli_epi32(_mm256_mullo_epi32(year, _mm256_set1_epi32(5243)), 19); // / 100
+        __m256i const year_of_century = _mm256_sub_epi32(year, _mm256_mullo_epi32(centuries, _mm256_set1_epi32(100)));
+        __m256i const year_digits = _mm256_or_si256(elk_time_helper_digit_pairs_avx2(centuries),
+                _mm256_slli_epi32(elk_time_helper_digit_pairs_avx2(year_of_century), 16));
+
+        __m256i date_digits;
+        if(format == ELK_DATETIME_DAY_OF_YEAR)
+        {
+            __m256i const tens = _mm256_srli_epi32(_mm256_mullo_epi32(day_of_year, _mm256_set1_epi32(6554)), 16); // / 10
+            __m256i const ones = _mm256_sub_epi32(day_of_year, _mm256_mullo_epi32(tens, _mm256_set1_epi32(10)));
+            date_digits = _mm256_or_si256(elk_time_helper_digit_pairs_avx2(tens),
+                    _mm256_slli_epi32(_mm256_add_epi32(ones, _mm256_set1_epi32('0')), 16));
+        }
+        else
+        {
+            date_digits = _mm256_or_si256(elk_time_helper_digit_pairs_avx2(month),
+                    _mm256_slli_epi32(elk_time_helper_digit_pairs_avx2(day), 16));
+        }
 
-    return;
-}
+        __m256i const hour_minute_digits = _mm256_or_si256(elk_time_helper_digit_pairs_avx2(hours),
+                _mm256_slli_epi32(elk_time_helper_digit_pairs_avx2(minutes), 16));
+        __m256i const second_digits = elk_time_helper_digit_pairs_avx2(seconds);
 
-static inline void *
-elk_hash_set_insert(ElkHashSet *set, void *value)
-{
-    // Inspired by https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
+        __m256i const year_date_01 = _mm256_unpacklo_epi32(year_digits, date_digits);
+        __m256i const year_date_23 = _mm256_unpackhi_epi32(year_digits, date_digits);
+        __m256i const time_01 = _mm256_unpacklo_epi32(hour_minute_digits, second_digits);
+        __m256i const time_23 = _mm256_unpackhi_epi32(hour_minute_digits, second_digits);
 
-    u64 const hash = set->hasher(value);
-    u32 i = hash & 0xffffffff; // truncate
-    while (true)
-    {
-        i = elk_hash_lookup(hash, set->size_exp, i);
-        ElkHashSetHandle *handle = &set->handles[i];
+        __m256i digits[4];
+        digits[0] = _mm256_unpacklo_epi64(year_date_01, time_01);   // times 0 and 4
+        digits[1] = _mm256_unpackhi_epi64(year_date_01, time_01);   // times 1 and 5
+        digits[2] = _mm256_unpacklo_epi64(year_date_23, time_23);   // times 2 and 6
+        digits[3] = _mm256_unpackhi_epi64(year_date_23, time_23);   // times 3 and 7
 
-        if (!handle->value)
+        for(i32 t = 0; t < 8; ++t)
         {
-            // empty, insert here if room in the table of handles. Check for room first!
-            if (elk_hash_table_large_enough(set->num_handles, set->size_exp))
-            {
-
-                *handle = (ElkHashSetHandle){.hash = hash, .value=value};
-                set->num_handles += 1;
+            __m256i const both = t < 4
+                ? _mm256_permute2x128_si256(digits[t], digits[t], 0x00)
+                : _mm256_permute2x128_si256(digits[t - 4], digits[t - 4], 0x11);
+            __m256i const text = _mm256_or_si256(_mm256_shuffle_epi8(both, shuffle), separator_chars);
 
-                return handle->value;
-            }
-            else 
+            /* Store 32 bytes and let the next one overwrite the extra, except near the end of the block. */
+            if(end - dest >= 32) { _mm256_storeu_si256((__m256i *)dest, text); }
+            else
             {
-                // Grow the table so we have room
-                elk_hash_set_expand(set);
-
-                // Recurse because all the state needed by the *_lookup function was just crushed
-                // by the expansion of the set.
-                return elk_hash_set_insert(set, value);
+                char tail[32];
+                _mm256_storeu_si256((__m256i *)tail, text);
+                memcpy(dest, tail, len);
             }
-        }
-        else if (handle->hash == hash && set->eq(handle->value, value)) 
-        {
-            // found it!
-            return handle->value;
+
+            out[i + t] = (ElkStr){ .start = dest, .len = len };
+            dest += len;
         }
     }
 
-    return NULL;
+    for(; i < n; ++i)
+    {
+        out[i] = elk_time_format(times[i], format, ELK_DATETIME_FORMAT_MAX_LEN, dest);
+        dest += out[i].len;
+    }
+
+    return true;
 }
 
+static inline b32
+elk_time_format_batch(ElkTime const *times, size n, ElkDatetimeFormat format, ElkStaticArena *arena, ElkStr *out)
+{
+#if __AVX2__
+    return elk_time_helper_format_batch_avx2(times, n, format, arena, out);
+#else
+    return elk_time_helper_format_batch_scalar(times, n, format, arena, out);
+#endif
+}
 
-static inline void *
-elk_hash_set_lookup(ElkHashSet *set, void *value)
+static inline b32
+elk_time_series_helper_resample_point(ElkTime const *times, f64 const *values, size n, size num_before, ElkTime grid_time,
+        ElkResampleMethod method, ElkTimeDiff max_gap, f64 *out)
 {
-    // Inspired by https://nullprogram.com/blog/2022/08/08
-    // All code & writing on this blog is in the public domain.
+    /* num_before is the number of observations at or before the grid time. */
+    static f64 const ELK_ZERO = 0.0;
+    f64 const ELK_NAN = 0.0 / ELK_ZERO;
 
-    u64 const hash = set->hasher(value);
-    u32 i = hash & 0xffffffff; // truncate
-    while (true)
+    size const prev = num_before - 1;
+    size const next = num_before;
+    b32 const has_prev = prev >= 0;
+    b32 const has_next = next < n;
+    ElkTimeDiff const to_prev = has_prev ? grid_time - times[prev] : INT64_MAX;
+    ElkTimeDiff const to_next = has_next ? times[next] - grid_time : INT64_MAX;
+
+    if(to_prev == 0) { *out = values[prev]; return true; }
+
+    switch(method)
     {
-        i = elk_hash_lookup(hash, set->size_exp, i);
-        ElkHashSetHandle *handle = &set->handles[i];
+        case ELK_RESAMPLE_STEP:
+        {
+            StopIf(!has_prev || to_prev > max_gap, goto NO_VALUE);
+            *out = values[prev];
+        } break;
 
-        if (!handle->value)
+        case ELK_RESAMPLE_NEAREST:
         {
-            return NULL;
-        }
-        else if (handle->hash == hash && set->eq(handle->value, value)) 
+            b32 const use_prev = has_prev && to_prev <= to_next;
+            StopIf(!has_prev && !has_next, goto NO_VALUE);
+            StopIf((use_prev ? to_prev : to_next) > max_gap, goto NO_VALUE);
+            *out = use_prev ? values[prev] : values[next];
+        } break;
+
+        case ELK_RESAMPLE_LINEAR:
         {
-            // found it!
-            return handle->value;
-        }
+            StopIf(!has_prev || !has_next || times[next] - times[prev] > max_gap, goto NO_VALUE);
+            f64 const weight = (f64)to_prev / (f64)(times[next] - times[prev]);
+            *out = values[prev] + (values[next] - values[prev]) * weight;
+        } break;
+
+        default: Panic();
     }
 
-    return NULL;
+    return true;
+
+NO_VALUE:
+    *out = ELK_NAN;
+    return false;
 }
 
-static inline size 
-elk_hash_set_len(ElkHashSet *set)
+static inline size
+elk_time_series_resample(ElkTime const *times, f64 const *values, size n, ElkTime start, ElkTimeDiff step, size num_out,
+        ElkResampleMethod method, ElkTimeDiff max_gap, f64 *out)
 {
-    return set->num_handles;
+    Assert(step > 0 && max_gap >= 0);
+
+    size num_ok = 0;
+    size num_before = 0;
+    for(size i = 0; i < num_out; ++i)
+    {
+        ElkTime const grid_time = start + i * step;
+        /* The times are sorted, so checking the last of 8 skips all of them, it saves a lot of mispredicted branches when
+         * there are many observations between grid points (like hourly grids over 5 minute data).
+         */
+        while(num_before + 8 <= n && times[num_before + 7] <= grid_time) { num_before += 8; }
+        while(num_before < n && times[num_before] <= grid_time) { ++num_before; }
+        num_ok += elk_time_series_helper_resample_point(times, values, n, num_before, grid_time, method, max_gap, out + i);
+    }
+
+    return num_ok;
 }
 
-static inline ElkHashSetIter
-elk_hash_set_value_iter(ElkHashSet *set)
+static inline void
+elk_scan_chars_scalar(char const *block, char const chars[4], u32 bits[4])
 {
-    return 0;
+    u32 b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+    for(i32 i = 0; i < 32; ++i)
+    {
+        b0 |= (u32)(block[i] == chars[0]) << i;
+        b1 |= (u32)(block[i] == chars[1]) << i;
+        b2 |= (u32)(block[i] == chars[2]) << i;
+        b3 |= (u32)(block[i] == chars[3]) << i;
+    }
+
+    bits[0] = b0;
+    bits[1] = b1;
+    bits[2] = b2;
+    bits[3] = b3;
 }
 
-static inline void *
-elk_hash_set_value_iter_next(ElkHashSet *set, ElkHashSetIter *iter)
+ELK_TARGET("sse2")
+static inline void
+elk_scan_chars_sse2(char const *block, char const chars[4], u32 bits[4])
 {
-    size const max_iter = (size)(1 << set->size_exp);
-    void *next_value = NULL;
-    if(*iter >= max_iter) { return next_value; }
+    __m128i lo = _mm_loadu_si128((__m128i const *)block);
+    __m128i hi = _mm_loadu_si128((__m128i const *)(block + 16));
 
-    do
+    for(i32 i = 0; i < 4; ++i)
     {
-        next_value = set->handles[*iter].value;
-        *iter += 1;
+        __m128i c = _mm_set1_epi8(chars[i]);
+        bits[i] = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(lo, c)) | ((u32)_mm_movemask_epi8(_mm_cmpeq_epi8(hi, c)) << 16);
+    }
+}
 
-    } while(next_value == NULL && *iter < max_iter);
+ELK_TARGET("avx2")
+static inline void
+elk_scan_chars_avx2(char const *block, char const chars[4], u32 bits[4])
+{
+    __m256i data = _mm256_loadu_si256((__m256i const *)block);
 
-    return next_value;
+    for(i32 i = 0; i < 4; ++i)
+    {
+        bits[i] = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, _mm256_set1_epi8(chars[i])));
+    }
 }
 
-#define ELK_I8_FLIP(x) ((x) ^ UINT8_C(0x80))
-#define ELK_I8_FLIP_BACK(x) ELK_I8_FLIP(x)
+static inline void
+elk_scan_chars(char const *block, char const chars[4], u32 bits[4])
+{
+    /* The best version we know is available at compile time. */
+#if __AVX2__
+    elk_scan_chars_avx2(block, chars, bits);
+#elif __SSE2__ || defined(_M_X64)
+    elk_scan_chars_sse2(block, chars, bits);
+#else
+    elk_scan_chars_scalar(block, chars, bits);
+#endif
+}
 
-#define ELK_I16_FLIP(x) ((x) ^ UINT16_C(0x8000))
-#define ELK_I16_FLIP_BACK(x) ELK_I16_FLIP(x)
+static inline ElkScanCharsFunction
+elk_scan_chars_default(void)
+{
+#if __AVX2__
+    return elk_scan_chars_avx2;
+#elif __SSE2__ || defined(_M_X64)
+    return elk_scan_chars_sse2;
+#else
+    return elk_scan_chars_scalar;
+#endif
+}
 
-#define ELK_I32_FLIP(x) ((x) ^ UINT32_C(0x80000000))
-#define ELK_I32_FLIP_BACK(x) ELK_I32_FLIP(x)
+static inline ElkCpuFeatures
+elk_cpu_features_detect(void)
+{
+    u32 leaf1[4] = {0}; /* eax, ebx, ecx, edx */
+    u32 leaf7[4] = {0};
+    u64 os_saved_state = 0;
 
-#define ELK_I64_FLIP(x) ((x) ^ UINT64_C(0x8000000000000000))
-#define ELK_I64_FLIP_BACK(x) ELK_I64_FLIP(x)
+#if defined(_MSC_VER) && !defined(__clang__)
+    i32 regs[4] = {0};
+    __cpuid(regs, 0);
+    i32 const max_leaf = regs[0];
 
-#define ELK_F32_FLIP(x) ((x) ^ (-(i32)(((u32)(x)) >> 31) | UINT32_C(0x80000000)))
-#define ELK_F32_FLIP_BACK(x) ((x) ^ (((((u32)(x)) >> 31) - 1) | UINT32_C(0x80000000)))
+    __cpuid(regs, 1);
+    for(i32 i = 0; i < 4; ++i) { leaf1[i] = (u32)regs[i]; }
 
-#define ELK_F64_FLIP(x) ((x) ^ (-(i64)(((u64)(x)) >> 63) | UINT64_C(0x8000000000000000)))
-#define ELK_F64_FLIP_BACK(x) ((x) ^ (((((u64)(x)) >> 63) - 1) | UINT64_C(0x8000000000000000)))
+    if(max_leaf >= 7)
+    {
+        __cpuidex(regs, 7, 0);
+        for(i32 i = 0; i < 4; ++i) { leaf7[i] = (u32)regs[i]; }
+    }
 
-static inline void
-elk_radix_pre_sort_transform(void *buffer, size num, size offset, size stride, ElkRadixSortByType sort_type)
-{
-    Assert(
-           sort_type == ELK_RADIX_SORT_UINT64 || sort_type == ELK_RADIX_SORT_INT64 || sort_type == ELK_RADIX_SORT_F64
-        || sort_type == ELK_RADIX_SORT_UINT32 || sort_type == ELK_RADIX_SORT_INT32 || sort_type == ELK_RADIX_SORT_F32
-        || sort_type == ELK_RADIX_SORT_UINT16 || sort_type == ELK_RADIX_SORT_INT16
-        || sort_type == ELK_RADIX_SORT_UINT8  || sort_type == ELK_RADIX_SORT_INT8
-    );
+    if((leaf1[2] >> 27) & 1) { os_saved_state = _xgetbv(0); }
+#else
+    u32 const max_leaf = __get_cpuid_max(0, NULL);
 
-    for(size i = 0; i < num; ++i)
+    if(max_leaf >= 1) { __cpuid(1, leaf1[0], leaf1[1], leaf1[2], leaf1[3]); }
+    if(max_leaf >= 7) { __cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]); }
+
+    if((leaf1[2] >> 27) & 1)
     {
-        switch(sort_type)
-        {
-            case ELK_RADIX_SORT_F64:
-            {
-                /* Flip bits so doubles sort correctly. */
-                u64 *v = (u64 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_F64_FLIP(*v);
-            } break;
+        /* The OS uses XSAVE, ask it which registers it saves. Not all compilers have the _xgetbv() intrinsic. */
+        u32 lo = 0, hi = 0;
+        __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        os_saved_state = ((u64)hi << 32) | lo;
+    }
+#endif
 
-            case ELK_RADIX_SORT_INT64:
-            {
-                /* Flip bits so two's complement signed integers sort correctly. */
-                u64 *v = (u64 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_I64_FLIP(*v);
-            } break;
+    /* The CPU may support AVX, but it's useless if the OS doesn't save the YMM registers (bits 1 & 2) on context switches. */
+    b32 const ymm_saved = (os_saved_state & 0x6) == 0x6;
+    b32 const avx = ymm_saved && ((leaf1[2] >> 28) & 1);
 
-            case ELK_RADIX_SORT_F32:
-            {
-                /* Flip bits so doubles sort correctly. */
-                u32 *v = (u32 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_F32_FLIP(*v);
-            } break;
+    return (ElkCpuFeatures)
+    {
+        .sse2 = (leaf1[3] >> 26) & 1,
+        .sse42 = (leaf1[2] >> 20) & 1,
+        .popcnt = (leaf1[2] >> 23) & 1,
+        .pclmul = (leaf1[2] >> 1) & 1,
+        .avx2 = avx && ((leaf7[1] >> 5) & 1),
+        .bmi2 = (leaf7[1] >> 8) & 1,
+    };
+}
 
-            case ELK_RADIX_SORT_INT32:
-            {
-                /* Flip bits so two's complement signed integers sort correctly. */
-                u32 *v = (u32 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_I32_FLIP(*v);
-            } break;
+static inline size elk_csv_helper_index_blocks_scalar(char const *base, size start, size end, char const chars[4],
+        u64 *delimiter_bits, u64 *newline_bits, b32 *ends_in_comment);
+static inline size elk_csv_helper_index_blocks_pclmul(char const *base, size start, size end, char const chars[4],
+        u64 *delimiter_bits, u64 *newline_bits, b32 *ends_in_comment);
 
-            case ELK_RADIX_SORT_INT16:
-            {
-                /* Flip bits so two's complement signed integers sort correctly. */
-                u16 *v = (u16 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_I16_FLIP(*v);
-            } break;
+static inline ElkDispatch
+elk_dispatch_create(ElkCpuFeatures features)
+{
+    ElkDispatch dispatch =
+    {
+        .scan_chars = elk_scan_chars_scalar,
+        .parse_datetime = elk_str_helper_parse_datetime_scalar,
+        .parse_f64_batch = elk_str_helper_parse_f64_batch_scalar,
+        .parse_datetime_batch = elk_str_helper_parse_datetime_batch_scalar,
+        .time_to_columns = elk_time_helper_to_columns_scalar,
+        .time_from_columns = elk_time_helper_from_columns_scalar,
+        .time_truncate_batch = elk_time_helper_truncate_batch_scalar,
+        .time_truncate_to_calendar_batch = elk_time_helper_truncate_to_calendar_batch_scalar,
+        .time_format_batch = elk_time_helper_format_batch_scalar,
+        .csv_index_blocks = elk_csv_helper_index_blocks_scalar,
+    };
 
-            case ELK_RADIX_SORT_INT8:
-            {
-                /* Flip bits so two's complement signed integers sort correctly. */
-                u8 *v = (u8 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_I8_FLIP(*v);
-            } break;
+    if(features.sse2) { dispatch.scan_chars = elk_scan_chars_sse2; }
+    if(features.pclmul) { dispatch.csv_index_blocks = elk_csv_helper_index_blocks_pclmul; }
 
-            /* Fall through without doing anything. */
-            case ELK_RADIX_SORT_UINT64:
-            case ELK_RADIX_SORT_UINT32:
-            case ELK_RADIX_SORT_UINT16:
-            case ELK_RADIX_SORT_UINT8: {}
-        }
+    if(features.avx2)
+    {
+        dispatch.scan_chars = elk_scan_chars_avx2;
+        dispatch.parse_datetime = elk_str_helper_parse_datetime_avx2;
+        dispatch.parse_f64_batch = elk_str_helper_parse_f64_batch_avx2;
+        dispatch.parse_datetime_batch = elk_str_helper_parse_datetime_batch_avx2;
+        dispatch.time_to_columns = elk_time_helper_to_columns_avx2;
+        dispatch.time_from_columns = elk_time_helper_from_columns_avx2;
+        dispatch.time_truncate_batch = elk_time_helper_truncate_batch_avx2;
+        dispatch.time_truncate_to_calendar_batch = elk_time_helper_truncate_to_calendar_batch_avx2;
+        dispatch.time_format_batch = elk_time_helper_format_batch_avx2;
     }
+
+    return dispatch;
 }
 
-static inline void
-elk_radix_post_sort_transform(void *buffer, size num, size offset, size stride, ElkRadixSortByType sort_type)
+static u64 const fnv_offset_bias = 0xcbf29ce484222325;
+static u64 const fnv_prime = 0x00000100000001b3;
+
+static inline u64
+elk_fnv1a_hash_accumulate(size const size_bytes, void const *value, u64 const hash_so_far)
 {
-    Assert(
-           sort_type == ELK_RADIX_SORT_UINT64 || sort_type == ELK_RADIX_SORT_INT64 || sort_type == ELK_RADIX_SORT_F64
-        || sort_type == ELK_RADIX_SORT_UINT32 || sort_type == ELK_RADIX_SORT_INT32 || sort_type == ELK_RADIX_SORT_F32
-        || sort_type == ELK_RADIX_SORT_UINT16 || sort_type == ELK_RADIX_SORT_INT16
-        || sort_type == ELK_RADIX_SORT_UINT8  || sort_type == ELK_RADIX_SORT_INT8
-    );
+    u8 const *data = value;
 
-    for(size i = 0; i < num; ++i)
+    u64 hash = hash_so_far;
+    for (size i = 0; i < size_bytes; ++i)
     {
-        switch(sort_type)
-        {
-            case ELK_RADIX_SORT_F64:
-            {
-                /* Flip bits so doubles sort correctly. */
-                u64 *v = (u64 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_F64_FLIP_BACK(*v);
-            } break;
+        hash ^= data[i];
+        hash *= fnv_prime;
+    }
 
-            case ELK_RADIX_SORT_INT64:
-            {
-                /* Flip bits so two's complement signed integers sort correctly. */
-                u64 *v = (u64 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_I64_FLIP_BACK(*v);
-            } break;
+    return hash;
+}
 
-            case ELK_RADIX_SORT_F32:
-            {
-                /* Flip bits so doubles sort correctly. */
-                u32 *v = (u32 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_F32_FLIP_BACK(*v);
-            } break;
+static inline u64
+elk_fnv1a_hash(size const n, void const *value)
+{
+    return elk_fnv1a_hash_accumulate(n, value, fnv_offset_bias);
+}
 
-            case ELK_RADIX_SORT_INT32:
-            {
-                /* Flip bits so two's complement signed integers sort correctly. */
-                u32 *v = (u32 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_I32_FLIP_BACK(*v);
-            } break;
+static inline u64
+elk_fnv1a_hash_str(ElkStr str)
+{
+    return elk_fnv1a_hash(str.len, str.start);
+}
 
-            case ELK_RADIX_SORT_INT16:
-            {
-                /* Flip bits so two's complement signed integers sort correctly. */
-                u16 *v = (u16 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_I16_FLIP_BACK(*v);
-            } break;
+static inline ElkStringInterner 
+elk_string_interner_create(i8 size_exp, ElkStaticArena *storage)
+{
+    Assert(size_exp > 0 && size_exp <= 31); // Come on, 31 is HUGE
 
-            case ELK_RADIX_SORT_INT8:
-            {
-                /* Flip bits so two's complement signed integers sort correctly. */
-                u8 *v = (u8 *)((byte *)buffer + offset + i * stride);
-                *v = ELK_I8_FLIP_BACK(*v);
-            } break;
+    usize const handles_len = (usize)(1 << size_exp);
+    ElkStringInternerHandle *handles = elk_static_arena_nmalloc(storage, handles_len, ElkStringInternerHandle);
+    PanicIf(!handles);
 
-            /* Fall through with no-op */
-            case ELK_RADIX_SORT_UINT64:
-            case ELK_RADIX_SORT_UINT32:
-            case ELK_RADIX_SORT_UINT16:
-            case ELK_RADIX_SORT_UINT8: {}
-        }
-    }
+    return (ElkStringInterner)
+    {
+        .storage = storage,
+        .handles = handles,
+        .num_handles = 0, 
+        .size_exp = size_exp
+    };
 }
 
 static inline void
-elk_radix_sort_8(void *buffer, size num, size offset, size stride, void *scratch, ElkSortOrder order)
+elk_string_interner_destroy(ElkStringInterner *interner)
 {
-    i64 counts[256] = {0};
+    return;
+}
 
-    /* Build the histograms. */
-    byte *position = (byte *)buffer + offset;
+static inline b32
+elk_hash_table_large_enough(usize num_handles, i8 size_exp)
+{
+    // Shoot for no more than 75% of slots filled.
+    return num_handles < 3 * (1 << size_exp) / 4;
+}
 
-    for(size i = 0; i < num; ++i)
-    {
-        u8 b0 = *(u8 *)position;
-        counts[b0] += 1;
-        position += stride;
-    }
+static inline u32
+elk_hash_lookup(u64 hash, i8 exp, u32 idx)
+{
+    // Copied from https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+    u32 mask = (UINT32_C(1) << exp) - 1;
+    u32 step = (u32)((hash >> (64 - exp)) | 1);    // the | 1 forces an odd number
+    return (idx + step) & mask;
+}
 
-    /* Sum the histograms. */
-    if(order == ELK_SORT_ASCENDING)
+static inline void
+elk_string_interner_expand_table(ElkStringInterner *interner)
+{
+    i8 const size_exp = interner->size_exp;
+    i8 const new_size_exp = size_exp + 1;
+
+    usize const handles_len = (usize)(1 << size_exp);
+    usize const new_handles_len = (usize)(1 << new_size_exp);
+
+    ElkStringInternerHandle *new_handles = elk_static_arena_nmalloc(interner->storage, new_handles_len, ElkStringInternerHandle);
+    PanicIf(!new_handles);
+
+    for (u32 i = 0; i < handles_len; i++) 
     {
-        for(size i = 1; i < 256; ++i)
+        ElkStringInternerHandle *handle = &interner->handles[i];
+
+        if (handle->str.start == NULL) { continue; } // Skip if it's empty
+
+        // Find the position in the new table and update it.
+        u64 const hash = handle->hash;
+        u32 j = hash & 0xffffffff; // truncate
+        while (true) 
         {
-            counts[i] += counts[i - 1];
+            j = elk_hash_lookup(hash, new_size_exp, j);
+            ElkStringInternerHandle *new_handle = &new_handles[j];
+
+            if (!new_handle->str.start)
+            {
+                // empty - put it here. Don't need to check for room because we just expanded
+                // the hash table of handles, and we're not copying anything new into storage,
+                // it's already there!
+                *new_handle = *handle;
+                break;
+            }
         }
     }
+
+    interner->handles = new_handles;
+    interner->size_exp = new_size_exp;
+
+    return;
+}
+
+static inline ElkStr
+elk_string_interner_intern_cstring(ElkStringInterner *interner, char *string)
+{
+    ElkStr str = elk_str_from_cstring(string);
+    return elk_string_interner_intern(interner, str);
+}
+
+static inline ElkStr
+elk_string_interner_intern(ElkStringInterner *interner, ElkStr str)
+{
+    // Inspired by https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+
+    u64 const hash = elk_fnv1a_hash_str(str);
+    u32 i = hash & 0xffffffff; // truncate
+    while (true)
+    {
+        i = elk_hash_lookup(hash, interner->size_exp, i);
+        ElkStringInternerHandle *handle = &interner->handles[i];
+
+        if (!handle->str.start)
+        {
+            // empty, insert here if room in the table of handles. Check for room first!
+            if (elk_hash_table_large_enough(interner->num_handles, interner->size_exp))
+            {
+                char *dest = elk_static_arena_nmalloc(interner->storage, str.len + 1, char);
+                PanicIf(!dest);
+                ElkStr interned_str = elk_str_copy(str.len + 1, dest, str);
+
+                *handle = (ElkStringInternerHandle){.hash = hash, .str = interned_str};
+                interner->num_handles += 1;
+
+                return handle->str;
+            }
+            else 
+            {
+                // Grow the table so we have room
+                elk_string_interner_expand_table(interner);
+
+                // Recurse because all the state needed by the *_lookup function was just crushed
+                // by the expansion of the table.
+                return elk_string_interner_intern(interner, str);
+            }
+        }
+        else if (handle->hash == hash && elk_str_eq(str, handle->str)) 
+        {
+            // found it!
+            return handle->str;
+        }
+    }
+}
+
+static inline b32
+elk_is_power_of_2(uptr p)
+{
+    return (p & (p - 1)) == 0;
+}
+
+static inline uptr
+elk_align_pointer(uptr ptr, usize align)
+{
+
+    Assert(elk_is_power_of_2(align));
+
+    uptr a = (uptr)align;
+    uptr mod = ptr & (a - 1); // Same as (ptr % a) but faster as 'a' is a power of 2
+
+    if (mod != 0)
+    {
+        // push the address forward to the next value which is aligned
+        ptr += a - mod;
+    }
+
+    return ptr;
+}
+
+static inline void
+elk_static_arena_create(ElkStaticArena *arena, size buf_size, byte buffer[])
+{
+    Assert(arena && buffer && buf_size > 0);
+
+    *arena = (ElkStaticArena)
+    {
+        .buf_size = buf_size,
+        .buf_offset = 0,
+        .buffer = buffer,
+        .prev_ptr = NULL,
+        .prev_offset = 0,
+    };
+
+#ifdef _ELK_TRACK_MEM_USAGE
+    size idx = elk_static_arena_metrics_next++;
+    Assert(idx < (sizeof(elk_static_arena_metrics) / sizeof(elk_static_arena_metrics[0])));
+    arena->metrics_ptr = &elk_static_arena_metrics[idx];
+    *arena->metrics_ptr = (ElkStaticArenaAllocationMetrics){0};
+#endif
+    return;
+}
+
+static inline void
+elk_static_arena_destroy(ElkStaticArena *arena)
+{
+    // no-op
+    return;
+}
+
+static inline void
+elk_static_arena_reset(ElkStaticArena *arena)
+{
+    Assert(arena->buffer);
+    arena->buf_offset = 0;
+    arena->prev_ptr = NULL;
+    arena->prev_offset = 0;
+    return;
+}
+
+static inline void *
+elk_static_arena_alloc(ElkStaticArena *arena, size num_bytes, size alignment)
+{
+    Assert(num_bytes > 0 && alignment > 0);
+
+    // Align 'curr_offset' forward to the specified alignment
+    uptr curr_ptr = (uptr)arena->buffer + (uptr)arena->buf_offset;
+    uptr offset = elk_align_pointer(curr_ptr, alignment);
+    offset -= (uptr)arena->buffer; // change to relative offset
+
+    // Check to see if there is enough space left
+    if ((size)(offset + num_bytes) <= arena->buf_size)
+    {
+        void *ptr = &arena->buffer[offset];
+        memset(ptr, 0, num_bytes);
+        arena->prev_offset = arena->buf_offset;
+        arena->buf_offset = offset + num_bytes;
+        arena->prev_ptr = ptr;
+
+#ifdef _ELK_TRACK_MEM_USAGE
+        arena->metrics_ptr->max_offset = arena->buf_offset > (arena->metrics_ptr->max_offset) ?
+            arena->buf_offset : (arena->metrics_ptr->max_offset);
+#endif
+
+        return ptr;
+    }
     else
     {
-        for(size i = 254; i >= 0; --i)
+#ifdef _ELK_TRACK_MEM_USAGE
+        arena->metrics_ptr->over_allocation_attempted = true;
+#endif
+        return NULL;
+    }
+}
+
+static inline void * 
+elk_static_arena_realloc(ElkStaticArena *arena, void *ptr, size asize)
+{
+    Assert(asize > 0);
+
+    if(ptr == arena->prev_ptr)
+    {
+        // Get previous extra offset due to alignment
+        uptr offset = (uptr)ptr - (uptr)arena->buffer; // relative offset accounting for alignment
+
+        // Check to see if there is enough space left
+        if ((size)(offset + asize) <= arena->buf_size)
         {
-            counts[i] += counts[i + 1];
+            arena->buf_offset = offset + asize;
+
+#ifdef _ELK_TRACK_MEM_USAGE
+            arena->metrics_ptr->max_offset = arena->buf_offset > (arena->metrics_ptr->max_offset) ?
+                arena->buf_offset : (arena->metrics_ptr->max_offset);
+#endif
+
+            return ptr;
+        }
+        else
+        {
+#ifdef _ELK_TRACK_MEM_USAGE
+            arena->metrics_ptr->over_allocation_attempted = true;
+#endif
+        }
+    }
+
+    return NULL;
+}
+
+static inline void
+elk_static_arena_free(ElkStaticArena *arena, void *ptr)
+{
+    if(ptr == arena->prev_ptr)
+    {
+        arena->buf_offset = arena->prev_offset;
+    }
+
+    return;
+}
+
+#ifdef _ELK_TRACK_MEM_USAGE
+
+static inline f64 
+elk_static_arena_max_ratio(ElkStaticArena *arena)
+{
+    return (f64)arena->metrics_ptr->max_offset / (f64)arena->buf_size;
+}
+
+static inline b32 
+elk_static_arena_over_allocated(ElkStaticArena *arena)
+{
+    return arena->metrics_ptr->over_allocation_attempted;
+}
+
+#endif
+
+static inline void
+elk_static_pool_initialize_linked_list(byte *buffer, size object_size, size num_objects)
+{
+
+    // Initialize the free list to a linked list.
+
+    // start by pointing to last element and assigning it NULL
+    size offset = object_size * (num_objects - 1);
+    uptr *ptr = (uptr *)&buffer[offset];
+    *ptr = (uptr)NULL;
+
+    // Then work backwards to the front of the list.
+    while (offset) 
+    {
+        size next_offset = offset;
+        offset -= object_size;
+        ptr = (uptr *)&buffer[offset];
+        uptr next = (uptr)&buffer[next_offset];
+        *ptr = next;
+    }
+
+    return;
+}
+
+static inline void
+elk_static_pool_reset(ElkStaticPool *pool)
+{
+    Assert(pool && pool->buffer && pool->num_objects && pool->object_size);
+
+    // Initialize the free list to a linked list.
+    elk_static_pool_initialize_linked_list(pool->buffer, pool->object_size, pool->num_objects);
+    pool->free = &pool->buffer[0];
+}
+
+static inline void
+elk_static_pool_create(ElkStaticPool *pool, size object_size, size num_objects, byte buffer[])
+{
+    Assert(object_size >= sizeof(void *));       // Need to be able to fit at least a pointer!
+    Assert(object_size % _Alignof(void *) == 0); // Need for alignment of pointers.
+    Assert(num_objects > 0);
+
+    pool->buffer = buffer;
+    pool->object_size = object_size;
+    pool->num_objects = num_objects;
+
+    elk_static_pool_reset(pool);
+}
+
+static inline void
+elk_static_pool_destroy(ElkStaticPool *pool)
+{
+    memset(pool, 0, sizeof(*pool));
+}
+
+static inline void
+elk_static_pool_free(ElkStaticPool *pool, void *ptr)
+{
+    uptr *next = ptr;
+    *next = (uptr)pool->free;
+    pool->free = ptr;
+}
+
+static inline void *
+elk_static_pool_alloc(ElkStaticPool *pool)
+{
+    void *ptr = pool->free;
+    uptr *next = pool->free;
+
+    if (ptr) 
+    {
+        pool->free = (void *)*next;
+        memset(ptr, 0, pool->object_size);
+    }
+
+    return ptr;
+}
+
+static inline ElkQueueLedger
+elk_queue_ledger_create(size capacity)
+{
+    return (ElkQueueLedger)
+    {
+        .capacity = capacity, 
+        .length = 0,
+        .front = 0, 
+        .back = 0
+    };
+}
+
+static inline b32 
+elk_queue_ledger_full(ElkQueueLedger *queue)
+{ 
+    return queue->length == queue->capacity;
+}
+
+static inline b32
+elk_queue_ledger_empty(ElkQueueLedger *queue)
+{ 
+    return queue->length == 0;
+}
+
+static inline size
+elk_queue_ledger_push_back_index(ElkQueueLedger *queue)
+{
+    if(elk_queue_ledger_full(queue)) { return ELK_COLLECTION_FULL; }
+
+    size idx = queue->back % queue->capacity;
+    queue->back += 1;
+    queue->length += 1;
+    return idx;
+}
+
+static inline size
+elk_queue_ledger_pop_front_index(ElkQueueLedger *queue)
+{
+    if(elk_queue_ledger_empty(queue)) { return ELK_COLLECTION_EMPTY; }
+
+    size idx = queue->front % queue->capacity;
+    queue->front += 1;
+    queue->length -= 1;
+    return idx;
+}
+
+static inline size
+elk_queue_ledger_peek_front_index(ElkQueueLedger *queue)
+{
+    if(queue->length == 0) { return ELK_COLLECTION_EMPTY; }
+    return queue->front % queue->capacity;
+}
+
+static inline size
+elk_queue_ledger_len(ElkQueueLedger const *queue)
+{
+    return queue->length;
+}
+
+static inline ElkArrayLedger
+elk_array_ledger_create(size capacity)
+{
+    Assert(capacity > 0);
+    return (ElkArrayLedger)
+    {
+        .capacity = capacity,
+        .length = 0
+    };
+}
+
+static inline b32 
+elk_array_ledger_full(ElkArrayLedger *array)
+{ 
+    return array->length == array->capacity;
+}
+
+static inline b32
+elk_array_ledger_empty(ElkArrayLedger *array)
+{ 
+    return array->length == 0;
+}
+
+static inline size
+elk_array_ledger_push_back_index(ElkArrayLedger *array)
+{
+    if(elk_array_ledger_full(array)) { return ELK_COLLECTION_FULL; }
+
+    size idx = array->length;
+    array->length += 1;
+    return idx;
+}
+
+static inline size
+elk_array_ledger_pop_back_index(ElkArrayLedger *array)
+{
+    if(elk_array_ledger_empty(array)) { return ELK_COLLECTION_EMPTY; }
+
+    return --array->length;
+}
+
+static inline size
+elk_array_ledger_len(ElkArrayLedger const *array)
+{
+    return array->length;
+}
+
+static inline void
+elk_array_ledger_reset(ElkArrayLedger *array)
+{
+    array->length = 0;
+}
+
+static inline void
+elk_array_ledger_set_capacity(ElkArrayLedger *array, size capacity)
+{
+    Assert(capacity > 0);
+    array->capacity = capacity;
+}
+
+static ElkHashMap 
+elk_hash_map_create(i8 size_exp, ElkSimpleHash key_hash, ElkEqFunction key_eq, ElkStaticArena *arena)
+{
+    Assert(size_exp > 0 && size_exp <= 31); // Come on, 31 is HUGE
+
+    size const handles_len = (size)(1 << size_exp);
+    ElkHashMapHandle *handles = elk_static_arena_nmalloc(arena, handles_len, ElkHashMapHandle);
+    PanicIf(!handles);
+
+    return (ElkHashMap)
+    {
+        .arena = arena,
+        .handles = handles,
+        .num_handles = 0, 
+        .hasher = key_hash,
+        .eq = key_eq,
+        .size_exp = size_exp
+    };
+}
+
+static inline void 
+elk_hash_map_destroy(ElkHashMap *map)
+{
+    return;
+}
+
+static inline void
+elk_hash_table_expand(ElkHashMap *map)
+{
+    i8 const size_exp = map->size_exp;
+    i8 const new_size_exp = size_exp + 1;
+
+    size const handles_len = (size)(1 << size_exp);
+    size const new_handles_len = (size)(1 << new_size_exp);
+
+    ElkHashMapHandle *new_handles = elk_static_arena_nmalloc(map->arena, new_handles_len, ElkHashMapHandle);
+    PanicIf(!new_handles);
+
+    for (u32 i = 0; i < handles_len; i++) 
+    {
+        ElkHashMapHandle *handle = &map->handles[i];
+
+        if (handle->key == NULL) { continue; } // Skip if it's empty
+
+        // Find the position in the new table and update it.
+        u64 const hash = handle->hash;
+        u32 j = hash & 0xffffffff; // truncate
+        while (true) 
+        {
+            j = elk_hash_lookup(hash, new_size_exp, j);
+            ElkHashMapHandle *new_handle = &new_handles[j];
+
+            if (!new_handle->key)
+            {
+                // empty - put it here. Don't need to check for room because we just expanded
+                // the hash table of handles, and we're not copying anything new into storage,
+                // it's already there!
+                *new_handle = *handle;
+                break;
+            }
+        }
+    }
+
+    map->handles = new_handles;
+    map->size_exp = new_size_exp;
+
+    return;
+}
+
+static inline void *
+elk_hash_map_insert(ElkHashMap *map, void *key, void *value)
+{
+    // Inspired by https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+
+    u64 const hash = map->hasher(key);
+    u32 i = hash & 0xffffffff; // truncate
+    while (true)
+    {
+        i = elk_hash_lookup(hash, map->size_exp, i);
+        ElkHashMapHandle *handle = &map->handles[i];
+
+        if (!handle->key)
+        {
+            // empty, insert here if room in the table of handles. Check for room first!
+            if (elk_hash_table_large_enough(map->num_handles, map->size_exp))
+            {
+
+                *handle = (ElkHashMapHandle){.hash = hash, .key=key, .value=value};
+                map->num_handles += 1;
+
+                return handle->value;
+            }
+            else 
+            {
+                // Grow the table so we have room
+                elk_hash_table_expand(map);
+
+                // Recurse because all the state needed by the *_lookup function was just crushed
+                // by the expansion of the table.
+                return elk_hash_map_insert(map, key, value);
+            }
+        }
+        else if (handle->hash == hash && map->eq(handle->key, key)) 
+        {
+            // found it!
+            return handle->value;
+        }
+    }
+
+    return NULL;
+}
+
+static inline void *
+elk_hash_map_lookup(ElkHashMap *map, void *key)
+{
+    // Inspired by https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+
+    u64 const hash = map->hasher(key);
+    u32 i = hash & 0xffffffff; // truncate
+    while (true)
+    {
+        i = elk_hash_lookup(hash, map->size_exp, i);
+        ElkHashMapHandle *handle = &map->handles[i];
+
+        if (!handle->key)
+        {
+            return NULL;
+            
+        }
+        else if (handle->hash == hash && map->eq(handle->key, key)) 
+        {
+            // found it!
+            return handle->value;
+        }
+    }
+
+    return NULL;
+}
+
+static inline size 
+elk_hash_map_len(ElkHashMap *map)
+{
+    return map->num_handles;
+}
+
+static inline ElkHashMapKeyIter 
+elk_hash_map_key_iter(ElkHashMap *map)
+{
+    return 0;
+}
+
+static inline void *
+elk_hash_map_key_iter_next(ElkHashMap *map, ElkHashMapKeyIter *iter)
+{
+    size const max_iter = (size)(1 << map->size_exp);
+    void *next_key = NULL;
+    if(*iter >= max_iter) { return next_key; }
+
+    do
+    {
+        next_key = map->handles[*iter].key;
+        *iter += 1;
+
+    } while(next_key == NULL && *iter < max_iter);
+
+    return next_key;
+}
+
+
+static inline ElkStrMap 
+elk_str_map_create(i8 size_exp, ElkStaticArena *arena)
+{
+    Assert(size_exp > 0 && size_exp <= 31); // Come on, 31 is HUGE
+
+    size const handles_len = (size)(1 << size_exp);
+    ElkStrMapHandle *handles = elk_static_arena_nmalloc(arena, handles_len, ElkStrMapHandle);
+    PanicIf(!handles);
+
+    return (ElkStrMap)
+    {
+        .arena = arena,
+        .handles = handles,
+        .num_handles = 0, 
+        .size_exp = size_exp,
+    };
+}
+
+static inline void
+elk_str_map_destroy(ElkStrMap *map)
+{
+    return;
+}
+
+static inline void
+elk_str_table_expand(ElkStrMap *map)
+{
+    i8 const size_exp = map->size_exp;
+    i8 const new_size_exp = size_exp + 1;
+
+    size const handles_len = (size)(1 << size_exp);
+    size const new_handles_len = (size)(1 << new_size_exp);
+
+    ElkStrMapHandle *new_handles = elk_static_arena_nmalloc(map->arena, new_handles_len, ElkStrMapHandle);
+    PanicIf(!new_handles);
+
+    for (u32 i = 0; i < handles_len; i++) 
+    {
+        ElkStrMapHandle *handle = &map->handles[i];
+
+        if (handle->key.start == NULL) { continue; } // Skip if it's empty
+
+        // Find the position in the new table and update it.
+        u64 const hash = handle->hash;
+        u32 j = hash & 0xffffffff; // truncate
+        while (true) 
+        {
+            j = elk_hash_lookup(hash, new_size_exp, j);
+            ElkStrMapHandle *new_handle = &new_handles[j];
+
+            if (!new_handle->key.start)
+            {
+                // empty - put it here. Don't need to check for room because we just expanded
+                // the hash table of handles, and we're not copying anything new into storage,
+                // it's already there!
+                *new_handle = *handle;
+                break;
+            }
+        }
+    }
+
+    map->handles = new_handles;
+    map->size_exp = new_size_exp;
+
+    return;
+}
+
+
+static inline void *
+elk_str_map_insert(ElkStrMap *map, ElkStr key, void *value)
+{
+    // Inspired by https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+
+    u64 const hash = elk_fnv1a_hash_str(key);
+    u32 i = hash & 0xffffffff; // truncate
+    while (true)
+    {
+        i = elk_hash_lookup(hash, map->size_exp, i);
+        ElkStrMapHandle *handle = &map->handles[i];
+
+        if (!handle->key.start)
+        {
+            // empty, insert here if room in the table of handles. Check for room first!
+            if (elk_hash_table_large_enough(map->num_handles, map->size_exp))
+            {
+
+                *handle = (ElkStrMapHandle){.hash = hash, .key=key, .value=value};
+                map->num_handles += 1;
+
+                return handle->value;
+            }
+            else 
+            {
+                // Grow the table so we have room
+                elk_str_table_expand(map);
+
+                // Recurse because all the state needed by the *_lookup function was just crushed
+                // by the expansion of the table.
+                return elk_str_map_insert(map, key, value);
+            }
+        }
+        else if (handle->hash == hash && elk_str_eq(key, handle->key)) 
+        {
+            // found it! Replace value
+            void *tmp = handle->value;
+            handle->value = value;
+
+            return tmp;
+        }
+    }
+}
+
+static inline void *
+elk_str_map_lookup(ElkStrMap *map, ElkStr key)
+{
+    // Inspired by https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+
+    u64 const hash = elk_fnv1a_hash_str(key);
+    u32 i = hash & 0xffffffff; // truncate
+    while (true)
+    {
+        i = elk_hash_lookup(hash, map->size_exp, i);
+        ElkStrMapHandle *handle = &map->handles[i];
+
+        if (!handle->key.start) { return NULL; }
+        else if (handle->hash == hash && elk_str_eq(key, handle->key)) 
+        {
+            // found it!
+            return handle->value;
+        }
+    }
+
+    return NULL;
+}
+
+static inline ElkStrMapHandle const *
+elk_str_map_lookup_handle(ElkStrMap *map, ElkStr key)
+{
+    // Inspired by https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+
+    u64 const hash = elk_fnv1a_hash_str(key);
+    u32 i = hash & 0xffffffff; // truncate
+    while (true)
+    {
+        i = elk_hash_lookup(hash, map->size_exp, i);
+        ElkStrMapHandle *handle = &map->handles[i];
+
+        if (!handle->key.start) { return NULL; }
+        else if (handle->hash == hash && elk_str_eq(key, handle->key)) 
+        {
+            // found it!
+            return handle;
+        }
+    }
+
+    return NULL;
+}
+
+static inline size
+elk_str_map_len(ElkStrMap *map)
+{
+    return map->num_handles;
+}
+
+static inline ElkHashMapKeyIter 
+elk_str_map_key_iter(ElkStrMap *map)
+{
+    return 0;
+}
+
+static inline ElkStrMapHandleIter 
+elk_str_map_handle_iter(ElkStrMap *map)
+{
+    return 0;
+}
+
+static inline ElkStr 
+elk_str_map_key_iter_next(ElkStrMap *map, ElkStrMapKeyIter *iter)
+{
+    size const max_iter = (size)(1 << map->size_exp);
+    if(*iter < max_iter) 
+    {
+        ElkStr next_key = map->handles[*iter].key;
+        *iter += 1;
+        while(next_key.start == NULL && *iter < max_iter)
+        {
+            next_key = map->handles[*iter].key;
+            *iter += 1;
+        }
+
+        return next_key;
+    }
+    else
+    {
+        return (ElkStr){.start=NULL, .len=0};
+    }
+
+}
+
+static inline ElkStrMapHandle 
+elk_str_map_handle_iter_next(ElkStrMap *map, ElkStrMapHandleIter *iter)
+{
+    size const max_iter = (size)(1 << map->size_exp);
+    if(*iter < max_iter) 
+    {
+        ElkStrMapHandle next = map->handles[*iter];
+        *iter += 1;
+        while(next.key.start == NULL && *iter < max_iter)
+        {
+            next = map->handles[*iter];
+            *iter += 1;
+        }
+
+        return next;
+    }
+    else
+    {
+        return (ElkStrMapHandle){ .key = (ElkStr){.start=NULL, .len=0}, .hash = 0, .value = NULL };
+    }
+}
+
+static inline ElkHashSet 
+elk_hash_set_create(i8 size_exp, ElkSimpleHash val_hash, ElkEqFunction val_eq, ElkStaticArena *arena)
+{
+    Assert(size_exp > 0 && size_exp <= 31); // Come on, 31 is HUGE
+
+    size const handles_len = (size)(1 << size_exp);
+    ElkHashSetHandle *handles = elk_static_arena_nmalloc(arena, handles_len, ElkHashSetHandle);
+    PanicIf(!handles);
+
+    return (ElkHashSet)
+    {
+        .arena = arena,
+        .handles = handles,
+        .num_handles = 0, 
+        .hasher = val_hash,
+        .eq = val_eq,
+        .size_exp = size_exp
+    };
+}
+
+static inline void 
+elk_hash_set_destroy(ElkHashSet *set)
+{
+    return;
+}
+
+static void
+elk_hash_set_expand(ElkHashSet *set)
+{
+    i8 const size_exp = set->size_exp;
+    i8 const new_size_exp = size_exp + 1;
+
+    size const handles_len = (size)(1 << size_exp);
+    size const new_handles_len = (size)(1 << new_size_exp);
+
+    ElkHashSetHandle *new_handles = elk_static_arena_nmalloc(set->arena, new_handles_len, ElkHashSetHandle);
+    PanicIf(!new_handles);
+
+    for (u32 i = 0; i < handles_len; i++) 
+    {
+        ElkHashSetHandle *handle = &set->handles[i];
+
+        if (handle->value == NULL) { continue; } // Skip if it's empty
+
+        // Find the position in the new table and update it.
+        u64 const hash = handle->hash;
+        u32 j = hash & 0xffffffff; // truncate
+        while (true) 
+        {
+            j = elk_hash_lookup(hash, new_size_exp, j);
+            ElkHashSetHandle *new_handle = &new_handles[j];
+
+            if (!new_handle->value)
+            {
+                // empty - put it here. Don't need to check for room because we just expanded
+                // the hash table of handles, and we're not copying anything new into storage,
+                // it's already there!
+                *new_handle = *handle;
+                break;
+            }
+        }
+    }
+
+    set->handles = new_handles;
+    set->size_exp = new_size_exp;
+
+    return;
+}
+
+static inline void *
+elk_hash_set_insert(ElkHashSet *set, void *value)
+{
+    // Inspired by https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+
+    u64 const hash = set->hasher(value);
+    u32 i = hash & 0xffffffff; // truncate
+    while (true)
+    {
+        i = elk_hash_lookup(hash, set->size_exp, i);
+        ElkHashSetHandle *handle = &set->handles[i];
+
+        if (!handle->value)
+        {
+            // empty, insert here if room in the table of handles. Check for room first!
+            if (elk_hash_table_large_enough(set->num_handles, set->size_exp))
+            {
+
+                *handle = (ElkHashSetHandle){.hash = hash, .value=value};
+                set->num_handles += 1;
+
+                return handle->value;
+            }
+            else 
+            {
+                // Grow the table so we have room
+                elk_hash_set_expand(set);
+
+                // Recurse because all the state needed by the *_lookup function was just crushed
+                // by the expansion of the set.
+                return elk_hash_set_insert(set, value);
+            }
+        }
+        else if (handle->hash == hash && set->eq(handle->value, value)) 
+        {
+            // found it!
+            return handle->value;
+        }
+    }
+
+    return NULL;
+}
+
+
+static inline void *
+elk_hash_set_lookup(ElkHashSet *set, void *value)
+{
+    // Inspired by https://nullprogram.com/blog/2022/08/08
+    // All code & writing on this blog is in the public domain.
+
+    u64 const hash = set->hasher(value);
+    u32 i = hash & 0xffffffff; // truncate
+    while (true)
+    {
+        i = elk_hash_lookup(hash, set->size_exp, i);
+        ElkHashSetHandle *handle = &set->handles[i];
+
+        if (!handle->value)
+        {
+            return NULL;
+        }
+        else if (handle->hash == hash && set->eq(handle->value, value)) 
+        {
+            // found it!
+            return handle->value;
+        }
+    }
+
+    return NULL;
+}
+
+static inline size 
+elk_hash_set_len(ElkHashSet *set)
+{
+    return set->num_handles;
+}
+
+static inline ElkHashSetIter
+elk_hash_set_value_iter(ElkHashSet *set)
+{
+    return 0;
+}
+
+static inline void *
+elk_hash_set_value_iter_next(ElkHashSet *set, ElkHashSetIter *iter)
+{
+    size const max_iter = (size)(1 << set->size_exp);
+    void *next_value = NULL;
+    if(*iter >= max_iter) { return next_value; }
+
+    do
+    {
+        next_value = set->handles[*iter].value;
+        *iter += 1;
+
+    } while(next_value == NULL && *iter < max_iter);
+
+    return next_value;
+}
+
+#define ELK_I8_FLIP(x) ((x) ^ UINT8_C(0x80))
+#define ELK_I8_FLIP_BACK(x) ELK_I8_FLIP(x)
+
+#define ELK_I16_FLIP(x) ((x) ^ UINT16_C(0x8000))
+#define ELK_I16_FLIP_BACK(x) ELK_I16_FLIP(x)
+
+#define ELK_I32_FLIP(x) ((x) ^ UINT32_C(0x80000000))
+#define ELK_I32_FLIP_BACK(x) ELK_I32_FLIP(x)
+
+#define ELK_I64_FLIP(x) ((x) ^ UINT64_C(0x8000000000000000))
+#define ELK_I64_FLIP_BACK(x) ELK_I64_FLIP(x)
+
+#define ELK_F32_FLIP(x) ((x) ^ (-(i32)(((u32)(x)) >> 31) | UINT32_C(0x80000000)))
+#define ELK_F32_FLIP_BACK(x) ((x) ^ (((((u32)(x)) >> 31) - 1) | UINT32_C(0x80000000)))
+
+#define ELK_F64_FLIP(x) ((x) ^ (-(i64)(((u64)(x)) >> 63) | UINT64_C(0x8000000000000000)))
+#define ELK_F64_FLIP_BACK(x) ((x) ^ (((((u64)(x)) >> 63) - 1) | UINT64_C(0x8000000000000000)))
+
+static inline void
+elk_radix_pre_sort_transform(void *buffer, size num, size offset, size stride, ElkRadixSortByType sort_type)
+{
+    Assert(
+           sort_type == ELK_RADIX_SORT_UINT64 || sort_type == ELK_RADIX_SORT_INT64 || sort_type == ELK_RADIX_SORT_F64
+        || sort_type == ELK_RADIX_SORT_UINT32 || sort_type == ELK_RADIX_SORT_INT32 || sort_type == ELK_RADIX_SORT_F32
+        || sort_type == ELK_RADIX_SORT_UINT16 || sort_type == ELK_RADIX_SORT_INT16
+        || sort_type == ELK_RADIX_SORT_UINT8  || sort_type == ELK_RADIX_SORT_INT8
+    );
+
+    for(size i = 0; i < num; ++i)
+    {
+        switch(sort_type)
+        {
+            case ELK_RADIX_SORT_F64:
+            {
+                /* Flip bits so doubles sort correctly. */
+                u64 *v = (u64 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_F64_FLIP(*v);
+            } break;
+
+            case ELK_RADIX_SORT_INT64:
+            {
+                /* Flip bits so two's complement signed integers sort correctly. */
+                u64 *v = (u64 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_I64_FLIP(*v);
+            } break;
+
+            case ELK_RADIX_SORT_F32:
+            {
+                /* Flip bits so doubles sort correctly. */
+                u32 *v = (u32 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_F32_FLIP(*v);
+            } break;
+
+            case ELK_RADIX_SORT_INT32:
+            {
+                /* Flip bits so two's complement signed integers sort correctly. */
+                u32 *v = (u32 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_I32_FLIP(*v);
+            } break;
+
+            case ELK_RADIX_SORT_INT16:
+            {
+                /* Flip bits so two's complement signed integers sort correctly. */
+                u16 *v = (u16 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_I16_FLIP(*v);
+            } break;
+
+            case ELK_RADIX_SORT_INT8:
+            {
+                /* Flip bits so two's complement signed integers sort correctly. */
+                u8 *v = (u8 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_I8_FLIP(*v);
+            } break;
+
+            /* Fall through without doing anything. */
+            case ELK_RADIX_SORT_UINT64:
+            case ELK_RADIX_SORT_UINT32:
+            case ELK_RADIX_SORT_UINT16:
+            case ELK_RADIX_SORT_UINT8: {}
+        }
+    }
+}
+
+static inline void
+elk_radix_post_sort_transform(void *buffer, size num, size offset, size stride, ElkRadixSortByType sort_type)
+{
+    Assert(
+           sort_type == ELK_RADIX_SORT_UINT64 || sort_type == ELK_RADIX_SORT_INT64 || sort_type == ELK_RADIX_SORT_F64
+        || sort_type == ELK_RADIX_SORT_UINT32 || sort_type == ELK_RADIX_SORT_INT32 || sort_type == ELK_RADIX_SORT_F32
+        || sort_type == ELK_RADIX_SORT_UINT16 || sort_type == ELK_RADIX_SORT_INT16
+        || sort_type == ELK_RADIX_SORT_UINT8  || sort_type == ELK_RADIX_SORT_INT8
+    );
+
+    for(size i = 0; i < num; ++i)
+    {
+        switch(sort_type)
+        {
+            case ELK_RADIX_SORT_F64:
+            {
+                /* Flip bits so doubles sort correctly. */
+                u64 *v = (u64 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_F64_FLIP_BACK(*v);
+            } break;
+
+            case ELK_RADIX_SORT_INT64:
+            {
+                /* Flip bits so two's complement signed integers sort correctly. */
+                u64 *v = (u64 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_I64_FLIP_BACK(*v);
+            } break;
+
+            case ELK_RADIX_SORT_F32:
+            {
+                /* Flip bits so doubles sort correctly. */
+                u32 *v = (u32 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_F32_FLIP_BACK(*v);
+            } break;
+
+            case ELK_RADIX_SORT_INT32:
+            {
+                /* Flip bits so two's complement signed integers sort correctly. */
+                u32 *v = (u32 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_I32_FLIP_BACK(*v);
+            } break;
+
+            case ELK_RADIX_SORT_INT16:
+            {
+                /* Flip bits so two's complement signed integers sort correctly. */
+                u16 *v = (u16 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_I16_FLIP_BACK(*v);
+            } break;
+
+            case ELK_RADIX_SORT_INT8:
+            {
+                /* Flip bits so two's complement signed integers sort correctly. */
+                u8 *v = (u8 *)((byte *)buffer + offset + i * stride);
+                *v = ELK_I8_FLIP_BACK(*v);
+            } break;
+
+            /* Fall through with no-op */
+            case ELK_RADIX_SORT_UINT64:
+            case ELK_RADIX_SORT_UINT32:
+            case ELK_RADIX_SORT_UINT16:
+            case ELK_RADIX_SORT_UINT8: {}
+        }
+    }
+}
+
+static inline void
+elk_radix_sort_8(void *buffer, size num, size offset, size stride, void *scratch, ElkSortOrder order)
+{
+    i64 counts[256] = {0};
+
+    /* Build the histograms. */
+    byte *position = (byte *)buffer + offset;
+
+    for(size i = 0; i < num; ++i)
+    {
+        u8 b0 = *(u8 *)position;
+        counts[b0] += 1;
+        position += stride;
+    }
+
+    /* Sum the histograms. */
+    if(order == ELK_SORT_ASCENDING)
+    {
+        for(size i = 1; i < 256; ++i)
+        {
+            counts[i] += counts[i - 1];
+        }
+    }
+    else
+    {
+        for(size i = 254; i >= 0; --i)
+        {
+            counts[i] += counts[i + 1];
+        }
+    }
+
+    /* Build the output array. */
+    void *dest = scratch;
+    void *source = buffer;
+    for(size i = num - 1; i >= 0; --i)
+    {
+        void *val_src = (byte *)source + i * stride;
+        u8 cnts_idx = *((u8 *)val_src + offset);
+        void *val_dest = (byte *)dest + (--counts[cnts_idx]) * stride;
+
+        memcpy(val_dest, val_src, stride);
+    }
+
+    /* Copy back to the original buffer. */
+    memcpy(buffer, scratch, stride * num);
+}
+
+static inline void
+elk_radix_sort_16(void *buffer, size num, size offset, size stride, void *scratch, ElkSortOrder order)
+{
+    i64 counts[256][2] = {0};
+    i32 skips[2] = {1, 1};
+
+    /* Build the histograms. */
+    byte *position = (byte *)buffer + offset;
+
+    u16 val = *(u16 *)position;
+    u8 b0 = UINT16_C(0xFF) & (val >>  0);
+    u8 b1 = UINT16_C(0xFF) & (val >>  8);
+
+    counts[b0][0] += 1;
+    counts[b1][1] += 1;
+
+    position += stride;
+
+    u8 initial_values[2] = {b0, b1};
+
+    for(size i = 1; i < num; ++i)
+    {
+        val = *(u16 *)position;
+        b0 = UINT16_C(0xFF) & (val >>  0);
+        b1 = UINT16_C(0xFF) & (val >>  8);
+
+        counts[b0][0] += 1;
+        counts[b1][1] += 1;
+
+        skips[0] &= initial_values[0] == b0;
+        skips[1] &= initial_values[1] == b1;
+
+        position += stride;
+    }
+
+    /* Sum the histograms. */
+    if(order == ELK_SORT_ASCENDING)
+    {
+        for(size i = 1; i < 256; ++i)
+        {
+            counts[i][0] += counts[i - 1][0];
+            counts[i][1] += counts[i - 1][1];
+        }
+    }
+    else
+    {
+        for(size i = 254; i >= 0; --i)
+        {
+            counts[i][0] += counts[i + 1][0];
+            counts[i][1] += counts[i + 1][1];
+        }
+    }
+
+    /* Build the output array. */
+    void *dest = scratch;
+    void *source = buffer;
+    size num_skips = 0;
+    for(size b = 0; b < 2; ++b)
+    {
+        if(!skips[b])
+        {
+            for(size i = num - 1; i >= 0; --i)
+            {
+                void *val_src = (byte *)source + i * stride;
+                u16 val = *(u16 *)((byte *)val_src + offset);
+                u8 cnts_idx = UINT16_C(0xFF) & (val >> (b * 8));
+                void *val_dest = (byte *)dest + (--counts[cnts_idx][b]) * stride;
+
+                memcpy(val_dest, val_src, stride);
+            }
+
+            /* Flip the source & destination buffers. */
+            dest = dest == scratch ? buffer : scratch;
+            source = source == scratch ? buffer : scratch;
+        }
+        else
+        {
+            num_skips++;
+        }
+    }
+
+    /* Swap back into the original buffer. */
+    if(num_skips % 2)
+    {
+        memcpy(buffer, scratch, num * stride);
+    }
+}
+
+static inline void
+elk_radix_sort_32(void *buffer, size num, size offset, size stride, void *scratch, ElkSortOrder order)
+{
+    i64 counts[256][4] = {0};
+    i32 skips[4] = {1, 1, 1, 1};
+
+    /* Build the histograms. */
+    byte *position = (byte *)buffer + offset;
+
+    u32 val = *(u32 *)position;
+    u8 b0 = UINT32_C(0xFF) & (val >>  0);
+    u8 b1 = UINT32_C(0xFF) & (val >>  8);
+    u8 b2 = UINT32_C(0xFF) & (val >> 16);
+    u8 b3 = UINT32_C(0xFF) & (val >> 24);
+
+    counts[b0][0] += 1;
+    counts[b1][1] += 1;
+    counts[b2][2] += 1;
+    counts[b3][3] += 1;
+
+    position += stride;
+
+    u8 initial_values[4] = {b0, b1, b2, b3};
+
+    for(size i = 1; i < num; ++i)
+    {
+        val = *(u32 *)position;
+        b0 = UINT32_C(0xFF) & (val >>  0);
+        b1 = UINT32_C(0xFF) & (val >>  8);
+        b2 = UINT32_C(0xFF) & (val >> 16);
+        b3 = UINT32_C(0xFF) & (val >> 24);
+
+        counts[b0][0] += 1;
+        counts[b1][1] += 1;
+        counts[b2][2] += 1;
+        counts[b3][3] += 1;
+
+        skips[0] &= initial_values[0] == b0;
+        skips[1] &= initial_values[1] == b1;
+        skips[2] &= initial_values[2] == b2;
+        skips[3] &= initial_values[3] == b3;
+
+        position += stride;
+    }
+
+    /* Sum the histograms. */
+    if(order == ELK_SORT_ASCENDING)
+    {
+        for(size i = 1; i < 256; ++i)
+        {
+            counts[i][0] += counts[i - 1][0];
+            counts[i][1] += counts[i - 1][1];
+            counts[i][2] += counts[i - 1][2];
+            counts[i][3] += counts[i - 1][3];
+        }
+    }
+    else
+    {
+        for(size i = 254; i >= 0; --i)
+        {
+            counts[i][0] += counts[i + 1][0];
+            counts[i][1] += counts[i + 1][1];
+            counts[i][2] += counts[i + 1][2];
+            counts[i][3] += counts[i + 1][3];
+        }
+    }
+
+    /* Build the output array. */
+    void *dest = scratch;
+    void *source = buffer;
+    size num_skips = 0;
+    for(size b = 0; b < 4; ++b)
+    {
+        if(!skips[b])
+        {
+            for(size i = num - 1; i >= 0; --i)
+            {
+                void *val_src = (byte *)source + i * stride;
+                u32 val = *(u32 *)((byte *)val_src + offset);
+                u8 cnts_idx = UINT32_C(0xFF) & (val >> (b * 8));
+                void *val_dest = (byte *)dest + (--counts[cnts_idx][b]) * stride;
+
+                memcpy(val_dest, val_src, stride);
+            }
+
+            /* Flip the source & destination buffers. */
+            dest = dest == scratch ? buffer : scratch;
+            source = source == scratch ? buffer : scratch;
+        }
+        else
+        {
+            num_skips++;
+        }
+    }
+
+    /* Swap back into the original buffer. */
+    if(num_skips % 2)
+    {
+        memcpy(buffer, scratch, num * stride);
+    }
+}
+
+static inline void
+elk_radix_sort_64(void *buffer, size num, size offset, size stride, void *scratch, ElkSortOrder order)
+{
+    i64 counts[256][8] = {0};
+    i32 skips[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+
+    /* Build the histograms. */
+    byte *position = (byte *)buffer + offset;
+
+    u64 val = *(u64 *)position;
+    u8 b0 = UINT64_C(0xFF) & (val >>  0);
+    u8 b1 = UINT64_C(0xFF) & (val >>  8);
+    u8 b2 = UINT64_C(0xFF) & (val >> 16);
+    u8 b3 = UINT64_C(0xFF) & (val >> 24);
+    u8 b4 = UINT64_C(0xFF) & (val >> 32);
+    u8 b5 = UINT64_C(0xFF) & (val >> 40);
+    u8 b6 = UINT64_C(0xFF) & (val >> 48);
+    u8 b7 = UINT64_C(0xFF) & (val >> 56);
+
+    counts[b0][0] += 1;
+    counts[b1][1] += 1;
+    counts[b2][2] += 1;
+    counts[b3][3] += 1;
+    counts[b4][4] += 1;
+    counts[b5][5] += 1;
+    counts[b6][6] += 1;
+    counts[b7][7] += 1;
+
+    position += stride;
+
+    u8 initial_values[8] = {b0, b1, b2, b3, b4, b5, b6, b7};
+
+    for(size i = 1; i < num; ++i)
+    {
+        val = *(u64 *)position;
+        b0 = UINT64_C(0xFF) & (val >>  0);
+        b1 = UINT64_C(0xFF) & (val >>  8);
+        b2 = UINT64_C(0xFF) & (val >> 16);
+        b3 = UINT64_C(0xFF) & (val >> 24);
+        b4 = UINT64_C(0xFF) & (val >> 32);
+        b5 = UINT64_C(0xFF) & (val >> 40);
+        b6 = UINT64_C(0xFF) & (val >> 48);
+        b7 = UINT64_C(0xFF) & (val >> 56);
+
+        counts[b0][0] += 1;
+        counts[b1][1] += 1;
+        counts[b2][2] += 1;
+        counts[b3][3] += 1;
+        counts[b4][4] += 1;
+        counts[b5][5] += 1;
+        counts[b6][6] += 1;
+        counts[b7][7] += 1;
+
+        skips[0] &= initial_values[0] == b0;
+        skips[1] &= initial_values[1] == b1;
+        skips[2] &= initial_values[2] == b2;
+        skips[3] &= initial_values[3] == b3;
+        skips[4] &= initial_values[4] == b4;
+        skips[5] &= initial_values[5] == b5;
+        skips[6] &= initial_values[6] == b6;
+        skips[7] &= initial_values[7] == b7;
+
+        position += stride;
+    }
+
+    /* Sum the histograms. */
+    if(order == ELK_SORT_ASCENDING)
+    {
+        for(size i = 1; i < 256; ++i)
+        {
+            counts[i][0] += counts[i - 1][0];
+            counts[i][1] += counts[i - 1][1];
+            counts[i][2] += counts[i - 1][2];
+            counts[i][3] += counts[i - 1][3];
+            counts[i][4] += counts[i - 1][4];
+            counts[i][5] += counts[i - 1][5];
+            counts[i][6] += counts[i - 1][6];
+            counts[i][7] += counts[i - 1][7];
+        }
+    }
+    else
+    {
+        for(size i = 254; i >= 0; --i)
+        {
+            counts[i][0] += counts[i + 1][0];
+            counts[i][1] += counts[i + 1][1];
+            counts[i][2] += counts[i + 1][2];
+            counts[i][3] += counts[i + 1][3];
+            counts[i][4] += counts[i + 1][4];
+            counts[i][5] += counts[i + 1][5];
+            counts[i][6] += counts[i + 1][6];
+            counts[i][7] += counts[i + 1][7];
+        }
+    }
+
+    /* Build the output array. */
+    void *dest = scratch;
+    void *source = buffer;
+    size num_skips = 0;
+    for(size b = 0; b < 8; ++b)
+    {
+        if(!skips[b])
+        {
+            for(size i = num - 1; i >= 0; --i)
+            {
+                void *val_src = (byte *)source + i * stride;
+                u64 val = *(u64 *)((byte *)val_src + offset);
+                u8 cnts_idx = UINT64_C(0xFF) & (val >> (b * 8));
+                void *val_dest = (byte *)dest + (--counts[cnts_idx][b]) * stride;
+
+                memcpy(val_dest, val_src, stride);
+            }
+
+            /* Flip the source & destination buffers. */
+            dest = dest == scratch ? buffer : scratch;
+            source = source == scratch ? buffer : scratch;
+        }
+        else
+        {
+            num_skips++;
+        }
+    }
+
+    /* Swap back into the original buffer. */
+    if(num_skips % 2)
+    {
+        memcpy(buffer, scratch, num * stride);
+    }
+}
+
+static inline void
+elk_radix_sort(void *buffer, size num, size offset, size stride, void *scratch, ElkRadixSortByType sort_type, ElkSortOrder order)
+{
+    elk_radix_pre_sort_transform(buffer, num, offset, stride, sort_type);
+
+    switch(sort_type)
+    {
+        case ELK_RADIX_SORT_UINT64:
+        case ELK_RADIX_SORT_INT64:
+        case ELK_RADIX_SORT_F64:
+        {
+            elk_radix_sort_64(buffer, num, offset, stride, scratch, order);
+        } break;
+
+        case ELK_RADIX_SORT_UINT32:
+        case ELK_RADIX_SORT_INT32:
+        case ELK_RADIX_SORT_F32:
+        {
+            elk_radix_sort_32(buffer, num, offset, stride, scratch, order);
+        } break;
+
+        case ELK_RADIX_SORT_UINT16:
+        case ELK_RADIX_SORT_INT16:
+        {
+            elk_radix_sort_16(buffer, num, offset, stride, scratch, order);
+        } break;
+
+        case ELK_RADIX_SORT_UINT8:
+        case ELK_RADIX_SORT_INT8:
+        {
+            elk_radix_sort_8(buffer, num, offset, stride, scratch, order);
+        } break;
+
+        default: Panic();
+    }
+    
+    elk_radix_post_sort_transform(buffer, num, offset, stride, sort_type);
+}
+
+static inline b32
+elk_time_index_create(ElkTime const *sorted_times, size n, ElkStaticArena *arena, ElkTimeIndex *index)
+{
+    /* Build the levels from the bottom up, the keys of a level are the first time under each node of the level below. The
+     * padding keys are INT64_MAX, which never compare less than anything.
+     */
+    Assert(n >= 0);
+
+    *index = (ElkTimeIndex){ .times = sorted_times, .n = n };
+
+    size const num_leaves = (n + 7) / 8;
+    size level_nodes[ELK_TIME_INDEX_MAX_LEVELS] = {0};
+    size total_keys = 0;
+    i32 num_levels = 0;
+    for(size below = num_leaves; below > 1; below = level_nodes[num_levels - 1])
+    {
+        PanicIf(num_levels == ELK_TIME_INDEX_MAX_LEVELS);
+        level_nodes[num_levels] = (below + 7) / 8;
+        total_keys += 8 * level_nodes[num_levels];
+        num_levels++;
+    }
+
+    ElkTime *keys = NULL;
+    if(total_keys > 0)
+    {
+        keys = elk_static_arena_alloc(arena, total_keys * (size)sizeof(ElkTime), 64);
+        StopIf(!keys, return false);
+    }
+
+    /* level_nodes is bottom up, but levels[] is top down. */
+    index->num_levels = num_levels;
+    for(i32 l = num_levels - 1; l >= 0; --l)
+    {
+        i32 const level = num_levels - 1 - l;
+        index->levels[level] = keys;
+
+        size const stride = (size)1 << (3 * (l + 1));  // Times under each key.
+        for(size k = 0; k < 8 * level_nodes[l]; ++k)
+        {
+            keys[k] = k * stride < n ? sorted_times[k * stride] : INT64_MAX;
+        }
+        keys += 8 * level_nodes[l];
+    }
+
+    for(size i = 0; i < 8; ++i)
+    {
+        size const pos = (num_leaves - 1) * 8 + i;
+        index->last_leaf[i] = n > 0 && pos < n ? sorted_times[pos] : INT64_MAX;
+    }
+
+    return true;
+}
+
+static inline i32
+elk_time_index_helper_count_less_scalar(ElkTime const *keys, ElkTime t)
+{
+    i32 count = 0;
+    for(i32 i = 0; i < 8; ++i) { count += keys[i] < t; }
+    return count;
+}
+
+ELK_TARGET("avx2")
+static inline i32
+elk_time_index_helper_count_less_avx2(ElkTime const *keys, ElkTime t)
+{
+    __m256i const target = _mm256_set1_epi64x(t);
+    __m256i const lo = _mm256_cmpgt_epi64(target, _mm256_loadu_si256((__m256i const *)keys));
+    __m256i const hi = _mm256_cmpgt_epi64(target, _mm256_loadu_si256((__m256i const *)(keys + 4)));
+    u32 const mask = (u32)_mm256_movemask_pd(_mm256_castsi256_pd(lo)) | ((u32)_mm256_movemask_pd(_mm256_castsi256_pd(hi)) << 4);
+    return elk_bit_popcount32(mask);
+}
+
+static inline i32
+elk_time_index_helper_count_less(ElkTime const *keys, ElkTime t)
+{
+#if __AVX2__
+    return elk_time_index_helper_count_less_avx2(keys, t);
+#else
+    return elk_time_index_helper_count_less_scalar(keys, t);
+#endif
+}
+
+static inline size
+elk_time_index_lower_bound(ElkTimeIndex const *index, ElkTime t)
+{
+    /* At each level go to the last child whose first time is before t. Everything under the children before it is before
+     * t too, and the first time under the next child isn't, so the answer is under that child or at the start of the
+     * next one, which is where a search that runs off the end of the child ends up.
+     */
+    StopIf(index->n == 0, return 0);
+
+    size node = 0;
+    for(i32 level = 0; level < index->num_levels; ++level)
+    {
+        i32 const count = elk_time_index_helper_count_less(index->levels[level] + 8 * node, t);
+        node = 8 * node + (count > 0 ? count - 1 : 0);
+    }
+
+    ElkTime const *leaf = node == (index->n - 1) / 8 ? index->last_leaf : index->times + 8 * node;
+    size const pos = 8 * node + elk_time_index_helper_count_less(leaf, t);
+    return pos < index->n ? pos : index->n;
+}
+
+static inline size
+elk_time_index_upper_bound(ElkTimeIndex const *index, ElkTime t)
+{
+    /* The first time after t is the first time not before t + 1. */
+    StopIf(t == INT64_MAX, return index->n);
+    return elk_time_index_lower_bound(index, t + 1);
+}
+
+static inline size
+elk_time_index_as_of(ElkTimeIndex const *index, ElkTime t)
+{
+    return elk_time_index_upper_bound(index, t) - 1;
+}
+
+static inline size
+elk_time_as_of_join(ElkTime const *left, size n_left, ElkTime const *right, size n_right, ElkTimeDiff tolerance,
+        size *matches)
+{
+    Assert(tolerance >= 0);
+
+    size num_matches = 0;
+    size next = 0; // The first right time after the current left time.
+    for(size i = 0; i < n_left; ++i)
+    {
+        ElkTime const t = left[i];
+        Assert(i == 0 || left[i - 1] <= t);
+
+        /* Gallop forward to bracket the next right time after t, then binary search between the last two steps. */
+        if(next < n_right && right[next] <= t)
+        {
+            size lo = next;
+            size step = 1;
+            while(lo + step < n_right && right[lo + step] <= t)
+            {
+                lo += step;
+                step *= 2;
+            }
+
+            size hi = lo + step < n_right ? lo + step : n_right;
+            while(hi - lo > 1)
+            {
+                size const mid = lo + (hi - lo) / 2;
+                if(right[mid] <= t) { lo = mid; }
+                else { hi = mid; }
+            }
+            next = hi;
+        }
+
+        size const match = next - 1;
+        b32 const found = match >= 0 && t - right[match] <= tolerance;
+        matches[i] = found ? match : -1;
+        num_matches += found;
+    }
+
+    return num_matches;
+}
+
+static inline u32
+elk_csv_helper_prefix_xor32(u32 bits)
+{
+    /* Each bit becomes the XOR of itself and every bit below it. For quote bits, this sets every bit from an opening quote
+     * up to (but not including) the closing quote. */
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    return bits;
+}
+
+static inline void
+elk_csv_helper_scan_block(char const *block, ElkCsvDialect dialect, u32 *quote_bits, u32 *comma_bits, u32 *newline_bits)
+{
+    char const chars[4] = { dialect.quote, dialect.delimiter, '\n', dialect.comment };
+    u32 bits[4] = {0};
+    elk_scan_chars(block, chars, bits);
+
+    *quote_bits = bits[0];
+    *comma_bits = bits[1];
+    *newline_bits = bits[2];
+}
+
+static inline void
+elk_csv_helper_parser_scan_block(ElkCsvParser const *p, char const *block, u32 *quote_bits, u32 *comma_bits, u32 *newline_bits)
+{
+    char const chars[4] = { p->dialect.quote, p->dialect.delimiter, '\n', p->dialect.comment };
+    u32 bits[4] = {0};
+#if __AVX2__
+    elk_scan_chars_avx2(block, chars, bits);
+#else
+    p->scan_chars(block, chars, bits);
+#endif
+
+    *quote_bits = bits[0];
+    *comma_bits = bits[1];
+    *newline_bits = bits[2];
+}
+
+static inline void elk_csv_helper_load_new_buffer_aligned(ElkCsvParser *p, i8 skip_bytes);
+static inline ElkCsvParser elk_csv_helper_create_parser(ElkStr input, ElkCsvDialect dialect, ElkScanCharsFunction scan_chars,
+                                                        b32 skip_comments);
+
+static inline size
+elk_csv_helper_strip_cr(ElkCsvParser const *p, char const *value, size len)
+{
+    /* With CRLF line endings, the carriage return ends up at the end of the last value in the row. */
+    return len - (p->dialect.crlf && len > 0 && value[len - 1] == '\r');
+}
+
+static inline ElkCsvParser 
+elk_csv_create_parser(ElkStr input)
+{
+    return elk_csv_create_parser_dispatch(input, NULL);
+}
+
+static inline ElkCsvParser 
+elk_csv_create_parser_dispatch(ElkStr input, ElkDispatch const *dispatch)
+{
+    return elk_csv_create_parser_dialect(input, ELK_CSV_DIALECT_DEFAULT, dispatch);
+}
+
+static inline ElkCsvParser 
+elk_csv_create_parser_dialect(ElkStr input, ElkCsvDialect dialect, ElkDispatch const *dispatch)
+{
+    ElkScanCharsFunction scan_chars = dispatch ? dispatch->scan_chars : elk_scan_chars_default();
+    return elk_csv_helper_create_parser(input, dialect, scan_chars, true);
+}
+
+static inline ElkCsvParser 
+elk_csv_helper_create_parser(ElkStr input, ElkCsvDialect dialect, ElkScanCharsFunction scan_chars, b32 skip_comments)
+{
+    ElkCsvParser parser = { .remaining=input, .row=0, .col=0, .error=false, .dialect=dialect, .scan_chars=scan_chars };
+
+    // Scan past leading comment lines.
+    while(skip_comments && parser.remaining.len > 0 && *parser.remaining.start == dialect.comment)
+    {
+        // We must be on a comment line if we got here, so read just past the end of the line
+        while(*parser.remaining.start && parser.remaining.len > 0)
+        {
+            char last_char = *parser.remaining.start;
+            ++parser.remaining.start;
+            --parser.remaining.len;
+            if(last_char == '\n') { break; }
+        }
+    }
+
+    i8 skip_bytes = (i8)((uptr)parser.remaining.start - ((uptr)parser.remaining.start & ~0x1F));
+    parser.remaining.start = (char *)((uptr)parser.remaining.start & ~0x1F); /* Force 32 byte alignment */
+    parser.carry = 0;
+    if(parser.remaining.len > 0) { elk_csv_helper_load_new_buffer_aligned(&parser, skip_bytes); }
+    else { parser.remaining.start += skip_bytes; }
+
+    return parser;
+}
+
+static inline b32 
+elk_csv_finished(ElkCsvParser *parser)
+{
+    return parser->error || parser->remaining.len == 0;
+}
+
+static inline ElkCsvToken 
+elk_csv_full_next_token(ElkCsvParser *parser)
+{
+    StopIf(elk_csv_finished(parser), goto ERR_RETURN);
+
+    // Current position in parser and how much we've processed
+    char *next_char = parser->remaining.start;
+    int num_chars_proc = 0;
+    size row = parser->row;
+    size col = parser->col;
+
+    // Handle comment lines
+    while(col == 0 && *next_char == parser->dialect.comment)
+    {
+        // We must be on a comment line if we got here, so read just past the end of the line
+        
+        while(*next_char && parser->remaining.len - num_chars_proc > 0)
+        {
+            char *last_char = next_char;
+            ++next_char;
+            ++num_chars_proc;
+            if(*last_char == '\n') { break; }
+        }
+    }
+
+    // The data for the next value to return
+    char *next_value_start = next_char;
+    size next_value_len = 0;
+
+    // Are we in a quoted string where we should ignore commas?
+    b32 stop = false;
+    u32 carry = 0;
+
+    /* Do SIMD */
+    while(!stop && parser->remaining.len > num_chars_proc + 32)
+    {
+        u32 quote_bits = 0;
+        u32 comma_bits = 0;
+        u32 newline_bits = 0;
+        elk_csv_helper_parser_scan_block(parser, next_char, &quote_bits, &comma_bits, &newline_bits);
+
+        u32 in_quotes = elk_csv_helper_prefix_xor32(quote_bits) ^ carry;
+        carry = -(in_quotes >> 31);
+
+        comma_bits &= ~in_quotes;
+        newline_bits &= ~in_quotes;
+        u32 comma_or_newline_bits = comma_bits | newline_bits;
+
+        i32 bit_pos = comma_or_newline_bits ? elk_bit_count_trailing_zeros32(comma_or_newline_bits) : 31;
+
+        b32 comma = (comma_bits >> bit_pos) & 1;
+        b32 newline = (newline_bits >> bit_pos) & 1;
+        b32 comma_or_newline = (comma_or_newline_bits >> bit_pos) & 1;
+
+        parser->row += newline;
+        parser->col += -col * newline + comma;
+        next_value_len += bit_pos + 1 - comma_or_newline;
+
+        next_char += bit_pos + 1 ;
+        num_chars_proc += bit_pos + 1 ;
+
+        stop = comma_or_newline;
+    }
+
+    /* Finish up when not 32 remaining. */
+    b32 in_string = carry > 0;
+    while(!stop && parser->remaining.len > num_chars_proc)
+    {
+        char const c = *next_char;
+        if(c == parser->dialect.quote)
+        {
+            in_string = !in_string;
+        }
+        else if(c == '\n' && !in_string)
+        {
+            parser->row += 1;
+            parser->col = 0;
+            --next_value_len;
+            stop = true;
+        }
+        else if(c == parser->dialect.delimiter && !in_string)
+        {
+            parser->col += 1;
+            --next_value_len;
+            stop = true;
+        }
+
+        ++next_value_len;
+        ++next_char;
+        ++num_chars_proc;
+    }
+
+    /* Running out of input without a delimiter ends the row too, so a trailing '\r' comes off the last value. */
+    b32 const row_ended = parser->row != row || !stop;
+    if(row_ended) { next_value_len = elk_csv_helper_strip_cr(parser, next_value_start, next_value_len); }
+
+    parser->remaining.start = next_char;
+    parser->remaining.len -= num_chars_proc;
+
+    return (ElkCsvToken){ .row=row, .col=col, .value=(ElkStr){ .start=next_value_start, .len=next_value_len }};
+
+ERR_RETURN:
+    parser->error = true;
+    return (ElkCsvToken){ .row=parser->row, .col=parser->col, .value=(ElkStr){.start=parser->remaining.start, .len=0}};
+}
+
+static inline void
+elk_csv_helper_load_new_buffer_aligned(ElkCsvParser *p, i8 skip_bytes)
+{
+    Assert((uptr)p->remaining.start % 32 == 0); /* Always aligned on a 32 byte boundary. */
+    Assert(skip_bytes >= 0 && skip_bytes < 32);
+
+    u32 quote_bits = 0;
+    u32 comma_bits = 0;
+    u32 newline_bits = 0;
+    elk_csv_helper_parser_scan_block(p, p->remaining.start, &quote_bits, &comma_bits, &newline_bits);
+
+    /* Ignore any leading bytes that come before the start of the string so they don't accidently match a delimiter. */
+    u32 valid_bits = UINT32_MAX << skip_bytes;
+
+    /* If at the end of the string, no worries just force all trailing bytes in the buffer to be delimiters. */
+    u32 past_end_bits = 0;
+    size const end = skip_bytes + p->remaining.len;
+    if(end < 32)
+    {
+        Assert(end > skip_bytes);
+        past_end_bits = UINT32_MAX << end;
+        valid_bits &= ~past_end_bits;
+    }
+
+    quote_bits &= valid_bits;
+    comma_bits &= valid_bits;
+    newline_bits &= valid_bits;
+
+    /* Create a running mask that is set for every byte inside a quoted string, carried over from the previous buffer. */
+    u32 in_quotes = elk_csv_helper_prefix_xor32(quote_bits) ^ p->carry;
+    p->carry = -(in_quotes >> 31);
+
+    p->buf_comma_bits = comma_bits & ~in_quotes;
+    p->buf_newline_bits = (newline_bits & ~in_quotes) | past_end_bits;
+    p->buf_any_delimiter_bits = p->buf_comma_bits | p->buf_newline_bits;
+
+    p->remaining.start += skip_bytes;
+    p->byte_pos = skip_bytes;
+}
+
+static inline ElkCsvToken 
+elk_csv_fast_next_token(ElkCsvParser *parser)
+{
+    size row = parser->row;
+    size col = parser->col;
+
+    StopIf(elk_csv_finished(parser), goto ERR_RETURN);
+
+    char *start = parser->remaining.start;
+    size next_value_len = 0;
+    b32 stop = false;
+    
+    /* Stop will signal when a new delimiter is found, but we may need to process a few buffers worth of data to find one. */
+    while(!stop)
+    {
+        u32 any_delim = parser->buf_any_delimiter_bits;
+
+        /* Find the position of the next delimiter or the end of the buffer */
+        u32 first_non_zero_bit_lsb = any_delim & ~(any_delim - 1);
+        i32 bit_pos = any_delim ? elk_bit_count_trailing_zeros32(any_delim) : 31;
+        i32 run_len = bit_pos - parser->byte_pos;
+
+        /* Detect type of delimiter, or maybe no delimiter and end of buffer. */
+        b32 comma = (parser->buf_comma_bits >> bit_pos) & 1;
+        b32 newline = (parser->buf_newline_bits >> bit_pos) & 1;
+        b32 comma_or_newline = (any_delim >> bit_pos) & 1;
+
+        /* Turn off that bit so we don't find it again! This delimiter has been processed. */
+        parser->buf_comma_bits &= ~first_non_zero_bit_lsb;
+        parser->buf_newline_bits &= ~first_non_zero_bit_lsb;
+        parser->buf_any_delimiter_bits &= ~first_non_zero_bit_lsb;
+
+        /* Update parser state based on position of next delimiter, or end of buffer. */
+        parser->row += newline;
+        parser->col += -col * newline + comma;
+        next_value_len += run_len + 1 - comma_or_newline;
+        parser->remaining.start += run_len + 1;
+        parser->remaining.len -= run_len + 1;
+        parser->remaining.len = parser->remaining.len < 0 ? 0 : parser->remaining.len; /* Last row w/o a newline. */
+        parser->byte_pos = bit_pos + 1;
+
+        /* Signal need to stop if we found a delimiter */
+        stop = comma_or_newline;
+
+        /* If we finished the buffer and need to scan the next one, load a new buffer! */
+        if(bit_pos + 1 > 31)
+        {
+            if(parser->remaining.len > 0)
+            {
+                elk_csv_helper_load_new_buffer_aligned(parser, 0);
+            }
+            else
+            {
+                /* The input ended at the end of the buffer without a newline, but that still ends the row. */
+                parser->row += !comma_or_newline;
+                parser->col *= comma_or_newline;
+                stop = true;
+            }
         }
     }
 
-    /* Build the output array. */
-    void *dest = scratch;
-    void *source = buffer;
-    for(size i = num - 1; i >= 0; --i)
-    {
-        void *val_src = (byte *)source + i * stride;
-        u8 cnts_idx = *((u8 *)val_src + offset);
-        void *val_dest = (byte *)dest + (--counts[cnts_idx]) * stride;
+    if(parser->row != row) { next_value_len = elk_csv_helper_strip_cr(parser, start, next_value_len); }
 
-        memcpy(val_dest, val_src, stride);
-    }
+    return (ElkCsvToken){ .row=row, .col=col, .value=(ElkStr){.start=start, .len=next_value_len}};
 
-    /* Copy back to the original buffer. */
-    memcpy(buffer, scratch, stride * num);
+ERR_RETURN:
+    parser->error = true;
+    return (ElkCsvToken){ .row=row, .col=col, .value=(ElkStr){.start=parser->remaining.start, .len=0}};
 }
 
 static inline void
-elk_radix_sort_16(void *buffer, size num, size offset, size stride, void *scratch, ElkSortOrder order)
-{
-    i64 counts[256][2] = {0};
-    i32 skips[2] = {1, 1};
-
-    /* Build the histograms. */
-    byte *position = (byte *)buffer + offset;
+elk_csv_helper_end_row(ElkCsvParser *parser, char *block, i32 pos)
+{
+    /* The row ended at the delimiter at pos in the current buffer, so set up the parser to start on the next row. */
+    u32 const later_bits = pos >= 31 ? 0 : UINT32_MAX << (pos + 1);
+    parser->buf_comma_bits &= later_bits;
+    parser->buf_newline_bits &= later_bits;
+    parser->buf_any_delimiter_bits &= later_bits;
+
+    char *const next = block + pos + 1;
+    parser->remaining.len -= next - parser->remaining.start;
+    parser->remaining.len = parser->remaining.len < 0 ? 0 : parser->remaining.len; /* Last row w/o a newline. */
+    parser->remaining.start = next;
+    parser->byte_pos = pos + 1;
+    if(parser->byte_pos > 31 && parser->remaining.len > 0) { elk_csv_helper_load_new_buffer_aligned(parser, 0); }
+
+    parser->row += 1;
+    parser->col = 0;
+}
 
-    u16 val = *(u16 *)position;
-    u8 b0 = UINT16_C(0xFF) & (val >>  0);
-    u8 b1 = UINT16_C(0xFF) & (val >>  8);
+static inline b32
+elk_csv_helper_next_buffer(ElkCsvParser *parser, char *block)
+{
+    /* Move on to the buffer after block, returns false if the input ended at the end of block. That still ends the row. */
+    parser->remaining.len -= block + 32 - parser->remaining.start;
+    parser->remaining.start = block + 32;
+    parser->byte_pos = 32;
 
-    counts[b0][0] += 1;
-    counts[b1][1] += 1;
+    if(parser->remaining.len <= 0)
+    {
+        parser->remaining.len = 0;
+        parser->row += 1;
+        parser->col = 0;
+        return false;
+    }
 
-    position += stride;
+    elk_csv_helper_load_new_buffer_aligned(parser, 0);
+    return true;
+}
 
-    u8 initial_values[2] = {b0, b1};
+static inline size
+elk_csv_next_row(ElkCsvParser *parser, size max_fields, ElkStr *fields)
+{
+    StopIf(elk_csv_finished(parser), goto ERR_RETURN);
 
-    for(size i = 1; i < num; ++i)
+    size num_fields = 0;
+    char *field_start = parser->remaining.start;
+    char *const end = parser->remaining.start + parser->remaining.len;
+    while(true)
     {
-        val = *(u16 *)position;
-        b0 = UINT16_C(0xFF) & (val >>  0);
-        b1 = UINT16_C(0xFF) & (val >>  8);
+        /* Walk every delimiter left in the buffer, the bits for delimiters already consumed have been cleared. */
+        char *const block = parser->remaining.start - parser->byte_pos;
+        u32 delims = parser->buf_any_delimiter_bits;
+        while(delims)
+        {
+            i32 const pos = elk_bit_count_trailing_zeros32(delims);
+            delims &= delims - 1;
 
-        counts[b0][0] += 1;
-        counts[b1][1] += 1;
+            char *const delim = block + pos;
+            if(num_fields < max_fields) { fields[num_fields] = (ElkStr){ .start = field_start, .len = delim - field_start }; }
+            num_fields += 1;
+            field_start = delim + 1;
 
-        skips[0] &= initial_values[0] == b0;
-        skips[1] &= initial_values[1] == b1;
+            /* Like the token parser, a comma at the very end of the input ends the row. */
+            if(((parser->buf_newline_bits >> pos) & 1) || field_start >= end)
+            {
+                if(num_fields <= max_fields)
+                {
+                    ElkStr *last = &fields[num_fields - 1];
+                    last->len = elk_csv_helper_strip_cr(parser, last->start, last->len);
+                }
 
-        position += stride;
-    }
+                elk_csv_helper_end_row(parser, block, pos);
+                return num_fields;
+            }
+        }
 
-    /* Sum the histograms. */
-    if(order == ELK_SORT_ASCENDING)
-    {
-        for(size i = 1; i < 256; ++i)
+        /* No newline in this buffer, move on to the next one. */
+        if(!elk_csv_helper_next_buffer(parser, block))
         {
-            counts[i][0] += counts[i - 1][0];
-            counts[i][1] += counts[i - 1][1];
+            if(num_fields < max_fields)
+            {
+                size const len = elk_csv_helper_strip_cr(parser, field_start, block + 32 - field_start);
+                fields[num_fields] = (ElkStr){ .start = field_start, .len = len };
+            }
+            return num_fields + 1;
         }
     }
-    else
+
+ERR_RETURN:
+    parser->error = true;
+    return 0;
+}
+
+static inline size
+elk_csv_next_projected_row(ElkCsvParser *parser, u64 column_mask, ElkStr *fields)
+{
+    StopIf(elk_csv_finished(parser), goto ERR_RETURN);
+
+    size col = parser->col;
+    size num_out = 0;
+    char *field_start = parser->remaining.start;
+    char *const end = parser->remaining.start + parser->remaining.len;
+    char *block = parser->remaining.start - parser->byte_pos;
+    while(true)
     {
-        for(size i = 254; i >= 0; --i)
+        u32 commas = parser->buf_comma_bits;
+        u32 const newlines = parser->buf_newline_bits;
+        u64 const wanted = col < 64 ? column_mask >> col : 0;
+
+        if(wanted & 1)
         {
-            counts[i][0] += counts[i + 1][0];
-            counts[i][1] += counts[i + 1][1];
-        }
-    }
+            /* Find the end of this field. */
+            u32 const delims = commas | newlines;
+            if(delims)
+            {
+                i32 const pos = elk_bit_count_trailing_zeros32(delims);
+                ElkStr *field = &fields[num_out++];
+                *field = (ElkStr){ .start = field_start, .len = block + pos - field_start };
+                field_start = block + pos + 1;
+                col += 1;
+
+                /* Like the token parser, a comma at the very end of the input ends the row. */
+                if(((newlines >> pos) & 1) || field_start >= end)
+                {
+                    field->len = elk_csv_helper_strip_cr(parser, field->start, field->len);
+                    elk_csv_helper_end_row(parser, block, pos);
+                    break;
+                }
 
-    /* Build the output array. */
-    void *dest = scratch;
-    void *source = buffer;
-    size num_skips = 0;
-    for(size b = 0; b < 2; ++b)
-    {
-        if(!skips[b])
+                parser->buf_comma_bits &= commas - 1;
+                parser->buf_any_delimiter_bits &= commas - 1;
+                continue;
+            }
+        }
+        else
         {
-            for(size i = num - 1; i >= 0; --i)
+            /* Count commas to jump to the start of the next wanted column, but don't go past the end of the row. */
+            size const skip = wanted ? elk_bit_count_trailing_zeros64(wanted) : PTRDIFF_MAX;
+            u32 row_commas = commas & (newlines ? (newlines & -newlines) - 1 : UINT32_MAX);
+            size const available = elk_bit_popcount32(row_commas);
+
+            if(available >= skip)
             {
-                void *val_src = (byte *)source + i * stride;
-                u16 val = *(u16 *)((byte *)val_src + offset);
-                u8 cnts_idx = UINT16_C(0xFF) & (val >> (b * 8));
-                void *val_dest = (byte *)dest + (--counts[cnts_idx][b]) * stride;
+                for(size i = 1; i < skip; ++i) { row_commas &= row_commas - 1; }
+                u32 const last = row_commas & -row_commas;
+                i32 const pos = elk_bit_count_trailing_zeros32(last);
+                parser->buf_comma_bits &= ~(last | (last - 1));
+                parser->buf_any_delimiter_bits &= ~(last | (last - 1));
+                field_start = block + pos + 1;
+                col += skip;
+
+                if(field_start >= end)
+                {
+                    elk_csv_helper_end_row(parser, block, pos);
+                    break;
+                }
+                continue;
+            }
 
-                memcpy(val_dest, val_src, stride);
+            if(available > 0)
+            {
+                i32 const pos = 31 - elk_bit_count_leading_zeros32(row_commas);
+                parser->buf_comma_bits &= ~row_commas;
+                parser->buf_any_delimiter_bits &= ~row_commas;
+                field_start = block + pos + 1;
+                col += available;
+
+                if(field_start >= end)
+                {
+                    elk_csv_helper_end_row(parser, block, pos);
+                    break;
+                }
             }
 
-            /* Flip the source & destination buffers. */
-            dest = dest == scratch ? buffer : scratch;
-            source = source == scratch ? buffer : scratch;
+            if(newlines)
+            {
+                /* The row ended in a column we didn't want. */
+                elk_csv_helper_end_row(parser, block, elk_bit_count_trailing_zeros32(newlines));
+                col += 1;
+                break;
+            }
         }
-        else
+
+        /* Nothing left in this buffer that ends the current field, move on to the next one. */
+        if(!elk_csv_helper_next_buffer(parser, block))
         {
-            num_skips++;
+            if(col < 64 && ((column_mask >> col) & 1))
+            {
+                size const len = elk_csv_helper_strip_cr(parser, field_start, block + 32 - field_start);
+                fields[num_out++] = (ElkStr){ .start = field_start, .len = len };
+            }
+            col += 1;
+            break;
         }
+        block += 32;
     }
 
-    /* Swap back into the original buffer. */
-    if(num_skips % 2)
+    /* Wanted columns missing from a short row are empty. */
+    size const num_missing = col < 64 ? elk_bit_popcount64(column_mask >> col) : 0;
+    for(size i = 0; i < num_missing; ++i) { fields[num_out++] = (ElkStr){ .start = parser->remaining.start, .len = 0 }; }
+
+    return col;
+
+ERR_RETURN:
+    parser->error = true;
+    return 0;
+}
+
+
+static inline ElkStr 
+elk_csv_unquote_str(ElkStr str, ElkStr const buffer)
+{
+    // remove any leading and trailing white space
+    str = elk_str_strip(str);
+
+    if(str.len >= 2 && str.start[0] == '"')
     {
-        memcpy(buffer, scratch, num * stride);
+        // Ok, now we've got a quoted non-empty string.
+        int next_read = 1;
+        int next_write = 0;
+        size len = 0;
+
+        while(next_read < str.len && next_write < buffer.len)
+        {
+            if(str.start[next_read] == '"')
+            {
+                next_read++;
+                if(next_read >= str.len - 2) { break; }
+            }
+
+            buffer.start[next_write] = str.start[next_read];
+
+            len += 1;
+            next_read += 1;
+            next_write += 1;
+        }
+
+        return (ElkStr){ .start=buffer.start, .len=len};
     }
+
+    return str;
 }
 
-static inline void
-elk_radix_sort_32(void *buffer, size num, size offset, size stride, void *scratch, ElkSortOrder order)
+static inline ElkStr 
+elk_csv_simple_unquote_str(ElkStr str)
 {
-    i64 counts[256][4] = {0};
-    i32 skips[4] = {1, 1, 1, 1};
+    // Handle string that isn't even quoted!
+    if(str.len < 2 || str.start[0] != '"') { return str; }
 
-    /* Build the histograms. */
-    byte *position = (byte *)buffer + offset;
+    return (ElkStr){ .start = str.start + 1, .len = str.len - 2};
+}
 
-    u32 val = *(u32 *)position;
-    u8 b0 = UINT32_C(0xFF) & (val >>  0);
-    u8 b1 = UINT32_C(0xFF) & (val >>  8);
-    u8 b2 = UINT32_C(0xFF) & (val >> 16);
-    u8 b3 = UINT32_C(0xFF) & (val >> 24);
+static inline ElkStr
+elk_csv_lazy_unquote_str(ElkStr str, char quote, ElkStaticArena *arena)
+{
+    if(str.len < 2 || str.start[0] != quote) { return str; }
 
-    counts[b0][0] += 1;
-    counts[b1][1] += 1;
-    counts[b2][2] += 1;
-    counts[b3][3] += 1;
+    ElkStr inner = { .start = str.start + 1, .len = str.len - 1 };
+    if(inner.start[inner.len - 1] == quote) { inner.len -= 1; }
 
-    position += stride;
+    /* The common case, no escaped quotes so just return a slice. */
+    char const *first_quote = memchr(inner.start, quote, inner.len);
+    if(!first_quote) { return inner; }
 
-    u8 initial_values[4] = {b0, b1, b2, b3};
+    /* Otherwise copy it, leaving out the first quote of each pair. The escapes make it shorter, so give back the extra. */
+    char *dest = elk_static_arena_nmalloc(arena, inner.len, char);
+    StopIf(!dest, return (ElkStr){0});
 
-    for(size i = 1; i < num; ++i)
+    size prefix_len = first_quote - inner.start;
+    memcpy(dest, inner.start, prefix_len);
+
+    size len = prefix_len;
+    for(size i = prefix_len; i < inner.len; ++i)
     {
-        val = *(u32 *)position;
-        b0 = UINT32_C(0xFF) & (val >>  0);
-        b1 = UINT32_C(0xFF) & (val >>  8);
-        b2 = UINT32_C(0xFF) & (val >> 16);
-        b3 = UINT32_C(0xFF) & (val >> 24);
+        dest[len++] = inner.start[i];
+        if(inner.start[i] == quote && i + 1 < inner.len && inner.start[i + 1] == quote) { ++i; }
+    }
 
-        counts[b0][0] += 1;
-        counts[b1][1] += 1;
-        counts[b2][2] += 1;
-        counts[b3][3] += 1;
+    elk_static_arena_realloc(arena, dest, len > 0 ? len : 1);
 
-        skips[0] &= initial_values[0] == b0;
-        skips[1] &= initial_values[1] == b1;
-        skips[2] &= initial_values[2] == b2;
-        skips[3] &= initial_values[3] == b3;
+    return (ElkStr){ .start = dest, .len = len };
+}
 
-        position += stride;
-    }
+static inline size
+elk_csv_chunks_create(ElkStr input, size max_chunks, ElkCsvChunk *chunks)
+{
+    return elk_csv_chunks_create_dialect(input, ELK_CSV_DIALECT_DEFAULT, max_chunks, chunks);
+}
 
-    /* Sum the histograms. */
-    if(order == ELK_SORT_ASCENDING)
-    {
-        for(size i = 1; i < 256; ++i)
-        {
-            counts[i][0] += counts[i - 1][0];
-            counts[i][1] += counts[i - 1][1];
-            counts[i][2] += counts[i - 1][2];
-            counts[i][3] += counts[i - 1][3];
-        }
-    }
-    else
+static inline size
+elk_csv_chunks_create_dialect(ElkStr input, ElkCsvDialect dialect, size max_chunks, ElkCsvChunk *chunks)
+{
+    Assert(max_chunks > 0);
+
+    /* Don't bother with chunks so small the overhead outweighs the work. */
+    size const min_chunk_len = ELK_KiB(4);
+    size num_chunks = input.len / min_chunk_len;
+    num_chunks = num_chunks < 1 ? 1 : num_chunks;
+    num_chunks = num_chunks > max_chunks ? max_chunks : num_chunks;
+
+    size const chunk_len = input.len / num_chunks;
+    char *next_start = input.start;
+    for(size i = 0; i < num_chunks; ++i)
     {
-        for(size i = 254; i >= 0; --i)
+        size len = i == num_chunks - 1 ? input.len - (next_start - input.start) : chunk_len;
+        chunks[i] = (ElkCsvChunk)
         {
-            counts[i][0] += counts[i + 1][0];
-            counts[i][1] += counts[i + 1][1];
-            counts[i][2] += counts[i + 1][2];
-            counts[i][3] += counts[i + 1][3];
-        }
+            .text = (ElkStr){ .start = next_start, .len = len },
+            .quote_count = 0,
+            .first_row_end = {-1, -1},
+            .dialect = dialect,
+        };
+        next_start += len;
     }
 
-    /* Build the output array. */
-    void *dest = scratch;
-    void *source = buffer;
-    size num_skips = 0;
-    for(size b = 0; b < 4; ++b)
-    {
-        if(!skips[b])
-        {
-            for(size i = num - 1; i >= 0; --i)
-            {
-                void *val_src = (byte *)source + i * stride;
-                u32 val = *(u32 *)((byte *)val_src + offset);
-                u8 cnts_idx = UINT32_C(0xFF) & (val >> (b * 8));
-                void *val_dest = (byte *)dest + (--counts[cnts_idx][b]) * stride;
+    return num_chunks;
+}
+
+static inline void
+elk_csv_chunk_scan(ElkCsvChunk *chunk)
+{
+    size quote_count = 0;
+    size first_row_end[2] = {-1, -1};
+    char *const start = chunk->text.start;
+    size const len = chunk->text.len;
 
-                memcpy(val_dest, val_src, stride);
-            }
+    /* Work in aligned blocks, the same way the fast parser does. */
+    char *const first_block = (char *)((uptr)start & ~(uptr)0x1F);
+    size const skip_bytes = start - first_block;
+    size const end = skip_bytes + len;
 
-            /* Flip the source & destination buffers. */
-            dest = dest == scratch ? buffer : scratch;
-            source = source == scratch ? buffer : scratch;
-        }
-        else
+    u32 carry = 0;
+    for(size pos = 0; pos < end; pos += 32)
+    {
+        u32 quote_bits = 0;
+        u32 comma_bits = 0;
+        u32 newline_bits = 0;
+        elk_csv_helper_scan_block(first_block + pos, chunk->dialect, &quote_bits, &comma_bits, &newline_bits);
+
+        u32 valid_bits = pos == 0 ? UINT32_MAX << skip_bytes : UINT32_MAX;
+        if(end - pos < 32) { valid_bits &= ~(UINT32_MAX << (end - pos)); }
+        quote_bits &= valid_bits;
+        newline_bits &= valid_bits;
+
+        /* Assume the chunk starts outside a quoted string. If that's wrong, then so is in_quotes, everywhere. */
+        u32 in_quotes = elk_csv_helper_prefix_xor32(quote_bits) ^ carry;
+        carry = -(in_quotes >> 31);
+        quote_count += elk_bit_popcount32(quote_bits);
+
+        u32 const row_ends[2] = { newline_bits & ~in_quotes, newline_bits & in_quotes };
+        for(i32 i = 0; i < 2; ++i)
         {
-            num_skips++;
+            if(first_row_end[i] < 0 && row_ends[i])
+            {
+                first_row_end[i] = pos + elk_bit_count_trailing_zeros32(row_ends[i]) + 1 - skip_bytes;
+            }
         }
     }
 
-    /* Swap back into the original buffer. */
-    if(num_skips % 2)
-    {
-        memcpy(buffer, scratch, num * stride);
-    }
+    chunk->quote_count = quote_count;
+    chunk->first_row_end[0] = first_row_end[0];
+    chunk->first_row_end[1] = first_row_end[1];
 }
 
-static inline void
-elk_radix_sort_64(void *buffer, size num, size offset, size stride, void *scratch, ElkSortOrder order)
+static inline size
+elk_csv_chunks_finalize(size num_chunks, ElkCsvChunk *chunks)
 {
-    i64 counts[256][8] = {0};
-    i32 skips[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+    Assert(num_chunks > 0);
 
-    /* Build the histograms. */
-    byte *position = (byte *)buffer + offset;
+    /* The first chunk always starts at the beginning of a row. */
+    size num_out = 1;
+    size in_quotes = chunks[0].quote_count & 1;
 
-    u64 val = *(u64 *)position;
-    u8 b0 = UINT64_C(0xFF) & (val >>  0);
-    u8 b1 = UINT64_C(0xFF) & (val >>  8);
-    u8 b2 = UINT64_C(0xFF) & (val >> 16);
-    u8 b3 = UINT64_C(0xFF) & (val >> 24);
-    u8 b4 = UINT64_C(0xFF) & (val >> 32);
-    u8 b5 = UINT64_C(0xFF) & (val >> 40);
-    u8 b6 = UINT64_C(0xFF) & (val >> 48);
-    u8 b7 = UINT64_C(0xFF) & (val >> 56);
+    for(size i = 1; i < num_chunks; ++i)
+    {
+        ElkCsvChunk chunk = chunks[i];
+        ElkCsvChunk *prev = &chunks[num_out - 1];
+        size const row_end = chunk.first_row_end[in_quotes];
+        in_quotes = (in_quotes + chunk.quote_count) & 1;
 
-    counts[b0][0] += 1;
-    counts[b1][1] += 1;
-    counts[b2][2] += 1;
-    counts[b3][3] += 1;
-    counts[b4][4] += 1;
-    counts[b5][5] += 1;
-    counts[b6][6] += 1;
-    counts[b7][7] += 1;
+        if(row_end < 0 || row_end == chunk.text.len)
+        {
+            /* No row starts in this chunk, so all of it belongs to the previous chunk. */
+            prev->text.len += chunk.text.len;
+            continue;
+        }
 
-    position += stride;
+        /* The partial row at the start of this chunk belongs to the previous chunk. */
+        prev->text.len += row_end;
+        chunk.text.start += row_end;
+        chunk.text.len -= row_end;
+        chunks[num_out++] = chunk;
+    }
 
-    u8 initial_values[8] = {b0, b1, b2, b3, b4, b5, b6, b7};
+    return num_out;
+}
 
-    for(size i = 1; i < num; ++i)
+static inline size
+elk_csv_helper_last_row_end(ElkStr str, ElkCsvDialect dialect)
+{
+    /* Find the offset just past the last newline that isn't in a quoted string, or -1 if there isn't one. The string must
+     * start at the beginning of a row. */
+    size last_row_end = -1;
+
+    char *const first_block = (char *)((uptr)str.start & ~(uptr)0x1F);
+    size const skip_bytes = str.start - first_block;
+    size const end = skip_bytes + str.len;
+
+    u32 carry = 0;
+    for(size pos = 0; pos < end; pos += 32)
     {
-        val = *(u64 *)position;
-        b0 = UINT64_C(0xFF) & (val >>  0);
-        b1 = UINT64_C(0xFF) & (val >>  8);
-        b2 = UINT64_C(0xFF) & (val >> 16);
-        b3 = UINT64_C(0xFF) & (val >> 24);
-        b4 = UINT64_C(0xFF) & (val >> 32);
-        b5 = UINT64_C(0xFF) & (val >> 40);
-        b6 = UINT64_C(0xFF) & (val >> 48);
-        b7 = UINT64_C(0xFF) & (val >> 56);
+        u32 quote_bits = 0;
+        u32 comma_bits = 0;
+        u32 newline_bits = 0;
+        elk_csv_helper_scan_block(first_block + pos, dialect, &quote_bits, &comma_bits, &newline_bits);
 
-        counts[b0][0] += 1;
-        counts[b1][1] += 1;
-        counts[b2][2] += 1;
-        counts[b3][3] += 1;
-        counts[b4][4] += 1;
-        counts[b5][5] += 1;
-        counts[b6][6] += 1;
-        counts[b7][7] += 1;
+        u32 valid_bits = pos == 0 ? UINT32_MAX << skip_bytes : UINT32_MAX;
+        if(end - pos < 32) { valid_bits &= ~(UINT32_MAX << (end - pos)); }
 
-        skips[0] &= initial_values[0] == b0;
-        skips[1] &= initial_values[1] == b1;
-        skips[2] &= initial_values[2] == b2;
-        skips[3] &= initial_values[3] == b3;
-        skips[4] &= initial_values[4] == b4;
-        skips[5] &= initial_values[5] == b5;
-        skips[6] &= initial_values[6] == b6;
-        skips[7] &= initial_values[7] == b7;
+        u32 in_quotes = elk_csv_helper_prefix_xor32(quote_bits & valid_bits) ^ carry;
+        carry = -(in_quotes >> 31);
 
-        position += stride;
+        u32 row_ends = newline_bits & valid_bits & ~in_quotes;
+        if(row_ends) { last_row_end = pos + 32 - elk_bit_count_leading_zeros32(row_ends) - skip_bytes; }
     }
 
-    /* Sum the histograms. */
-    if(order == ELK_SORT_ASCENDING)
+    return last_row_end;
+}
+
+static inline ElkCsvStreamParser
+elk_csv_create_stream_parser(ElkCsvReadFunction read, void *read_ctx, size buf_size, byte buffer[])
+{
+    return elk_csv_create_stream_parser_dialect(read, read_ctx, buf_size, buffer, ELK_CSV_DIALECT_DEFAULT, NULL);
+}
+
+static inline ElkCsvStreamParser
+elk_csv_create_stream_parser_dialect(ElkCsvReadFunction read, void *read_ctx, size buf_size, byte buffer[],
+                                     ElkCsvDialect dialect, ElkDispatch const *dispatch)
+{
+    Assert(read && buffer && buf_size > 0);
+
+    return (ElkCsvStreamParser)
     {
-        for(size i = 1; i < 256; ++i)
-        {
-            counts[i][0] += counts[i - 1][0];
-            counts[i][1] += counts[i - 1][1];
-            counts[i][2] += counts[i - 1][2];
-            counts[i][3] += counts[i - 1][3];
-            counts[i][4] += counts[i - 1][4];
-            counts[i][5] += counts[i - 1][5];
-            counts[i][6] += counts[i - 1][6];
-            counts[i][7] += counts[i - 1][7];
-        }
-    }
-    else
+        .parser = { .remaining = (ElkStr){ .start = buffer, .len = 0 } },
+        .read = read,
+        .read_ctx = read_ctx,
+        .buffer = (ElkStr){ .start = buffer, .len = buf_size },
+        .filled = 0,
+        .window_len = 0,
+        .row = 0,
+        .started = false,
+        .eof = false,
+        .error = false,
+        .dialect = dialect,
+        .scan_chars = dispatch ? dispatch->scan_chars : elk_scan_chars_default(),
+    };
+}
+
+static inline size
+elk_csv_helper_leading_comments_len(ElkStr str, char comment)
+{
+    /* Length of the complete comment lines at the start of the string, they might have unbalanced quotes in them. */
+    size len = 0;
+    while(len < str.len && str.start[len] == comment)
     {
-        for(size i = 254; i >= 0; --i)
-        {
-            counts[i][0] += counts[i + 1][0];
-            counts[i][1] += counts[i + 1][1];
-            counts[i][2] += counts[i + 1][2];
-            counts[i][3] += counts[i + 1][3];
-            counts[i][4] += counts[i + 1][4];
-            counts[i][5] += counts[i + 1][5];
-            counts[i][6] += counts[i + 1][6];
-            counts[i][7] += counts[i + 1][7];
-        }
+        char const *newline = memchr(str.start + len, '\n', str.len - len);
+        if(!newline) { break; }
+        len = newline - str.start + 1;
     }
 
-    /* Build the output array. */
-    void *dest = scratch;
-    void *source = buffer;
-    size num_skips = 0;
-    for(size b = 0; b < 8; ++b)
+    return len;
+}
+
+static inline b32
+elk_csv_helper_stream_next_window(ElkCsvStreamParser *sp)
+{
+    /* Move the partial row left over from the last window to the front of the buffer. */
+    sp->row += sp->parser.row;
+    sp->filled -= sp->window_len;
+    memmove(sp->buffer.start, sp->buffer.start + sp->window_len, sp->filled);
+    sp->window_len = 0;
+    sp->parser = (ElkCsvParser){ .remaining = (ElkStr){ .start = sp->buffer.start, .len = 0 } };
+
+    /* Fill the rest of the buffer. */
+    while(!sp->eof && sp->filled < sp->buffer.len)
     {
-        if(!skips[b])
-        {
-            for(size i = num - 1; i >= 0; --i)
-            {
-                void *val_src = (byte *)source + i * stride;
-                u64 val = *(u64 *)((byte *)val_src + offset);
-                u8 cnts_idx = UINT64_C(0xFF) & (val >> (b * 8));
-                void *val_dest = (byte *)dest + (--counts[cnts_idx][b]) * stride;
+        size num_read = sp->read(sp->read_ctx, sp->buffer.len - sp->filled, (byte *)sp->buffer.start + sp->filled);
+        StopIf(num_read < 0, goto ERR_RETURN);
 
-                memcpy(val_dest, val_src, stride);
-            }
+        sp->eof = num_read == 0;
+        sp->filled += num_read;
+    }
 
-            /* Flip the source & destination buffers. */
-            dest = dest == scratch ? buffer : scratch;
-            source = source == scratch ? buffer : scratch;
-        }
-        else
-        {
-            num_skips++;
-        }
+    /* Only hand complete rows to the parser, unless this is the end of the input. Comment lines are only skipped until the
+     * first row of data, after that every window starts in the middle of the input and a comment character is just data.
+     */
+    ElkStr window = { .start = sp->buffer.start, .len = sp->filled };
+    if(!sp->eof)
+    {
+        size const comments_len = sp->started ? 0 : elk_csv_helper_leading_comments_len(window, sp->dialect.comment);
+        ElkStr const rows = { .start = window.start + comments_len, .len = window.len - comments_len };
+        size const rows_len = elk_csv_helper_last_row_end(rows, sp->dialect);
+        StopIf(rows_len < 0 && comments_len == 0, goto ERR_RETURN); /* A row didn't fit in the buffer. */
+
+        window.len = comments_len + (rows_len > 0 ? rows_len : 0);
     }
 
-    /* Swap back into the original buffer. */
-    if(num_skips % 2)
+    if(window.len == 0) { return false; }
+
+    sp->window_len = window.len;
+    sp->parser = elk_csv_helper_create_parser(window, sp->dialect, sp->scan_chars, !sp->started);
+    sp->started |= sp->parser.remaining.len > 0;
+    return true;
+
+ERR_RETURN:
+    sp->error = true;
+    return false;
+}
+
+static inline b32
+elk_csv_stream_finished(ElkCsvStreamParser *parser)
+{
+    /* If the current window is used up, load the next one to find out if there is anything left. */
+    while(!parser->error && elk_csv_finished(&parser->parser) && !(parser->eof && parser->filled == parser->window_len))
     {
-        memcpy(buffer, scratch, num * stride);
+        if(!elk_csv_helper_stream_next_window(parser)) { break; }
     }
+
+    return parser->error || elk_csv_finished(&parser->parser);
+}
+
+static inline ElkCsvToken
+elk_csv_stream_next_token(ElkCsvStreamParser *parser)
+{
+    StopIf(elk_csv_stream_finished(parser), goto ERR_RETURN);
+
+    ElkCsvToken token = elk_csv_fast_next_token(&parser->parser);
+    token.row += parser->row;
+    return token;
+
+ERR_RETURN:
+    parser->error = true;
+    return (ElkCsvToken){ .row=parser->row + parser->parser.row, .col=parser->parser.col, .value=(ElkStr){.start=parser->buffer.start, .len=0}};
+}
+
+static inline u64
+elk_csv_helper_prefix_xor64_scalar(u64 bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+ELK_TARGET("pclmul")
+static inline u64
+elk_csv_helper_prefix_xor64_pclmul(u64 bits)
+{
+    /* A carry-less multiply by all ones is a prefix XOR. */
+    __m128i const all_ones = _mm_set1_epi8((char)0xFF);
+    return (u64)_mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_set_epi64x(0, (i64)bits), all_ones, 0));
 }
 
 static inline void
-elk_radix_sort(void *buffer, size num, size offset, size stride, void *scratch, ElkRadixSortByType sort_type, ElkSortOrder order)
+elk_csv_helper_scan_block64(char const *block, char const chars[4], u64 *quote_bits, u64 *comma_bits, u64 *newline_bits,
+        u64 *hash_bits)
 {
-    elk_radix_pre_sort_transform(buffer, num, offset, stride, sort_type);
+    Assert((uptr)block % 64 == 0); /* Aligned loads never cross a page boundary, so it's safe to read past the end. */
 
-    switch(sort_type)
+    u32 lo[4] = {0};
+    u32 hi[4] = {0};
+    elk_scan_chars(block, chars, lo);
+    elk_scan_chars(block + 32, chars, hi);
+
+    *quote_bits = lo[0] | ((u64)hi[0] << 32);
+    *comma_bits = lo[1] | ((u64)hi[1] << 32);
+    *newline_bits = lo[2] | ((u64)hi[2] << 32);
+    *hash_bits = lo[3] | ((u64)hi[3] << 32);
+}
+
+static inline size
+elk_csv_helper_index_blocks(char const *base, size start, size end, char const chars[4], u64 *delimiter_bits,
+        u64 *newline_bits, b32 *ends_in_comment, b32 pclmul)
+{
+    /* The body of both index kernels, pclmul is always a constant so only one prefix XOR is left in each of them. */
+    size const num_blocks = (end + 63) / 64;
+
+    u64 quote_carry = 0;                         /* All ones if the previous block ended in a quoted string.    */
+    u64 row_start_carry = UINT64_C(1) << start;  /* Bit set where a row starts because the last block ended one. */
+    b32 in_comment = false;                      /* Did the previous block end in a comment line?                */
+    size num_comment_lines = 0;
+
+    for(size b = 0; b < num_blocks; ++b)
     {
-        case ELK_RADIX_SORT_UINT64:
-        case ELK_RADIX_SORT_INT64:
-        case ELK_RADIX_SORT_F64:
+        u64 q = 0, c = 0, n = 0, h = 0;
+        elk_csv_helper_scan_block64(base + 64 * b, chars, &q, &c, &n, &h);
+
+        u64 valid_bits = b == 0 ? UINT64_MAX << start : UINT64_MAX;
+        if(end - 64 * b < 64) { valid_bits &= ~(UINT64_MAX << (end - 64 * b)); }
+        q &= valid_bits;
+        c &= valid_bits;
+        n &= valid_bits;
+        h &= valid_bits;
+
+        /* Everything in a comment line up to (not including) the newline is masked out, quotes included. */
+        u64 comment_bits = 0;
+        if(in_comment)
         {
-            elk_radix_sort_64(buffer, num, offset, stride, scratch, order);
-        } break;
+            comment_bits = n ? (n & -n) - 1 : UINT64_MAX;
+            in_comment = !n;
+        }
 
-        case ELK_RADIX_SORT_UINT32:
-        case ELK_RADIX_SORT_INT32:
-        case ELK_RADIX_SORT_F32:
+        u64 in_quotes = 0;
+        while(true)
         {
-            elk_radix_sort_32(buffer, num, offset, stride, scratch, order);
-        } break;
+            u64 const quotes = q & ~comment_bits;
+            in_quotes = (pclmul ? elk_csv_helper_prefix_xor64_pclmul(quotes) : elk_csv_helper_prefix_xor64_scalar(quotes));
+            in_quotes ^= quote_carry;
+
+            u64 row_starts = ((n & ~in_quotes & ~comment_bits) << 1) | row_start_carry;
+            u64 comment_starts = h & row_starts & ~in_quotes & ~comment_bits;
+            if(!comment_starts) { break; }
+
+            /* Mask out the first new comment line and try again, it may change which quotes count. This is rare. */
+            u64 first = comment_starts & -comment_starts;
+            u64 newlines_after = n & ~((first << 1) - 1);
+            if(newlines_after)
+            {
+                comment_bits |= ((newlines_after & -newlines_after) - 1) & ~(first - 1);
+            }
+            else
+            {
+                comment_bits |= ~(first - 1);
+                in_comment = true;
+            }
 
-        case ELK_RADIX_SORT_UINT16:
-        case ELK_RADIX_SORT_INT16:
-        {
-            elk_radix_sort_16(buffer, num, offset, stride, scratch, order);
-        } break;
+            num_comment_lines += 1;
+        }
 
-        case ELK_RADIX_SORT_UINT8:
-        case ELK_RADIX_SORT_INT8:
-        {
-            elk_radix_sort_8(buffer, num, offset, stride, scratch, order);
-        } break;
+        quote_carry = -(in_quotes >> 63);
 
-        default: Panic();
+        u64 const unquoted = ~in_quotes & ~comment_bits;
+        newline_bits[b] = n & unquoted;
+        delimiter_bits[b] = (c | n) & unquoted;
+        row_start_carry = newline_bits[b] >> 63;
     }
-    
-    elk_radix_post_sort_transform(buffer, num, offset, stride, sort_type);
+
+    *ends_in_comment = in_comment;
+    return num_comment_lines;
 }
 
-#if __AVX2__
-static inline void elk_csv_helper_load_new_buffer_aligned(ElkCsvParser *p, i8 skip_bytes);
-#endif
+static inline size
+elk_csv_helper_index_blocks_scalar(char const *base, size start, size end, char const chars[4], u64 *delimiter_bits,
+        u64 *newline_bits, b32 *ends_in_comment)
+{
+    return elk_csv_helper_index_blocks(base, start, end, chars, delimiter_bits, newline_bits, ends_in_comment,
+            false);
+}
 
-static inline ElkCsvParser 
-elk_csv_create_parser(ElkStr input)
+ELK_TARGET("pclmul") ELK_FLATTEN
+static inline size
+elk_csv_helper_index_blocks_pclmul(char const *base, size start, size end, char const chars[4], u64 *delimiter_bits,
+        u64 *newline_bits, b32 *ends_in_comment)
 {
-    ElkCsvParser parser = { .remaining=input, .row=0, .col=0, .error=false };
+    return elk_csv_helper_index_blocks(base, start, end, chars, delimiter_bits, newline_bits, ends_in_comment,
+            true);
+}
 
-    // Scan past leading comment lines.
-    while(*parser.remaining.start == '#')
-    {
-        // We must be on a comment line if we got here, so read just past the end of the line
-        while(*parser.remaining.start && parser.remaining.len > 0)
-        {
-            char last_char = *parser.remaining.start;
-            ++parser.remaining.start;
-            --parser.remaining.len;
-            if(last_char == '\n') { break; }
-        }
-    }
+static inline ElkCsvIndex
+elk_csv_index_create(ElkStr input, ElkStaticArena *arena)
+{
+    return elk_csv_index_create_dispatch(input, arena, NULL);
+}
 
-#if __AVX2__
-    i8 skip_bytes = (i8)((uptr)parser.remaining.start - ((uptr)parser.remaining.start & ~0x1F));
-    parser.remaining.start = (char *)((uptr)parser.remaining.start & ~0x1F); /* Force 32 byte alignment */
-    parser.carry = 0;
-    elk_csv_helper_load_new_buffer_aligned(&parser, skip_bytes);
+static inline ElkCsvIndex
+elk_csv_index_create_dispatch(ElkStr input, ElkStaticArena *arena, ElkDispatch const *dispatch)
+{
+    return elk_csv_index_create_dialect(input, ELK_CSV_DIALECT_DEFAULT, arena, dispatch);
+}
+
+static inline ElkCsvIndex
+elk_csv_index_create_dialect(ElkStr input, ElkCsvDialect dialect, ElkStaticArena *arena, ElkDispatch const *dispatch)
+{
+    char *base = (char *)((uptr)input.start & ~(uptr)0x3F);
+    size const start = input.start - base;
+    size const end = start + input.len;
+    size const num_blocks = (end + 63) / 64;
+
+    /* An empty input has no blocks, even if it doesn't start on a block boundary. */
+    ElkCsvIndex index = { .base = base, .start = start, .end = end, .num_blocks = 0, .dialect = dialect };
+    StopIf(input.len == 0, return index);
+
+    u64 *delimiter_bits = elk_static_arena_nmalloc(arena, num_blocks, u64);
+    u64 *newline_bits = elk_static_arena_nmalloc(arena, num_blocks, u64);
+    StopIf(!delimiter_bits || !newline_bits, return index);
+
+#if defined(__PCLMUL__) || (defined(_MSC_VER) && defined(__AVX2__))
+    ElkCsvIndexBlocksFunction index_blocks = elk_csv_helper_index_blocks_pclmul;
+#else
+    ElkCsvIndexBlocksFunction index_blocks = elk_csv_helper_index_blocks_scalar;
 #endif
+    if(dispatch) { index_blocks = dispatch->csv_index_blocks; }
+
+    char const chars[4] = { dialect.quote, dialect.delimiter, '\n', dialect.comment };
+    b32 in_comment = false;
+    size const num_comment_lines = index_blocks(base, start, end, chars, delimiter_bits, newline_bits, &in_comment);
+
+    /* Does the input end in the middle of a row that needs counted? */
+    u64 last_valid_bit = UINT64_C(1) << ((end - 1) & 63);
+    b32 last_row_unterminated = !(newline_bits[num_blocks - 1] & last_valid_bit) && !in_comment;
+
+    index.num_blocks = num_blocks;
+    index.delimiter_bits = delimiter_bits;
+    index.newline_bits = newline_bits;
+    index.num_comment_newlines = num_comment_lines - in_comment; /* The last comment may not have a newline. */
+    index.last_row_unterminated = last_row_unterminated;
+    return index;
+}
+
+static inline size
+elk_csv_index_count_rows(ElkCsvIndex const *index)
+{
+    size num_newlines = 0;
+    for(size b = 0; b < index->num_blocks; ++b) { num_newlines += elk_bit_popcount64(index->newline_bits[b]); }
 
-    return parser;
+    return num_newlines - index->num_comment_newlines + index->last_row_unterminated;
 }
 
-static inline b32 
-elk_csv_finished(ElkCsvParser *parser)
+static inline ElkCsvIndexIter
+elk_csv_index_iter(ElkCsvIndex const *index)
 {
-    return parser->error || parser->remaining.len == 0;
+    return (ElkCsvIndexIter)
+    {
+        .index = index,
+        .block = 0,
+        .bits = index->num_blocks > 0 ? index->delimiter_bits[0] : 0,
+        .next_start = index->start,
+        .row = 0,
+        .col = 0,
+    };
 }
 
-static inline ElkCsvToken 
-elk_csv_full_next_token(ElkCsvParser *parser)
+
+static inline size
+elk_csv_helper_index_next_delimiter(ElkCsvIndexIter *iter)
 {
-    StopIf(elk_csv_finished(parser), goto ERR_RETURN);
+    /* Offset from base of the next delimiter, or the end of the input if there are no more. Consumes the delimiter. */
+    ElkCsvIndex const *index = iter->index;
+    while(!iter->bits)
+    {
+        iter->block += 1;
+        if(iter->block >= index->num_blocks) { return index->end; }
+        iter->bits = index->delimiter_bits[iter->block];
+    }
 
-    // Current position in parser and how much we've processed
-    char *next_char = parser->remaining.start;
-    int num_chars_proc = 0;
-    size row = parser->row;
-    size col = parser->col;
+    size pos = 64 * iter->block + elk_bit_count_trailing_zeros64(iter->bits);
+    iter->bits &= iter->bits - 1;
+    return pos;
+}
 
-    // Handle comment lines
-    while(col == 0 && *next_char == '#')
+static inline b32
+elk_csv_index_iter_finished(ElkCsvIndexIter *iter)
+{
+    ElkCsvIndex const *index = iter->index;
+
+    /* Skip comment lines, they always start at the beginning of a row and end at a delimiter (a newline). */
+    while(iter->col == 0 && iter->next_start < index->end && index->base[iter->next_start] == index->dialect.comment)
     {
-        // We must be on a comment line if we got here, so read just past the end of the line
-        
-        while(*next_char && parser->remaining.len - num_chars_proc > 0)
-        {
-            char *last_char = next_char;
-            ++next_char;
-            ++num_chars_proc;
-            if(*last_char == '\n') { break; }
-        }
+        iter->next_start = elk_csv_helper_index_next_delimiter(iter) + 1;
     }
 
-    // The data for the next value to return
-    char *next_value_start = next_char;
-    size next_value_len = 0;
+    return iter->next_start >= index->end;
+}
 
-    // Are we in a quoted string where we should ignore commas?
-    b32 stop = false;
-    u32 carry = 0;
+static inline ElkCsvToken
+elk_csv_index_next_token(ElkCsvIndexIter *iter)
+{
+    ElkCsvIndex const *index = iter->index;
+    size row = iter->row;
+    size col = iter->col;
 
-#if __AVX2__
-    /* Do SIMD */
+    StopIf(elk_csv_index_iter_finished(iter), goto ERR_RETURN);
 
-    __m256i quotes = _mm256_set1_epi8('"');
-    __m256i commas = _mm256_set1_epi8(',');
-    __m256i newlines = _mm256_set1_epi8('\n');
+    size const start = iter->next_start;
+    size const pos = elk_csv_helper_index_next_delimiter(iter);
 
-    __m256i S = _mm256_setr_epi64x(0x0000000000000000, 0x0101010101010101, 0x0202020202020202, 0x0303030303030303);
-    __m256i M = _mm256_set1_epi64x(0x7fbfdfeff7fbfdfe);
-    __m256i A = _mm256_set1_epi64x(0xffffffffffffffff);
+    b32 newline = pos >= index->end || ((index->newline_bits[pos / 64] >> (pos & 63)) & 1);
+    iter->row += newline;
+    iter->col = newline ? 0 : col + 1;
+    iter->next_start = pos + 1;
 
-    while(!stop && parser->remaining.len > num_chars_proc + 32)
-    {
-        __m256i chars = _mm256_lddqu_si256((__m256i *)next_char);
+    size len = pos - start;
+    if(newline && index->dialect.crlf && len > 0 && index->base[pos - 1] == '\r') { len -= 1; }
 
-        __m256i quote_mask = _mm256_cmpeq_epi8(chars, quotes);
-        __m256i comma_mask = _mm256_cmpeq_epi8(chars, commas);
-        __m256i newline_mask = _mm256_cmpeq_epi8(chars, newlines);
+    return (ElkCsvToken){ .row=row, .col=col, .value=(ElkStr){ .start=index->base + start, .len=len }};
 
-        /* https://nullprogram.com/blog/2021/12/04/ - public domain code to create running mask */
-        u32 running_quote_mask = _mm256_movemask_epi8(quote_mask);
-        u32 r = running_quote_mask;
+ERR_RETURN:
+    return (ElkCsvToken){ .row=row, .col=col, .value=(ElkStr){ .start=index->base + index->end, .len=0 }};
+}
 
-        while(running_quote_mask)
-        {
-            r ^= -running_quote_mask ^ running_quote_mask;
-            running_quote_mask &= running_quote_mask - 1;
-        }
+static inline size
+elk_csv_index_skip_columns(ElkCsvIndexIter *iter, size num_cols)
+{
+    ElkCsvIndex const *index = iter->index;
+    size skipped = 0;
 
-        running_quote_mask = r ^ carry;
-        carry = -(running_quote_mask >> 31);
-        quote_mask = _mm256_set1_epi32(running_quote_mask);
-        quote_mask = _mm256_shuffle_epi8(quote_mask, S);
-        quote_mask = _mm256_or_si256(quote_mask, M);
-        quote_mask = _mm256_cmpeq_epi8(quote_mask, A);
+    while(skipped < num_cols && iter->next_start < index->end)
+    {
+        /* Only the commas before the end of the row can be skipped. */
+        u64 const newlines = index->newline_bits[iter->block] & iter->bits;
+        u64 const before_newline = newlines ? (newlines & -newlines) - 1 : UINT64_MAX;
+        u64 commas = iter->bits & before_newline;
+        size const available = elk_bit_popcount64(commas);
 
-        comma_mask = _mm256_andnot_si256(quote_mask, comma_mask);
-        u32 comma_bits = _mm256_movemask_epi8(comma_mask);
-        newline_mask = _mm256_andnot_si256(quote_mask, newline_mask);
-        u32 newline_bits = _mm256_movemask_epi8(newline_mask);
+        if(available >= num_cols - skipped)
+        {
+            /* The last comma to skip is in this block, drop the ones before it. */
+            for(size i = skipped + 1; i < num_cols; ++i) { commas &= commas - 1; }
+            u64 const last = commas & -commas;
+            iter->bits &= ~(last | (last - 1));
+            iter->next_start = 64 * iter->block + elk_bit_count_trailing_zeros64(last) + 1;
+            skipped = num_cols;
+            break;
+        }
 
-        __m256i comma_or_newline_mask = _mm256_or_si256(comma_mask, newline_mask);
-        u32 comma_or_newline_bits = _mm256_movemask_epi8(comma_or_newline_mask);
+        /* Skip all the commas in this block. */
+        if(available > 0)
+        {
+            iter->bits &= ~commas;
+            iter->next_start = 64 * iter->block + 64 - elk_bit_count_leading_zeros64(commas);
+            skipped += available;
+        }
 
-        u32 first_non_zero_bit_lsb = comma_or_newline_bits & ~(comma_or_newline_bits - 1);
-        i32 bit_pos = 31 - __lzcnt32(first_non_zero_bit_lsb);
-        bit_pos = bit_pos > 31 || bit_pos < 0 ? 31 : bit_pos;
+        if(newlines || iter->block + 1 >= index->num_blocks) { break; }
 
-        b32 comma = (comma_bits >> bit_pos) & 1;
-        b32 newline = (newline_bits >> bit_pos) & 1;
-        b32 comma_or_newline = (comma_or_newline_bits >> bit_pos) & 1;
+        iter->block += 1;
+        iter->bits = index->delimiter_bits[iter->block];
+    }
 
-        parser->row += newline;
-        parser->col += -col * newline + comma;
-        next_value_len += bit_pos + 1 - comma_or_newline;
+    iter->col += skipped;
+    return skipped;
+}
 
-        next_char += bit_pos + 1 ;
-        num_chars_proc += bit_pos + 1 ;
+#define ELK_CSV_LOAD_BATCH 64
 
-        stop = comma_or_newline;
+static inline void
+elk_csv_helper_index_skip_row(ElkCsvIndexIter *iter)
+{
+    size const row = iter->row;
+    while(iter->row == row && !elk_csv_index_iter_finished(iter))
+    {
+        elk_csv_index_skip_columns(iter, PTRDIFF_MAX);
+        elk_csv_index_next_token(iter);
     }
+}
 
-#endif
-
-    /* Finish up when not 32 remaining. */
-    b32 in_string = carry > 0;
-    while(!stop && parser->remaining.len > num_chars_proc)
+static inline void
+elk_csv_helper_load_batch(ElkCsvTable *table, size num_rows, ElkStr const *batch, ElkStringInterner *interner)
+{
+    /* Parse a batch of rows one column at a time and append them to the table. */
+    size const first_row = table->num_rows;
+    for(size c = 0; c < table->num_cols; ++c)
     {
-        switch(*next_char)
+        ElkStr const *tokens = batch + c * ELK_CSV_LOAD_BATCH;
+        void *data = table->cols[c].data;
+        switch(table->cols[c].type)
         {
-            case '\n':
+            case ELK_CSV_COL_I64:
             {
-                parser->row += 1;
-                parser->col = 0;
-                --next_value_len;
-                stop = true;
+                i64 *out = (i64 *)data + first_row;
+                for(size i = 0; i < num_rows; ++i)
+                {
+                    out[i] = INT64_MIN;
+                    table->num_parse_errors += !elk_str_parse_i64(elk_str_strip(tokens[i]), out + i);
+                }
+            } break;
+
+            case ELK_CSV_COL_TIME:
+            {
+                ElkStr stripped[ELK_CSV_LOAD_BATCH];
+                for(size i = 0; i < num_rows; ++i) { stripped[i] = elk_str_strip(tokens[i]); }
+
+                ElkTime *out = (ElkTime *)data + first_row;
+                table->num_parse_errors += num_rows - elk_str_parse_datetime_batch(stripped, num_rows, out, NULL);
             } break;
 
-            case '"':
+            case ELK_CSV_COL_F64:
             {
-                in_string = !in_string;
+                ElkStr stripped[ELK_CSV_LOAD_BATCH];
+                for(size i = 0; i < num_rows; ++i) { stripped[i] = elk_str_strip(tokens[i]); }
+
+                f64 *out = (f64 *)data + first_row;
+                table->num_parse_errors += num_rows - elk_str_parse_f64_batch(stripped, num_rows, out, NULL);
             } break;
 
-            case ',':
+            case ELK_CSV_COL_STR:
             {
-                if(!in_string) 
+                ElkStr *out = (ElkStr *)data + first_row;
+                for(size i = 0; i < num_rows; ++i)
                 {
-                    parser->col += 1;
-                    --next_value_len;
-                    stop = true;
+                    out[i] = interner && tokens[i].len > 0 ? elk_string_interner_intern(interner, tokens[i]) : tokens[i];
                 }
             } break;
 
-            default: break;
+            case ELK_CSV_COL_SKIP: break;
         }
-
-        ++next_value_len;
-        ++next_char;
-        ++num_chars_proc;
     }
 
-    parser->remaining.start = next_char;
-    parser->remaining.len -= num_chars_proc;
-
-    return (ElkCsvToken){ .row=row, .col=col, .value=(ElkStr){ .start=next_value_start, .len=next_value_len }};
-
-ERR_RETURN:
-    parser->error = true;
-    return (ElkCsvToken){ .row=parser->row, .col=parser->col, .value=(ElkStr){.start=parser->remaining.start, .len=0}};
+    table->num_rows += num_rows;
 }
 
-#if __AVX2__
-static inline void
-elk_csv_helper_load_new_buffer_aligned(ElkCsvParser *p, i8 skip_bytes)
+static inline ElkCsvTable
+elk_csv_load_columns(ElkStr input, b32 has_header, size num_cols, ElkCsvColumnType const *types,
+                     ElkStringInterner *interner, ElkStaticArena *arena)
 {
-    Assert((uptr)p->remaining.start % 32 == 0); /* Always aligned on a 32 byte boundary. */
+    return elk_csv_load_columns_dialect(input, ELK_CSV_DIALECT_DEFAULT, has_header, num_cols, types, interner, arena, NULL);
+}
 
-    /* SIMD constants for expanding a bit as index mask to a byte mask. */
-    __m256i S = _mm256_setr_epi64x(0x0000000000000000, 0x0101010101010101, 0x0202020202020202, 0x0303030303030303);
-    __m256i M = _mm256_set1_epi64x(0x7fbfdfeff7fbfdfe);
-    __m256i A = _mm256_set1_epi64x(0xffffffffffffffff);
-
-    /* Constants for matching delimiters & quotes. */
-    __m256i quotes = _mm256_set1_epi8('"');
-    __m256i commas = _mm256_set1_epi8(',');
-    __m256i newlines = _mm256_set1_epi8('\n');
-
-    /* Load data into the buffer. */
-    p->buf = _mm256_load_si256((__m256i *)(p->remaining.start));
-
-    /* Zero out leading bytes if necessary so they don't accidently match a delimiter. */
-    if(skip_bytes)
-    {
-        Assert(skip_bytes > 0 && skip_bytes < 32);
-        switch(skip_bytes - 1)
-        {
-            case 30: p->buf = _mm256_insert_epi8(p->buf, 0, 30); /* fall through */
-            case 29: p->buf = _mm256_insert_epi8(p->buf, 0, 29); /* fall through */
-            case 28: p->buf = _mm256_insert_epi8(p->buf, 0, 28); /* fall through */
-            case 27: p->buf = _mm256_insert_epi8(p->buf, 0, 27); /* fall through */
-            case 26: p->buf = _mm256_insert_epi8(p->buf, 0, 26); /* fall through */
-            case 25: p->buf = _mm256_insert_epi8(p->buf, 0, 25); /* fall through */
-            case 24: p->buf = _mm256_insert_epi8(p->buf, 0, 24); /* fall through */
-            case 23: p->buf = _mm256_insert_epi8(p->buf, 0, 23); /* fall through */
-            case 22: p->buf = _mm256_insert_epi8(p->buf, 0, 22); /* fall through */
-            case 21: p->buf = _mm256_insert_epi8(p->buf, 0, 21); /* fall through */
-            case 20: p->buf = _mm256_insert_epi8(p->buf, 0, 20); /* fall through */
-            case 19: p->buf = _mm256_insert_epi8(p->buf, 0, 19); /* fall through */
-            case 18: p->buf = _mm256_insert_epi8(p->buf, 0, 18); /* fall through */
-            case 17: p->buf = _mm256_insert_epi8(p->buf, 0, 17); /* fall through */
-            case 16: p->buf = _mm256_insert_epi8(p->buf, 0, 16); /* fall through */
-            case 15: p->buf = _mm256_insert_epi8(p->buf, 0, 15); /* fall through */
-            case 14: p->buf = _mm256_insert_epi8(p->buf, 0, 14); /* fall through */
-            case 13: p->buf = _mm256_insert_epi8(p->buf, 0, 13); /* fall through */
-            case 12: p->buf = _mm256_insert_epi8(p->buf, 0, 12); /* fall through */
-            case 11: p->buf = _mm256_insert_epi8(p->buf, 0, 11); /* fall through */
-            case 10: p->buf = _mm256_insert_epi8(p->buf, 0, 10); /* fall through */
-            case  9: p->buf = _mm256_insert_epi8(p->buf, 0,  9); /* fall through */
-            case  8: p->buf = _mm256_insert_epi8(p->buf, 0,  8); /* fall through */
-            case  7: p->buf = _mm256_insert_epi8(p->buf, 0,  7); /* fall through */
-            case  6: p->buf = _mm256_insert_epi8(p->buf, 0,  6); /* fall through */
-            case  5: p->buf = _mm256_insert_epi8(p->buf, 0,  5); /* fall through */
-            case  4: p->buf = _mm256_insert_epi8(p->buf, 0,  4); /* fall through */
-            case  3: p->buf = _mm256_insert_epi8(p->buf, 0,  3); /* fall through */
-            case  2: p->buf = _mm256_insert_epi8(p->buf, 0,  2); /* fall through */
-            case  1: p->buf = _mm256_insert_epi8(p->buf, 0,  2); /* fall through */
-            case  0: p->buf = _mm256_insert_epi8(p->buf, 0,  0); /* fall through */
-        }
-    }
-
-    /* If at the end of the string, no worries just force all trailing characters in the buffer to be delimiters. */
-    if(p->remaining.len < 32)
-    {
-        size start = p->remaining.len;
-        Assert(start > 0 && start < 32);
-        switch(start)
-        {
-            case  1: p->buf = _mm256_insert_epi8(p->buf, '\n',  2); /* fall through */
-            case  2: p->buf = _mm256_insert_epi8(p->buf, '\n',  2); /* fall through */
-            case  3: p->buf = _mm256_insert_epi8(p->buf, '\n',  3); /* fall through */
-            case  4: p->buf = _mm256_insert_epi8(p->buf, '\n',  4); /* fall through */
-            case  5: p->buf = _mm256_insert_epi8(p->buf, '\n',  5); /* fall through */
-            case  6: p->buf = _mm256_insert_epi8(p->buf, '\n',  6); /* fall through */
-            case  7: p->buf = _mm256_insert_epi8(p->buf, '\n',  7); /* fall through */
-            case  8: p->buf = _mm256_insert_epi8(p->buf, '\n',  8); /* fall through */
-            case  9: p->buf = _mm256_insert_epi8(p->buf, '\n',  9); /* fall through */
-            case 10: p->buf = _mm256_insert_epi8(p->buf, '\n', 10); /* fall through */
-            case 11: p->buf = _mm256_insert_epi8(p->buf, '\n', 11); /* fall through */
-            case 12: p->buf = _mm256_insert_epi8(p->buf, '\n', 12); /* fall through */
-            case 13: p->buf = _mm256_insert_epi8(p->buf, '\n', 13); /* fall through */
-            case 14: p->buf = _mm256_insert_epi8(p->buf, '\n', 14); /* fall through */
-            case 15: p->buf = _mm256_insert_epi8(p->buf, '\n', 15); /* fall through */
-            case 16: p->buf = _mm256_insert_epi8(p->buf, '\n', 16); /* fall through */
-            case 17: p->buf = _mm256_insert_epi8(p->buf, '\n', 17); /* fall through */
-            case 18: p->buf = _mm256_insert_epi8(p->buf, '\n', 18); /* fall through */
-            case 19: p->buf = _mm256_insert_epi8(p->buf, '\n', 19); /* fall through */
-            case 20: p->buf = _mm256_insert_epi8(p->buf, '\n', 20); /* fall through */
-            case 21: p->buf = _mm256_insert_epi8(p->buf, '\n', 21); /* fall through */
-            case 22: p->buf = _mm256_insert_epi8(p->buf, '\n', 22); /* fall through */
-            case 23: p->buf = _mm256_insert_epi8(p->buf, '\n', 23); /* fall through */
-            case 24: p->buf = _mm256_insert_epi8(p->buf, '\n', 24); /* fall through */
-            case 25: p->buf = _mm256_insert_epi8(p->buf, '\n', 25); /* fall through */
-            case 26: p->buf = _mm256_insert_epi8(p->buf, '\n', 26); /* fall through */
-            case 27: p->buf = _mm256_insert_epi8(p->buf, '\n', 27); /* fall through */
-            case 28: p->buf = _mm256_insert_epi8(p->buf, '\n', 28); /* fall through */
-            case 29: p->buf = _mm256_insert_epi8(p->buf, '\n', 29); /* fall through */
-            case 30: p->buf = _mm256_insert_epi8(p->buf, '\n', 30); /* fall through */
-            case 31: p->buf = _mm256_insert_epi8(p->buf, '\n', 31); /* fall through */
-        }
-    }
-
-    __m256i quote_mask = _mm256_cmpeq_epi8(p->buf, quotes);
-    __m256i comma_mask = _mm256_cmpeq_epi8(p->buf, commas);
-    __m256i newline_mask = _mm256_cmpeq_epi8(p->buf, newlines);
-
-    /* https://nullprogram.com/blog/2021/12/04/ - public domain code to create running mask */
-    u32 running_quote_mask = _mm256_movemask_epi8(quote_mask);
-    u32 r = running_quote_mask;
-
-    while(running_quote_mask)
-    {
-        r ^= -running_quote_mask ^ running_quote_mask;
-        running_quote_mask &= running_quote_mask - 1;
-    }
-
-    running_quote_mask = r ^ p->carry;
-    p->carry = -(running_quote_mask >> 31);
-    quote_mask = _mm256_set1_epi32(running_quote_mask);
-    quote_mask = _mm256_shuffle_epi8(quote_mask, S);
-    quote_mask = _mm256_or_si256(quote_mask, M);
-    quote_mask = _mm256_cmpeq_epi8(quote_mask, A);
-
-    comma_mask = _mm256_andnot_si256(quote_mask, comma_mask);
-    p->buf_comma_bits = _mm256_movemask_epi8(comma_mask);
-    newline_mask = _mm256_andnot_si256(quote_mask, newline_mask);
-    p->buf_newline_bits = _mm256_movemask_epi8(newline_mask);
-
-    __m256i comma_or_newline_mask = _mm256_or_si256(comma_mask, newline_mask);
-    p->buf_any_delimiter_bits = _mm256_movemask_epi8(comma_or_newline_mask);
-    p->remaining.start += skip_bytes;
-    p->byte_pos = skip_bytes;
+static inline b32
+elk_csv_helper_index_blank_row(ElkCsvIndex const *index, size start)
+{
+    /* Is the row starting at offset start empty? With crlf, a lone '\r' before the newline doesn't count. */
+    if(start < index->end && index->dialect.crlf && index->base[start] == '\r') { start += 1; }
+    return start >= index->end || ((index->newline_bits[start / 64] >> (start & 63)) & 1);
 }
 
-static inline ElkCsvToken 
-elk_csv_fast_next_token(ElkCsvParser *parser)
+static inline ElkCsvTable
+elk_csv_load_columns_dialect(ElkStr input, ElkCsvDialect dialect, b32 has_header, size num_cols,
+                             ElkCsvColumnType const *types, ElkStringInterner *interner, ElkStaticArena *arena,
+                             ElkDispatch const *dispatch)
 {
-    size row = parser->row;
-    size col = parser->col;
+    ElkCsvTable table = { .num_rows = 0, .num_cols = num_cols, .cols = NULL, .num_parse_errors = 0, .error = false };
 
-    StopIf(elk_csv_finished(parser), goto ERR_RETURN);
+    ElkCsvIndex index = elk_csv_index_create_dialect(input, dialect, arena, dispatch);
+    StopIf(index.num_blocks == 0 && input.len > 0, goto ERR_RETURN);
+    size const max_rows = elk_csv_index_count_rows(&index);
 
-    char *start = parser->remaining.start;
-    size next_value_len = 0;
-    b32 stop = false;
-    
-    /* Stop will signal when a new delimiter is found, but we may need to process a few buffers worth of data to find one. */
-    while(!stop)
+    table.cols = elk_static_arena_nmalloc(arena, num_cols, ElkCsvColumn);
+    StopIf(!table.cols, goto ERR_RETURN);
+    for(size c = 0; c < num_cols; ++c)
     {
-        u32 any_delim = parser->buf_any_delimiter_bits;
-
-        /* Find the position of the next delimiter or the end of the buffer */
-        u32 first_non_zero_bit_lsb = any_delim & ~(any_delim - 1);
-        i32 bit_pos = 31 - __lzcnt32(first_non_zero_bit_lsb);
-        bit_pos = bit_pos > 31 || bit_pos < 0 ? 31 : bit_pos;
-        i32 run_len = bit_pos - parser->byte_pos;
+        table.cols[c] = (ElkCsvColumn){ .type = types[c], .data = NULL };
+        if(max_rows == 0) { continue; }
 
-        /* Detect type of delimiter, or maybe no delimiter and end of buffer. */
-        b32 comma = (parser->buf_comma_bits >> bit_pos) & 1;
-        b32 newline = (parser->buf_newline_bits >> bit_pos) & 1;
-        b32 comma_or_newline = (any_delim >> bit_pos) & 1;
+        switch(types[c])
+        {
+            case ELK_CSV_COL_I64:  table.cols[c].data = elk_static_arena_nmalloc(arena, max_rows, i64); break;
+            case ELK_CSV_COL_F64:  table.cols[c].data = elk_static_arena_nmalloc(arena, max_rows, f64); break;
+            case ELK_CSV_COL_TIME: table.cols[c].data = elk_static_arena_nmalloc(arena, max_rows, ElkTime); break;
+            case ELK_CSV_COL_STR:  table.cols[c].data = elk_static_arena_nmalloc(arena, max_rows, ElkStr); break;
+            case ELK_CSV_COL_SKIP: continue;
+        }
+        StopIf(!table.cols[c].data, goto ERR_RETURN);
+    }
 
-        /* Turn off that bit so we don't find it again! This delimiter has been processed. */
-        parser->buf_comma_bits &= ~first_non_zero_bit_lsb;
-        parser->buf_newline_bits &= ~first_non_zero_bit_lsb;
-        parser->buf_any_delimiter_bits &= ~first_non_zero_bit_lsb;
+    /* Tokens for a batch of rows, stored by column. */
+    ElkStr *batch = elk_static_arena_nmalloc(arena, num_cols * ELK_CSV_LOAD_BATCH, ElkStr);
+    StopIf(!batch, goto ERR_RETURN);
 
-        /* Update parser state based on position of next delimiter, or end of buffer. */
-        parser->row += newline;
-        parser->col += -col * newline + comma;
-        next_value_len += run_len + 1 - comma_or_newline;
-        parser->remaining.start += run_len + 1;
-        parser->remaining.len -= run_len + 1;
-        parser->byte_pos = bit_pos + 1;
+    ElkCsvIndexIter iter = elk_csv_index_iter(&index);
+    if(has_header) { elk_csv_helper_index_skip_row(&iter); }
 
-        /* Signal need to stop if we found a delimiter */
-        stop = comma_or_newline;
+    size batch_rows = 0;
+    while(!elk_csv_index_iter_finished(&iter))
+    {
+        /* Skip blank lines. */
+        size const start = iter.next_start;
+        if(elk_csv_helper_index_blank_row(&index, start))
+        {
+            elk_csv_index_next_token(&iter);
+            continue;
+        }
 
-        /* If we finished the buffer and need to scan the next one, load a new buffer! */
-        if(bit_pos + 1 > 31)
+        size const row = iter.row;
+        b32 row_ended = false;
+        for(size c = 0; c < num_cols; ++c)
         {
-            if(parser->remaining.len > 0)
+            if(row_ended)
             {
-                elk_csv_helper_load_new_buffer_aligned(parser, 0);
+                batch[c * ELK_CSV_LOAD_BATCH + batch_rows] = (ElkStr){ .start = index.base + start, .len = 0 };
+            }
+            else if(types[c] == ELK_CSV_COL_SKIP)
+            {
+                size run = 1;
+                while(c + run < num_cols && types[c + run] == ELK_CSV_COL_SKIP) { ++run; }
+
+                /* If the row doesn't have enough commas, the last value in it is one of the skipped ones. */
+                if(elk_csv_index_skip_columns(&iter, run) < run)
+                {
+                    elk_csv_index_next_token(&iter);
+                    row_ended = true;
+                }
+                c += run - 1;
             }
             else
             {
-                stop = true;
+                ElkCsvToken token = elk_csv_index_next_token(&iter);
+                ElkStr value = elk_csv_lazy_unquote_str(token.value, dialect.quote, arena);
+                StopIf(!value.start, goto ERR_RETURN);
+                batch[c * ELK_CSV_LOAD_BATCH + batch_rows] = value;
+                row_ended = iter.row != row;
             }
         }
+
+        if(!row_ended) { elk_csv_helper_index_skip_row(&iter); }
+
+        batch_rows += 1;
+        if(batch_rows == ELK_CSV_LOAD_BATCH)
+        {
+            elk_csv_helper_load_batch(&table, batch_rows, batch, interner);
+            batch_rows = 0;
+        }
     }
+    elk_csv_helper_load_batch(&table, batch_rows, batch, interner);
 
-    return (ElkCsvToken){ .row=row, .col=col, .value=(ElkStr){.start=start, .len=next_value_len}};
+    elk_static_arena_free(arena, batch);
+    return table;
 
 ERR_RETURN:
-    parser->error = true;
-    return (ElkCsvToken){ .row=row, .col=col, .value=(ElkStr){.start=parser->remaining.start, .len=0}};
+    table.error = true;
+    return table;
 }
 
-#else
+static inline ElkCsvWriter
+elk_csv_create_writer(ElkCsvWriteFunction write, void *write_ctx, size buf_size, byte buffer[])
+{
+    Assert(buffer && buf_size >= 64); /* Numbers are formatted directly into the buffer, so they have to fit. */
 
-static inline ElkCsvToken 
-elk_csv_fast_next_token(ElkCsvParser *parser)
+    return (ElkCsvWriter)
+    {
+        .write = write,
+        .write_ctx = write_ctx,
+        .buffer = (ElkStr){ .start = buffer, .len = buf_size },
+        .len = 0,
+        .col = 0,
+        .dialect = ELK_CSV_DIALECT_DEFAULT,
+        .error = false,
+    };
+}
+
+static inline void
+elk_csv_helper_writer_flush_buffer(ElkCsvWriter *writer)
 {
-    return elk_csv_full_next_token(parser);
+    StopIf(writer->error || writer->len == 0, return);
+    StopIf(!writer->write, goto ERR_RETURN); /* Out of room, and nowhere to send it. */
+
+    size const written = writer->write(writer->write_ctx, writer->len, writer->buffer.start);
+    StopIf(written != writer->len, goto ERR_RETURN);
+
+    writer->len = 0;
+    return;
+
+ERR_RETURN:
+    writer->error = true;
 }
 
-#endif
+static inline char *
+elk_csv_helper_writer_reserve(ElkCsvWriter *writer, size num_bytes)
+{
+    /* Get room for a small number of bytes in the buffer, the caller updates len after writing to it. */
+    Assert(num_bytes <= 64);
+    if(writer->buffer.len - writer->len < num_bytes) { elk_csv_helper_writer_flush_buffer(writer); }
+    StopIf(writer->error, return NULL);
 
-static inline ElkStr 
-elk_csv_unquote_str(ElkStr str, ElkStr const buffer)
+    return writer->buffer.start + writer->len;
+}
+
+static inline void
+elk_csv_helper_writer_put(ElkCsvWriter *writer, char const *src, size len)
 {
-    // remove any leading and trailing white space
-    str = elk_str_strip(str);
+    while(len > 0 && !writer->error)
+    {
+        if(writer->len == writer->buffer.len) { elk_csv_helper_writer_flush_buffer(writer); continue; }
+
+        size const room = writer->buffer.len - writer->len;
+        size const num = len < room ? len : room;
+        memcpy(writer->buffer.start + writer->len, src, num);
+        writer->len += num;
+        src += num;
+        len -= num;
+    }
+}
 
-    if(str.len >= 2 && str.start[0] == '"')
+static inline void
+elk_csv_helper_writer_start_value(ElkCsvWriter *writer)
+{
+    if(writer->col > 0) { elk_csv_helper_writer_put(writer, &writer->dialect.delimiter, 1); }
+    writer->col += 1;
+}
+
+static inline u32
+elk_csv_helper_writer_scan(char const *block, size pos, size len, char const chars[4], u32 *quote_bits)
+{
+    /* Bits for characters that need quoting in the block that's pos bytes into an aligned run of len bytes. */
+    u32 bits[4] = {0};
+    elk_scan_chars(block + pos, chars, bits);
+
+    u32 valid_bits = UINT32_MAX;
+    if(len - pos < 32) { valid_bits &= ~(UINT32_MAX << (len - pos)); }
+
+    *quote_bits = bits[0] & valid_bits;
+    return (bits[0] | bits[1] | bits[2] | bits[3]) & valid_bits;
+}
+
+static inline void
+elk_csv_write_str(ElkCsvWriter *writer, ElkStr value)
+{
+    StopIf(writer->error, return);
+    b32 const first_col = writer->col == 0;
+    elk_csv_helper_writer_start_value(writer);
+
+    /* Scan in aligned blocks, they never cross a page boundary, so it's safe to read past the end of the string. */
+    char const chars[4] = { writer->dialect.quote, writer->dialect.delimiter, '\n', '\r' };
+    char *const first_block = (char *)((uptr)value.start & ~(uptr)0x1F);
+    size const skip_bytes = value.start - first_block;
+    size const end = skip_bytes + value.len;
+
+    /* Quote it if it has any special characters, or it would look like a comment line. */
+    b32 needs_quotes = first_col && value.len > 0 && value.start[0] == writer->dialect.comment;
+    for(size pos = 0; pos < end && !needs_quotes; pos += 32)
     {
-        // Ok, now we've got a quoted non-empty string.
-        int next_read = 1;
-        int next_write = 0;
-        size len = 0;
+        u32 quote_bits = 0;
+        u32 special = elk_csv_helper_writer_scan(first_block, pos, end, chars, &quote_bits);
+        if(pos == 0) { special &= UINT32_MAX << skip_bytes; }
+        needs_quotes = special != 0;
+    }
 
-        while(next_read < str.len && next_write < buffer.len)
-        {
-            if(str.start[next_read] == '"')
-            {
-                next_read++;
-                if(next_read >= str.len - 2) { break; }
-            }
+    if(!needs_quotes)
+    {
+        elk_csv_helper_writer_put(writer, value.start, value.len);
+        return;
+    }
 
-            buffer.start[next_write] = str.start[next_read];
+    /* Write runs of characters between quotes, and escape each quote with another one. */
+    elk_csv_helper_writer_put(writer, &writer->dialect.quote, 1);
+    char const *run_start = value.start;
+    for(size pos = 0; pos < end; pos += 32)
+    {
+        u32 quote_bits = 0;
+        elk_csv_helper_writer_scan(first_block, pos, end, chars, &quote_bits);
+        if(pos == 0) { quote_bits &= UINT32_MAX << skip_bytes; }
 
-            len += 1;
-            next_read += 1;
-            next_write += 1;
-        }
+        while(quote_bits)
+        {
+            char const *quote = first_block + pos + elk_bit_count_trailing_zeros32(quote_bits);
+            quote_bits &= quote_bits - 1;
 
-        return (ElkStr){ .start=buffer.start, .len=len};
+            elk_csv_helper_writer_put(writer, run_start, quote + 1 - run_start);
+            elk_csv_helper_writer_put(writer, &writer->dialect.quote, 1);
+            run_start = quote + 1;
+        }
     }
+    elk_csv_helper_writer_put(writer, run_start, value.start + value.len - run_start);
+    elk_csv_helper_writer_put(writer, &writer->dialect.quote, 1);
+}
 
-    return str;
+static inline void
+elk_csv_write_i64(ElkCsvWriter *writer, i64 value)
+{
+    StopIf(writer->error, return);
+    elk_csv_helper_writer_start_value(writer);
+
+    char *dest = elk_csv_helper_writer_reserve(writer, ELK_I64_FORMAT_MAX_LEN);
+    StopIf(!dest, return);
+
+    writer->len += elk_str_format_i64(value, ELK_I64_FORMAT_MAX_LEN, dest).len;
 }
 
-static inline ElkStr 
-elk_csv_simple_unquote_str(ElkStr str)
+static inline void
+elk_csv_write_f64(ElkCsvWriter *writer, f64 value, i32 num_decimals)
 {
-    // Handle string that isn't even quoted!
-    if(str.len < 2 || str.start[0] != '"') { return str; }
+    Assert(num_decimals <= 17);
 
-    return (ElkStr){ .start = str.start + 1, .len = str.len - 2};
+    StopIf(writer->error, return);
+    elk_csv_helper_writer_start_value(writer);
+
+    /* Fixed notation can be hundreds of characters long, so it may not fit in the buffer all at once. */
+    char buf[ELK_F64_FIXED_FORMAT_MAX_LEN];
+    ElkStr const text = num_decimals < 0
+        ? elk_str_format_f64(value, sizeof(buf), buf)
+        : elk_str_format_f64_fixed(value, num_decimals, sizeof(buf), buf);
+
+    elk_csv_helper_writer_put(writer, text.start, text.len);
+}
+
+static inline void
+elk_csv_write_time(ElkCsvWriter *writer, ElkTime value)
+{
+    StopIf(writer->error, return);
+    elk_csv_helper_writer_start_value(writer);
+
+    char *dest = elk_csv_helper_writer_reserve(writer, ELK_DATETIME_FORMAT_MAX_LEN);
+    StopIf(!dest, return);
+
+    writer->len += elk_time_format(value, ELK_DATETIME_LONG, ELK_DATETIME_FORMAT_MAX_LEN, dest).len;
+}
+
+static inline void
+elk_csv_write_end_row(ElkCsvWriter *writer)
+{
+    if(writer->dialect.crlf) { elk_csv_helper_writer_put(writer, "\r\n", 2); }
+    else { elk_csv_helper_writer_put(writer, "\n", 1); }
+
+    writer->col = 0;
+}
+
+static inline b32
+elk_csv_writer_flush(ElkCsvWriter *writer)
+{
+    if(writer->write) { elk_csv_helper_writer_flush_buffer(writer); }
+    return !writer->error;
 }
 
 static inline ElkRandomState
@@ -1,7 +1,12 @@
 #include <inttypes.h>
+#include <math.h>
 
 #include "test.h"
 
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
 /*---------------------------------------------------------------------------------------------------------------------------
  *
  *                                                        Test CSV
@@ -144,6 +149,1042 @@ test_unquote(void)
     }
 }
 
+static void
+test_lazy_unquote(void)
+{
+    char *test[] = {"\"Frank \"\"The Tank\"\" Johnson\"", "\"plain\"", "unquoted string", "\"\"", "\"\"\"\"", "", "'it''s'"};
+    char *correct_answer[] = {"Frank \"The Tank\" Johnson", "plain", "unquoted string", "", "\"", "", "it's"};
+    b32 copied[] = {true, false, false, false, true, false, true};
+
+    byte arena_storage[512] = {0};
+    ElkStaticArena arena = {0};
+    elk_static_arena_create(&arena, sizeof(arena_storage), arena_storage);
+
+    for(i32 i = 0; i < sizeof(test) / sizeof(test[0]); ++i)
+    {
+        ElkStr test_str = elk_str_from_cstring(test[i]);
+        char quote = test[i][0] == '\'' ? '\'' : '"';
+
+        ElkStr parsed = elk_csv_lazy_unquote_str(test_str, quote, &arena);
+        Assert(elk_str_eq(parsed, elk_str_from_cstring(correct_answer[i])));
+
+        b32 in_input = parsed.start >= test_str.start && parsed.start <= test_str.start + test_str.len;
+        Assert(in_input == !copied[i]);
+    }
+
+    /* Out of memory. */
+    ElkStaticArena tiny = {0};
+    elk_static_arena_create(&tiny, 4, arena_storage);
+    ElkStr parsed = elk_csv_lazy_unquote_str(elk_str_from_cstring(test[0]), '"', &tiny);
+    Assert(parsed.start == NULL && parsed.len == 0);
+}
+
+#define TEST_BIG_CSV_LEN ELK_KiB(64)
+#define TEST_BIG_CSV_MAX_TOKENS 12000
+#define TEST_MAX_CHUNKS 8
+
+static char big_csv[TEST_BIG_CSV_LEN];
+static ElkCsvToken big_csv_tokens[TEST_BIG_CSV_MAX_TOKENS];
+
+static ElkStr
+build_big_csv(void)
+{
+    size len = 0;
+    len += sprintf(big_csv + len, "station,valid_time,temperature,note\n");
+
+    for(i32 i = 0; len < TEST_BIG_CSV_LEN - 6000; ++i)
+    {
+        switch(i % 5)
+        {
+            case 0: len += sprintf(big_csv + len, "KMSO,2024-05-01 %02d:00:00,%d.5,plain\n", i % 24, i); break;
+            case 1: len += sprintf(big_csv + len, "KGPI,2024-05-01 %02d:00:00,%d.0,\"quoted, with comma\"\n", i % 24, i); break;
+            case 2: len += sprintf(big_csv + len, "KBTM,2024-05-01 %02d:00:00,%d,\"multi\nline\n\"\"note\"\"\"\n", i % 24, i); break;
+            case 3: len += sprintf(big_csv + len, "\"KHLN\",,,\n"); break;
+            case 4: len += sprintf(big_csv + len, "KMSO,2024-05-02 %02d:00:00,-%d.25,\"\"\n", i % 24, i); break;
+        }
+
+        /* One really long quoted value, longer than a chunk, with rows inside it that aren't really rows. */
+        if(i == 300)
+        {
+            len += sprintf(big_csv + len, "KLVM,2024-05-03 00:00:00,1.0,\"");
+            for(i32 j = 0; j < 5000; ++j) { len += sprintf(big_csv + len, "a,b\n"); }
+            len += sprintf(big_csv + len, "\"\n");
+        }
+    }
+
+    /* No newline at the end of the last row. */
+    len += sprintf(big_csv + len, "KMSO,2024-05-04 00:00:00,2.0,last");
+
+    Assert(len < TEST_BIG_CSV_LEN);
+    return (ElkStr){ .start = big_csv, .len = len };
+}
+
+static size
+parse_all_tokens(ElkStr input, ElkCsvToken *tokens, size max_tokens)
+{
+    ElkCsvParser p = elk_csv_create_parser(input);
+
+    size num_tokens = 0;
+    while(!elk_csv_finished(&p))
+    {
+        Assert(num_tokens < max_tokens);
+        tokens[num_tokens++] = elk_csv_fast_next_token(&p);
+        Assert(!p.error);
+    }
+
+    return num_tokens;
+}
+
+static void
+test_chunks(void)
+{
+    ElkStr input = build_big_csv();
+    size const num_tokens = parse_all_tokens(input, big_csv_tokens, TEST_BIG_CSV_MAX_TOKENS);
+
+    /* The full parser should agree with the fast parser, including the last row with no newline at the end. */
+    ElkCsvParser full = elk_csv_create_parser(input);
+    for(size i = 0; i < num_tokens; ++i)
+    {
+        ElkCsvToken t = elk_csv_full_next_token(&full);
+        Assert(t.row == big_csv_tokens[i].row && t.col == big_csv_tokens[i].col);
+        Assert(elk_str_eq(t.value, big_csv_tokens[i].value));
+    }
+    Assert(elk_csv_finished(&full));
+    Assert(big_csv_tokens[num_tokens - 1].col == 3);
+    Assert(elk_str_eq(big_csv_tokens[num_tokens - 1].value, elk_str_from_cstring("last")));
+
+    for(size max_chunks = 1; max_chunks <= TEST_MAX_CHUNKS; ++max_chunks)
+    {
+        ElkCsvChunk chunks[TEST_MAX_CHUNKS] = {0};
+        size num_chunks = elk_csv_chunks_create(input, max_chunks, chunks);
+        Assert(num_chunks == max_chunks);
+
+        for(size c = 0; c < num_chunks; ++c) { elk_csv_chunk_scan(&chunks[c]); }
+        num_chunks = elk_csv_chunks_finalize(num_chunks, chunks);
+        Assert(num_chunks >= 1 && num_chunks <= max_chunks);
+
+        /* Parse every chunk and check we get the same tokens, in the same order, as parsing it all at once. */
+        size next_token = 0;
+        size row_offset = 0;
+        char *next_start = input.start;
+        for(size c = 0; c < num_chunks; ++c)
+        {
+            Assert(chunks[c].text.start == next_start);
+            next_start += chunks[c].text.len;
+
+            ElkCsvParser p = elk_csv_create_parser(chunks[c].text);
+            while(!elk_csv_finished(&p))
+            {
+                ElkCsvToken t = elk_csv_fast_next_token(&p);
+                ElkCsvToken expected = big_csv_tokens[next_token++];
+
+                Assert(!p.error);
+                Assert(t.row + row_offset == expected.row && t.col == expected.col);
+                Assert(elk_str_eq(t.value, expected.value));
+            }
+
+            row_offset += p.row;
+        }
+
+        Assert(next_start == input.start + input.len);
+        Assert(next_token == num_tokens);
+        Assert(row_offset == big_csv_tokens[num_tokens - 1].row + 1);
+    }
+}
+
+#if !defined(_WIN32)
+typedef struct
+{
+    ElkCsvChunk *chunk;
+    size num_rows;
+    size num_tokens;
+    u64 hash;
+} ChunkWork;
+
+static void *
+scan_chunk_thread(void *arg)
+{
+    ChunkWork *work = arg;
+    elk_csv_chunk_scan(work->chunk);
+    return NULL;
+}
+
+static void *
+parse_chunk_thread(void *arg)
+{
+    ChunkWork *work = arg;
+
+    ElkCsvParser p = elk_csv_create_parser(work->chunk->text);
+    u64 hash = fnv_offset_bias;
+    while(!elk_csv_finished(&p))
+    {
+        ElkCsvToken t = elk_csv_fast_next_token(&p);
+        hash = elk_fnv1a_hash_accumulate(t.value.len, t.value.start, hash);
+        work->num_tokens += 1;
+    }
+
+    work->num_rows = p.row;
+    work->hash = hash;
+    return NULL;
+}
+
+static void
+test_chunks_threaded(void)
+{
+    ElkStr input = build_big_csv();
+    size const num_tokens = parse_all_tokens(input, big_csv_tokens, TEST_BIG_CSV_MAX_TOKENS);
+
+    ElkCsvChunk chunks[TEST_MAX_CHUNKS] = {0};
+    ChunkWork work[TEST_MAX_CHUNKS] = {0};
+    pthread_t threads[TEST_MAX_CHUNKS];
+
+    size num_chunks = elk_csv_chunks_create(input, TEST_MAX_CHUNKS, chunks);
+    for(size c = 0; c < num_chunks; ++c)
+    {
+        work[c] = (ChunkWork){ .chunk = &chunks[c] };
+        Assert(pthread_create(&threads[c], NULL, scan_chunk_thread, &work[c]) == 0);
+    }
+    for(size c = 0; c < num_chunks; ++c) { Assert(pthread_join(threads[c], NULL) == 0); }
+
+    num_chunks = elk_csv_chunks_finalize(num_chunks, chunks);
+
+    for(size c = 0; c < num_chunks; ++c)
+    {
+        work[c] = (ChunkWork){ .chunk = &chunks[c] };
+        Assert(pthread_create(&threads[c], NULL, parse_chunk_thread, &work[c]) == 0);
+    }
+    for(size c = 0; c < num_chunks; ++c) { Assert(pthread_join(threads[c], NULL) == 0); }
+
+    /* Stitch the results back together in chunk order. */
+    size next_token = 0;
+    size total_rows = 0;
+    for(size c = 0; c < num_chunks; ++c)
+    {
+        u64 hash = fnv_offset_bias;
+        for(size i = 0; i < work[c].num_tokens; ++i)
+        {
+            ElkCsvToken t = big_csv_tokens[next_token++];
+            hash = elk_fnv1a_hash_accumulate(t.value.len, t.value.start, hash);
+        }
+        Assert(hash == work[c].hash);
+        total_rows += work[c].num_rows;
+    }
+
+    Assert(next_token == num_tokens);
+    Assert(total_rows == big_csv_tokens[num_tokens - 1].row + 1);
+}
+#endif
+
+typedef struct
+{
+    ElkStr src;
+    size pos;
+    size max_read;
+} TestReader;
+
+static size
+test_read(void *read_ctx, size max_bytes, byte *dest)
+{
+    TestReader *reader = read_ctx;
+
+    size num_bytes = reader->src.len - reader->pos;
+    num_bytes = num_bytes > max_bytes ? max_bytes : num_bytes;
+    num_bytes = num_bytes > reader->max_read ? reader->max_read : num_bytes;
+
+    memcpy(dest, reader->src.start + reader->pos, num_bytes);
+    reader->pos += num_bytes;
+    return num_bytes;
+}
+
+static byte stream_buffer[ELK_KiB(32)];
+
+static void
+test_stream_matches_dialect(ElkStr input, ElkCsvDialect dialect, size buf_size, size max_read)
+{
+    static ElkCsvToken tokens[TEST_BIG_CSV_MAX_TOKENS];
+    size num_tokens = 0;
+    ElkCsvParser fast = elk_csv_create_parser_dialect(input, dialect, NULL);
+    while(!elk_csv_finished(&fast))
+    {
+        Assert(num_tokens < TEST_BIG_CSV_MAX_TOKENS);
+        tokens[num_tokens++] = elk_csv_fast_next_token(&fast);
+    }
+
+    TestReader reader = { .src = input, .pos = 0, .max_read = max_read };
+    ElkCsvStreamParser p = elk_csv_create_stream_parser_dialect(test_read, &reader, buf_size, stream_buffer, dialect, NULL);
+
+    size next_token = 0;
+    while(!elk_csv_stream_finished(&p))
+    {
+        ElkCsvToken t = elk_csv_stream_next_token(&p);
+        ElkCsvToken expected = tokens[next_token++];
+
+        Assert(!p.error);
+        Assert(t.row == expected.row && t.col == expected.col);
+        Assert(elk_str_eq(t.value, expected.value));
+    }
+
+    Assert(!p.error);
+    Assert(next_token == num_tokens);
+}
+
+static void
+test_stream_matches(ElkStr input, size buf_size, size max_read)
+{
+    test_stream_matches_dialect(input, ELK_CSV_DIALECT_DEFAULT, buf_size, max_read);
+}
+
+static void
+test_stream(void)
+{
+    test_stream_matches(elk_str_from_cstring(sample_one), 100, 7);
+    test_stream_matches(elk_str_from_cstring(sample_one + 69), 96, 1);
+    test_stream_matches(elk_str_from_cstring(sample_one), sizeof(stream_buffer), sizeof(stream_buffer));
+
+    ElkStr input = build_big_csv();
+    test_stream_matches(input, ELK_KiB(32), 1000);
+    test_stream_matches(input, ELK_KiB(24) + 13, ELK_KiB(24));
+
+    /* The long quoted value won't fit in a small buffer. */
+    TestReader reader = { .src = input, .pos = 0, .max_read = 100 };
+    ElkCsvStreamParser p = elk_csv_create_stream_parser(test_read, &reader, ELK_KiB(4), stream_buffer);
+    while(!elk_csv_stream_finished(&p)) { elk_csv_stream_next_token(&p); }
+    Assert(p.error);
+}
+
+static char *sample_comments = 
+    "# Comments at the start, \"with quotes\", and commas.\n"
+    "station,valid_time,note\n"
+    "KMSO,2024-05-01 00:00:00,\"quoted, with a\n# that is not a comment\"\n"
+    "# A comment in the middle with one \" quote and a comma, here.\n"
+    "#\n"
+    "KGPI,2024-05-01 01:00:00,plain\n"
+    "\n"
+    "# Another comment to make sure some land on a block boundary at some alignment...............\n"
+    "KBTM,,\"\"\"\"\n"
+    "#FF0000,looks like a color but it's a comment\n"
+    "KHLN,2024-05-01 02:00:00,last row\n"
+    "# Comment at the end without a newline";
+
+static void
+test_index_matches_full(ElkStr input, ElkStaticArena *arena)
+{
+    ElkCsvIndex index = elk_csv_index_create(input, arena);
+    Assert(index.num_blocks > 0);
+
+    ElkCsvIndexIter iter = elk_csv_index_iter(&index);
+    ElkCsvParser p = elk_csv_create_parser(input);
+
+    size num_rows = 0;
+    while(!elk_csv_finished(&p))
+    {
+        ElkCsvToken expected = elk_csv_full_next_token(&p);
+        if(elk_csv_finished(&p) && expected.value.len == 0 && expected.col == 0) { break; } /* Trailing comment. */
+
+        Assert(!elk_csv_index_iter_finished(&iter));
+        ElkCsvToken t = elk_csv_index_next_token(&iter);
+
+        Assert(t.row == expected.row && t.col == expected.col);
+        Assert(elk_str_eq(t.value, expected.value));
+        num_rows = t.row + 1;
+    }
+
+    Assert(elk_csv_index_iter_finished(&iter));
+    Assert(elk_csv_index_count_rows(&index) == num_rows);
+}
+
+static void
+test_index(void)
+{
+    _Alignas(64) static char aligned[1024];
+    static _Alignas(64) byte arena_buf[ELK_KiB(64)];
+    ElkStaticArena arena_ = {0};
+    ElkStaticArena *arena = &arena_;
+    elk_static_arena_create(arena, sizeof(arena_buf), arena_buf);
+
+    /* Try every alignment so the comments and quotes land on both sides of the block boundaries. */
+    ElkStr sample = elk_str_from_cstring(sample_comments);
+    for(size offset = 0; offset < 64; ++offset)
+    {
+        memcpy(aligned + offset, sample.start, sample.len);
+        test_index_matches_full((ElkStr){ .start = aligned + offset, .len = sample.len }, arena);
+        elk_static_arena_reset(arena);
+    }
+
+    /* Empty input has no rows at any alignment. */
+    for(size offset = 0; offset < 64; ++offset)
+    {
+        ElkCsvIndex empty = elk_csv_index_create((ElkStr){ .start = aligned + offset, .len = 0 }, arena);
+        Assert(elk_csv_index_count_rows(&empty) == 0);
+
+        ElkCsvIndexIter iter = elk_csv_index_iter(&empty);
+        Assert(elk_csv_index_iter_finished(&iter));
+    }
+
+    ElkStr one = elk_str_from_cstring(sample_one);
+    test_index_matches_full(one, arena);
+    elk_static_arena_reset(arena);
+
+    ElkCsvIndex index = elk_csv_index_create(one, arena);
+    Assert(elk_csv_index_count_rows(&index) == 6);
+    elk_static_arena_reset(arena);
+
+    /* Compare with the fast parser on a big file, then skip columns. */
+    ElkStr input = build_big_csv();
+    size const num_tokens = parse_all_tokens(input, big_csv_tokens, TEST_BIG_CSV_MAX_TOKENS);
+    index = elk_csv_index_create(input, arena);
+    Assert(elk_csv_index_count_rows(&index) == big_csv_tokens[num_tokens - 1].row + 1);
+
+    ElkCsvIndexIter iter = elk_csv_index_iter(&index);
+    for(size i = 0; i < num_tokens; ++i)
+    {
+        ElkCsvToken t = elk_csv_index_next_token(&iter);
+        Assert(t.row == big_csv_tokens[i].row && t.col == big_csv_tokens[i].col);
+        Assert(elk_str_eq(t.value, big_csv_tokens[i].value));
+    }
+    Assert(elk_csv_index_iter_finished(&iter));
+
+    iter = elk_csv_index_iter(&index);
+    for(size i = 0; i < num_tokens; i += 4)
+    {
+        /* Every row has 4 columns, skip to the temperature then the rest of the row. */
+        Assert(big_csv_tokens[i].col == 0);
+        Assert(elk_csv_index_skip_columns(&iter, 2) == 2);
+
+        ElkCsvToken t = elk_csv_index_next_token(&iter);
+        Assert(t.row == big_csv_tokens[i + 2].row && t.col == 2);
+        Assert(elk_str_eq(t.value, big_csv_tokens[i + 2].value));
+
+        Assert(elk_csv_index_skip_columns(&iter, 5) == 0);
+        t = elk_csv_index_next_token(&iter);
+        Assert(t.col == 3 && elk_str_eq(t.value, big_csv_tokens[i + 3].value));
+    }
+    Assert(elk_csv_index_iter_finished(&iter));
+
+    /* Skipping stops at the end of a row. */
+    iter = elk_csv_index_iter(&index);
+    Assert(elk_csv_index_skip_columns(&iter, 10) == 3);
+    Assert(elk_str_eq(elk_csv_index_next_token(&iter).value, elk_str_from_cstring("note")));
+    Assert(elk_str_eq(elk_csv_index_next_token(&iter).value, elk_str_from_cstring("KMSO")));
+}
+
+static void
+test_next_row_matches_tokens(ElkStr input, size max_fields)
+{
+    ElkStr fields[8] = {0};
+    size const num_tokens = parse_all_tokens(input, big_csv_tokens, TEST_BIG_CSV_MAX_TOKENS);
+
+    ElkCsvParser p = elk_csv_create_parser(input);
+    size t = 0;
+    while(!elk_csv_finished(&p))
+    {
+        size const row = p.row;
+        size const num_fields = elk_csv_next_row(&p, max_fields, fields);
+        Assert(!p.error && p.row == row + 1 && p.col == 0);
+
+        for(size f = 0; f < num_fields; ++f, ++t)
+        {
+            Assert(t < num_tokens);
+            Assert(big_csv_tokens[t].row == row && big_csv_tokens[t].col == f);
+            if(f < max_fields) { Assert(elk_str_eq(fields[f], big_csv_tokens[t].value)); }
+        }
+    }
+    Assert(t == num_tokens);
+}
+
+static void
+test_next_row(void)
+{
+    _Alignas(32) static char aligned[256];
+    char *ragged = 
+        "a,b,c\n"
+        "1,\"2,3\",4,5\n"
+        "\n"
+        "6\n"
+        "\"quoted\nnewline\",7,8\n"
+        "9,10,11";
+
+    /* Try every alignment so the rows and quotes land on both sides of the buffer boundaries. */
+    ElkStr sample = elk_str_from_cstring(ragged);
+    for(size offset = 0; offset < 32; ++offset)
+    {
+        memcpy(aligned + offset, sample.start, sample.len);
+        ElkStr input = { .start = aligned + offset, .len = sample.len };
+        test_next_row_matches_tokens(input, 8);
+        test_next_row_matches_tokens(input, 2);
+    }
+
+    ElkStr fields[3] = {0};
+    ElkCsvParser p = elk_csv_create_parser(sample);
+    Assert(elk_csv_next_row(&p, 3, fields) == 3);
+    Assert(elk_str_eq(fields[2], elk_str_from_cstring("c")));
+    Assert(elk_csv_next_row(&p, 3, fields) == 4);
+    Assert(elk_str_eq(fields[1], elk_str_from_cstring("\"2,3\"")));
+    Assert(elk_csv_next_row(&p, 3, fields) == 1 && fields[0].len == 0);
+    Assert(elk_csv_next_row(&p, 3, fields) == 1);
+    Assert(elk_csv_next_row(&p, 3, fields) == 3);
+    Assert(elk_csv_next_row(&p, 3, fields) == 3);
+    Assert(elk_str_eq(fields[2], elk_str_from_cstring("11")));
+    Assert(elk_csv_finished(&p));
+
+    test_next_row_matches_tokens(elk_str_from_cstring(sample_one), 8);
+
+    /* The big file ends without a newline right at the end of a buffer. */
+    ElkStr input = build_big_csv();
+    test_next_row_matches_tokens(input, 4);
+    for(size len = input.len - 40; len < input.len; ++len)
+    {
+        test_next_row_matches_tokens((ElkStr){ .start = input.start, .len = len }, 3);
+    }
+}
+
+static void
+test_projected_row_matches_next_row(ElkStr input, u64 column_mask)
+{
+    ElkStr all_fields[64] = {0};
+    ElkStr fields[64] = {0};
+
+    ElkCsvParser all = elk_csv_create_parser(input);
+    ElkCsvParser p = elk_csv_create_parser(input);
+    while(!elk_csv_finished(&all))
+    {
+        size const num_all = elk_csv_next_row(&all, 64, all_fields);
+        size const num_fields = elk_csv_next_projected_row(&p, column_mask, fields);
+        Assert(!p.error && num_fields == num_all && p.row == all.row && p.col == 0);
+
+        size f = 0;
+        for(size c = 0; c < 64; ++c)
+        {
+            if(!((column_mask >> c) & 1)) { continue; }
+            if(c < num_all) { Assert(elk_str_eq(fields[f], all_fields[c])); }
+            else { Assert(fields[f].len == 0); }
+            f += 1;
+        }
+    }
+    Assert(elk_csv_finished(&p));
+}
+
+static void
+test_projected_row(void)
+{
+    _Alignas(32) static char aligned[256];
+    char *ragged = 
+        "a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p,q,r,s,t,u,v,w,x,y,z\n"
+        "1,\"2,3\",4,5\n"
+        "\n"
+        "6\n"
+        "\"quoted\nnewline\",7,8,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,9\n"
+        "9,10,11,";
+
+    u64 const masks[] = { 0, 1, 2, 0x5, 0x8, 0x6, 0x2000001, UINT64_MAX, UINT64_C(1) << 63 };
+
+    ElkStr sample = elk_str_from_cstring(ragged);
+    for(size offset = 0; offset < 32; ++offset)
+    {
+        memcpy(aligned + offset, sample.start, sample.len);
+        ElkStr input = { .start = aligned + offset, .len = sample.len };
+        for(size m = 0; m < sizeof(masks) / sizeof(masks[0]); ++m)
+        {
+            test_projected_row_matches_next_row(input, masks[m]);
+            test_projected_row_matches_next_row((ElkStr){ .start = input.start, .len = input.len - 1 }, masks[m]);
+        }
+    }
+
+    ElkStr fields[2] = {0};
+    ElkCsvParser p = elk_csv_create_parser(sample);
+    Assert(elk_csv_next_projected_row(&p, 0x2000004, fields) == 26);
+    Assert(elk_str_eq(fields[0], elk_str_from_cstring("c")) && elk_str_eq(fields[1], elk_str_from_cstring("z")));
+    Assert(elk_csv_next_projected_row(&p, 0x2000004, fields) == 4);
+    Assert(elk_str_eq(fields[0], elk_str_from_cstring("4")) && fields[1].len == 0);
+
+    ElkStr input = build_big_csv();
+    for(size m = 0; m < sizeof(masks) / sizeof(masks[0]); ++m)
+    {
+        test_projected_row_matches_next_row(input, masks[m]);
+        for(size len = input.len - 40; len < input.len; ++len)
+        {
+            test_projected_row_matches_next_row((ElkStr){ .start = input.start, .len = len }, masks[m]);
+        }
+    }
+}
+
+static char *sample_dialect = 
+    "# A comment with a \"quote\n"
+    "station,valid_time,temperature,note\n"
+    "KMSO,2024-05-01 00:00:00,12.5,\"quoted, with a comma\"\n"
+    "\"KH\"\"LN\",,,\n"
+    "\n"
+    "KBTM,2024-05-01 02:00:00,9,\"multi\nline\"\n"
+    "KGPI,2024-05-02 03:00:00,-3.25,a note that is long enough to need another buffer\n"
+    "last,row,without,newline";
+
+static size
+test_dialect_convert(ElkStr input, ElkCsvDialect dialect, char *dest)
+{
+    /* Convert the default dialect to another one. */
+    size len = 0;
+    b32 in_quotes = false;
+    b32 row_start = true;
+    for(size i = 0; i < input.len; ++i)
+    {
+        char c = input.start[i];
+        if(c == '#' && row_start)
+        {
+            /* Copy the rest of the comment line as is. */
+            dest[len++] = dialect.comment;
+            while(input.start[++i] != '\n') { dest[len++] = input.start[i]; }
+            c = '\n';
+        }
+        else if(c == '"') { in_quotes = !in_quotes; c = dialect.quote; }
+        else if(c == ',' && !in_quotes) { c = dialect.delimiter; }
+
+        if(c == '\n' && !in_quotes && dialect.crlf) { dest[len++] = '\r'; }
+
+        row_start = c == '\n';
+        dest[len++] = c;
+    }
+
+    return len;
+}
+
+static b32
+test_dialect_eq(ElkStr value, ElkStr expected, ElkCsvDialect dialect)
+{
+    if(value.len != expected.len) { return false; }
+    for(size i = 0; i < value.len; ++i)
+    {
+        char const e = expected.start[i] == '"' ? dialect.quote : expected.start[i];
+        if(value.start[i] != e) { return false; }
+    }
+
+    return true;
+}
+
+static void
+test_dialect(void)
+{
+    _Alignas(32) static char converted[1024];
+    ElkStr sample = elk_str_from_cstring(sample_dialect);
+    size const num_tokens = parse_all_tokens(sample, big_csv_tokens, TEST_BIG_CSV_MAX_TOKENS);
+
+    static _Alignas(64) byte expected_buf[ELK_KiB(16)];
+    static _Alignas(64) byte arena_buf[ELK_KiB(16)];
+    ElkStaticArena expected_arena = {0};
+    ElkStaticArena arena = {0};
+    elk_static_arena_create(&expected_arena, sizeof(expected_buf), expected_buf);
+    elk_static_arena_create(&arena, sizeof(arena_buf), arena_buf);
+
+    ElkCsvColumnType const types[] = { ELK_CSV_COL_STR, ELK_CSV_COL_TIME, ELK_CSV_COL_F64, ELK_CSV_COL_STR };
+    ElkCsvTable const expected_table = elk_csv_load_columns(sample, true, 4, types, NULL, &expected_arena);
+    Assert(!expected_table.error && expected_table.num_rows == 5);
+
+    ElkCsvDialect const dialects[] = 
+    {
+        { .delimiter = '\t', .quote = '"', .comment = '#', .crlf = false },
+        { .delimiter = '|', .quote = '\'', .comment = ';', .crlf = false },
+        { .delimiter = ';', .quote = '"', .comment = '%', .crlf = true },
+        { .delimiter = ',', .quote = '"', .comment = '#', .crlf = true },
+    };
+
+    for(size d = 0; d < sizeof(dialects) / sizeof(dialects[0]); ++d)
+    {
+        ElkCsvDialect const dialect = dialects[d];
+        for(size offset = 0; offset < 32; ++offset)
+        {
+            size const len = test_dialect_convert(sample, dialect, converted + offset);
+            ElkStr const input = { .start = converted + offset, .len = len };
+
+            ElkCsvParser fast = elk_csv_create_parser_dialect(input, dialect, NULL);
+            ElkCsvParser full = elk_csv_create_parser_dialect(input, dialect, NULL);
+            ElkCsvParser rows = elk_csv_create_parser_dialect(input, dialect, NULL);
+            ElkStr fields[8] = {0};
+            size num_fields = 0;
+            size field = 0;
+            for(size t = 0; t < num_tokens; ++t)
+            {
+                ElkCsvToken const expected = big_csv_tokens[t];
+
+                ElkCsvToken token = elk_csv_fast_next_token(&fast);
+                Assert(token.row == expected.row && token.col == expected.col);
+                Assert(test_dialect_eq(token.value, expected.value, dialect));
+
+                token = elk_csv_full_next_token(&full);
+                Assert(token.row == expected.row && token.col == expected.col);
+                Assert(test_dialect_eq(token.value, expected.value, dialect));
+
+                if(field == num_fields)
+                {
+                    num_fields = elk_csv_next_row(&rows, 8, fields);
+                    field = 0;
+                }
+                Assert(test_dialect_eq(fields[field++], expected.value, dialect));
+            }
+            Assert(elk_csv_finished(&fast) && elk_csv_finished(&full) && elk_csv_finished(&rows));
+
+            /* The structural index and the column loader. */
+            elk_static_arena_reset(&arena);
+            ElkCsvIndex const index = elk_csv_index_create_dialect(input, dialect, &arena, NULL);
+            Assert(elk_csv_index_count_rows(&index) == big_csv_tokens[num_tokens - 1].row + 1);
+
+            ElkCsvIndexIter iter = elk_csv_index_iter(&index);
+            for(size t = 0; t < num_tokens; ++t)
+            {
+                ElkCsvToken const expected = big_csv_tokens[t];
+                ElkCsvToken token = elk_csv_index_next_token(&iter);
+                Assert(token.row == expected.row && token.col == expected.col);
+                Assert(test_dialect_eq(token.value, expected.value, dialect));
+            }
+            Assert(elk_csv_index_iter_finished(&iter));
+
+            ElkCsvTable table = elk_csv_load_columns_dialect(input, dialect, true, 4, types, NULL, &arena, NULL);
+            Assert(!table.error && table.num_rows == expected_table.num_rows);
+            Assert(table.num_parse_errors == expected_table.num_parse_errors);
+            for(size r = 0; r < table.num_rows; ++r)
+            {
+                for(size c = 0; c < 4; c += 3)
+                {
+                    ElkStr const value = ((ElkStr *)table.cols[c].data)[r];
+                    Assert(test_dialect_eq(value, ((ElkStr *)expected_table.cols[c].data)[r], dialect));
+                }
+                Assert(((ElkTime *)table.cols[1].data)[r] == ((ElkTime *)expected_table.cols[1].data)[r]);
+
+                f64 const v = ((f64 *)table.cols[2].data)[r];
+                f64 const e = ((f64 *)expected_table.cols[2].data)[r];
+                Assert(v == e || (v != v && e != e));
+            }
+        }
+    }
+
+    /* With CRLF, a trailing '\r' comes off the last value even if there's no '\n' after it. */
+    ElkCsvDialect const crlf = { .delimiter = '|', .quote = '"', .comment = '#', .crlf = true };
+    char const *const cr_inputs[] = { "a|b\r", "id|note\r\na value long enough to get past a whole block|b\r" };
+    for(size i = 0; i < sizeof(cr_inputs) / sizeof(cr_inputs[0]); ++i)
+    {
+        ElkStr const cr_input = elk_str_from_cstring((char *)cr_inputs[i]);
+        for(size offset = 0; offset < 32; ++offset)
+        {
+            memcpy(converted + offset, cr_input.start, cr_input.len);
+            ElkStr const input = { .start = converted + offset, .len = cr_input.len };
+
+            ElkCsvParser fast = elk_csv_create_parser_dialect(input, crlf, NULL);
+            ElkCsvParser full = elk_csv_create_parser_dialect(input, crlf, NULL);
+            ElkCsvToken fast_token = {0};
+            ElkCsvToken full_token = {0};
+            while(!elk_csv_finished(&fast)) { fast_token = elk_csv_fast_next_token(&fast); }
+            while(!elk_csv_finished(&full)) { full_token = elk_csv_full_next_token(&full); }
+            Assert(elk_str_eq(fast_token.value, elk_str_from_cstring("b")));
+            Assert(elk_str_eq(full_token.value, elk_str_from_cstring("b")));
+
+            ElkCsvParser rows = elk_csv_create_parser_dialect(input, crlf, NULL);
+            ElkStr fields[4] = {0};
+            size num_fields = 0;
+            while(!elk_csv_finished(&rows)) { num_fields = elk_csv_next_row(&rows, 4, fields); }
+            Assert(num_fields == 2 && elk_str_eq(fields[1], elk_str_from_cstring("b")));
+
+            elk_static_arena_reset(&arena);
+            ElkCsvIndex const index = elk_csv_index_create_dialect(input, crlf, &arena, NULL);
+            ElkCsvIndexIter iter = elk_csv_index_iter(&index);
+            ElkCsvToken index_token = {0};
+            while(!elk_csv_index_iter_finished(&iter)) { index_token = elk_csv_index_next_token(&iter); }
+            Assert(elk_str_eq(index_token.value, elk_str_from_cstring("b")));
+        }
+    }
+
+    /* The chunk splitter has to find the quotes to know where the rows end. */
+    static char big_converted[2 * TEST_BIG_CSV_LEN];
+    ElkStr const big = build_big_csv();
+    size const big_num_tokens = parse_all_tokens(big, big_csv_tokens, TEST_BIG_CSV_MAX_TOKENS);
+    ElkCsvDialect const dialect = { .delimiter = '|', .quote = '\'', .comment = ';', .crlf = true };
+    ElkStr const input = { .start = big_converted, .len = test_dialect_convert(big, dialect, big_converted) };
+
+    ElkCsvChunk chunks[TEST_MAX_CHUNKS] = {0};
+    size num_chunks = elk_csv_chunks_create_dialect(input, dialect, TEST_MAX_CHUNKS, chunks);
+    Assert(num_chunks == TEST_MAX_CHUNKS);
+    for(size c = 0; c < num_chunks; ++c) { elk_csv_chunk_scan(&chunks[c]); }
+    num_chunks = elk_csv_chunks_finalize(num_chunks, chunks);
+
+    size next_token = 0;
+    size row_offset = 0;
+    for(size c = 0; c < num_chunks; ++c)
+    {
+        ElkCsvParser p = elk_csv_create_parser_dialect(chunks[c].text, dialect, NULL);
+        while(!elk_csv_finished(&p))
+        {
+            ElkCsvToken t = elk_csv_fast_next_token(&p);
+            ElkCsvToken expected = big_csv_tokens[next_token++];
+
+            Assert(!p.error);
+            Assert(t.row + row_offset == expected.row && t.col == expected.col);
+            Assert(test_dialect_eq(t.value, expected.value, dialect));
+        }
+
+        row_offset += p.row;
+    }
+    Assert(next_token == big_num_tokens);
+}
+
+static void
+test_stream_buffer_sizes(void)
+{
+    /* A data row that starts with a comment character isn't a comment after the start of the input, even if it happens to
+     * start a new window in the buffer. */
+    ElkStr const hashes = elk_str_from_cstring("id,tag\n1,a\n#2,b\n3,c\n#4,d\n5,e\n");
+    ElkStr const leading = elk_str_from_cstring("# Leading comment \"\n#\nid,tag\n1,a\n#2,b\n3,c\n#4,d\n5,e");
+    for(size buf_size = 8; buf_size <= 64; ++buf_size)
+    {
+        for(size max_read = 1; max_read <= buf_size; max_read += 3)
+        {
+            test_stream_matches(hashes, buf_size, max_read);
+            if(buf_size >= 20) { test_stream_matches(leading, buf_size, max_read); } /* The first comment has to fit. */
+        }
+    }
+
+    /* Other dialects, the carriage returns have to come off with CRLF line endings. */
+    static char converted[1024];
+    ElkStr sample = elk_str_from_cstring(sample_dialect);
+    ElkCsvDialect const dialects[] =
+    {
+        { .delimiter = '\t', .quote = '"', .comment = '#', .crlf = false },
+        { .delimiter = '|', .quote = '\'', .comment = ';', .crlf = true },
+        { .delimiter = ',', .quote = '"', .comment = '#', .crlf = true },
+    };
+
+    for(size d = 0; d < sizeof(dialects) / sizeof(dialects[0]); ++d)
+    {
+        ElkStr const input = { .start = converted, .len = test_dialect_convert(sample, dialects[d], converted) };
+        for(size buf_size = 96; buf_size <= input.len + 8; buf_size += 5)
+        {
+            test_stream_matches_dialect(input, dialects[d], buf_size, 17);
+        }
+
+        TestReader reader = { .src = input, .pos = 0, .max_read = 17 };
+        ElkCsvStreamParser p = elk_csv_create_stream_parser_dialect(test_read, &reader, 100, stream_buffer, dialects[d], NULL);
+        while(!elk_csv_stream_finished(&p))
+        {
+            ElkCsvToken t = elk_csv_stream_next_token(&p);
+            Assert(t.value.len == 0 || t.value.start[t.value.len - 1] != '\r');
+        }
+        Assert(!p.error);
+    }
+}
+
+static char *sample_columns = 
+    "# Comment lines and blank lines are skipped.\n"
+    "id,valid_time,value,skip,name\n"
+    "1,2024-05-01 00:00:00,1.5,x,\"KMSO\"\n"
+    "2,2024-05-01 01:00:00, -2.25 ,y,KGPI,extra,columns\n"
+    "\n"
+    "# Another comment\n"
+    "3,2024-05-01 02:00:00,,z,KMSO\n"
+    "4,bad\n"
+    "5,2024-05-01 04:00:00,4.0,w,KBTM";
+
+static void
+test_load_columns(void)
+{
+    static _Alignas(64) byte arena_buf[ELK_KiB(256)];
+    ElkStaticArena arena_ = {0};
+    ElkStaticArena *arena = &arena_;
+    elk_static_arena_create(arena, sizeof(arena_buf), arena_buf);
+    ElkStringInterner interner = elk_string_interner_create(5, arena);
+
+    ElkCsvColumnType types[] = { ELK_CSV_COL_I64, ELK_CSV_COL_TIME, ELK_CSV_COL_F64, ELK_CSV_COL_SKIP, ELK_CSV_COL_STR };
+    ElkCsvTable table = elk_csv_load_columns(elk_str_from_cstring(sample_columns), true, 5, types, &interner, arena);
+    Assert(!table.error);
+    Assert(table.num_rows == 5 && table.num_cols == 5);
+    Assert(table.num_parse_errors == 3); // Empty value, bad time, missing value
+
+    i64 const *ids = table.cols[0].data;
+    ElkTime const *times = table.cols[1].data;
+    f64 const *values = table.cols[2].data;
+    ElkStr const *names = table.cols[4].data;
+    Assert(table.cols[3].data == NULL);
+
+    for(size i = 0; i < 5; ++i) { Assert(ids[i] == i + 1); }
+
+    Assert(times[0] == elk_time_from_ymd_and_hms(2024, 5, 1, 0, 0, 0));
+    Assert(times[1] == elk_time_from_ymd_and_hms(2024, 5, 1, 1, 0, 0));
+    Assert(times[3] == INT64_MIN);
+    Assert(times[4] == elk_time_from_ymd_and_hms(2024, 5, 1, 4, 0, 0));
+
+    Assert(values[0] == 1.5 && values[1] == -2.25 && values[4] == 4.0);
+    Assert(values[2] != values[2] && values[3] != values[3]); // NaN
+
+    Assert(elk_str_eq(names[0], elk_str_from_cstring("KMSO")));
+    Assert(names[0].start == names[2].start); // Interned
+    Assert(elk_str_eq(names[1], elk_str_from_cstring("KGPI")));
+    Assert(names[3].len == 0);
+    Assert(elk_str_eq(names[4], elk_str_from_cstring("KBTM")));
+
+    /* An empty slice that isn't aligned has no rows. */
+    elk_static_arena_reset(arena);
+    table = elk_csv_load_columns((ElkStr){ .start = sample_columns + 1, .len = 0 }, false, 5, types, NULL, arena);
+    Assert(!table.error && table.num_rows == 0);
+
+    /* Escaped quotes are unescaped, with or without an interner. */
+    ElkStr const escaped = elk_str_from_cstring("name,id\n\"Frank \"\"The Tank\"\" Johnson\",1\n\"Plain\",2\n");
+    ElkCsvColumnType escaped_types[] = { ELK_CSV_COL_STR, ELK_CSV_COL_I64 };
+    for(i32 interned = 0; interned < 2; ++interned)
+    {
+        elk_static_arena_reset(arena);
+        ElkStringInterner escaped_interner = elk_string_interner_create(3, arena);
+        table = elk_csv_load_columns(escaped, true, 2, escaped_types, interned ? &escaped_interner : NULL, arena);
+        Assert(!table.error && table.num_rows == 2 && table.num_parse_errors == 0);
+
+        names = table.cols[0].data;
+        Assert(elk_str_eq(names[0], elk_str_from_cstring("Frank \"The Tank\" Johnson")));
+        Assert(elk_str_eq(names[1], elk_str_from_cstring("Plain")));
+        Assert(((i64 *)table.cols[1].data)[1] == 2);
+    }
+
+    /* Compare with parsing token by token on a big file, more than one batch. */
+    elk_static_arena_reset(arena);
+    ElkStr input = build_big_csv();
+    size const num_tokens = parse_all_tokens(input, big_csv_tokens, TEST_BIG_CSV_MAX_TOKENS);
+
+    ElkCsvColumnType big_types[] = { ELK_CSV_COL_STR, ELK_CSV_COL_TIME, ELK_CSV_COL_F64 };
+    table = elk_csv_load_columns(input, true, 3, big_types, NULL, arena);
+    Assert(!table.error);
+    Assert(table.num_rows == num_tokens / 4 - 1);
+
+    size num_errors = 0;
+    for(size r = 0; r < table.num_rows; ++r)
+    {
+        ElkCsvToken const *row = big_csv_tokens + 4 * (r + 1);
+        Assert(row[0].col == 0);
+
+        Assert(elk_str_eq(((ElkStr *)table.cols[0].data)[r], elk_csv_simple_unquote_str(row[0].value)));
+
+        ElkTime t = INT64_MIN;
+        num_errors += !elk_str_parse_datetime(row[1].value, &t);
+        Assert(((ElkTime *)table.cols[1].data)[r] == t);
+
+        f64 v = 0.0;
+        if(elk_str_robust_parse_f64(row[2].value, &v)) { Assert(((f64 *)table.cols[2].data)[r] == v); }
+        else { num_errors += 1; }
+    }
+    Assert(table.num_parse_errors == num_errors && num_errors > 0);
+}
+
+typedef struct
+{
+    char *dest;
+    size len;
+    size max_len;
+    size num_writes;
+} TestWriter;
+
+static size
+test_write(void *write_ctx, size num_bytes, byte const *src)
+{
+    TestWriter *w = write_ctx;
+    if(w->len + num_bytes > w->max_len) { return -1; }
+
+    memcpy(w->dest + w->len, src, num_bytes);
+    w->len += num_bytes;
+    w->num_writes += 1;
+    return num_bytes;
+}
+
+static void
+test_writer_rows(ElkCsvWriter *writer)
+{
+    elk_csv_write_str(writer, elk_str_from_cstring("station"));
+    elk_csv_write_str(writer, elk_str_from_cstring("count"));
+    elk_csv_write_str(writer, elk_str_from_cstring("value"));
+    elk_csv_write_str(writer, elk_str_from_cstring("valid_time"));
+    elk_csv_write_end_row(writer);
+
+    elk_csv_write_str(writer, elk_str_from_cstring("KMSO"));
+    elk_csv_write_i64(writer, 0);
+    elk_csv_write_f64(writer, 3.14159, 3);
+    elk_csv_write_time(writer, elk_time_from_ymd_and_hms(2024, 5, 1, 3, 4, 5));
+    elk_csv_write_end_row(writer);
+
+    elk_csv_write_str(writer, elk_str_from_cstring("#KGPI, \"Glacier\""));
+    elk_csv_write_i64(writer, INT64_MIN);
+    elk_csv_write_f64(writer, -0.0004, 3);
+    elk_csv_write_time(writer, elk_time_from_ymd_and_hms(1, 1, 1, 0, 0, 0));
+    elk_csv_write_end_row(writer);
+
+    elk_csv_write_str(writer, elk_str_from_cstring("multi\nline with a long value that spans 32 byte blocks, twice\""));
+    elk_csv_write_i64(writer, INT64_MAX);
+    elk_csv_write_f64(writer, -1.0e20, 2);
+    elk_csv_write_str(writer, elk_str_from_cstring(""));
+    elk_csv_write_end_row(writer);
+
+    elk_csv_write_str(writer, elk_str_from_cstring("KBTM"));
+    elk_csv_write_i64(writer, -42);
+    elk_csv_write_f64(writer, NAN, 1);
+    elk_csv_write_f64(writer, -INFINITY, 1);
+    elk_csv_write_f64(writer, 99.995, 0);
+    elk_csv_write_f64(writer, 1234567.891, 9);
+    elk_csv_write_f64(writer, 0.1, -1);
+    elk_csv_write_end_row(writer);
+}
+
+static char *test_writer_expected =
+    "station,count,value,valid_time\n"
+    "KMSO,0,3.142,2024-05-01 03:04:05\n"
+    "\"#KGPI, \"\"Glacier\"\"\",-9223372036854775808,0.000,0001-01-01 00:00:00\n"
+    "\"multi\nline with a long value that spans 32 byte blocks, twice\"\"\",9223372036854775807,-100000000000000000000.00,\n"
+    "KBTM,-42,NaN,-Infinity,100,1234567.891000000,0.1\n";
+
+static void
+test_writer(void)
+{
+    static char output[1024];
+    _Alignas(32) static byte buffer[1024];
+
+    /* Everything in one buffer. */
+    ElkCsvWriter writer = elk_csv_create_writer(NULL, NULL, sizeof(buffer), buffer);
+    test_writer_rows(&writer);
+    Assert(elk_csv_writer_flush(&writer));
+    Assert(elk_str_eq((ElkStr){ .start = writer.buffer.start, .len = writer.len }, elk_str_from_cstring(test_writer_expected)));
+
+    /* Small buffers have to flush, try them at every alignment. */
+    for(size offset = 0; offset < 32; ++offset)
+    {
+        TestWriter tw = { .dest = output, .len = 0, .max_len = sizeof(output) };
+        writer = elk_csv_create_writer(test_write, &tw, 64 + offset, buffer + offset);
+        test_writer_rows(&writer);
+        Assert(elk_csv_writer_flush(&writer) && writer.len == 0 && tw.num_writes > 1);
+        Assert(elk_str_eq((ElkStr){ .start = output, .len = tw.len }, elk_str_from_cstring(test_writer_expected)));
+    }
+
+    /* It all reads back in. */
+    ElkCsvParser p = elk_csv_create_parser(elk_str_from_cstring(test_writer_expected));
+    ElkStr fields[7] = {0};
+    Assert(elk_csv_next_row(&p, 7, fields) == 4);
+    Assert(elk_csv_next_row(&p, 7, fields) == 4);
+    Assert(elk_csv_next_row(&p, 7, fields) == 4);
+    i64 i = 0;
+    Assert(elk_str_parse_i64(fields[1], &i) && i == INT64_MIN);
+    Assert(elk_csv_next_row(&p, 7, fields) == 4);
+    Assert(elk_csv_next_row(&p, 7, fields) == 7);
+    f64 f = 0.0;
+    Assert(elk_str_robust_parse_f64(fields[3], &f) && f == -INFINITY);
+    Assert(elk_str_robust_parse_f64(fields[6], &f) && f == 0.1);
+    Assert(elk_csv_finished(&p));
+
+    /* Dialects and errors. */
+    writer = elk_csv_create_writer(NULL, NULL, 64, buffer);
+    writer.dialect = (ElkCsvDialect){ .delimiter = '\t', .quote = '\'', .comment = '#', .crlf = true };
+    elk_csv_write_str(&writer, elk_str_from_cstring("it's"));
+    elk_csv_write_str(&writer, elk_str_from_cstring("a,b"));
+    elk_csv_write_end_row(&writer);
+    Assert(elk_csv_writer_flush(&writer));
+    Assert(elk_str_eq((ElkStr){ .start = writer.buffer.start, .len = writer.len }, elk_str_from_cstring("'it''s'\ta,b\r\n")));
+
+    for(i32 r = 0; r < 10; ++r) { elk_csv_write_i64(&writer, INT64_MAX); }
+    Assert(writer.error && !elk_csv_writer_flush(&writer));
+
+    TestWriter tw = { .dest = output, .len = 0, .max_len = 100 };
+    writer = elk_csv_create_writer(test_write, &tw, 64, buffer);
+    for(i32 r = 0; r < 10; ++r) { elk_csv_write_i64(&writer, INT64_MAX); }
+    Assert(writer.error && !elk_csv_writer_flush(&writer));
+}
+
 /*---------------------------------------------------------------------------------------------------------------------------
  *                                                       All tests
  *-------------------------------------------------------------------------------------------------------------------------*/
@@ -154,4 +1195,17 @@ elk_csv_tests(void)
     test_one_fast();
     test_two_fast();
     test_unquote();
+    test_lazy_unquote();
+    test_chunks();
+    test_stream();
+    test_index();
+    test_load_columns();
+    test_writer();
+    test_next_row();
+    test_projected_row();
+    test_dialect();
+    test_stream_buffer_sizes();
+#if !defined(_WIN32)
+    test_chunks_threaded();
+#endif
 }
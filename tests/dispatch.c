@@ -0,0 +1,199 @@
+#include "test.h"
+
+#include <string.h>
+
+/*---------------------------------------------------------------------------------------------------------------------------
+ *
+ *                                              Tests for CPU Features & Dispatch
+ *
+ *-------------------------------------------------------------------------------------------------------------------------*/
+static void
+test_cpu_features(void)
+{
+    ElkCpuFeatures features = elk_cpu_features_detect();
+
+    /* Anything we compiled for had better be there at runtime. */
+#if __SSE2__
+    Assert(features.sse2);
+#endif
+#if __SSE4_2__
+    Assert(features.sse42);
+#endif
+#if __AVX2__
+    Assert(features.avx2);
+#endif
+#if __BMI2__
+    Assert(features.bmi2);
+#endif
+#if __PCLMUL__
+    Assert(features.pclmul);
+#endif
+}
+
+static char *dispatch_csv = 
+    "station,valid_time,temperature,note\n"
+    "KMSO,2024-05-01 00:00:00,12.5,plain\n"
+    "KGPI,2024-05-01 01:00:00,11.0,\"quoted, with comma\"\n"
+    "KBTM,2024-05-01 02:00:00,9,\"multi\nline\n\"\"note\"\"\"\n"
+    "\"KHLN\",,,\n"
+    "KMSO,2024-05-02 03:00:00,-3.25,\"\"\n"
+    "KMSO,2024-05-04 00:00:00,2.0,a much longer note that needs more than one buffer to hold it all";
+
+static void
+test_dispatch_matches(ElkDispatch const *dispatch, ElkStr input, ElkStaticArena *arena)
+{
+    ElkCsvParser expected = elk_csv_create_parser(input);
+    ElkCsvParser p = elk_csv_create_parser_dispatch(input, dispatch);
+    while(!elk_csv_finished(&expected))
+    {
+        ElkCsvToken et = elk_csv_fast_next_token(&expected);
+        ElkCsvToken t = elk_csv_fast_next_token(&p);
+        Assert(t.row == et.row && t.col == et.col && elk_str_eq(t.value, et.value));
+    }
+    Assert(elk_csv_finished(&p) && !p.error);
+
+    /* The full parser uses the dispatched kernel too. */
+    expected = elk_csv_create_parser(input);
+    p = elk_csv_create_parser_dispatch(input, dispatch);
+    while(!elk_csv_finished(&expected))
+    {
+        ElkCsvToken et = elk_csv_full_next_token(&expected);
+        ElkCsvToken t = elk_csv_full_next_token(&p);
+        Assert(t.row == et.row && t.col == et.col && elk_str_eq(t.value, et.value));
+    }
+    Assert(elk_csv_finished(&p) && !p.error);
+
+    /* So does the structural index. */
+    elk_static_arena_reset(arena);
+    ElkCsvIndex const index = elk_csv_index_create_dispatch(input, arena, dispatch);
+    Assert(index.num_blocks > 0);
+
+    ElkCsvIndexIter iter = elk_csv_index_iter(&index);
+    expected = elk_csv_create_parser(input);
+    while(!elk_csv_finished(&expected))
+    {
+        ElkCsvToken et = elk_csv_fast_next_token(&expected);
+        ElkCsvToken t = elk_csv_index_next_token(&iter);
+        Assert(t.row == et.row && t.col == et.col && elk_str_eq(t.value, et.value));
+    }
+    Assert(elk_csv_index_iter_finished(&iter));
+    Assert(elk_csv_index_count_rows(&index) == expected.row);
+}
+
+static void
+test_dispatch(void)
+{
+    ElkCpuFeatures const detected = elk_cpu_features_detect();
+    ElkCpuFeatures const sse2_only = { .sse2 = detected.sse2 };
+    ElkCpuFeatures const pclmul_only = { .pclmul = detected.pclmul };
+    ElkCpuFeatures const nothing = {0};
+
+    ElkDispatch const dispatches[] =
+    {
+        elk_dispatch_create(detected),
+        elk_dispatch_create(sse2_only),
+        elk_dispatch_create(pclmul_only),
+        elk_dispatch_create(nothing),
+    };
+
+    _Alignas(32) static char aligned[512];
+    ElkStr sample = elk_str_from_cstring(dispatch_csv);
+    Assert(sample.len + 32 < sizeof(aligned));
+
+    _Alignas(16) static byte index_buf[512];
+    ElkStaticArena index_arena = {0};
+    elk_static_arena_create(&index_arena, sizeof(index_buf), index_buf);
+
+    for(size d = 0; d < sizeof(dispatches) / sizeof(dispatches[0]); ++d)
+    {
+        for(size offset = 0; offset < 32; ++offset)
+        {
+            memcpy(aligned + offset, sample.start, sample.len);
+            test_dispatch_matches(&dispatches[d], (ElkStr){ .start = aligned + offset, .len = sample.len }, &index_arena);
+        }
+
+        char *valid[] =
+        {
+            "1981-04-15T00:15:16", "1981-04-15 00:15:16", "1981105001516", "1981-04-15T00:15:16Z",
+            "1981-04-14T23:15:16.5-01:00"
+        };
+        char *invalid[] =
+        {
+            "1981-4-15T00:15:16", "19810415001516", "1981 105 001516", "1981-04-31 00:15:16", "1981366001516"
+        };
+        for(size i = 0; i < sizeof(valid) / sizeof(valid[0]); ++i)
+        {
+            ElkTime out = 0;
+            Assert(dispatches[d].parse_datetime(elk_str_from_cstring(valid[i]), &out));
+            Assert(out == elk_time_from_ymd_and_hms(1981, 4, 15, 0, 15, 16));
+
+            out = 0;
+            Assert(!dispatches[d].parse_datetime(elk_str_from_cstring(invalid[i]), &out) && out == 0);
+        }
+
+        ElkStr numbers[] =
+        {
+            elk_str_from_cstring("-12.3"), elk_str_from_cstring("1013.25"), elk_str_from_cstring("1.2.3"),
+            elk_str_from_cstring("6.02e23"), elk_str_from_cstring("7")
+        };
+        f64 values[5] = {0};
+        b32 ok[5] = {0};
+        Assert(dispatches[d].parse_f64_batch(numbers, 5, values, ok) == 4);
+        Assert(ok[0] && values[0] == -12.3 && ok[1] && values[1] == 1013.25 && !ok[2]);
+        Assert(ok[3] && values[3] == 6.02e23 && ok[4] && values[4] == 7.0);
+
+        ElkStr times[9];
+        for(size i = 0; i < 9; ++i) { times[i] = elk_str_from_cstring(i == 4 ? invalid[3] : valid[i % 3]); }
+        ElkTime time_values[9] = {0};
+        Assert(dispatches[d].parse_datetime_batch(times, 9, time_values, NULL) == 8);
+        Assert(time_values[0] == elk_time_from_ymd_and_hms(1981, 4, 15, 0, 15, 16) && time_values[4] == INT64_MIN);
+
+        i16 years[9];
+        i8 months[9];
+        i8 days[9];
+        i8 hours[9];
+        i8 minutes[9];
+        i8 seconds[9];
+        i16 days_of_year[9];
+        ElkTimeColumns const columns =
+        {
+            .year = years, .month = months, .day = days, .hour = hours, .minute = minutes, .second = seconds,
+            .day_of_year = days_of_year
+        };
+        for(size i = 0; i < 9; ++i) { time_values[i] = elk_time_from_ymd_and_hms(1980 + i, 12, 31, 23, 59, 58); }
+        dispatches[d].time_to_columns(time_values, 9, columns);
+        for(size i = 0; i < 9; ++i)
+        {
+            Assert(years[i] == 1980 + i && months[i] == 12 && days[i] == 31 && hours[i] == 23 && minutes[i] == 59);
+            Assert(seconds[i] == 58 && days_of_year[i] == (elk_is_leap_year(1980 + i) ? 366 : 365));
+        }
+
+        ElkTime round_trip[9] = {0};
+        dispatches[d].time_from_columns(columns, 9, round_trip);
+        for(size i = 0; i < 9; ++i) { Assert(round_trip[i] == time_values[i]); }
+
+        dispatches[d].time_truncate_batch(time_values, 9, 6 * ElkHour, 3 * ElkHour, round_trip);
+        for(size i = 0; i < 9; ++i) { Assert(round_trip[i] == elk_time_from_ymd_and_hms(1980 + i, 12, 31, 21, 0, 0)); }
+
+        dispatches[d].time_truncate_to_calendar_batch(time_values, 9, ElkCalendarMonth, round_trip);
+        for(size i = 0; i < 9; ++i) { Assert(round_trip[i] == elk_time_from_ymd_and_hms(1980 + i, 12, 1, 0, 0, 0)); }
+
+        _Alignas(16) byte arena_buf[256];
+        ElkStaticArena arena = {0};
+        elk_static_arena_create(&arena, sizeof(arena_buf), arena_buf);
+        ElkStr texts[9];
+        Assert(dispatches[d].time_format_batch(time_values, 9, ELK_DATETIME_ISO_8601, &arena, texts));
+        Assert(elk_str_eq(texts[0], elk_str_from_cstring("1980-12-31T23:59:58")));
+        Assert(elk_str_eq(texts[8], elk_str_from_cstring("1988-12-31T23:59:58")));
+    }
+}
+
+/*---------------------------------------------------------------------------------------------------------------------------
+ *                                                       All tests
+ *-------------------------------------------------------------------------------------------------------------------------*/
+void
+elk_dispatch_tests(void)
+{
+    test_cpu_features();
+    test_dispatch();
+}
@@ -1,5 +1,8 @@
 #include "test.h"
+#include <inttypes.h>
 #include <math.h>
+#include <string.h>
+#include <time.h>
 
 /*---------------------------------------------------------------------------------------------------------------------------
  *
@@ -34,6 +37,90 @@ test_parse_i64(void)
     }
 }
 
+static void
+test_parse_i64_limits(void)
+{
+    char *valid_num_strs[] = {"9223372036854775807", "-9223372036854775808", "+0000000000000000000000001", "-0",
+                              "1234567890123456", "-123456789012345", "+123456789012345", "12345678901234567"};
+    i64 const valid_nums[] = {INT64_MAX, INT64_MIN, 1, 0, 1234567890123456, -123456789012345, 123456789012345,
+                              12345678901234567};
+
+    for (i32 i = 0; i < sizeof(valid_nums) / sizeof(valid_nums[0]); ++i)
+    {
+        i64 parsed = 0;
+        Assert(elk_str_parse_i64(elk_str_from_cstring(valid_num_strs[i]), &parsed) && parsed == valid_nums[i]);
+    }
+
+    char *invalid_num_strs[] = {"9223372036854775808", "-9223372036854775809", "18446744073709551616",
+                                "99999999999999999999", "", "-", "+", "--1", "+-1", "1-", "12 3", "1234567890123456x"};
+
+    for (i32 i = 0; i < sizeof(invalid_num_strs) / sizeof(invalid_num_strs[0]); ++i)
+    {
+        i64 parsed = 42;
+        Assert(!elk_str_parse_i64(elk_str_from_cstring(invalid_num_strs[i]), &parsed) && parsed == 42);
+    }
+
+    /* The vector version has to agree with the scalar version everywhere, including right after a page boundary. */
+    _Alignas(4096) static char text[ELK_KiB(8)];
+    ElkRandomState state = elk_random_state_create(99);
+    for(i32 i = 0; i < 10000; ++i)
+    {
+        char buf[32] = {0};
+        i64 value = (i64)elk_random_state_uniform_u64(&state) >> (elk_random_state_uniform_u64(&state) % 64);
+        i32 len = snprintf(buf, sizeof(buf), (i % 3 || value < 0) ? "%" PRId64 : "+%" PRId64, value);
+        if(i % 7 == 0) { buf[elk_random_state_uniform_u64(&state) % len] = 'x'; }
+
+        size const offset = (i % 2) ? ELK_KiB(4) : ELK_KiB(4) - 20 + (i % 20);
+        memcpy(text + offset, buf, len);
+        ElkStr str = { .start = text + offset, .len = len };
+
+        i64 expected = 0;
+        i64 parsed = 0;
+        b32 const expected_ok = elk_str_helper_parse_i64_scalar(str, &expected);
+        Assert(elk_str_parse_i64(str, &parsed) == expected_ok);
+        Assert(!expected_ok || parsed == expected);
+        if(i % 7 != 0) { Assert(expected_ok && parsed == value); }
+    }
+}
+
+#ifdef ELK_RUN_BENCHMARKS
+static void
+bench_parse_i64(void)
+{
+    /* Not a test, compile with -DELK_RUN_BENCHMARKS to compare the vector and scalar versions. */
+    enum { NUM = 100000, REPEATS = 100 };
+    static char text[NUM * 24];
+    static ElkStr strs[NUM];
+
+    ElkRandomState state = elk_random_state_create(7);
+    size len = 0;
+    for(i32 i = 0; i < NUM; ++i)
+    {
+        i64 value = (i64)(elk_random_state_uniform_u64(&state) % 10000000) - 5000000;
+        i32 n = snprintf(text + len, 24, "%" PRId64, value);
+        strs[i] = (ElkStr){ .start = text + len, .len = n };
+        len += n + 1;
+    }
+
+    i64 sum = 0;
+    clock_t start = clock();
+    for(i32 r = 0; r < REPEATS; ++r)
+    {
+        for(i32 i = 0; i < NUM; ++i) { i64 v = 0; elk_str_helper_parse_i64_scalar(strs[i], &v); sum += v; }
+    }
+    clock_t middle = clock();
+    for(i32 r = 0; r < REPEATS; ++r)
+    {
+        for(i32 i = 0; i < NUM; ++i) { i64 v = 0; elk_str_parse_i64(strs[i], &v); sum -= v; }
+    }
+    clock_t end = clock();
+
+    f64 const per_value = 1.0e9 / CLOCKS_PER_SEC / ((f64)NUM * REPEATS);
+    printf("parse i64: scalar %.2f ns, elk_str_parse_i64 %.2f ns, checksum %" PRId64 "\n",
+            (middle - start) * per_value, (end - middle) * per_value, sum);
+}
+#endif
+
 static void
 test_robust_parse_f64(void)
 {
@@ -55,7 +142,7 @@ test_robust_parse_f64(void)
         Assert(fabs((tval - parsed) / tval) < precision);
     }
 
-    char *invalid_num_strs[] = {"1.0x", " -1.0", "3.1415999999999999999", "1.0e500", "1.8e308"};
+    char *invalid_num_strs[] = {"1.0x", " -1.0", "1.0e500", "1.8e308"};
 
     for (i32 i = 0; i < sizeof(invalid_num_strs) / sizeof(invalid_num_strs[0]); ++i) 
     {
@@ -106,6 +193,408 @@ test_fast_parse_f64(void)
     }
 }
 
+static void
+test_f64_correctly_rounded(void)
+{
+    /* Hard cases, halfway between doubles, subnormals, and the edges of the range. */
+    char *hard_cases[] =
+    {
+        "0.1", "1e23", "8.98846567431158e307", "1.7976931348623157e308", "2.2250738585072011e-308",
+        "2.2250738585072014e-308", "4.9406564584124654e-324", "9007199254740993", "9007199254740993.0000000000000000001",
+        "9007199254740992.9999999999999999999", "9007199254740995", "1.00000000000000011102230246251565404236316680908203125",
+        "1.00000000000000011102230246251565404236316680908203124", "1.00000000000000011102230246251565404236316680908203126",
+        "7.4109846876186981626485318930233205854758970392148714663837852375101326090531312779794975454245398856969484704316857659638998506553390969459816219401617281718945106978546710679176872575177347315553307795408549809608457500958111373034747658096871009590975442271004757307809711118935784838675653998783503015228055934046593739791790738723868299395818481660169122019456499931289798411362062484498678713572180352209017023903285791732520220528974020802906854021606612375549983402671300035812486479041385743401875520901590172592547146296175134159774938718574737870961645638908718119841271673056017045493004705269590165763776884908267986972573366521765567941072508764337505851e-308",
+        "123456789012345678901234567890", "0.000000000000000000000000000000000000000000000000000000000001234567890123456789012345",
+        "3.14159265358979323846", "0.12345678901234567890123", "1.0000000000000000000001", "3.1415999999999999999",
+        "-9007199254740993.0000000000000000001",
+    };
+
+    for(i32 i = 0; i < sizeof(hard_cases) / sizeof(hard_cases[0]); ++i)
+    {
+        f64 parsed = NAN;
+        Assert(elk_str_fast_parse_f64(elk_str_from_cstring(hard_cases[i]), &parsed));
+        Assert(parsed == strtod(hard_cases[i], NULL));
+
+        /* The robust parser takes any number of significant digits too. */
+        parsed = NAN;
+        Assert(elk_str_robust_parse_f64(elk_str_from_cstring(hard_cases[i]), &parsed));
+        Assert(parsed == strtod(hard_cases[i], NULL));
+    }
+
+    /* The robust parser still rejects values that underflow to zero. */
+    f64 parsed = 0.0;
+    Assert(elk_str_robust_parse_f64(elk_str_from_cstring("4.9406564584124654e-324"), &parsed) && parsed > 0.0);
+    Assert(!elk_str_robust_parse_f64(elk_str_from_cstring("1.0e-400"), &parsed));
+    Assert(elk_str_robust_parse_f64(elk_str_from_cstring("0.0e-400"), &parsed) && parsed == 0.0);
+
+    /* Compare to the C library for a lot of random values, formatted different ways. */
+    ElkRandomState state = elk_random_state_create(42);
+    char const *formats[] = { "%.17g", "%.15g", "%.6e", "%.25e", "%.3f" };
+    for(i32 i = 0; i < 20000; ++i)
+    {
+        u64 bits = elk_random_state_uniform_u64(&state) & ~(UINT64_C(1) << 63);
+        f64 value = 0.0;
+        memcpy(&value, &bits, sizeof(value));
+        if(isnan(value) || isinf(value)) { continue; }
+
+        char buf[512] = {0};
+        snprintf(buf, sizeof(buf), formats[i % 5], value);
+
+        f64 expected = strtod(buf, NULL);
+        Assert(elk_str_fast_parse_f64(elk_str_from_cstring(buf), &parsed) && parsed == expected);
+
+        u64 parsed_bits = 0;
+        memcpy(&parsed_bits, &parsed, sizeof(parsed));
+        u64 expected_bits = 0;
+        memcpy(&expected_bits, &expected, sizeof(expected));
+        Assert(parsed_bits == expected_bits);
+
+        f64 robust = 0.0;
+        Assert(elk_str_robust_parse_f64(elk_str_from_cstring(buf), &robust) && robust == expected);
+    }
+
+    /* Random digits, so there are lots of values close to halfway between two doubles. */
+    for(i32 i = 0; i < 20000; ++i)
+    {
+        char buf[128] = {0};
+        i32 num_digits = 1 + elk_random_state_uniform_u64(&state) % 40;
+        i32 len = 0;
+        for(i32 d = 0; d < num_digits; ++d)
+        {
+            if(d == 1) { buf[len++] = '.'; }
+            buf[len++] = (char)('0' + elk_random_state_uniform_u64(&state) % 10);
+        }
+        i32 exp = (i32)(elk_random_state_uniform_u64(&state) % 660) - 330;
+        snprintf(buf + len, sizeof(buf) - len, "e%d", exp);
+
+        f64 expected = strtod(buf, NULL);
+        if(isinf(expected)) { continue; }
+        Assert(elk_str_fast_parse_f64(elk_str_from_cstring(buf), &parsed) && parsed == expected);
+
+        /* Except for underflow to zero, the robust parser has to agree. */
+        f64 robust = 0.0;
+        b32 const robust_ok = elk_str_robust_parse_f64(elk_str_from_cstring(buf), &robust);
+        Assert(robust_ok ? robust == expected : expected == 0.0);
+    }
+}
+
+static void
+test_parse_f64_batch_matches(ElkStr const *tokens, size n)
+{
+    f64 out[256] = {0};
+    b32 ok[256] = {0};
+    Assert(n <= 256);
+
+    size num_ok = elk_str_parse_f64_batch(tokens, n, out, ok);
+
+    size expected_ok = 0;
+    for(size i = 0; i < n; ++i)
+    {
+        f64 expected = 0.0;
+        b32 success = elk_str_robust_parse_f64(tokens[i], &expected);
+        expected_ok += success;
+
+        Assert(ok[i] == success);
+        Assert(memcmp(&expected, out + i, sizeof(f64)) == 0 || (isnan(expected) && isnan(out[i])));
+    }
+    Assert(num_ok == expected_ok);
+}
+
+static void
+test_parse_f64_batch(void)
+{
+    char *fixed[] =
+    {
+        "-12.3", "1013.25", "0", "-0", "+5", ".5", "5.", "1234567890123456", "-123456789012345", "0.000000000000001",
+        "9007199254740993", "1.2.3", "-", "", "1-2", "--1", "abc", "12a", " 1", "NaN", "-Infinity", "1e5", "2.5E-3",
+        "12345678901234567", "3.14159265358979323846", ".", "+.", "-.0", "99999999.99999999",
+        "0.12345678901234567890123", "-1.0000000000000000000001", "123456789012345678901234567890e-20",
+    };
+
+    /* Put them all in one buffer, separated by commas like they came out of a CSV file. */
+    _Alignas(4096) static char text[ELK_KiB(8)];
+    ElkStr tokens[256] = {0};
+    size n = 0;
+    size len = 0;
+    for(size i = 0; i < sizeof(fixed) / sizeof(fixed[0]); ++i)
+    {
+        size const token_len = strlen(fixed[i]);
+        memcpy(text + len, fixed[i], token_len);
+        tokens[n++] = (ElkStr){ .start = text + len, .len = token_len };
+        len += token_len + 1;
+        text[len - 1] = ',';
+    }
+
+    /* Random short decimals. */
+    ElkRandomState state = elk_random_state_create(13);
+    while(n < 200)
+    {
+        char buf[32] = {0};
+        i32 const whole = (i32)(elk_random_state_uniform_u64(&state) % 100000) - 50000;
+        i32 const frac = (i32)(elk_random_state_uniform_u64(&state) % 1000);
+        i32 const token_len = snprintf(buf, sizeof(buf), "%d.%0*d", whole, 1 + (i32)(n % 3), frac % (n % 3 == 0 ? 10 : 1000));
+
+        memcpy(text + len, buf, token_len);
+        tokens[n++] = (ElkStr){ .start = text + len, .len = token_len };
+        len += token_len + 1;
+        text[len - 1] = ',';
+    }
+
+    /* Strings right at the start of a page have to go through the scalar path. */
+    memcpy(text + ELK_KiB(4), "12.5", 4);
+    tokens[n++] = (ElkStr){ .start = text + ELK_KiB(4), .len = 4 };
+
+    /* Odd and even counts, so the last one is left over. */
+    test_parse_f64_batch_matches(tokens, n);
+    test_parse_f64_batch_matches(tokens + 1, n - 1);
+    test_parse_f64_batch_matches(tokens, 0);
+
+    f64 out[2] = {0};
+    Assert(elk_str_parse_f64_batch(tokens, 2, out, NULL) == 2 && out[0] == -12.3 && out[1] == 1013.25);
+
+    /* Long mantissas are correctly rounded, not errors. */
+    ElkStr const long_tokens[] =
+    {
+        elk_str_from_cstring("3.14159265358979323846"),
+        elk_str_from_cstring("0.12345678901234567890123"),
+        elk_str_from_cstring("1.0000000000000000000001"),
+    };
+    f64 long_out[3] = {0};
+    Assert(elk_str_parse_f64_batch(long_tokens, 3, long_out, NULL) == 3);
+    Assert(long_out[0] == strtod("3.14159265358979323846", NULL));
+    Assert(long_out[1] == strtod("0.12345678901234567890123", NULL));
+    Assert(long_out[2] == 1.0);
+}
+
+static void
+test_parse_fixed(void)
+{
+    char *strs[] = {"-12.3", "1013.25", "0", "-0.04", "+5", ".5", "5.", "12.345", "-12.355", "7.65", "9.999", "1", "-1.2"};
+    i64 const one_decimal[] = {-123, 10133, 0, 0, 50, 5, 50, 123, -124, 77, 100, 10, -12};
+    i64 const three_decimals[] = {-12300, 1013250, 0, -40, 5000, 500, 5000, 12345, -12355, 7650, 9999, 1000, -1200};
+
+    for(i32 i = 0; i < sizeof(strs) / sizeof(strs[0]); ++i)
+    {
+        i64 parsed = 0;
+        Assert(elk_str_parse_fixed(elk_str_from_cstring(strs[i]), 1, &parsed) && parsed == one_decimal[i]);
+        Assert(elk_str_parse_fixed(elk_str_from_cstring(strs[i]), 3, &parsed) && parsed == three_decimals[i]);
+    }
+
+    i64 parsed = 0;
+    Assert(elk_str_parse_fixed(elk_str_from_cstring("-922337203685477.5808"), 4, &parsed) && parsed == INT64_MIN);
+    Assert(elk_str_parse_fixed(elk_str_from_cstring("922337203685477.58074"), 4, &parsed) && parsed == INT64_MAX);
+    Assert(elk_str_parse_fixed(elk_str_from_cstring("3"), 18, &parsed) && parsed == INT64_C(3000000000000000000));
+
+    char *invalid[] = {"922337203685477.5808", "10", "", "-", ".", "1.2.3", "1e5", "abc", " 1", "1-", "--1"};
+    for(i32 i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    {
+        parsed = 42;
+        i32 const decimals = i == 1 ? 18 : 4;
+        Assert(!elk_str_parse_fixed(elk_str_from_cstring(invalid[i]), decimals, &parsed) && parsed == 42);
+    }
+
+    /* The batch version matches the single value version, except values out of range for an i32 fail. */
+    _Alignas(4096) static char text[ELK_KiB(8)];
+    ElkStr tokens[301] = {0};
+    size n = 0;
+    size len = 0;
+    ElkRandomState state = elk_random_state_create(5);
+    while(n < 300)
+    {
+        char buf[64] = {0};
+        i32 token_len = 0;
+        if(n < sizeof(strs) / sizeof(strs[0])) { token_len = snprintf(buf, sizeof(buf), "%s", strs[n]); }
+        else if(n < sizeof(strs) / sizeof(strs[0]) + sizeof(invalid) / sizeof(invalid[0]))
+        {
+            token_len = snprintf(buf, sizeof(buf), "%s", invalid[n - sizeof(strs) / sizeof(strs[0])]);
+        }
+        else
+        {
+            i64 const whole = (i64)(elk_random_state_uniform_u64(&state) % 2000000000) - 1000000000;
+            i32 const frac = (i32)(elk_random_state_uniform_u64(&state) % 100000);
+            token_len = snprintf(buf, sizeof(buf), "%" PRId64 ".%0*d", whole, 1 + (i32)(n % 5), frac % 10);
+            if(n % 11 == 0) { token_len = snprintf(buf, sizeof(buf), "%d", (i32)(whole % 10000)); }
+        }
+
+        memcpy(text + len, buf, token_len);
+        tokens[n++] = (ElkStr){ .start = text + len, .len = token_len };
+        len += token_len + 1;
+        text[len - 1] = ',';
+    }
+
+    /* Right at the start of a page. */
+    memcpy(text + ELK_KiB(4), "-7.25", 5);
+    tokens[n++] = (ElkStr){ .start = text + ELK_KiB(4), .len = 5 };
+
+    for(i32 decimals = 0; decimals <= 6; ++decimals)
+    {
+        i32 out[301] = {0};
+        b32 ok[301] = {0};
+        size num_ok = elk_str_parse_fixed_batch(tokens, n, decimals, out, ok);
+
+        size expected_ok = 0;
+        for(size i = 0; i < n; ++i)
+        {
+            i64 expected = 0;
+            b32 success = elk_str_parse_fixed(tokens[i], decimals, &expected);
+            success = success && expected >= INT32_MIN && expected <= INT32_MAX;
+            expected_ok += success;
+
+            Assert(ok[i] == success);
+            Assert(success ? out[i] == expected : out[i] == INT32_MIN);
+        }
+        Assert(num_ok == expected_ok);
+    }
+}
+
+static void
+test_format_i64(void)
+{
+    char buf[ELK_I64_FORMAT_MAX_LEN];
+    i64 values[] = { 0, 1, -1, 9, 10, 99, 100, -12345, 1000000007, INT64_MAX, INT64_MIN, INT64_MIN + 1 };
+    for(i32 i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+    {
+        char expected[32] = {0};
+        snprintf(expected, sizeof(expected), "%" PRIi64, values[i]);
+
+        ElkStr formatted = elk_str_format_i64(values[i], sizeof(buf), buf);
+        Assert(formatted.start == buf && elk_str_eq(formatted, elk_str_from_cstring(expected)));
+
+        i64 parsed = 0;
+        Assert(elk_str_parse_i64(formatted, &parsed) && parsed == values[i]);
+    }
+
+    /* Not enough room. */
+    ElkStr formatted = elk_str_format_i64(INT64_MIN, 19, buf);
+    Assert(formatted.start == NULL && formatted.len == 0);
+    formatted = elk_str_format_i64(-123, 4, buf);
+    Assert(elk_str_eq(formatted, elk_str_from_cstring("-123")));
+}
+
+static void
+test_format_f64(void)
+{
+    char buf[ELK_F64_FORMAT_MAX_LEN];
+
+    struct { f64 value; char *expected; } cases[] =
+    {
+        { 0.0, "0" }, { -0.0, "-0" }, { 1.0, "1" }, { -2.5, "-2.5" }, { 0.1, "0.1" }, { 0.3, "0.3" },
+        { 0.1 + 0.2, "0.30000000000000004" }, { 100.0, "100" }, { 1013.25, "1013.25" }, { 0.001, "0.001" },
+        { 0.0001, "0.0001" }, { 0.00001, "1e-5" }, { 1.25e-7, "1.25e-7" }, { 1.0e16, "10000000000000000" }, { 1.0e17, "1e17" },
+        { 6.02214076e23, "6.02214076e23" }, { 9007199254740993.0, "9007199254740992" }, { 1.0e23, "1e23" },
+        { 5e-324, "5e-324" }, { 2.2250738585072014e-308, "2.2250738585072014e-308" },
+        { 1.7976931348623157e308, "1.7976931348623157e308" }, { NAN, "NaN" }, { INFINITY, "Infinity" },
+        { -INFINITY, "-Infinity" },
+    };
+
+    for(i32 i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        ElkStr formatted = elk_str_format_f64(cases[i].value, sizeof(buf), buf);
+        Assert(elk_str_eq(formatted, elk_str_from_cstring(cases[i].expected)));
+    }
+
+    /* Compare to the shortest %e precision from the C library that round trips, for a lot of random values. */
+    ElkRandomState state = elk_random_state_create(7);
+    for(i32 i = 0; i < 50000; ++i)
+    {
+        u64 bits = elk_random_state_uniform_u64(&state);
+        if(i % 4 == 1) { bits &= UINT64_C(0x800FFFFFFFFFFFFF); }       /* Subnormals */
+        if(i % 4 == 2) { bits &= UINT64_C(0xFFFFFFFFF0000000); }       /* Few significant digits */
+        if(i % 4 == 3) { bits = (bits & UINT64_C(0x800FFFFFFFFFFFFF)) | ((u64)(1075 - i % 60) << 52); } /* Near integers */
+
+        f64 value = 0.0;
+        memcpy(&value, &bits, sizeof(value));
+        if(isnan(value) || isinf(value) || value == 0.0) { continue; }
+
+        char expected[32] = {0};
+        for(i32 precision = 0; precision < 17; ++precision)
+        {
+            snprintf(expected, sizeof(expected), "%.*e", precision, value);
+            if(strtod(expected, NULL) == value) { break; }
+        }
+
+        ElkStr formatted = elk_str_format_f64(value, sizeof(buf), buf);
+        Assert(formatted.len > 0);
+
+        f64 round_trip = 0.0;
+        Assert(elk_str_robust_parse_f64(formatted, &round_trip) && round_trip == value);
+
+        /* Same significant digits. */
+        char expected_digits[32] = {0};
+        char digits[32] = {0};
+        i32 num_expected = 0;
+        i32 num_digits = 0;
+        for(char *c = expected; *c && *c != 'e'; ++c) { if(*c >= '0' && *c <= '9') { expected_digits[num_expected++] = *c; } }
+        for(size j = 0; j < formatted.len && formatted.start[j] != 'e'; ++j)
+        {
+            char c = formatted.start[j];
+            if(c >= '0' && c <= '9' && (num_digits > 0 || c != '0')) { digits[num_digits++] = c; }
+        }
+        while(num_expected > 1 && expected_digits[num_expected - 1] == '0') { --num_expected; }
+        while(num_digits > 1 && digits[num_digits - 1] == '0') { --num_digits; }
+        Assert(num_digits == num_expected && memcmp(digits, expected_digits, num_digits) == 0);
+    }
+
+    /* Not enough room, and the arena version. */
+    ElkStr formatted = elk_str_format_f64(0.1 + 0.2, 18, buf);
+    Assert(formatted.start == NULL && formatted.len == 0);
+
+    _Alignas(16) byte arena_buf[64];
+    ElkStaticArena arena = {0};
+    elk_static_arena_create(&arena, sizeof(arena_buf), arena_buf);
+    formatted = elk_str_format_f64_alloc(-1.5e-10, &arena);
+    Assert(elk_str_eq(formatted, elk_str_from_cstring("-1.5e-10")) && (byte *)formatted.start == arena_buf);
+    formatted = elk_str_format_i64_alloc(-42, &arena);
+    Assert(elk_str_eq(formatted, elk_str_from_cstring("-42")));
+}
+
+static void
+test_format_f64_fixed(void)
+{
+    char buf[ELK_F64_FIXED_FORMAT_MAX_LEN];
+
+    struct { f64 value; i32 decimals; char *expected; } cases[] =
+    {
+        { 0.0, 2, "0.00" }, { -0.0, 2, "0.00" }, { -0.004, 2, "0.00" }, { -0.005, 2, "-0.01" }, { 0.125, 2, "0.12" },
+        { 0.375, 2, "0.38" }, { 2.5, 0, "2" }, { 3.5, 0, "4" }, { 99.995, 2, "100.00" }, { 0.1, 17, "0.10000000000000001" },
+        { 1.0e20, 1, "100000000000000000000.0" }, { -123.456, 3, "-123.456" }, { 5e-324, 17, "0.00000000000000000" },
+        { NAN, 3, "NaN" }, { -INFINITY, 0, "-Infinity" },
+    };
+
+    for(i32 i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        ElkStr formatted = elk_str_format_f64_fixed(cases[i].value, cases[i].decimals, sizeof(buf), buf);
+        Assert(elk_str_eq(formatted, elk_str_from_cstring(cases[i].expected)));
+    }
+
+    /* The largest value fits in the buffer. */
+    ElkStr formatted = elk_str_format_f64_fixed(-1.7976931348623157e308, 17, sizeof(buf), buf);
+    Assert(formatted.len == ELK_F64_FIXED_FORMAT_MAX_LEN);
+
+    /* Compare to printf, but it keeps the minus sign for negative values that round to zero. */
+    ElkRandomState state = elk_random_state_create(11);
+    for(i32 i = 0; i < 50000; ++i)
+    {
+        u64 bits = elk_random_state_uniform_u64(&state);
+        i32 const biased_exponent = 1023 - 70 + (i32)(elk_random_state_uniform_u64(&state) % 140);
+        if(i % 8 != 0) { bits = (bits & UINT64_C(0x800FFFFFFFFFFFFF)) | ((u64)biased_exponent << 52); }
+
+        f64 value = 0.0;
+        memcpy(&value, &bits, sizeof(value));
+        if(isnan(value) || isinf(value)) { continue; }
+
+        i32 const decimals = i % 18;
+        char expected[ELK_F64_FIXED_FORMAT_MAX_LEN + 1] = {0};
+        snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+
+        char *start = expected;
+        if(start[0] == '-' && strspn(start + 1, "0.") == strlen(start + 1)) { ++start; }
+
+        formatted = elk_str_format_f64_fixed(value, decimals, sizeof(buf), buf);
+        Assert(elk_str_eq(formatted, elk_str_from_cstring(start)));
+    }
+}
+
 static void
 test_parse_datetime(void)
 {
@@ -131,6 +620,177 @@ test_parse_datetime(void)
     Assert(!elk_str_parse_datetime(tst_str2, &out) && out == 0);
     Assert(!elk_str_parse_datetime(tst_str3, &out) && out == 0);
 
+    // The compact formats
+    struct { char *str; ElkTime expected; } valid[] =
+    {
+        { "2024050112", elk_time_from_ymd_and_hms(2024, 5, 1, 12, 0, 0) },
+        { "202405011230", elk_time_from_ymd_and_hms(2024, 5, 1, 12, 30, 0) },
+        { "2024366235959", elk_time_from_ymd_and_hms(2024, 12, 31, 23, 59, 59) },
+        { "2023300060000", elk_time_from_ymd_and_hms(2023, 10, 27, 6, 0, 0) },
+        { "2024-02-29T23:59:59", elk_time_from_ymd_and_hms(2024, 2, 29, 23, 59, 59) },
+        { "0001-01-01 00:00:00", elk_time_from_ymd_and_hms(1, 1, 1, 0, 0, 0) },
+    };
+
+    char *invalid[] =
+    {
+        "2024130112", "2024050012", "2024053212", "2024050124", "202405011260", "2023366000000", "2023000000000",
+        "2023001006000", "2023-02-29 00:00:00", "2024-04-31 00:00:00", "0000-01-01 00:00:00", "2024-05-01 12:00:60",
+        "2024-05-01x12:00:00", "2024/05/01 12:00:00", "2024-05-01 12-00-00", "+024-05-01 12:00:00", "20240501 2",
+        "2024-05-01 1:00:00", "202405011", "20240501123",
+    };
+
+    /* Copy them to the end of a page-sized, aligned buffer to test reading near the end of the string. */
+    _Alignas(4096) static char page[4096];
+    for(i32 i = 0; i < sizeof(valid) / sizeof(valid[0]); ++i)
+    {
+        ElkStr str = elk_str_from_cstring(valid[i].str);
+        char *end = page + sizeof(page) - str.len;
+        memcpy(end, str.start, str.len);
+
+        out = 0;
+        Assert(elk_str_parse_datetime(str, &out) && out == valid[i].expected);
+        out = 0;
+        Assert(elk_str_parse_datetime((ElkStr){ .start = end, .len = str.len }, &out) && out == valid[i].expected);
+    }
+
+    for(i32 i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    {
+        out = 0;
+        Assert(!elk_str_parse_datetime(elk_str_from_cstring(invalid[i]), &out) && out == 0);
+    }
+}
+
+static void
+test_parse_datetime_iso8601(void)
+{
+    ElkTime const noon = elk_time_from_ymd_and_hms(2024, 5, 1, 12, 0, 0);
+    struct { char *str; ElkTime expected; i32 nanoseconds; } valid[] =
+    {
+        { "2024-05-01T12:00:00Z", noon, 0 },
+        { "2024-05-01T12:00:00.250+00:00", noon, 250000000 },
+        { "2024-05-01 12:00:00.5", noon, 500000000 },
+        { "2024-05-01T12:00:00.123456789Z", noon, 123456789 },
+        { "2024-05-01T12:00:00.000000001-00:00", noon, 1 },
+        { "2024-05-01T06:00:00-06:00", noon, 0 },
+        { "2024-05-01T17:30:00+0530", noon, 0 },
+        { "2024-05-02T02:00:00.75+14", noon, 750000000 },
+        { "2024-04-30T23:59:59.999999999-12:00", elk_time_from_ymd_and_hms(2024, 5, 1, 11, 59, 59), 999999999 },
+        { "2023-12-31T23:00:00-13:00", elk_time_from_ymd_and_hms(2024, 1, 1, 12, 0, 0), 0 },
+    };
+
+    /* Near the end of a page too, the fraction is read 16 bytes at a time. */
+    _Alignas(4096) static char page[4096];
+    for(i32 i = 0; i < sizeof(valid) / sizeof(valid[0]); ++i)
+    {
+        ElkStr str = elk_str_from_cstring(valid[i].str);
+        char *end = page + sizeof(page) - str.len;
+        memcpy(end, str.start, str.len);
+        ElkStr strs[2] = { str, { .start = end, .len = str.len } };
+
+        for(i32 j = 0; j < 2; ++j)
+        {
+            ElkTime out = 0;
+            i32 nanoseconds = -1;
+            Assert(elk_str_parse_datetime_ns(strs[j], &out, &nanoseconds));
+            Assert(out == valid[i].expected && nanoseconds == valid[i].nanoseconds);
+
+            out = 0;
+            Assert(elk_str_parse_datetime(strs[j], &out) && out == valid[i].expected);
+        }
+    }
+
+    char *invalid[] =
+    {
+        "2024-05-01T12:00:00z", "2024-05-01T12:00:00.", "2024-05-01T12:00:00.Z", "2024-05-01T12:00:00.1234567890Z",
+        "2024-05-01T12:00:00+24:00", "2024-05-01T12:00:00+01:60", "2024-05-01T12:00:00+1:00", "2024-05-01T12:00:00+01-00",
+        "2024-05-01T12:00:00+0", "2024-05-01T12:00:00ZZ", "2024-05-01T12:00:00 Z", "2024-05-01T12:00:00.5Z+01:00",
+        "0001-01-01T00:00:00+01:00", "2024-05-01T12:00:0.5", "2024050112Z", "2024-05-01T12:00:00.123456789+01:00:00",
+    };
+
+    for(i32 i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    {
+        ElkTime out = 0;
+        i32 nanoseconds = -1;
+        Assert(!elk_str_parse_datetime_ns(elk_str_from_cstring(invalid[i]), &out, &nanoseconds));
+        Assert(out == 0 && nanoseconds == -1);
+    }
+
+    /* The compact formats never have a fraction. */
+    ElkTime out = 0;
+    i32 nanoseconds = -1;
+    Assert(elk_str_parse_datetime_ns(elk_str_from_cstring("2024050112"), &out, &nanoseconds) && nanoseconds == 0);
+}
+
+static void
+test_parse_datetime_batch_matches(ElkStr const *tokens, size n)
+{
+    ElkTime out[256] = {0};
+    b32 ok[256] = {0};
+    Assert(n <= 256);
+
+    size num_ok = elk_str_parse_datetime_batch(tokens, n, out, ok);
+
+    size expected_ok = 0;
+    for(size i = 0; i < n; ++i)
+    {
+        ElkTime expected = INT64_MIN;
+        b32 success = elk_str_parse_datetime(tokens[i], &expected);
+        expected_ok += success;
+
+        Assert(ok[i] == success && out[i] == expected);
+    }
+    Assert(num_ok == expected_ok);
+}
+
+static void
+test_parse_datetime_batch(void)
+{
+    /* Random valid and slightly broken values in every format. */
+    static char text[256][20];
+    ElkStr tokens[256] = {0};
+    ElkRandomState state = elk_random_state_create(19);
+    char const *formats[] = { "%04d-%02d-%02d %02d:%02d:%02d", "%04d%03d%02d%02d%02d", "%04d%02d%02d%02d%02d",
+        "%04d%02d%02d%02d" };
+
+    for(i32 f = 0; f < 4; ++f)
+    {
+        for(i32 i = 0; i < 256; ++i)
+        {
+            i32 year = 1 + (i32)(elk_random_state_uniform_u64(&state) % 9999);
+            if(i % 3 == 0) { year = (i32)(elk_random_state_uniform_u64(&state) % 5) * 100 + 1600; } /* Leap centuries */
+            i32 month = 1 + (i32)(elk_random_state_uniform_u64(&state) % 12);
+            i32 day = 1 + (i32)(elk_random_state_uniform_u64(&state) % 31);
+            i32 hour = (i32)(elk_random_state_uniform_u64(&state) % 24);
+            i32 minute = (i32)(elk_random_state_uniform_u64(&state) % 60);
+            i32 second = (i32)(elk_random_state_uniform_u64(&state) % 60);
+            if(i % 17 == 5) { month = 13; }
+            if(i % 19 == 7) { hour = 24; }
+
+            if(f == 0) { snprintf(text[i], sizeof(text[i]), formats[f], year, month, day, hour, minute, second); }
+            if(f == 1)
+            {
+                i32 day_of_year = 1 + (i32)(elk_random_state_uniform_u64(&state) % 366);
+                snprintf(text[i], sizeof(text[i]), formats[f], year, day_of_year, hour, minute, second);
+            }
+            if(f == 2) { snprintf(text[i], sizeof(text[i]), formats[f], year, month, day, hour, minute); }
+            if(f == 3) { snprintf(text[i], sizeof(text[i]), formats[f], year, month, day, hour); }
+
+            if(i % 23 == 11) { text[i][2] = 'x'; }
+            if(f == 0 && i % 29 == 13) { text[i][10] = 'T'; }
+            if(f == 0 && i % 31 == 17) { text[i][13] = '-'; }
+
+            tokens[i] = elk_str_from_cstring(text[i]);
+        }
+
+        test_parse_datetime_batch_matches(tokens, 256);
+        test_parse_datetime_batch_matches(tokens + 3, 250);
+    }
+
+    /* Mixed formats fall back to parsing one at a time. */
+    tokens[5] = elk_str_from_cstring("2024050112");
+    tokens[9] = elk_str_from_cstring("");
+    tokens[20] = elk_str_from_cstring("2024-05-01T12:00:00.250+01:00");
+    test_parse_datetime_batch_matches(tokens, 64);
 }
 
 /*---------------------------------------------------------------------------------------------------------------------------
@@ -140,7 +800,20 @@ void
 elk_parse_tests(void)
 {
     test_parse_i64();
+    test_parse_i64_limits();
     test_robust_parse_f64();
     test_fast_parse_f64();
+    test_f64_correctly_rounded();
+    test_parse_f64_batch();
+    test_parse_fixed();
+    test_format_i64();
+    test_format_f64();
+    test_format_f64_fixed();
     test_parse_datetime();
+    test_parse_datetime_iso8601();
+    test_parse_datetime_batch();
+
+#ifdef ELK_RUN_BENCHMARKS
+    bench_parse_i64();
+#endif
 }
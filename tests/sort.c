@@ -267,6 +267,112 @@ elk_radix_sort_2darray_test(void)
     }
 }
 
+/*---------------------------------------------------------------------------------------------------------------------------
+ *
+ *                                                 Sorted Time Series Search
+ *
+ *-------------------------------------------------------------------------------------------------------------------------*/
+static size
+linear_lower_bound(ElkTime const *times, size n, ElkTime t)
+{
+    size i = 0;
+    while(i < n && times[i] < t) { ++i; }
+    return i;
+}
+
+static void
+elk_time_index_test(void)
+{
+    enum { MAX_TIMES = 5000 };
+    static ElkTime times[MAX_TIMES];
+    static _Alignas(64) byte arena_buf[ELK_KiB(16)];
+
+    size const sizes[] = { 0, 1, 7, 8, 9, 63, 64, 65, 511, 512, 513, 4097, MAX_TIMES };
+    for(size s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        size const n = sizes[s];
+
+        /* Hourly with some gaps and some repeated times. */
+        ElkTime t = elk_time_from_ymd_and_hms(2024, 1, 1, 0, 0, 0);
+        for(size i = 0; i < n; ++i)
+        {
+            times[i] = t;
+            if(i % 5 != 3) { t += i % 11 == 0 ? 6 * ElkHour : ElkHour; }
+        }
+
+        ElkStaticArena arena = {0};
+        elk_static_arena_create(&arena, sizeof(arena_buf), arena_buf);
+        ElkTimeIndex index = {0};
+        Assert(elk_time_index_create(times, n, &arena, &index));
+
+        ElkTime const first = n > 0 ? times[0] : 0;
+        for(ElkTime q = first - 2 * ElkHour; q <= t + ElkHour; q += ElkHour / 2)
+        {
+            size const lower = linear_lower_bound(times, n, q);
+            size const upper = linear_lower_bound(times, n, q + 1);
+            Assert(elk_time_index_lower_bound(&index, q) == lower);
+            Assert(elk_time_index_upper_bound(&index, q) == upper);
+            Assert(elk_time_index_as_of(&index, q) == upper - 1);
+        }
+
+        for(size i = 0; i < n; ++i)
+        {
+            Assert(elk_time_index_lower_bound(&index, times[i]) == linear_lower_bound(times, n, times[i]));
+            Assert(times[elk_time_index_as_of(&index, times[i])] == times[i]);
+        }
+
+        Assert(elk_time_index_lower_bound(&index, INT64_MIN) == 0);
+        Assert(elk_time_index_upper_bound(&index, INT64_MAX) == n);
+        Assert(elk_time_index_lower_bound(&index, INT64_MAX) == n);
+        Assert(elk_time_index_as_of(&index, INT64_MIN) == -1);
+    }
+
+    /* Not enough room in the arena. */
+    _Alignas(64) byte small_buf[64];
+    ElkStaticArena arena = {0};
+    elk_static_arena_create(&arena, sizeof(small_buf), small_buf);
+    ElkTimeIndex index = {0};
+    Assert(!elk_time_index_create(times, MAX_TIMES, &arena, &index));
+}
+
+static void
+elk_time_as_of_join_test(void)
+{
+    /* Forecasts every 6 hours with a long gap, and observations every 20 minutes starting before the first forecast. */
+    enum { NUM_FORECASTS = 40, NUM_OBS = 900 };
+    ElkTime forecasts[NUM_FORECASTS];
+    ElkTime obs[NUM_OBS];
+    size matches[NUM_OBS];
+
+    ElkTime const start = elk_time_from_ymd_and_hms(2024, 1, 1, 0, 0, 0);
+    for(size i = 0; i < NUM_FORECASTS; ++i) { forecasts[i] = start + (i < 20 ? i : i + 10) * 6 * ElkHour; }
+    for(size i = 0; i < NUM_OBS; ++i) { obs[i] = start - ElkHour + i * 20 * ElkMinute; }
+
+    ElkTimeDiff const tolerances[] = { INT64_MAX, 6 * ElkHour, ElkHour, 0 };
+    for(size j = 0; j < sizeof(tolerances) / sizeof(tolerances[0]); ++j)
+    {
+        size const num_matches = elk_time_as_of_join(obs, NUM_OBS, forecasts, NUM_FORECASTS, tolerances[j], matches);
+
+        size expected_matches = 0;
+        for(size i = 0; i < NUM_OBS; ++i)
+        {
+            size expected = -1;
+            for(size k = 0; k < NUM_FORECASTS && forecasts[k] <= obs[i]; ++k) { expected = k; }
+            if(expected >= 0 && obs[i] - forecasts[expected] > tolerances[j]) { expected = -1; }
+
+            Assert(matches[i] == expected);
+            expected_matches += expected >= 0;
+        }
+        Assert(num_matches == expected_matches);
+    }
+
+    /* Dense right side so the gallop takes big steps, and an empty right side. */
+    ElkTime const later[2] = { obs[NUM_OBS / 2] + 1, obs[NUM_OBS - 1] + ElkDay };
+    Assert(elk_time_as_of_join(later, 2, obs, NUM_OBS, INT64_MAX, matches) == 2);
+    Assert(matches[0] == NUM_OBS / 2 && matches[1] == NUM_OBS - 1);
+    Assert(elk_time_as_of_join(obs, 3, forecasts, 0, INT64_MAX, matches) == 0 && matches[2] == -1);
+}
+
 /*---------------------------------------------------------------------------------------------------------------------------
  *                                                       All tests
  *-------------------------------------------------------------------------------------------------------------------------*/
@@ -275,6 +381,8 @@ elk_sort_tests(void)
 {
     elk_radix_sort_test();
     elk_radix_sort_2darray_test();
+    elk_time_index_test();
+    elk_time_as_of_join_test();
 }
 
 #pragma warning(pop)
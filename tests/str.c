@@ -1,4 +1,6 @@
 #include "test.h"
+#include <inttypes.h>
+#include <time.h>
 
 /*---------------------------------------------------------------------------------------------------------------------------
  *
@@ -114,6 +116,68 @@ test_str_cmp(void)
     Assert(elk_str_cmp(sample_str, sample_copy_str) == 0);
 }
 
+static i32
+str_cmp_reference(ElkStr left, ElkStr right)
+{
+    size const len = left.len > right.len ? right.len : left.len;
+    for(size i = 0; i < len; ++i)
+    {
+        if(left.start[i] != right.start[i]) { return left.start[i] < right.start[i] ? -1 : 1; }
+    }
+    return left.len == right.len ? 0 : (left.len < right.len ? -1 : 1);
+}
+
+static void
+test_str_cmp_eq_page_edges(void)
+{
+    /* The vectorized versions load 32 bytes at a time, so try every length up to a few blocks with the strings right up
+     * against the start and the end of a page, and with a difference in every position.
+     */
+    _Alignas(4096) static char pages[3 * 4096];
+    char text[100];
+    for(size i = 0; i < sizeof(text); ++i) { text[i] = (char)(' ' + (i * 37) % 95 + (i % 7 == 3 ? 100 : 0)); }
+
+    for(size len = 0; len <= 96; ++len)
+    {
+        char *const left_spots[] = { pages + 4096, pages + 4096 - len, pages + 4096 + 13, pages + 2 * 4096 - len - 5 };
+        char *const right_spots[] = { pages + 2 * 4096 - len, pages + 4096 + 2, pages + 4096 - len - 1, pages + 4096 + 61 };
+        for(size l = 0; l < sizeof(left_spots) / sizeof(left_spots[0]); ++l)
+        {
+            for(size r = 0; r < sizeof(right_spots) / sizeof(right_spots[0]); ++r)
+            {
+                if(left_spots[l] < right_spots[r] + len && right_spots[r] < left_spots[l] + len) { continue; }
+
+                ElkStr const left = { .start = left_spots[l], .len = len };
+                ElkStr const right = { .start = right_spots[r], .len = len };
+                memcpy(left.start, text, len);
+                memcpy(right.start, text, len);
+                Assert(elk_str_eq(left, right) && elk_str_cmp(left, right) == 0);
+
+                if(len > 0)
+                {
+                    ElkStr const shorter = { .start = right.start, .len = len - 1 };
+                    Assert(!elk_str_eq(left, shorter));
+                    Assert(elk_str_cmp(left, shorter) == 1 && elk_str_cmp(shorter, left) == -1);
+                }
+
+                for(size i = 0; i < len; ++i)
+                {
+                    char const original = right.start[i];
+                    char const changes[] = { (char)(original + 1), (char)(original - 1), (char)(original ^ 0x80) };
+                    for(size c = 0; c < sizeof(changes); ++c)
+                    {
+                        right.start[i] = changes[c];
+                        Assert(!elk_str_eq(left, right) && !elk_str_eq(right, left));
+                        Assert(elk_str_cmp(left, right) == str_cmp_reference(left, right));
+                        Assert(elk_str_cmp(right, left) == str_cmp_reference(right, left));
+                    }
+                    right.start[i] = original;
+                }
+            }
+        }
+    }
+}
+
 static void
 test_str_copy(void)
 {
@@ -169,6 +233,65 @@ test_str_substr(void)
     Assert(elk_str_eq(sample_str, extra_substr));
 }
 
+#ifdef ELK_RUN_BENCHMARKS
+static void
+bench_str_eq_cmp(void)
+{
+    /* Not a test, compile with -DELK_RUN_BENCHMARKS to compare the vector and scalar versions. */
+    enum { NUM = 10000, REPEATS = 1000, MAX_LEN = 64 };
+    static char text[2 * NUM * MAX_LEN];
+    static ElkStr lefts[NUM];
+    static ElkStr rights[NUM];
+
+    size const lengths[] = { 4, 16, 32, 64 };
+    for(size l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l)
+    {
+        /* Pairs of strings that are equal, or differ somewhere, about half the time each. */
+        size const len = lengths[l];
+        ElkRandomState state = elk_random_state_create(11);
+        for(i32 i = 0; i < NUM; ++i)
+        {
+            char *left = text + 2 * i * MAX_LEN;
+            char *right = left + MAX_LEN;
+            for(size c = 0; c < len; ++c) { left[c] = right[c] = (char)('a' + elk_random_state_uniform_u64(&state) % 26); }
+            if(i & 1) { right[elk_random_state_uniform_u64(&state) % len] ^= 1; }
+
+            lefts[i] = (ElkStr){ .start = left, .len = len };
+            rights[i] = (ElkStr){ .start = right, .len = len };
+        }
+
+        i64 sum = 0;
+        clock_t const start = clock();
+        for(i32 r = 0; r < REPEATS; ++r)
+        {
+            for(i32 i = 0; i < NUM; ++i) { sum += elk_str_helper_eq_scalar(lefts[i], rights[i]); }
+        }
+        clock_t const eq_scalar = clock();
+        for(i32 r = 0; r < REPEATS; ++r)
+        {
+            for(i32 i = 0; i < NUM; ++i) { sum -= elk_str_eq(lefts[i], rights[i]); }
+        }
+        clock_t const eq = clock();
+        for(i32 r = 0; r < REPEATS; ++r)
+        {
+            for(i32 i = 0; i < NUM; ++i) { sum += elk_str_helper_cmp_scalar(lefts[i], rights[i]); }
+        }
+        clock_t const cmp_scalar = clock();
+        for(i32 r = 0; r < REPEATS; ++r)
+        {
+            for(i32 i = 0; i < NUM; ++i) { sum -= elk_str_cmp(lefts[i], rights[i]); }
+        }
+        clock_t const cmp = clock();
+
+        f64 const per_call = 1.0e9 / CLOCKS_PER_SEC / ((f64)NUM * REPEATS);
+        printf("str len %2td: eq scalar %.2f ns, elk_str_eq %.2f ns, cmp scalar %.2f ns, elk_str_cmp %.2f ns, "
+               "checksum %" PRId64 "\n",
+                len, (eq_scalar - start) * per_call, (eq - eq_scalar) * per_call, (cmp_scalar - eq) * per_call,
+                (cmp - cmp_scalar) * per_call, sum);
+    }
+}
+#endif
+
 /*---------------------------------------------------------------------------------------------------------------------------
  *                                                      All Str tests
  *-------------------------------------------------------------------------------------------------------------------------*/
@@ -179,6 +302,11 @@ elk_str_tests(void)
     test_str_strip();
     test_str_eq();
     test_str_cmp();
+    test_str_cmp_eq_page_edges();
     test_str_copy();
     test_str_substr();
+
+#ifdef ELK_RUN_BENCHMARKS
+    bench_str_eq_cmp();
+#endif
 }
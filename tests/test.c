@@ -23,6 +23,7 @@ main(void)
     elk_hash_set_tests();
     elk_sort_tests();
     elk_csv_tests();
+    elk_dispatch_tests();
 
     printf("\n\n*** Tests completed successfully. ***\n\n");
     return EXIT_SUCCESS;
@@ -31,6 +32,7 @@ main(void)
 #include "arena.c"
 #include "array_ledger.c"
 #include "csv.c"
+#include "dispatch.c"
 #include "fnv1a.c"
 #include "hash_set.c"
 #include "hash_tables.c"
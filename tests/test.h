@@ -27,5 +27,6 @@ void elk_hash_table_tests(void);
 void elk_hash_set_tests(void);
 void elk_sort_tests(void);
 void elk_csv_tests(void);
+void elk_dispatch_tests(void);
 
 #endif
@@ -105,14 +105,12 @@ test_time_time_t_is_seconds(void)
     Assert((day1 - epoch) == (60 * 60 * 24));
 }
 
-#if TEST_EVERY_1_SEC_INTERVAL || TEST_EVERY_SECOND
 // Days in a month - first row is normal, second is leap year
 static int dim[2][12] =
 {
     {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31},
     {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31},
 };
-#endif
 
 static void
 test_increments_are_1_second(void)
@@ -256,6 +254,101 @@ test_time_struct(void)
 #endif
 }
 
+static void
+test_time_struct_every_day(void)
+{
+    // Walk every day from 0001-01-01 through 32767-12-31 and check both directions of the calendar conversion.
+    i64 day_number = 0;
+    for (int year = 1; year <= INT16_MAX; ++year)
+    {
+        int const leap = elk_is_leap_year(year) ? 1 : 0;
+        int day_of_year = 1;
+        for (int month = 1; month <= 12; ++month)
+        {
+            for (int day = 1; day <= dim[leap][month - 1]; ++day, ++day_of_year, ++day_number)
+            {
+                // Vary the time of day so the hours, minutes, and seconds get exercised too.
+                int const hour = (int)(day_number % 24);
+                int const minute = (int)(day_number % 60);
+                int const second = (int)((day_number * 7) % 60);
+
+                ElkTime const t = elk_time_from_ymd_and_hms(year, month, day, hour, minute, second);
+                Assert(t == day_number * SECONDS_PER_DAY + hour * SECONDS_PER_HOUR + minute * SECONDS_PER_MINUTE + second);
+                Assert(t == elk_time_from_yd_and_hms(year, day_of_year, hour, minute, second));
+
+                ElkStructTime const tm = elk_make_struct_time(t);
+                Assert(tm.year == year);
+                Assert(tm.month == month);
+                Assert(tm.day == day);
+                Assert(tm.hour == hour);
+                Assert(tm.minute == minute);
+                Assert(tm.second == second);
+                Assert(tm.day_of_year == day_of_year);
+
+                Assert(elk_make_time(tm) == t);
+            }
+        }
+    }
+
+    Assert(day_number == elk_days_since_epoch(INT16_MAX + 1));
+}
+
+static void
+test_time_columns(void)
+{
+    /* Every day in the range, in chunks that aren't a multiple of 8 so the scalar tail gets used too. */
+    enum { CHUNK = 1003 };
+    ElkTime times[CHUNK];
+    ElkTime round_trip[CHUNK];
+    i16 years[CHUNK];
+    i8 months[CHUNK];
+    i8 days[CHUNK];
+    i8 hours[CHUNK];
+    i8 minutes[CHUNK];
+    i8 seconds[CHUNK];
+    i16 days_of_year[CHUNK];
+    ElkTimeColumns const columns =
+    {
+        .year = years, .month = months, .day = days, .hour = hours, .minute = minutes, .second = seconds,
+        .day_of_year = days_of_year
+    };
+
+    i64 const num_days = elk_days_since_epoch(INT16_MAX + 1);
+    for(i64 start = 0; start < num_days; start += CHUNK)
+    {
+        size const n = start + CHUNK <= num_days ? CHUNK : (size)(num_days - start);
+        for(size i = 0; i < n; ++i)
+        {
+            i64 const day_number = start + i;
+            times[i] = day_number * SECONDS_PER_DAY + (day_number * 7919) % SECONDS_PER_DAY;
+        }
+        times[0] = start * SECONDS_PER_DAY;                           // First second of a day
+        times[n - 1] = (start + n) * SECONDS_PER_DAY - 1;             // Last second of a day
+
+        elk_time_to_columns(times, n, columns);
+        for(size i = 0; i < n; ++i)
+        {
+            ElkStructTime const tm = elk_make_struct_time(times[i]);
+            Assert(years[i] == tm.year);
+            Assert(months[i] == tm.month);
+            Assert(days[i] == tm.day);
+            Assert(hours[i] == tm.hour);
+            Assert(minutes[i] == tm.minute);
+            Assert(seconds[i] == tm.second);
+            Assert(days_of_year[i] == tm.day_of_year);
+        }
+
+        elk_time_from_columns(columns, n, round_trip);
+        for(size i = 0; i < n; ++i) { Assert(round_trip[i] == times[i]); }
+    }
+
+    /* Columns that aren't needed can be left out. */
+    for(size i = 0; i < 9; ++i) { times[i] = elk_time_from_ymd_and_hms(2024, 2, 28, 23, 59, 59) + i * ElkDay; }
+    for(size i = 0; i < 9; ++i) { hours[i] = -1; days_of_year[i] = -1; }
+    elk_time_to_columns(times, 9, (ElkTimeColumns){ .hour = hours, .day_of_year = days_of_year });
+    for(size i = 0; i < 9; ++i) { Assert(hours[i] == 23 && days_of_year[i] == 59 + i); }
+}
+
 static void
 test_time_linux_timestamp(void)
 {
@@ -287,6 +380,174 @@ test_time_truncate_to_specific_hour()
     Assert(elk_time_truncate_to_specific_hour(start, 21) == target2);
 }
 
+static void
+test_time_truncate()
+{
+    ElkTime const t = elk_time_from_ymd_and_hms(2022, 6, 20, 19, 14, 39);
+
+    Assert(elk_time_truncate(t, 3 * ElkHour, 0) == elk_time_from_ymd_and_hms(2022, 6, 20, 18, 0, 0));
+    Assert(elk_time_truncate(t, 6 * ElkHour, 0) == elk_time_from_ymd_and_hms(2022, 6, 20, 18, 0, 0));
+    Assert(elk_time_truncate(t, ElkDay, 12 * ElkHour) == elk_time_from_ymd_and_hms(2022, 6, 20, 12, 0, 0));
+    Assert(elk_time_truncate(t, ElkDay, -3 * ElkHour) == elk_time_from_ymd_and_hms(2022, 6, 19, 21, 0, 0));
+    Assert(elk_time_truncate(t, ElkWeek, 0) == elk_time_from_ymd_and_hms(2022, 6, 20, 0, 0, 0)); // A Monday
+    Assert(elk_time_truncate(t, 15 * ElkMinute, 0) == elk_time_from_ymd_and_hms(2022, 6, 20, 19, 0, 0));
+    Assert(elk_time_truncate(t, ElkHour, ElkHour + 10 * ElkMinute) == elk_time_from_ymd_and_hms(2022, 6, 20, 19, 10, 0));
+
+    Assert(elk_time_truncate_to_calendar(t, ElkCalendarDay) == elk_time_from_ymd_and_hms(2022, 6, 20, 0, 0, 0));
+    Assert(elk_time_truncate_to_calendar(t, ElkCalendarMonth) == elk_time_from_ymd_and_hms(2022, 6, 1, 0, 0, 0));
+    Assert(elk_time_truncate_to_calendar(t, ElkCalendarYear) == elk_time_from_ymd_and_hms(2022, 1, 1, 0, 0, 0));
+
+    /* The batch versions must match over the whole range, including the first and last seconds of intervals. */
+    enum { NUM_TIMES = 1001 };
+    ElkTime times[NUM_TIMES];
+    ElkTime truncated[NUM_TIMES];
+    ElkTime const last = elk_time_from_ymd_and_hms(INT16_MAX, 12, 31, 23, 59, 59);
+
+    ElkTimeDiff const intervals[][2] =
+    {
+        {1, 0}, {ElkMinute, 0}, {3 * ElkHour, 0}, {6 * ElkHour, 3 * ElkHour}, {ElkDay, 12 * ElkHour}, {ElkDay, -ElkHour},
+        {ElkWeek, 0}, {7919, 13}, {365 * ElkDay, 5 * ElkDay}
+    };
+
+    for(i64 pass = 0; pass < 200; ++pass)
+    {
+        for(size i = 0; i < NUM_TIMES; ++i)
+        {
+            ElkTime const base = (last / (200 * NUM_TIMES)) * (pass * NUM_TIMES + (i64)i);
+            times[i] = base + ((i64)i * 104729) % ElkWeek;
+            if(i % 3 == 0) { times[i] = elk_time_truncate(times[i], ElkDay, 0); }
+            if(i % 3 == 1) { times[i] = elk_time_truncate(times[i], ElkHour, 0) - 1; }
+        }
+        times[0] = pass == 0 ? 0 : times[0];
+        times[NUM_TIMES - 1] = pass == 199 ? last : times[NUM_TIMES - 1];
+
+        for(size j = 0; j < sizeof(intervals) / sizeof(intervals[0]); ++j)
+        {
+            ElkTimeDiff const interval = intervals[j][0];
+            ElkTimeDiff const offset = intervals[j][1];
+            elk_time_truncate_batch(times, NUM_TIMES, interval, offset, truncated);
+            for(size i = 0; i < NUM_TIMES; ++i)
+            {
+                Assert(truncated[i] == elk_time_truncate(times[i], interval, offset));
+                Assert(truncated[i] <= times[i] && times[i] - truncated[i] < interval);
+                Assert((truncated[i] - offset) % interval == 0);
+            }
+        }
+
+        ElkCalendarUnit const units[] = { ElkCalendarDay, ElkCalendarMonth, ElkCalendarYear };
+        for(size j = 0; j < sizeof(units) / sizeof(units[0]); ++j)
+        {
+            elk_time_truncate_to_calendar_batch(times, NUM_TIMES, units[j], truncated);
+            for(size i = 0; i < NUM_TIMES; ++i)
+            {
+                ElkStructTime const tm = elk_make_struct_time(times[i]);
+                ElkStructTime const start = elk_make_struct_time(truncated[i]);
+                Assert(start.year == tm.year && start.hour == 0 && start.minute == 0 && start.second == 0);
+                Assert(start.month == (units[j] == ElkCalendarYear ? 1 : tm.month));
+                Assert(start.day == (units[j] == ElkCalendarDay ? tm.day : 1));
+                Assert(truncated[i] == elk_time_truncate_to_calendar(times[i], units[j]));
+            }
+        }
+    }
+
+    /* In place */
+    for(size i = 0; i < 9; ++i) { times[i] = t + (i64)i * ElkHour; }
+    elk_time_truncate_batch(times, 9, 3 * ElkHour, 0, times);
+    for(size i = 0; i < 9; ++i) { Assert(times[i] == elk_time_truncate(t + (i64)i * ElkHour, 3 * ElkHour, 0)); }
+}
+
+static void
+test_time_format(void)
+{
+    char buf[ELK_DATETIME_FORMAT_MAX_LEN];
+
+    struct { ElkTime time; ElkDatetimeFormat format; char *expected; } cases[] =
+    {
+        {elk_time_from_ymd_and_hms(2024, 5, 1, 3, 4, 5), ELK_DATETIME_LONG, "2024-05-01 03:04:05"},
+        {elk_time_from_ymd_and_hms(2024, 5, 1, 3, 4, 5), ELK_DATETIME_ISO_8601, "2024-05-01T03:04:05"},
+        {elk_time_from_ymd_and_hms(2024, 5, 1, 3, 4, 5), ELK_DATETIME_ISO_8601_Z, "2024-05-01T03:04:05Z"},
+        {elk_time_from_ymd_and_hms(2024, 5, 1, 3, 4, 5), ELK_DATETIME_DAY_OF_YEAR, "2024122030405"},
+        {elk_time_from_ymd_and_hms(2024, 5, 1, 3, 4, 5), ELK_DATETIME_COMPACT_MINUTES, "202405010304"},
+        {elk_time_from_ymd_and_hms(2024, 5, 1, 3, 4, 5), ELK_DATETIME_COMPACT_HOURS, "2024050103"},
+        {0, ELK_DATETIME_LONG, "0001-01-01 00:00:00"},
+        {0, ELK_DATETIME_DAY_OF_YEAR, "0001001000000"},
+        {elk_time_from_ymd_and_hms(9999, 12, 31, 23, 59, 59), ELK_DATETIME_ISO_8601_Z, "9999-12-31T23:59:59Z"},
+        {elk_time_from_ymd_and_hms(10000, 1, 1, 0, 0, 0), ELK_DATETIME_LONG, "10000-01-01 00:00:00"},
+        {elk_time_from_ymd_and_hms(32767, 12, 31, 23, 59, 59), ELK_DATETIME_ISO_8601_Z, "32767-12-31T23:59:59Z"},
+        {elk_time_from_ymd_and_hms(32767, 12, 31, 23, 59, 59), ELK_DATETIME_DAY_OF_YEAR, "32767365235959"},
+    };
+
+    for(size i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        ElkStr const text = elk_time_format(cases[i].time, cases[i].format, sizeof(buf), buf);
+        Assert(elk_str_eq(text, elk_str_from_cstring(cases[i].expected)) && text.start == buf);
+    }
+
+    /* Not enough room, and the arena version. */
+    ElkStr text = elk_time_format(0, ELK_DATETIME_LONG, 18, buf);
+    Assert(text.start == NULL && text.len == 0);
+
+    _Alignas(16) byte arena_buf[64];
+    ElkStaticArena arena = {0};
+    elk_static_arena_create(&arena, sizeof(arena_buf), arena_buf);
+    text = elk_time_format_alloc(cases[0].time, ELK_DATETIME_ISO_8601_Z, &arena);
+    Assert(elk_str_eq(text, elk_str_from_cstring(cases[2].expected)) && (byte *)text.start == arena_buf);
+
+    /* Everything parses back, the compact formats are truncated. */
+    for(ElkTime t = 0; t < elk_time_from_ymd_and_hms(10000, 1, 1, 0, 0, 0); t += 7919 * ElkMinute + 17)
+    {
+        ElkTime parsed = 0;
+        Assert(elk_str_parse_datetime(elk_time_format(t, ELK_DATETIME_LONG, sizeof(buf), buf), &parsed) && parsed == t);
+        Assert(elk_str_parse_datetime(elk_time_format(t, ELK_DATETIME_ISO_8601, sizeof(buf), buf), &parsed) && parsed == t);
+        Assert(elk_str_parse_datetime(elk_time_format(t, ELK_DATETIME_ISO_8601_Z, sizeof(buf), buf), &parsed) && parsed == t);
+        Assert(elk_str_parse_datetime(elk_time_format(t, ELK_DATETIME_DAY_OF_YEAR, sizeof(buf), buf), &parsed) && parsed == t);
+
+        Assert(elk_str_parse_datetime(elk_time_format(t, ELK_DATETIME_COMPACT_MINUTES, sizeof(buf), buf), &parsed));
+        Assert(parsed == elk_time_truncate(t, ElkMinute, 0));
+        Assert(elk_str_parse_datetime(elk_time_format(t, ELK_DATETIME_COMPACT_HOURS, sizeof(buf), buf), &parsed));
+        Assert(parsed == elk_time_truncate(t, ElkHour, 0));
+    }
+}
+
+static void
+test_time_format_batch(void)
+{
+    enum { NUM_TIMES = 1003 };
+    ElkTime times[NUM_TIMES];
+    ElkStr texts[NUM_TIMES];
+    char buf[ELK_DATETIME_FORMAT_MAX_LEN];
+
+    static byte arena_buf[NUM_TIMES * ELK_DATETIME_FORMAT_MAX_LEN];
+    ElkStaticArena arena = {0};
+    elk_static_arena_create(&arena, sizeof(arena_buf), arena_buf);
+
+    ElkTime const last = elk_time_from_ymd_and_hms(INT16_MAX, 12, 31, 23, 59, 59);
+    for(i64 pass = 0; pass < 20; ++pass)
+    {
+        /* Mostly 4 digit years, with a few 5 digit ones in some passes. */
+        ElkTime const range = pass % 4 == 3 ? last : elk_time_from_ymd_and_hms(10000, 1, 1, 0, 0, 0) - 1;
+        for(size i = 0; i < NUM_TIMES; ++i) { times[i] = (range / NUM_TIMES) * (i64)i + pass * 104729 + (i64)i * 7; }
+        times[NUM_TIMES - 1] = range;
+
+        for(ElkDatetimeFormat format = ELK_DATETIME_LONG; format <= ELK_DATETIME_COMPACT_HOURS; ++format)
+        {
+            elk_static_arena_reset(&arena);
+            Assert(elk_time_format_batch(times, NUM_TIMES, format, &arena, texts));
+            for(size i = 0; i < NUM_TIMES; ++i)
+            {
+                Assert(elk_str_eq(texts[i], elk_time_format(times[i], format, sizeof(buf), buf)));
+                if(i > 0) { Assert(texts[i].start == texts[i - 1].start + texts[i - 1].len); }
+            }
+        }
+    }
+
+    /* Not enough room in the arena. */
+    _Alignas(16) byte small_buf[64];
+    elk_static_arena_create(&arena, sizeof(small_buf), small_buf);
+    Assert(!elk_time_format_batch(times, 4, ELK_DATETIME_LONG, &arena, texts));
+    Assert(elk_time_format_batch(times, 3, ELK_DATETIME_LONG, &arena, texts));
+}
+
 static void
 test_time_addition()
 {
@@ -297,6 +558,108 @@ test_time_addition()
     Assert(elk_time_add(epoch, 14 * ElkMinute + 39 * ElkSecond) == t1);
 }
 
+static b32
+resample_reference(ElkTime const *times, f64 const *values, size n, ElkTime g, ElkResampleMethod method,
+        ElkTimeDiff max_gap, f64 *out)
+{
+    size prev = -1;
+    size next = -1;
+    for(size i = 0; i < n; ++i)
+    {
+        if(times[i] <= g) { prev = i; }
+        else if(next < 0) { next = i; }
+    }
+
+    if(prev >= 0 && times[prev] == g) { *out = values[prev]; return true; }
+
+    if(method == ELK_RESAMPLE_STEP && prev >= 0 && g - times[prev] <= max_gap) { *out = values[prev]; return true; }
+
+    if(method == ELK_RESAMPLE_NEAREST)
+    {
+        ElkTimeDiff const to_prev = prev >= 0 ? g - times[prev] : INT64_MAX;
+        ElkTimeDiff const to_next = next >= 0 ? times[next] - g : INT64_MAX;
+        if(prev >= 0 && to_prev <= to_next && to_prev <= max_gap) { *out = values[prev]; return true; }
+        if(next >= 0 && to_next < to_prev && to_next <= max_gap) { *out = values[next]; return true; }
+    }
+
+    if(method == ELK_RESAMPLE_LINEAR && prev >= 0 && next >= 0 && times[next] - times[prev] <= max_gap)
+    {
+        *out = values[prev] + (values[next] - values[prev]) * (f64)(g - times[prev]) / (f64)(times[next] - times[prev]);
+        return true;
+    }
+
+    return false;
+}
+
+static void
+test_time_series_resample(void)
+{
+    enum { NUM_OBS = 200, NUM_GRID = 151 };
+    ElkTime times[NUM_OBS];
+    f64 values[NUM_OBS];
+    f64 grid[NUM_GRID];
+
+    /* Observations every 7 to 97 minutes, with a few repeated times and a long outage. */
+    ElkTime const start = elk_time_from_ymd_and_hms(2024, 7, 1, 0, 0, 0);
+    ElkTime t = start + 13 * ElkMinute;
+    for(size i = 0; i < NUM_OBS; ++i)
+    {
+        times[i] = t;
+        values[i] = 15.0 + (f64)(i % 17) - 0.25 * (f64)i;
+        if(i % 23 != 5) { t += ((i * 37) % 91 + 7) * ElkMinute; }
+        if(i == 120) { t += 9 * ElkHour; }
+    }
+
+    ElkResampleMethod const methods[] = { ELK_RESAMPLE_STEP, ELK_RESAMPLE_NEAREST, ELK_RESAMPLE_LINEAR };
+    ElkTimeDiff const gaps[] = { INT64_MAX, 2 * ElkHour, 30 * ElkMinute, 0 };
+    ElkTime const starts[] = { start - 5 * ElkHour, start, times[0], times[NUM_OBS / 2] };
+    size const sizes[] = { 0, 1, 2, NUM_OBS };
+    ElkTimeDiff const steps[] = { 75 * ElkMinute, 12 * ElkHour };  /* Sometimes many observations between grid points. */
+
+    for(size m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m)
+    {
+        for(size gp = 0; gp < sizeof(gaps) / sizeof(gaps[0]); ++gp)
+        {
+            for(size st = 0; st < sizeof(starts) / sizeof(starts[0]); ++st)
+            {
+                for(size sz = 0; sz < sizeof(sizes) / sizeof(sizes[0]); ++sz)
+                {
+                    for(size sp = 0; sp < sizeof(steps) / sizeof(steps[0]); ++sp)
+                    {
+                        size const n = sizes[sz];
+                        size const num_ok = elk_time_series_resample(times, values, n, starts[st], steps[sp], NUM_GRID,
+                                methods[m], gaps[gp], grid);
+
+                        size expected_ok = 0;
+                        for(size i = 0; i < NUM_GRID; ++i)
+                        {
+                            f64 expected = 0.0;
+                            ElkTime const g = starts[st] + i * steps[sp];
+                            if(resample_reference(times, values, n, g, methods[m], gaps[gp], &expected))
+                            {
+                                f64 const diff = grid[i] - expected;
+                                Assert(diff < 1.0e-12 && diff > -1.0e-12);
+                                ++expected_ok;
+                            }
+                            else { Assert(grid[i] != grid[i]); }
+                        }
+                        Assert(num_ok == expected_ok);
+                    }
+                }
+            }
+        }
+    }
+
+    /* On the observation times exactly, every method gives back the observations. */
+    for(size m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m)
+    {
+        ElkTime const hourly[3] = { start, start + ElkHour, start + 2 * ElkHour };
+        f64 const hourly_values[3] = { 1.0, 2.0, 4.0 };
+        Assert(elk_time_series_resample(hourly, hourly_values, 3, start, ElkHour, 3, methods[m], 0, grid) == 3);
+        Assert(grid[0] == 1.0 && grid[1] == 2.0 && grid[2] == 4.0);
+    }
+}
+
 /*---------------------------------------------------------------------------------------------------------------------------
  *                                                     All time tests
  *-------------------------------------------------------------------------------------------------------------------------*/
@@ -308,8 +671,14 @@ elk_time_tests(void)
     test_time_time_t_is_seconds();
     test_increments_are_1_second();
     test_time_struct();
+    test_time_struct_every_day();
+    test_time_columns();
     test_time_linux_timestamp();
     test_time_truncate_to_hour();
     test_time_truncate_to_specific_hour();
+    test_time_truncate();
+    test_time_format();
+    test_time_format_batch();
+    test_time_series_resample();
     test_time_addition();
 }